@@ -0,0 +1,141 @@
+//
+// Created on 10/19/26.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "../client-server/include/blocks/BlockCompressor.hpp"
+
+using namespace std;
+
+/**
+ * Fill the data with lines made by a generator, as the intermediate files of a workflow.
+ */
+static void fillLines(vector<char> &data, mt19937_64 &generator, string (*line)(mt19937_64 &, size_t)) {
+    size_t filled = 0;
+    for (size_t i=0; filled < data.size(); i++) {
+        string text = line(generator, i);
+        size_t bytes = min(text.size(), data.size() - filled);
+        memcpy(data.data() + filled, text.data(), bytes);
+        filled += bytes;
+    }
+}
+
+static string csvLine(mt19937_64 &generator, size_t i) {
+    uniform_real_distribution<double> value(-100.0, 100.0);
+    return to_string(i) + "," + to_string(1700000000 + i) + ",station_" + to_string(generator() % 64) + "," + to_string(value(generator)) + "," + to_string(value(generator)) + "\n";
+}
+
+static string jsonLine(mt19937_64 &generator, size_t i) {
+    uniform_real_distribution<double> value(0.0, 1.0);
+    return "{\"id\": " + to_string(i) + ", \"task\": \"task-" + to_string(generator() % 256) + "\", \"status\": \"" + (generator() % 8 ? "completed" : "failed") +
+           "\", \"score\": " + to_string(value(generator)) + "}\n";
+}
+
+static string logLine(mt19937_64 &generator, size_t i) {
+    static const char *levels[] = {"INFO", "DEBUG", "WARN", "ERROR"};
+    return "2026-10-19 12:" + to_string(i / 60000 % 60) + ":" + to_string(i / 1000 % 60) + "." + to_string(i % 1000) + " " + levels[generator() % 4] +
+           " worker-" + to_string(generator() % 32) + " - processed chunk " + to_string(i) + " in " + to_string(generator() % 1000) + " ms\n";
+}
+
+static void fillRandom(vector<char> &data, mt19937_64 &generator) {
+    for (size_t i=0; i + sizeof(uint64_t) <= data.size(); i += sizeof(uint64_t)) {
+        uint64_t word = generator();
+        memcpy(data.data() + i, &word, sizeof(word));
+    }
+}
+
+/**
+ * Compress the blocks of the data and decompress them back, printing the throughput of a core and the ratio.
+ * It returns FALSE if the data read back is different.
+ */
+static bool measure(const string &name, vector<char> &data, int compression, const string &codec) {
+    BlockCompressor *blockCompressor = BlockCompressor::getInstance();
+    size_t nblocks = data.size() / FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+    vector<void *> blocks(nblocks);
+    for (size_t i=0; i < nblocks; i++) {
+        blocks[i] = data.data() + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+    }
+
+    //The raw blocks are in the data, they aren't released
+    vector<void *> replaced;
+    auto startSeal = chrono::steady_clock::now();
+    size_t savedBytes = blockCompressor->seal(blocks, compression, replaced);
+    double sealTime = chrono::duration<double>(chrono::steady_clock::now() - startSeal).count();
+
+    vector<char> readBack(data.size());
+    auto startLoad = chrono::steady_clock::now();
+    for (size_t i=0; i < nblocks; i++) {
+        blockCompressor->load(blocks[i], readBack.data() + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+    }
+    double loadTime = chrono::duration<double>(chrono::steady_clock::now() - startLoad).count();
+    bool same = memcmp(data.data(), readBack.data(), nblocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE) == 0;
+
+    for (void *block : blocks) {
+        blockCompressor->release(block);
+    }
+
+    double bytes = (double) nblocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+    cout << setw(6) << codec << setw(8) << name << setw(10) << replaced.size() << "/" << nblocks << setprecision(2) << setw(10) << bytes / (bytes - savedBytes)
+         << setprecision(0) << setw(14) << bytes / sealTime / (1 << 20) << setw(14) << bytes / loadTime / (1 << 20) << (same ? "" : "  MISMATCH") << endl;
+    return same;
+}
+
+int main(int argc, char *argv[]) {
+    size_t dataBytes = (size_t) 64 << 20;
+
+    int opt;
+    bool help = false;
+    while (!help && (opt = getopt(argc, argv, "m:h")) != -1) {
+        switch (opt) {
+            case 'm':
+                dataBytes = (size_t) max(atoi(optarg), 1) << 20;
+                break;
+            default:
+                help = true;
+                break;
+        }
+    }
+    if (help) {
+        cout << "Usage: " << argv[0] << " [-m MiB of each dataset (64)]" << endl;
+        cout << "Measure the compression of the blocks of the storage processes on a core, with each codec built in" << endl;
+        return opt == 'h' ? 0 : 1;
+    }
+
+    vector<pair<int, string> > codecs = {{DAGONFS_COMPRESSION_LZ4, "lz4"}, {DAGONFS_COMPRESSION_ZSTD, "zstd"}};
+    vector<pair<string, vector<char> > > datasets = {{"csv", vector<char>(dataBytes)}, {"json", vector<char>(dataBytes)}, {"log", vector<char>(dataBytes)}, {"random", vector<char>(dataBytes)}};
+    mt19937_64 generator(1);
+    fillLines(datasets[0].second, generator, csvLine);
+    fillLines(datasets[1].second, generator, jsonLine);
+    fillLines(datasets[2].second, generator, logLine);
+    fillRandom(datasets[3].second, generator);
+
+    cout << fixed << setw(6) << "codec" << setw(8) << "data" << setw(17) << "compressed" << setw(10) << "ratio" << setw(14) << "write MiB/s" << setw(14) << "read MiB/s" << endl;
+    bool same = true;
+    bool anyCodec = false;
+    for (auto &codec : codecs) {
+        if (!BlockCompressor::isAvailable(codec.first)) {
+            cout << codec.second << " isn't built in" << endl;
+            continue;
+        }
+        anyCodec = true;
+        for (auto &dataset : datasets) {
+            same = measure(dataset.first, dataset.second, codec.first, codec.second) && same;
+        }
+    }
+
+    if (!anyCodec) {
+        cout << "Error: no codec is built in, install the lz4 or the zstd development files" << endl;
+        return 1;
+    }
+
+    return same ? 0 : 1;
+}
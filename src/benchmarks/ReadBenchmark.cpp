@@ -0,0 +1,166 @@
+//
+// Created on 10/19/26.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+#define READ_SIZE 4096
+
+/**
+ * The reads of a thread, it stops when running is cleared.
+ */
+static void randomReads(int fd, size_t fileBytes, unsigned int seed, const atomic<bool> *running, size_t *reads, size_t *errors) {
+    void *buf;
+    if (posix_memalign(&buf, READ_SIZE, READ_SIZE) != 0) {
+        (*errors)++;
+        return;
+    }
+
+    mt19937_64 generator(seed);
+    uniform_int_distribution<size_t> pages(0, fileBytes / READ_SIZE - 1);
+    while (running->load(memory_order_relaxed)) {
+        if (pread(fd, buf, READ_SIZE, pages(generator) * READ_SIZE) == READ_SIZE) {
+            (*reads)++;
+        }
+        else {
+            (*errors)++;
+        }
+    }
+    free(buf);
+}
+
+/**
+ * Fill the file with fileBytes of data, unless it's already as large.
+ */
+static bool prepareFile(const string &path, size_t fileBytes) {
+    struct stat statbuf;
+    if (stat(path.c_str(), &statbuf) == 0 && (size_t) statbuf.st_size >= fileBytes) {
+        return true;
+    }
+
+    int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    vector<char> chunk(1 << 20);
+    for (size_t i=0; i < chunk.size(); i++) {
+        chunk[i] = (char) i;
+    }
+    for (size_t written=0; written < fileBytes; written += chunk.size()) {
+        if (write(fd, chunk.data(), min(chunk.size(), fileBytes - written)) < 0) {
+            close(fd);
+            return false;
+        }
+    }
+    return close(fd) == 0;
+}
+
+/**
+ * Read the file from the threads for the given seconds, it returns the reads per second, -1 on errors.
+ * The reads bypass the page cache when the file system allows O_DIRECT, so every read is a request of the kernel.
+ */
+static double measureIOPS(const string &path, size_t fileBytes, int threads, int seconds) {
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECT);
+    if (fd < 0 && errno == EINVAL) {
+        cout << "Warning: " << path << " can't be opened with O_DIRECT, the page cache may serve the reads" << endl;
+        fd = open(path.c_str(), O_RDONLY);
+    }
+    if (fd < 0) {
+        cout << "Error: cannot open " << path << ": " << strerror(errno) << endl;
+        return -1;
+    }
+
+    atomic<bool> running(true);
+    vector<size_t> reads(threads, 0);
+    vector<size_t> errors(threads, 0);
+    vector<thread> workers;
+    auto start = chrono::steady_clock::now();
+    for (int i=0; i < threads; i++) {
+        workers.push_back(thread(randomReads, fd, fileBytes, i + 1, &running, &reads[i], &errors[i]));
+    }
+    this_thread::sleep_for(chrono::seconds(seconds));
+    running = false;
+    for (thread &worker : workers) {
+        worker.join();
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    close(fd);
+
+    size_t totalReads = 0, totalErrors = 0;
+    for (int i=0; i < threads; i++) {
+        totalReads += reads[i];
+        totalErrors += errors[i];
+    }
+    if (totalErrors > 0) {
+        cout << "Error: " << totalErrors << " reads of " << path << " failed" << endl;
+        return -1;
+    }
+
+    return totalReads / elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    int threads = 8;
+    int seconds = 10;
+    size_t fileBytes = (size_t) 256 << 20;
+
+    int opt;
+    bool help = false;
+    while (!help && (opt = getopt(argc, argv, "t:d:m:h")) != -1) {
+        switch (opt) {
+            case 't':
+                threads = max(atoi(optarg), 1);
+                break;
+            case 'd':
+                seconds = max(atoi(optarg), 1);
+                break;
+            case 'm':
+                fileBytes = (size_t) max(atoi(optarg), 1) << 20;
+                break;
+            default:
+                help = true;
+                break;
+        }
+    }
+    if (help || optind >= argc) {
+        cout << "Usage: " << argv[0] << " [-t threads (8)] [-d seconds (10)] [-m MiB of the file (256)] <file on the legacy mount> [<file on another mount> ...]" << endl;
+        cout << "Compare the 4 KB random read IOPS of the mounts, e.g. DAGonFS mounted with the default loop and with -o io_uring or -o queues=N" << endl;
+        return help && opt == 'h' ? 0 : 1;
+    }
+
+    cout << threads << " threads, " << seconds << " s per file, file of " << (fileBytes >> 20) << " MiB" << endl;
+    cout << fixed << setprecision(0);
+    double baseline = 0;
+    for (int i=optind; i < argc; i++) {
+        if (!prepareFile(argv[i], fileBytes)) {
+            cout << "Error: cannot write " << argv[i] << ": " << strerror(errno) << endl;
+            return 1;
+        }
+
+        double iops = measureIOPS(argv[i], fileBytes, threads, seconds);
+        if (iops < 0) {
+            return 1;
+        }
+        if (i == optind) {
+            baseline = iops;
+        }
+        cout << argv[i] << ": " << iops << " IOPS" << setprecision(2) << " (x" << iops / baseline << ")" << setprecision(0) << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+//
+// Created on 10/19/26.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <mpi.h>
+
+#include "../client-server/include/mpi/NodeTopology.hpp"
+#include "../client-server/include/utils/log_level.hpp"
+
+using namespace std;
+
+using namespace log4cplus;
+
+LogLevel DAGONFS_LOG_LEVEL = OFF_LOG_LEVEL;
+
+MPI_Comm DAGONFS_COMM_WORLD = MPI_COMM_WORLD;
+
+/**
+ * Time the scatter of a write with a distribution, it returns the average of the slowest process over the iterations.
+ */
+static double timeScatter(NodeTopology *topology, bool hierarchical, char *sendBuf, vector<int> &counts, vector<int> &displs, char *recvBuf, int rank, int iterations) {
+    topology->setHierarchical(hierarchical);
+
+    //Warm up: the first transfers set up the connections
+    MPI_Request request;
+    topology->scatter(sendBuf, counts.data(), displs.data(), MPI_BYTE, recvBuf, &request);
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+
+    //Every process checks that it received its own data
+    int errors = recvBuf[0] != (char) (rank & 0xff) || recvBuf[counts[rank] - 1] != (char) (rank & 0xff);
+    int totalErrors;
+    MPI_Allreduce(&errors, &totalErrors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (rank == 0 && totalErrors > 0) {
+        cout << "Error: " << totalErrors << " processes received wrong data with the " << (hierarchical ? "hierarchical" : "flat") << " distribution" << endl;
+    }
+
+    double elapsed = 0.0;
+    for (int i=0; i < iterations; i++) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        double start = MPI_Wtime();
+        topology->scatter(sendBuf, counts.data(), displs.data(), MPI_BYTE, recvBuf, &request);
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        double local = MPI_Wtime() - start;
+        double slowest;
+        MPI_Allreduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        elapsed += slowest;
+    }
+
+    return elapsed / iterations;
+}
+
+int main(int argc, char *argv[]) {
+    MPI_Init(&argc, &argv);
+
+    int rank, worldSize;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        if (rank == 0) {
+            cout << "Usage: [DAGONFS_RANKS_PER_NODE=<n>] mpirun -np <number of processes> [--oversubscribe] " << argv[0]
+                 << " [MiB per process (default 16)] [iterations (default 20)]" << endl;
+        }
+        MPI_Finalize();
+        return 0;
+    }
+    size_t bytesPerRank = (argc > 1 ? strtoull(argv[1], nullptr, 10) : 16) << 20;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+
+    Initializer initializer;
+    NodeTopology *topology = NodeTopology::getInstance(rank, worldSize);
+    if (rank == 0 && topology->getNumberOfNodes() == 1) {
+        cout << "Warning: a single node, set DAGONFS_RANKS_PER_NODE to emulate several nodes on this host" << endl;
+    }
+
+    vector<int> counts(worldSize, bytesPerRank);
+    vector<int> displs(worldSize);
+    for (int i=0; i < worldSize; i++) {
+        displs[i] = i * bytesPerRank;
+    }
+    char *sendBuf = nullptr;
+    if (rank == 0) {
+        sendBuf = (char *) malloc(worldSize * bytesPerRank);
+        for (int i=0; i < worldSize; i++) {
+            memset(sendBuf + i * bytesPerRank, i & 0xff, bytesPerRank);
+        }
+    }
+    char *recvBuf = (char *) malloc(bytesPerRank);
+
+    double flat = timeScatter(topology, false, sendBuf, counts, displs, recvBuf, rank, iterations);
+    double hierarchical = timeScatter(topology, true, sendBuf, counts, displs, recvBuf, rank, iterations);
+
+    if (rank == 0) {
+        double totalMiB = (double) worldSize * bytesPerRank / (1 << 20);
+        cout << worldSize << " processes on " << topology->getNumberOfNodes() << " nodes, " << (bytesPerRank >> 20) << " MiB per process, "
+             << iterations << " iterations" << endl;
+        cout << fixed << setprecision(3);
+        cout << "flat:         " << flat * 1000 << " ms, " << totalMiB / flat << " MiB/s" << endl;
+        cout << "hierarchical: " << hierarchical * 1000 << " ms, " << totalMiB / hierarchical << " MiB/s" << endl;
+    }
+
+    free(sendBuf);
+    free(recvBuf);
+    MPI_Finalize();
+    return 0;
+}
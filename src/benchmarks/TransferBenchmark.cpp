@@ -0,0 +1,158 @@
+//
+// Created on 10/19/26.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <sys/mman.h>
+#include <mpi.h>
+
+#include "../client-server/include/mpi/NodeTopology.hpp"
+#include "../client-server/include/mpi/TransferPlan.hpp"
+#include "../client-server/include/utils/log_level.hpp"
+
+using namespace std;
+
+using namespace log4cplus;
+
+LogLevel DAGONFS_LOG_LEVEL = OFF_LOG_LEVEL;
+
+MPI_Comm DAGONFS_COMM_WORLD = MPI_COMM_WORLD;
+
+/**
+ * The marker written at the beginning of the chunk of a process in a round, the rest of the file is made of zeros.
+ */
+static uint64_t chunkMarker(int rank, int round) {
+    return ((uint64_t) (rank + 1) << 32) | (uint64_t) (round + 1);
+}
+
+/**
+ * Check the chunk of a round and copy it in the blocks, it returns the number of wrong chunks.
+ */
+static int copyChunk(TransferPlan &plan, char *chunk, char *blocks, int rank, int round) {
+    size_t count = plan.getBlockCounts(round)[rank];
+    if (count == 0) {
+        return 0;
+    }
+
+    memcpy(blocks, chunk, count * FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+    return *(uint64_t *) chunk != chunkMarker(rank, round);
+}
+
+/**
+ * Distribute the file as the write of DAGonFS does, it returns the time of the slowest process.
+ * The master copies its own chunk of a round while the round is sent. A storage process requests
+ * the next chunk before copying the current one when pipelined is set, otherwise after.
+ */
+static double timeWrite(NodeTopology *topology, TransferPlan &plan, bool pipelined, char *sendBuf, char *chunkBuffers[2], char *blocks, int rank) {
+    int rounds = plan.getNumberOfRounds();
+    MPI_Datatype blockType = TransferPlan::getBlockType();
+    int errors = 0;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    MPI_Request request;
+    if (rank == 0) {
+        for (int round=0; round < rounds; round++) {
+            topology->scatter(sendBuf, plan.getBlockCounts(round), plan.getBlockDispls(round), blockType, MPI_IN_PLACE, &request);
+            errors += copyChunk(plan, sendBuf + (size_t) plan.getBlockDispls(round)[rank] * FILE_SYSTEM_SINGLE_BLOCK_SIZE, blocks, rank, round);
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+        }
+    }
+    else if (pipelined) {
+        topology->scatter(nullptr, plan.getBlockCounts(0), plan.getBlockDispls(0), blockType, chunkBuffers[0], &request);
+        for (int round=0; round < rounds; round++) {
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+            if (round + 1 < rounds) {
+                topology->scatter(nullptr, plan.getBlockCounts(round + 1), plan.getBlockDispls(round + 1), blockType, chunkBuffers[(round + 1) % 2], &request);
+            }
+            errors += copyChunk(plan, chunkBuffers[round % 2], blocks, rank, round);
+        }
+    }
+    else {
+        for (int round=0; round < rounds; round++) {
+            topology->scatter(nullptr, plan.getBlockCounts(round), plan.getBlockDispls(round), blockType, chunkBuffers[0], &request);
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+            errors += copyChunk(plan, chunkBuffers[0], blocks, rank, round);
+        }
+    }
+    double local = MPI_Wtime() - start;
+
+    double slowest;
+    int totalErrors;
+    MPI_Allreduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(&errors, &totalErrors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (rank == 0 && totalErrors > 0) {
+        cout << "Error: " << totalErrors << " chunks received with wrong data in the " << (pipelined ? "pipelined" : "sequential") << " write" << endl;
+    }
+
+    return slowest;
+}
+
+int main(int argc, char *argv[]) {
+    MPI_Init(&argc, &argv);
+
+    int rank, worldSize;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        if (rank == 0) {
+            cout << "Usage: [DAGONFS_TRANSFER_CHUNK_BYTES=<n>] [DAGONFS_DISTRIBUTION=flat|hierarchical] mpirun -np <number of processes> [--oversubscribe] "
+                 << argv[0] << " [GiB of the file (default 4)]" << endl;
+            cout << "The file is reserved but not allocated: only the pages touched by the transfers take memory, so it can be larger than the memory of the host" << endl;
+        }
+        MPI_Finalize();
+        return 0;
+    }
+    size_t fileBytes = (argc > 1 ? strtoull(argv[1], nullptr, 10) : 4) << 30;
+
+    Initializer initializer;
+    NodeTopology *topology = NodeTopology::getInstance(rank, worldSize);
+    size_t nblocks = fileBytes / FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+    DataLayout layout;
+    TransferPlan plan(layout, nblocks, worldSize, 0, topology->getChunkBlocks());
+    size_t chunkBlocks = plan.getChunkBlocks();
+
+    //The master maps the whole file, only the markers are written
+    char *sendBuf = nullptr;
+    if (rank == 0) {
+        sendBuf = (char *) mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (sendBuf == MAP_FAILED) {
+            cout << "Error: cannot reserve " << (fileBytes >> 30) << " GiB of address space" << endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        for (int round=0; round < plan.getNumberOfRounds(); round++) {
+            for (int i : plan.getDistribution().getTouchedRanks()) {
+                if (plan.getBlockCounts(round)[i] > 0) {
+                    *(uint64_t *) (sendBuf + (size_t) plan.getBlockDispls(round)[i] * FILE_SYSTEM_SINGLE_BLOCK_SIZE) = chunkMarker(i, round);
+                }
+            }
+        }
+    }
+    char *chunkBuffers[2] = {(char *) malloc(chunkBlocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE), (char *) malloc(chunkBlocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE)};
+    char *blocks = (char *) malloc(chunkBlocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+
+    double sequential = timeWrite(topology, plan, false, sendBuf, chunkBuffers, blocks, rank);
+    double pipelined = timeWrite(topology, plan, true, sendBuf, chunkBuffers, blocks, rank);
+
+    if (rank == 0) {
+        double totalGiB = (double) nblocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE / (1 << 30);
+        cout << worldSize << " processes, " << (topology->isHierarchical() ? "hierarchical" : "flat") << " distribution, file of " << totalGiB << " GiB, "
+             << plan.getNumberOfRounds() << " rounds of " << (chunkBlocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE >> 20) << " MiB per process" << endl;
+        cout << fixed << setprecision(3);
+        cout << "sequential: " << sequential << " s, " << totalGiB / sequential << " GiB/s" << endl;
+        cout << "pipelined:  " << pipelined << " s, " << totalGiB / pipelined << " GiB/s" << endl;
+        munmap(sendBuf, fileBytes);
+    }
+
+    free(chunkBuffers[0]);
+    free(chunkBuffers[1]);
+    free(blocks);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,134 @@
+//
+// Created on 10/19/26.
+//
+
+#include "BlockCompressor.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#ifdef DAGONFS_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef DAGONFS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+BlockCompressor *BlockCompressor::instance = nullptr;
+
+BlockCompressor *BlockCompressor::getInstance() {
+	if (instance == nullptr) {
+		instance = new BlockCompressor();
+	}
+
+	return instance;
+}
+
+BlockCompressor::BlockCompressor() {
+	scratch = vector<char>(COMPRESSED_BLOCK_MAX_BYTES);
+}
+
+bool BlockCompressor::isAvailable(int compression) {
+	switch (compression) {
+#ifdef DAGONFS_HAVE_LZ4
+		case DAGONFS_COMPRESSION_LZ4:
+			return true;
+#endif
+#ifdef DAGONFS_HAVE_ZSTD
+		case DAGONFS_COMPRESSION_ZSTD:
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+size_t BlockCompressor::compressData(int compression, [[maybe_unused]] const void *block, [[maybe_unused]] char *dst, [[maybe_unused]] size_t capacity) {
+	switch (compression) {
+#ifdef DAGONFS_HAVE_LZ4
+		case DAGONFS_COMPRESSION_LZ4:
+			//0 when the output doesn't fit
+			return LZ4_compress_default((const char *) block, dst, FILE_SYSTEM_SINGLE_BLOCK_SIZE, capacity);
+#endif
+#ifdef DAGONFS_HAVE_ZSTD
+		case DAGONFS_COMPRESSION_ZSTD: {
+			size_t size = ZSTD_compress(dst, capacity, block, FILE_SYSTEM_SINGLE_BLOCK_SIZE, DAGONFS_ZSTD_LEVEL);
+			return ZSTD_isError(size) ? 0 : size;
+		}
+#endif
+		default:
+			return 0;
+	}
+}
+
+size_t BlockCompressor::seal(vector<void *> &blocks, int compression, vector<void *> &replaced) {
+	if (!isAvailable(compression))
+		return 0;
+
+	size_t savedBytes = 0;
+	size_t incompressibleRun = 0;
+	for (size_t i=0; i < blocks.size(); i++) {
+		if (incompressibleRun >= COMPRESSION_SKIP_AFTER && (incompressibleRun - COMPRESSION_SKIP_AFTER) % COMPRESSION_PROBE_INTERVAL != 0) {
+			incompressibleRun++;
+			continue;
+		}
+
+		size_t size = compressData(compression, blocks[i], scratch.data(), scratch.size());
+		void *copy = size > 0 ? malloc(size) : nullptr;
+		if (copy == nullptr) {
+			incompressibleRun++;
+			continue;
+		}
+		incompressibleRun = 0;
+
+		memcpy(copy, scratch.data(), size);
+		compressedBlocks[copy] = {compression, size};
+		replaced.push_back(blocks[i]);
+		blocks[i] = copy;
+		savedBytes += FILE_SYSTEM_SINGLE_BLOCK_SIZE - size;
+	}
+
+	return savedBytes;
+}
+
+bool BlockCompressor::load(const void *block, void *dst) {
+	auto block_it = compressedBlocks.find(block);
+	if (block_it == compressedBlocks.end()) {
+		memcpy(dst, block, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+		return true;
+	}
+
+	bool decompressed = false;
+	switch (block_it->second.compression) {
+#ifdef DAGONFS_HAVE_LZ4
+		case DAGONFS_COMPRESSION_LZ4:
+			decompressed = LZ4_decompress_safe((const char *) block, (char *) dst, block_it->second.size, FILE_SYSTEM_SINGLE_BLOCK_SIZE) == FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+			break;
+#endif
+#ifdef DAGONFS_HAVE_ZSTD
+		case DAGONFS_COMPRESSION_ZSTD:
+			decompressed = ZSTD_decompress(dst, FILE_SYSTEM_SINGLE_BLOCK_SIZE, block, block_it->second.size) == FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+			break;
+#endif
+		default:
+			break;
+	}
+	if (!decompressed) {
+		memset(dst, 0, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+	}
+
+	return decompressed;
+}
+
+bool BlockCompressor::release(void *block) {
+	auto block_it = compressedBlocks.find(block);
+	if (block_it == compressedBlocks.end()) {
+		return false;
+	}
+
+	compressedBlocks.erase(block_it);
+	free(block);
+	return true;
+}
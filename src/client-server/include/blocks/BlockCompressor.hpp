@@ -0,0 +1,95 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BLOCKCOMPRESSOR_HPP
+#define BLOCKCOMPRESSOR_HPP
+
+#include <map>
+#include <vector>
+#include <cstddef>
+
+#include "data_blocks_info.hpp"
+#include "DataLayout.hpp"
+
+using namespace std;
+
+//A block is kept compressed only if it takes at most 7/8 of its size
+#define COMPRESSED_BLOCK_MAX_BYTES (FILE_SYSTEM_SINGLE_BLOCK_SIZE / 8 * 7)
+//After this number of blocks in a row which don't shrink enough, the compression of a transfer is only probed
+#define COMPRESSION_SKIP_AFTER 4
+//The blocks tried while the compression is skipped, one every this number
+#define COMPRESSION_PROBE_INTERVAL 16
+//The level of zstd, the fastest one: the blocks are compressed while the transfers wait
+#define DAGONFS_ZSTD_LEVEL 1
+
+/**
+ * @brief The compressed blocks of a storage process.
+ *
+ * The blocks of a file with a compression policy are compressed when all of them have been received, and
+ * the compressed copies replace them: their address is the one of the copy, which is outside the block pool,
+ * so the master reads them with the collective read, and they're decompressed while they're sent.
+ * The codecs are built in only if their libraries are found (DAGONFS_HAVE_LZ4, DAGONFS_HAVE_ZSTD), with an
+ * unavailable codec the blocks are stored as they are.
+ */
+class BlockCompressor {
+private:
+	//Singleton implementation
+	static BlockCompressor* instance;
+	BlockCompressor();
+
+	typedef struct CompressedBlock {
+		int compression;
+		size_t size;
+	} CompressedBlock;
+	//The compressed copies, by address
+	map<const void *, CompressedBlock> compressedBlocks;
+	//The output of the codecs, the data which doesn't fit doesn't shrink enough
+	vector<char> scratch;
+
+	/**
+	 * @return The size of the compressed data, 0 if it doesn't fit in capacity.
+	 */
+	size_t compressData(int compression, const void *block, char *dst, size_t capacity);
+
+public:
+	static BlockCompressor* getInstance();
+
+	/**
+	 * @brief Check if a codec is built in.
+	 */
+	static bool isAvailable(int compression);
+
+	/**
+	 * @brief Compress some blocks, the ones which don't shrink enough are left as they are.
+	 *
+	 * After COMPRESSION_SKIP_AFTER blocks in a row which don't shrink, only a block every COMPRESSION_PROBE_INTERVAL
+	 * is tried, until one shrinks again: incompressible data costs little more than a copy.
+	 *
+	 * @param blocks The address of each block, replaced by the address of its compressed copy.
+	 * @param compression The codec.
+	 * @param replaced Filled with the blocks replaced by a compressed copy, to be released by the caller.
+	 * @return The bytes saved.
+	 */
+	size_t seal(vector<void *> &blocks, int compression, vector<void *> &replaced);
+
+	bool isCompressed(const void *block) { return compressedBlocks.find(block) != compressedBlocks.end(); }
+
+	/**
+	 * @brief Copy the data of a block, decompressing it if it's compressed.
+	 *
+	 * @return FALSE if the compressed data is corrupted, dst is filled with zeros.
+	 */
+	bool load(const void *block, void *dst);
+
+	/**
+	 * @brief Free a block if it's compressed.
+	 *
+	 * @return FALSE if the block isn't compressed, it must be released to its pool.
+	 */
+	bool release(void *block);
+};
+
+
+
+#endif //BLOCKCOMPRESSOR_HPP
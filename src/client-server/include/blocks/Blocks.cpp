@@ -36,7 +36,7 @@ void Blocks::setBlockListForInode(fuse_ino_t inode, vector<DataBlock*> &blockLis
 }
 
 bool Blocks::blockListExistForInode(fuse_ino_t inode) {
-	return FileSystemDataBlocks.find(inode) == FileSystemDataBlocks.end();
+	return FileSystemDataBlocks.find(inode) != FileSystemDataBlocks.end();
 }
 
 
@@ -49,7 +49,7 @@ DataBlock* Blocks::addDataBlockToInode(fuse_ino_t inode) {
 
 	if (!FileSystemDataBlocks[inode].empty()) {
 		DataBlock *lastBlock = FileSystemDataBlocks[inode].back();
-		unsigned int newAbsBytes = lastBlock->getAbsoluteBytes() + FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+		size_t newAbsBytes = lastBlock->getAbsoluteBytes() + FILE_SYSTEM_SINGLE_BLOCK_SIZE;
 		newBlock->setAbsoluteBytes(newAbsBytes);
 	}
 
@@ -22,7 +22,7 @@ DataBlock::DataBlock(fuse_ino_t inode) {
 	progressiveNumber = 0;
 }
 
-DataBlock::DataBlock(fuse_ino_t inode, void *dataBlockAddress, unsigned int absoluteBytes) {
+DataBlock::DataBlock(fuse_ino_t inode, void *dataBlockAddress, size_t absoluteBytes) {
 	this->inode = inode;
 	this->dataBlockAddress = dataBlockAddress;
 	usedBytes = 0;
@@ -15,28 +15,30 @@ private:
 	fuse_ino_t inode;
 	void *dataBlockAddress;
 	unsigned int usedBytes;
-	unsigned int absoluteBytes;
+	size_t absoluteBytes;
 	unsigned int processRank;
 	unsigned int progressiveNumber;
 
 public:
 	DataBlock();
 	DataBlock(fuse_ino_t inode);
-	DataBlock(fuse_ino_t inode, void *dataBlockAddress, unsigned int absoluteBytes);
+	DataBlock(fuse_ino_t inode, void *dataBlockAddress, size_t absoluteBytes);
 	~DataBlock();
 
 	fuse_ino_t getInode(){ return inode; }
 
 	void *getData(){ return dataBlockAddress; }
 	void setData(void *address);
+	//A block of zeros has no data
+	bool isHole(){ return dataBlockAddress == nullptr; }
 
 	void setUsedBytes(unsigned int bytes) { usedBytes = bytes; }
 	unsigned int getUsedBytes(){ return usedBytes; }
 	unsigned int getFreeBytes(){ return FILE_SYSTEM_SINGLE_BLOCK_SIZE - usedBytes; }
 	bool isFull() { return usedBytes == FILE_SYSTEM_SINGLE_BLOCK_SIZE; }
 
-	unsigned int getAbsoluteBytes(){ return absoluteBytes; }
-	void setAbsoluteBytes(unsigned int bytes){ absoluteBytes = bytes; }
+	size_t getAbsoluteBytes(){ return absoluteBytes; }
+	void setAbsoluteBytes(size_t bytes){ absoluteBytes = bytes; }
 
 	unsigned int getProgressiveNumber(){ return progressiveNumber; }
 	void setProgressiveNumber(unsigned int number){ progressiveNumber = number; }
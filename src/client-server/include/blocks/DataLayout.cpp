@@ -0,0 +1,95 @@
+//
+// Created on 10/19/26.
+//
+
+#include "DataLayout.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstdint>
+
+using namespace std;
+
+int DataLayout::getEffectiveStripeCount(int mpi_world_size) const {
+	if (stripeCount <= 0 || stripeCount > mpi_world_size)
+		return mpi_world_size;
+	return stripeCount;
+}
+
+void DataLayout::mapBlocks(size_t nblocks, int mpi_world_size, int firstStorageRank, vector<int> &blockRanks) const {
+	int storageProcesses = mpi_world_size - firstStorageRank;
+	int effectiveStripeCount = getEffectiveStripeCount(storageProcesses);
+	int firstProcess = startRank > firstStorageRank ? startRank - firstStorageRank : 0;
+	blockRanks.resize(nblocks);
+
+	if (stripeUnit == 0) {
+		//Contiguous chunks: the first "remainingBlocks" processes store one more block
+		size_t blockPerProcess = nblocks / effectiveStripeCount;
+		size_t remainingBlocks = nblocks % effectiveStripeCount;
+		size_t block = 0;
+		for (int i=0; i < effectiveStripeCount; i++) {
+			size_t effectiveBlocks = blockPerProcess + (i < remainingBlocks);
+			int rank = firstStorageRank + (firstProcess + i) % storageProcesses;
+			for (size_t j=0; j < effectiveBlocks; j++) {
+				blockRanks[block++] = rank;
+			}
+		}
+	}
+	else {
+		//Round-robin of stripe units over the selected processes
+		size_t blocksPerStripe = stripeUnit / FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+		for (size_t i=0; i < nblocks; i++) {
+			blockRanks[i] = firstStorageRank + (firstProcess + (i / blocksPerStripe) % effectiveStripeCount) % storageProcesses;
+		}
+	}
+}
+
+int DataLayout::setAttribute(const string &name, const char *value, size_t size, int mpi_world_size) {
+	string strValue = string(value, size);
+	char *end = nullptr;
+	errno = 0;
+	long number = strtol(strValue.c_str(), &end, 10);
+	if (strValue.empty() || errno != 0 || *end != '\0' || number < 0) {
+		return EINVAL;
+	}
+
+	if (name == DAGONFS_XATTR_STRIPE_COUNT) {
+		if (number > mpi_world_size)
+			return EINVAL;
+		stripeCount = (int) number;
+	}
+	else if (name == DAGONFS_XATTR_STRIPE_UNIT) {
+		//The stripe unit must be a multiple of the block size
+		if (number % FILE_SYSTEM_SINGLE_BLOCK_SIZE != 0 || number > UINT32_MAX)
+			return EINVAL;
+		stripeUnit = (unsigned int) number;
+	}
+	else if (name == DAGONFS_XATTR_START_RANK) {
+		if (number >= mpi_world_size)
+			return EINVAL;
+		startRank = (int) number;
+	}
+	else if (name == DAGONFS_XATTR_COMPRESSION) {
+		//A codec which isn't built in leaves the blocks as they are
+		if (number > DAGONFS_COMPRESSION_ZSTD)
+			return EINVAL;
+		compression = (int) number;
+	}
+	else {
+		return ENOTSUP;
+	}
+
+	return 0;
+}
+
+void DataLayout::resetAttribute(const string &name) {
+	DataLayout defaultLayout;
+	if (name == DAGONFS_XATTR_STRIPE_COUNT)
+		stripeCount = defaultLayout.stripeCount;
+	else if (name == DAGONFS_XATTR_STRIPE_UNIT)
+		stripeUnit = defaultLayout.stripeUnit;
+	else if (name == DAGONFS_XATTR_START_RANK)
+		startRank = defaultLayout.startRank;
+	else if (name == DAGONFS_XATTR_COMPRESSION)
+		compression = defaultLayout.compression;
+}
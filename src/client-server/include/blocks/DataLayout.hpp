@@ -0,0 +1,92 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef DATALAYOUT_HPP
+#define DATALAYOUT_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+
+#include "data_blocks_info.hpp"
+
+using namespace std;
+
+//Extended attributes used to set the layout of a file (or the default layout of a directory)
+#define DAGONFS_XATTR_PREFIX        "user.dagonfs."
+#define DAGONFS_XATTR_STRIPE_COUNT  "user.dagonfs.stripe_count"
+#define DAGONFS_XATTR_STRIPE_UNIT   "user.dagonfs.stripe_unit"
+#define DAGONFS_XATTR_START_RANK    "user.dagonfs.start_rank"
+#define DAGONFS_XATTR_COMPRESSION   "user.dagonfs.compression"
+
+//Values of the compression attribute, the codec compressing the blocks in the storage processes
+#define DAGONFS_COMPRESSION_NONE    0
+#define DAGONFS_COMPRESSION_LZ4     1
+#define DAGONFS_COMPRESSION_ZSTD    2
+
+/**
+ * @brief The layout policy of a file: how its data blocks are distributed among the MPI processes.
+ *
+ * The blocks are striped in units of stripeUnit bytes over stripeCount processes, starting from startRank.
+ * A stripe count of 0 means "all the processes", a stripe unit of 0 means that the blocks are split
+ * in contiguous chunks of (almost) the same size, which is the default distribution of DAGonFS.
+ * Only the processes from the first storage rank store blocks: a start rank below it selects the
+ * first storage process.
+ * The storage processes keep the blocks compressed with the codec of the compression field, if it's
+ * built in, and if a block shrinks enough; they're decompressed when they're read.
+ * The class is trivially copyable because it travels inside the MPI request packets.
+ */
+class DataLayout {
+public:
+	int stripeCount;
+	unsigned int stripeUnit;
+	int startRank;
+	int compression;
+
+	DataLayout(): stripeCount(0), stripeUnit(0), startRank(0), compression(DAGONFS_COMPRESSION_NONE) {}
+
+	/**
+	 * @brief Get the number of processes involved in the layout.
+	 *
+	 * @param mpi_world_size The number of MPI processes.
+	 * @return The number of processes storing the blocks of the file.
+	 */
+	int getEffectiveStripeCount(int mpi_world_size) const;
+
+	/**
+	 * @brief Compute the owner rank of each block of a file.
+	 *
+	 * @param nblocks The number of blocks of the file.
+	 * @param mpi_world_size The number of MPI processes.
+	 * @param firstStorageRank The lowest rank storing blocks.
+	 * @param blockRanks The output vector, blockRanks[i] is the rank storing the i-th block.
+	 */
+	void mapBlocks(size_t nblocks, int mpi_world_size, int firstStorageRank, vector<int> &blockRanks) const;
+
+	/**
+	 * @brief Set a layout field from the value of one of the DAGonFS extended attributes.
+	 *
+	 * @param name The extended attribute name.
+	 * @param value The value, a decimal number not necessarily null terminated.
+	 * @param size The size of the value.
+	 * @param mpi_world_size The number of MPI processes.
+	 * @return 0 on success, EINVAL if the value is not valid or ENOTSUP if the attribute is unknown.
+	 */
+	int setAttribute(const string &name, const char *value, size_t size, int mpi_world_size);
+
+	/**
+	 * @brief Reset a layout field to its default value.
+	 *
+	 * @param name The extended attribute name.
+	 */
+	void resetAttribute(const string &name);
+
+	/**
+	 * @brief Check if an extended attribute name belongs to the DAGonFS layout attributes.
+	 */
+	static bool isLayoutAttribute(const string &name) { return name.compare(0, strlen(DAGONFS_XATTR_PREFIX), DAGONFS_XATTR_PREFIX) == 0; }
+};
+
+#endif //DATALAYOUT_HPP
@@ -0,0 +1,80 @@
+//
+// Created on 10/19/26.
+//
+
+#include "zero_blocks.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "data_blocks_info.hpp"
+
+static const char zeroBlock[FILE_SYSTEM_SINGLE_BLOCK_SIZE] = {0};
+
+const void *getZeroBlock() {
+	return zeroBlock;
+}
+
+static bool isZeroScalar(const char *data, size_t size) {
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, data + i, sizeof(word));
+		if (word != 0)
+			return false;
+	}
+	for (; i < size; i++) {
+		if (data[i] != 0)
+			return false;
+	}
+
+	return true;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+//Compiled for AVX2 even if the rest of the code isn't, it's used only when the processor has it
+__attribute__((target("avx2")))
+static bool isZeroAVX2(const char *data, size_t size) {
+	size_t i = 0;
+	//Four vectors are checked at once, the data of the blocks with data is usually not zero at the beginning
+	for (; i + 128 <= size; i += 128) {
+		__m256i bits = _mm256_or_si256(
+			_mm256_or_si256(_mm256_loadu_si256((const __m256i *) (data + i)), _mm256_loadu_si256((const __m256i *) (data + i + 32))),
+			_mm256_or_si256(_mm256_loadu_si256((const __m256i *) (data + i + 64)), _mm256_loadu_si256((const __m256i *) (data + i + 96))));
+		if (!_mm256_testz_si256(bits, bits))
+			return false;
+	}
+
+	return isZeroScalar(data + i, size - i);
+}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+static bool isZeroNEON(const char *data, size_t size) {
+	size_t i = 0;
+	for (; i + 64 <= size; i += 64) {
+		const uint8_t *bytes = (const uint8_t *) data + i;
+		uint8x16_t bits = vorrq_u8(vorrq_u8(vld1q_u8(bytes), vld1q_u8(bytes + 16)), vorrq_u8(vld1q_u8(bytes + 32), vld1q_u8(bytes + 48)));
+		if (vmaxvq_u8(bits) != 0)
+			return false;
+	}
+
+	return isZeroScalar(data + i, size - i);
+}
+#endif
+
+bool isZeroBlock(const void *data, size_t size) {
+#if defined(__x86_64__) || defined(__i386__)
+	static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+	if (hasAVX2)
+		return isZeroAVX2((const char *) data, size);
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+	return isZeroNEON((const char *) data, size);
+#endif
+
+	return isZeroScalar((const char *) data, size);
+}
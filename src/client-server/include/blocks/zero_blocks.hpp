@@ -0,0 +1,26 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef ZERO_BLOCKS_HPP
+#define ZERO_BLOCKS_HPP
+
+#include <cstddef>
+
+/**
+ * @brief Check if some data is all zeros, with AVX2 or NEON when the processor has them.
+ *
+ * A block of zeros is a hole: it isn't stored nor transferred, and it's read as zeros.
+ *
+ * @param data The data.
+ * @param size The size of the data.
+ * @return TRUE if every byte is 0.
+ */
+bool isZeroBlock(const void *data, size_t size);
+
+/**
+ * @brief Get a block of FILE_SYSTEM_SINGLE_BLOCK_SIZE zeros, the data of the holes. It must not be written.
+ */
+const void *getZeroBlock();
+
+#endif //ZERO_BLOCKS_HPP
@@ -0,0 +1,78 @@
+//
+// Created on 10/19/26.
+//
+
+#include "BlockDistribution.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+BlockDistribution::BlockDistribution(const DataLayout &layout, size_t nblocks, int mpi_world_size, int firstStorageRank) {
+	this->nblocks = nblocks;
+	this->mpi_world_size = mpi_world_size;
+	layout.mapBlocks(nblocks, mpi_world_size, firstStorageRank, blockRanks);
+	distribute();
+}
+
+BlockDistribution::BlockDistribution(const vector<int> &blockRanks, int mpi_world_size) {
+	this->nblocks = blockRanks.size();
+	this->mpi_world_size = mpi_world_size;
+	this->blockRanks = blockRanks;
+	distribute();
+}
+
+void BlockDistribution::distribute() {
+	blocksPerRank = vector<size_t>(mpi_world_size, 0);
+	firstBlock = vector<size_t>(mpi_world_size, 0);
+	contiguous = true;
+	for (size_t i=0; i < nblocks; i++) {
+		int rank = blockRanks[i];
+		if (blocksPerRank[rank] == 0) {
+			firstBlock[rank] = i;
+			touchedRanks.push_back(rank);
+		}
+		else if (blockRanks[i-1] != rank) {
+			//The process already received a range of blocks which is not adjacent to this one
+			contiguous = false;
+		}
+		blocksPerRank[rank]++;
+	}
+
+	//The slots are assigned in rank order, the processes without blocks don't take any
+	sort(touchedRanks.begin(), touchedRanks.end());
+	firstSlot = vector<size_t>(mpi_world_size, 0);
+	size_t slotOffset = 0;
+	for (int rank : touchedRanks) {
+		firstSlot[rank] = slotOffset;
+		slotOffset += blocksPerRank[rank];
+	}
+
+	if (!contiguous) {
+		transferOrder = vector<size_t>(nblocks);
+		vector<size_t> nextSlot = firstSlot;
+		for (size_t i=0; i < nblocks; i++) {
+			transferOrder[nextSlot[blockRanks[i]]++] = i;
+		}
+	}
+}
+
+void BlockDistribution::fillCountsAndDispls(int *counts, int *displs, size_t unitSize) {
+	for (int rank : touchedRanks) {
+		counts[rank] = blocksPerRank[rank] * unitSize;
+		displs[rank] = (contiguous ? firstBlock[rank] : firstSlot[rank]) * unitSize;
+	}
+}
+
+void BlockDistribution::pack(void *dst, const void *src, size_t unitSize) {
+	for (size_t slot=0; slot < nblocks; slot++) {
+		memcpy((char *) dst + slot*unitSize, (const char *) src + transferOrder[slot]*unitSize, unitSize);
+	}
+}
+
+void BlockDistribution::unpack(void *dst, const void *src, size_t unitSize) {
+	for (size_t slot=0; slot < nblocks; slot++) {
+		memcpy((char *) dst + transferOrder[slot]*unitSize, (const char *) src + slot*unitSize, unitSize);
+	}
+}
@@ -0,0 +1,90 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BLOCKDISTRIBUTION_HPP
+#define BLOCKDISTRIBUTION_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "../blocks/DataLayout.hpp"
+
+using namespace std;
+
+/**
+ * @brief The distribution of the blocks of a single transfer among the MPI processes.
+ *
+ * It translates a DataLayout into the counts and displacements of the MPI_Scatterv/MPI_Gatherv calls.
+ * When every process stores a contiguous range of blocks the displacements point directly into the
+ * file buffer, otherwise the blocks must be packed in "transfer order" (grouped by rank) before
+ * sending them and unpacked after receiving them.
+ */
+class BlockDistribution {
+private:
+	size_t nblocks;
+	int mpi_world_size;
+	bool contiguous;
+
+	vector<int> blockRanks;
+	vector<size_t> blocksPerRank;
+	vector<size_t> firstBlock;
+	vector<size_t> firstSlot;
+	vector<size_t> transferOrder;
+	//The processes storing at least a block, in increasing order
+	vector<int> touchedRanks;
+
+	//Compute the shares of the processes from the rank of each block
+	void distribute();
+
+public:
+	BlockDistribution(const DataLayout &layout, size_t nblocks, int mpi_world_size, int firstStorageRank);
+
+	/**
+	 * @brief The distribution of blocks which are already placed, such as the blocks with data of a file with holes.
+	 *
+	 * @param blockRanks The rank of each block.
+	 * @param mpi_world_size The number of processes.
+	 */
+	BlockDistribution(const vector<int> &blockRanks, int mpi_world_size);
+
+	size_t getNumberOfBlocks() { return nblocks; }
+	int getRankOfBlock(size_t block) { return blockRanks[block]; }
+	size_t getBlocksOfRank(int rank) { return blocksPerRank[rank]; }
+	const vector<int> &getTouchedRanks() { return touchedRanks; }
+
+	/**
+	 * @brief Check if the blocks of every process are contiguous in the file.
+	 *
+	 * @return TRUE if the file buffer can be transferred without packing.
+	 */
+	bool isContiguous() { return contiguous; }
+
+	/**
+	 * @brief Get the block of the file in a slot of the transfer order.
+	 */
+	size_t getBlockOfSlot(size_t slot) { return contiguous ? slot : transferOrder[slot]; }
+
+	/**
+	 * @brief Fill the counts and displacements arrays for a collective transfer.
+	 *
+	 * Only the entries of the processes storing some blocks are written, the others must be already 0.
+	 *
+	 * @param counts The counts array (one entry per process).
+	 * @param displs The displacements array (one entry per process).
+	 * @param unitSize The size of the data transferred for each block.
+	 */
+	void fillCountsAndDispls(int *counts, int *displs, size_t unitSize);
+
+	/**
+	 * @brief Copy the data of each block from file order to transfer order.
+	 */
+	void pack(void *dst, const void *src, size_t unitSize);
+
+	/**
+	 * @brief Copy the data of each block from transfer order to file order.
+	 */
+	void unpack(void *dst, const void *src, size_t unitSize);
+};
+
+#endif //BLOCKDISTRIBUTION_HPP
@@ -0,0 +1,177 @@
+//
+// Created on 10/19/26.
+//
+
+#include "BlockPool.hpp"
+
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+using namespace log4cplus;
+
+BlockPool *BlockPool::instance = nullptr;
+
+BlockPool *BlockPool::getInstance(int rank, int mpi_world_size) {
+	if (instance == nullptr) {
+		instance = new BlockPool(rank, mpi_world_size);
+	}
+
+	return instance;
+}
+
+BlockPool::BlockPool(int rank, int mpi_world_size) {
+	this->rank = rank;
+	this->mpi_world_size = mpi_world_size;
+	remotePools = false;
+
+	BlockPoolLogger = Logger::getInstance("BlockPool.logger Process " + to_string(rank) + " - ");
+	LogLevel ll = DAGONFS_LOG_LEVEL;
+	BlockPoolLogger.setLogLevel(ll);
+
+	//The master doesn't need a pool: it reads its own blocks directly
+	poolBlocks = 0;
+	const char *env = getenv(DAGONFS_ENV_BLOCK_POOL_BYTES);
+	if (env != nullptr && rank != 0) {
+		poolBlocks = strtoull(env, nullptr, 10) / FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+	}
+
+	//The pools of the processes of a node are in the shared memory, the pool of each process is on its NUMA node
+	MPI_Comm_split_type(DAGONFS_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm);
+	MPI_Info info;
+	MPI_Info_create(&info);
+	MPI_Info_set(info, "alloc_shared_noncontig", "true");
+	poolBase = nullptr;
+	MPI_Win_allocate_shared(poolBlocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE, FILE_SYSTEM_SINGLE_BLOCK_SIZE, info, nodeComm, &poolBase, &sharedWindow);
+	MPI_Info_free(&info);
+	MPI_Win_create(poolBase, poolBlocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE, FILE_SYSTEM_SINGLE_BLOCK_SIZE, MPI_INFO_NULL, DAGONFS_COMM_WORLD, &window);
+	//The slots are handed out in increasing order, so the blocks of a file are likely adjacent in the pool
+	for (size_t slot = poolBlocks; slot > 0; slot--) {
+		freeSlots.push_back(slot - 1);
+	}
+
+	uint64_t localPool[2] = {(uint64_t) (uintptr_t) poolBase, poolBlocks};
+	vector<uint64_t> pools(rank == 0 ? 2 * mpi_world_size : 0);
+	MPI_Gather(localPool, 2, MPI_UINT64_T, pools.data(), 2, MPI_UINT64_T, 0, DAGONFS_COMM_WORLD);
+	if (rank == 0) {
+		remoteBases = vector<uintptr_t>(mpi_world_size);
+		remoteBlocks = vector<size_t>(mpi_world_size);
+		for (int i=0; i < mpi_world_size; i++) {
+			remoteBases[i] = pools[2*i];
+			remoteBlocks[i] = pools[2*i + 1];
+			remotePools = remotePools || remoteBlocks[i] > 0;
+		}
+	}
+
+	int nodeSize;
+	MPI_Comm_size(nodeComm, &nodeSize);
+	vector<int> nodeRanks(nodeSize);
+	MPI_Allgather(&rank, 1, MPI_INT, nodeRanks.data(), 1, MPI_INT, nodeComm);
+	if (rank == 0) {
+		sharedBases = vector<char *>(mpi_world_size, nullptr);
+		for (int i=0; i < nodeSize; i++) {
+			MPI_Aint size;
+			int dispUnit;
+			char *base;
+			MPI_Win_shared_query(sharedWindow, i, &size, &dispUnit, &base);
+			if (size > 0) {
+				sharedBases[nodeRanks[i]] = base;
+			}
+		}
+	}
+
+	//Passive target epochs for the whole life of the file system, MPI_Win_sync() needs them
+	MPI_Win_lock_all(MPI_MODE_NOCHECK, sharedWindow);
+	MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+	open = true;
+
+	LOG4CPLUS_INFO(BlockPoolLogger, BlockPoolLogger.getName() << "pool of " << poolBlocks << " blocks, " << nodeSize << " processes on this node");
+}
+
+void *BlockPool::allocateBlock() {
+	if (freeSlots.empty()) {
+		return malloc(FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+	}
+
+	size_t slot = freeSlots.back();
+	freeSlots.pop_back();
+	return poolBase + slot * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+}
+
+char *BlockPool::allocateRun(size_t nblocks) {
+	if (nblocks == 0 || freeSlots.size() < nblocks) {
+		return nullptr;
+	}
+
+	size_t first = freeSlots.back();
+	for (size_t i=1; i < nblocks; i++) {
+		if (freeSlots[freeSlots.size() - 1 - i] != first + i) {
+			return nullptr;
+		}
+	}
+	freeSlots.resize(freeSlots.size() - nblocks);
+	return poolBase + first * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+}
+
+void BlockPool::releaseBlock(void *block) {
+	char *block_p = (char *) block;
+	if (poolBlocks > 0 && block_p >= poolBase && block_p < poolBase + poolBlocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE) {
+		freeSlots.push_back((block_p - poolBase) / FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+	}
+	else {
+		free(block);
+	}
+}
+
+void BlockPool::publish() {
+	if (open) {
+		MPI_Win_sync(sharedWindow);
+		MPI_Win_sync(window);
+	}
+}
+
+bool BlockPool::locate(int owner, void *address, MPI_Aint &displacement) {
+	uintptr_t block = (uintptr_t) address;
+	uintptr_t base = remoteBases[owner];
+	if (remoteBlocks[owner] == 0 || block < base || block >= base + remoteBlocks[owner] * FILE_SYSTEM_SINGLE_BLOCK_SIZE) {
+		return false;
+	}
+
+	displacement = (block - base) / FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+	return true;
+}
+
+void *BlockPool::getSharedAddress(int owner, void *address) {
+	MPI_Aint displacement;
+	if (sharedBases[owner] == nullptr || !locate(owner, address, displacement)) {
+		return nullptr;
+	}
+
+	return sharedBases[owner] + displacement * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+}
+
+void BlockPool::getBlocks(void *dst, int owner, MPI_Aint displacement, int nblocks, MPI_Request *request) {
+	int count = nblocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+	MPI_Rget(dst, count, MPI_BYTE, owner, displacement, count, MPI_BYTE, window, request);
+}
+
+void BlockPool::synchronize() {
+	if (open) {
+		MPI_Win_sync(sharedWindow);
+		MPI_Win_sync(window);
+	}
+}
+
+void BlockPool::close() {
+	if (!open) {
+		return;
+	}
+
+	MPI_Win_unlock_all(window);
+	MPI_Win_free(&window);
+	MPI_Win_unlock_all(sharedWindow);
+	MPI_Win_free(&sharedWindow);
+	MPI_Comm_free(&nodeComm);
+	open = false;
+}
@@ -0,0 +1,138 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BLOCKPOOL_HPP
+#define BLOCKPOOL_HPP
+
+#include <mpi.h>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "dagonfs_comm.hpp"
+#include "../blocks/data_blocks_info.hpp"
+#include "../utils/log_level.hpp"
+
+using namespace std;
+
+//Environment variable setting the size of the block pool of each storage process
+#define DAGONFS_ENV_BLOCK_POOL_BYTES "DAGONFS_BLOCK_POOL_BYTES"
+
+/**
+ * @brief The pool of data blocks of a storage process, exposed to the master as an MPI window.
+ *
+ * Each storage process allocates DAGONFS_BLOCK_POOL_BYTES bytes (0 by default, which disables the pool)
+ * with MPI_Win_allocate_shared on the communicator of the processes of its node, and exposes them to
+ * every process with a window whose displacement unit is a block. The master keeps a passive target
+ * epoch open on every process: it copies the blocks stored in the pools of the processes of its own
+ * node through the shared memory, and reads the others with MPI_Rget, so a read doesn't wait for the
+ * storage processes to be scheduled. The blocks which don't fit in the pool are allocated with malloc()
+ * and read with the collective transfers.
+ */
+class BlockPool {
+private:
+	//Singleton implementation
+	static BlockPool* instance;
+	BlockPool(int rank, int mpi_world_size);
+
+	int rank;
+	int mpi_world_size;
+
+	//The processes of this node, and the window of their pools in the shared memory
+	MPI_Comm nodeComm;
+	MPI_Win sharedWindow;
+	//The window of the pools of every process
+	MPI_Win window;
+	char *poolBase;
+	size_t poolBlocks;
+	vector<size_t> freeSlots;
+	bool open;
+
+	//Master only: the address and the number of blocks of the pool of every process
+	vector<uintptr_t> remoteBases;
+	vector<size_t> remoteBlocks;
+	//The address of the pool of every process of this node in the shared memory, nullptr for the others
+	vector<char *> sharedBases;
+	bool remotePools;
+
+	log4cplus::Logger BlockPoolLogger;
+
+public:
+	/**
+	 * @brief Get the pool, the first call is collective over DAGONFS_COMM_WORLD.
+	 */
+	static BlockPool* getInstance(int rank, int mpi_world_size);
+
+	/**
+	 * @brief Check if any storage process has a pool.
+	 */
+	bool hasRemotePools() { return remotePools; }
+
+	/**
+	 * @brief Allocate a data block, in the pool if there's a free slot.
+	 */
+	void *allocateBlock();
+
+	/**
+	 * @brief Allocate adjacent data blocks in the pool.
+	 *
+	 * @param nblocks The number of blocks.
+	 * @return The first block, nullptr if the next free slots of the pool aren't adjacent.
+	 */
+	char *allocateRun(size_t nblocks);
+
+	/**
+	 * @brief Release a data block allocated by allocateBlock() or allocateRun().
+	 */
+	void releaseBlock(void *block);
+
+	/**
+	 * @brief Make the blocks written by this process visible to the reads of the master.
+	 */
+	void publish();
+
+	/**
+	 * @brief Find a block of a storage process in its pool.
+	 *
+	 * @param owner The rank of the storage process.
+	 * @param address The address of the block in the storage process.
+	 * @param displacement Set to the displacement of the block in the window.
+	 * @return FALSE if the block isn't in the pool of the process.
+	 */
+	bool locate(int owner, void *address, MPI_Aint &displacement);
+
+	/**
+	 * @brief Get the address of a block of a storage process of this node in the shared memory.
+	 *
+	 * @param owner The rank of the storage process.
+	 * @param address The address of the block in the storage process.
+	 * @return The address of the block in this process, nullptr if the block can't be accessed directly.
+	 */
+	void *getSharedAddress(int owner, void *address);
+
+	/**
+	 * @brief Start the read of consecutive blocks from the pool of a storage process.
+	 *
+	 * @param dst The destination buffer.
+	 * @param owner The rank of the storage process.
+	 * @param displacement The displacement of the first block.
+	 * @param nblocks The number of blocks.
+	 * @param request Set to the request completed when the blocks are in dst.
+	 */
+	void getBlocks(void *dst, int owner, MPI_Aint displacement, int nblocks, MPI_Request *request);
+
+	/**
+	 * @brief Make visible to this process the blocks written by the storage processes, before a read.
+	 */
+	void synchronize();
+
+	/**
+	 * @brief Free the windows, it's collective over DAGONFS_COMM_WORLD.
+	 */
+	void close();
+};
+
+
+
+#endif //BLOCKPOOL_HPP
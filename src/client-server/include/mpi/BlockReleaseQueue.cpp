@@ -0,0 +1,92 @@
+//
+// Created on 10/19/26.
+//
+
+#include "BlockReleaseQueue.hpp"
+
+#include "../blocks/Blocks.hpp"
+
+using namespace std;
+
+using namespace log4cplus;
+
+BlockReleaseQueue *BlockReleaseQueue::instance = nullptr;
+
+BlockReleaseQueue *BlockReleaseQueue::getInstance(int rank, int mpi_world_size) {
+	if (instance == nullptr) {
+		instance = new BlockReleaseQueue(rank, mpi_world_size);
+	}
+
+	return instance;
+}
+
+BlockReleaseQueue::BlockReleaseQueue(int rank, int mpi_world_size) {
+	this->rank = rank;
+	this->mpi_world_size = mpi_world_size;
+	pinnedReads = 0;
+	queuedBlocks = vector<vector<PointerPacket> >(mpi_world_size);
+	nodeTopology = NodeTopology::getInstance(rank, mpi_world_size);
+
+	BlockReleaseQueueLogger = Logger::getInstance("BlockReleaseQueue.logger - ");
+	LogLevel ll = DAGONFS_LOG_LEVEL;
+	BlockReleaseQueueLogger.setLogLevel(ll);
+}
+
+void BlockReleaseQueue::pin() {
+	lock_guard<mutex> lock(queueMutex);
+	pinnedReads++;
+}
+
+void BlockReleaseQueue::unpin() {
+	lock_guard<mutex> lock(queueMutex);
+	if (pinnedReads == 0) {
+		LOG4CPLUS_WARN(BlockReleaseQueueLogger, BlockReleaseQueueLogger.getName() << "unpin without a pinned read");
+		return;
+	}
+	if (--pinnedReads == 0) {
+		sendQueuedBlocks();
+	}
+}
+
+void BlockReleaseQueue::add(int rank, void *address) {
+	if (rank == this->rank || address == nullptr)
+		return;
+
+	lock_guard<mutex> lock(queueMutex);
+	queuedBlocks[rank].push_back({address});
+}
+
+void BlockReleaseQueue::addBlocksOfInode(fuse_ino_t inode) {
+	Blocks *blocks = Blocks::getInstance();
+	if (!blocks->blockListExistForInode(inode))
+		return;
+
+	for (DataBlock *dataBlock : blocks->getDataBlockListOfInode(inode)) {
+		add(dataBlock->getRank(), dataBlock->getData());
+	}
+}
+
+void BlockReleaseQueue::flush() {
+	lock_guard<mutex> lock(queueMutex);
+	if (pinnedReads == 0) {
+		sendQueuedBlocks();
+	}
+}
+
+void BlockReleaseQueue::sendQueuedBlocks() {
+	MPI_Comm frontEndComm = nodeTopology->getFrontEndComm();
+	for (int i=0; i < mpi_world_size; i++) {
+		if (queuedBlocks[i].empty())
+			continue;
+
+		BlockRequestPacket request;
+		request.type = RELEASE_BLOCKS;
+		request.inode = 0;
+		request.nblocks = queuedBlocks[i].size();
+		request.compression = DAGONFS_COMPRESSION_NONE;
+		MPI_Send(&request, sizeof(request), MPI_BYTE, i, BLOCK_REQUEST_TAG, frontEndComm);
+		MPI_Send(queuedBlocks[i].data(), queuedBlocks[i].size() * sizeof(PointerPacket), MPI_BYTE, i, BLOCK_DATA_TAG, frontEndComm);
+		LOG4CPLUS_DEBUG(BlockReleaseQueueLogger, BlockReleaseQueueLogger.getName() << queuedBlocks[i].size() << " blocks released by process " << i);
+		queuedBlocks[i].clear();
+	}
+}
@@ -0,0 +1,80 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BLOCKRELEASEQUEUE_HPP
+#define BLOCKRELEASEQUEUE_HPP
+
+#include <mutex>
+#include <vector>
+
+#include "../utils/fuse_headers.hpp"
+#include "../utils/log_level.hpp"
+#include "NodeTopology.hpp"
+#include "mpi_data.hpp"
+
+using namespace std;
+
+/**
+ * @brief The blocks of the storage processes no longer used by any file, released by the master.
+ *
+ * A front end reads the blocks of a file from the storage processes after the master told it where they are, and
+ * the messages of the front end and of the master to a storage process aren't ordered. So the master pins the blocks
+ * when it opens a file for a front end, and the front end unpins them when it has read them: the blocks replaced by a
+ * write are queued while any read is pinned, and released when the last one is unpinned. It's used only when there
+ * are other front ends or clients, the storage processes release the blocks of the writes of the master otherwise.
+ */
+class BlockReleaseQueue {
+private:
+	//Singleton implementation
+	static BlockReleaseQueue* instance;
+	BlockReleaseQueue(int rank, int mpi_world_size);
+
+	int rank;
+	int mpi_world_size;
+	//The reads of the front ends in progress
+	unsigned int pinnedReads;
+	//The queued blocks of each process
+	vector<vector<PointerPacket> > queuedBlocks;
+	mutex queueMutex;
+
+	NodeTopology *nodeTopology;
+	log4cplus::Logger BlockReleaseQueueLogger;
+
+	/**
+	 * @brief Send the queued blocks to their processes, queueMutex must be held.
+	 */
+	void sendQueuedBlocks();
+
+public:
+	static BlockReleaseQueue* getInstance(int rank, int mpi_world_size);
+
+	/**
+	 * @brief Pin the blocks of a file opened by a front end, until unpin() is invoked.
+	 */
+	void pin();
+
+	/**
+	 * @brief End a read of a front end, the queued blocks are released with the last one.
+	 */
+	void unpin();
+
+	/**
+	 * @brief Queue a block of a storage process, the blocks of the master aren't released through the queue.
+	 */
+	void add(int rank, void *address);
+
+	/**
+	 * @brief Queue the blocks of the current version of a file, before they're replaced by the new one.
+	 */
+	void addBlocksOfInode(fuse_ino_t inode);
+
+	/**
+	 * @brief Release the queued blocks, unless a read is pinned.
+	 */
+	void flush();
+};
+
+
+
+#endif //BLOCKRELEASEQUEUE_HPP
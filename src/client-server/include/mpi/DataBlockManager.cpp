@@ -6,6 +6,8 @@
 #include <iostream>
 #include <cstring>
 
+#include "../blocks/Blocks.hpp"
+
 using namespace log4cplus;
 
 DataBlockManager *DataBlockManager::instance = nullptr;
@@ -20,28 +22,100 @@ DataBlockManager *DataBlockManager::getInstance(int mpi_world_size) {
 
 DataBlockManager::DataBlockManager(int mpi_world_size) {
 	this->mpi_world_size = mpi_world_size;
+	firstStorageRank = 0;
 	DataBlockManagerLogger = Logger::getInstance("DataBlockManager.logger - ");
 	LogLevel ll = DAGONFS_LOG_LEVEL;
 	DataBlockManagerLogger.setLogLevel(ll);
 }
 
-void DataBlockManager::addDataBlocksTo(vector<DataBlock*>& blockList, int nblocks, fuse_ino_t inode) {
-	int startingIndex = blockList.size();
+void DataBlockManager::setMetadataOnlyMaster(bool metadataOnly) {
+	int newFirstStorageRank = metadataOnly && mpi_world_size > 1 ? 1 : 0;
+	if (newFirstStorageRank == firstStorageRank) {
+		return;
+	}
+
+	//The cached plans place blocks on the master, or don't
+	for (auto &plan : transferPlans) {
+		delete plan.second.first;
+	}
+	transferPlans.clear();
+	planUsage.clear();
+	firstStorageRank = newFirstStorageRank;
+}
+
+TransferPlan *DataBlockManager::getTransferPlan(const DataLayout &layout, size_t nblocks, size_t chunkBlocks) {
+	PlanKey key(nblocks, layout.stripeCount, layout.stripeUnit, layout.startRank, chunkBlocks);
+	auto plan_it = transferPlans.find(key);
+	if (plan_it != transferPlans.end()) {
+		planUsage.splice(planUsage.begin(), planUsage, plan_it->second.second);
+		return plan_it->second.first;
+	}
+
+	if (transferPlans.size() >= TRANSFER_PLAN_CACHE_SIZE) {
+		auto oldest_it = transferPlans.find(planUsage.back());
+		delete oldest_it->second.first;
+		transferPlans.erase(oldest_it);
+		planUsage.pop_back();
+	}
+
+	LOG4CPLUS_DEBUG(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "New transfer plan for " << nblocks << " blocks");
+	TransferPlan *plan = new TransferPlan(layout, nblocks, mpi_world_size, firstStorageRank, chunkBlocks);
+	planUsage.push_front(key);
+	transferPlans[key] = make_pair(plan, planUsage.begin());
+	return plan;
+}
+
+TransferPlan *DataBlockManager::getSparseTransferPlan(const DataLayout &layout, const vector<char> &blockMap, size_t chunkBlocks) {
+	//The blocks transferred keep the processes of the layout
+	BlockDistribution distribution(layout, blockMap.size(), mpi_world_size, firstStorageRank);
+	vector<int> blockRanks;
+	for (size_t i=0; i < blockMap.size(); i++) {
+		if (blockMap[i] == BLOCK_DATA || blockMap[i] == BLOCK_INDEXED) {
+			blockRanks.push_back(distribution.getRankOfBlock(i));
+		}
+	}
+
+	LOG4CPLUS_DEBUG(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "New transfer plan for " << blockRanks.size() << " blocks of " << blockMap.size());
+	return new TransferPlan(blockRanks, mpi_world_size, chunkBlocks);
+}
+
+void DataBlockManager::addDataBlocksTo(vector<DataBlock*>& blockList, size_t nblocks, fuse_ino_t inode, BlockDistribution &distribution) {
+	size_t startingIndex = blockList.size();
 	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Master Process - Starting index for new blocks: " << startingIndex);
-	int newSize = blockList.size() + nblocks;
+	size_t newSize = blockList.size() + nblocks;
 	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Master Process - New block list size: " << newSize);
-	int lastRank = blockList.size() == 0 ? 0 : blockList[startingIndex - 1]->getRank();
-	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Master Process - Last rank in list " << lastRank);
-	int rank_i = lastRank;
-	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Master Process - Starting rank " << lastRank);
 
-	for (int i = startingIndex; i < newSize; i++) {
+	for (size_t i = startingIndex; i < newSize; i++) {
 		DataBlock *dataBlock = new DataBlock(inode);
-		dataBlock->setRank(rank_i);
+		dataBlock->setRank(distribution.getRankOfBlock(i));
 		dataBlock->setProgressiveNumber(i);
 		dataBlock->setAbsoluteBytes(i*FILE_SYSTEM_SINGLE_BLOCK_SIZE);
 		blockList.push_back(dataBlock);
+	}
+}
 
-		if (++rank_i == mpi_world_size) rank_i = 0;
+void DataBlockManager::setBlocksOfInode(fuse_ino_t inode, const PointerPacket *addresses, size_t nblocks, BlockDistribution &distribution) {
+	Blocks *blocks = Blocks::getInstance();
+	if (!blocks->blockListExistForInode(inode)) {
+		blocks->createEmptyBlockListForInode(inode);
+	}
+	vector<DataBlock *> &inodeBlockList = blocks->getDataBlockListOfInode(inode);
+	long additionBlocks = (long) nblocks - (long) inodeBlockList.size();
+	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Current block list size: " << inodeBlockList.size() );
+	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Number of blocks: " << nblocks);
+	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Additional block: " << additionBlocks);
+	if (additionBlocks > 0) {
+		addDataBlocksTo(inodeBlockList, additionBlocks, inode, distribution);
+		LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "New block list size: " << inodeBlockList.size());
+	}
+
+	for (size_t i=0; i < nblocks; i++) {
+		DataBlock *dataBlock = inodeBlockList[i];
+		dataBlock->setData(addresses[i].address);
+		dataBlock->setRank(distribution.getRankOfBlock(i));
+	}
+	//The blocks past the end of a shorter version belong to the previous one, which is released by its storage processes
+	for (size_t i=nblocks; i < inodeBlockList.size(); i++) {
+		inodeBlockList[i]->setData(nullptr);
 	}
 }
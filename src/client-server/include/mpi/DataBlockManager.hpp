@@ -6,11 +6,20 @@
 #define DATABLOCKMANAGER_HPP
 
 #include <vector>
+#include <map>
+#include <list>
+#include <tuple>
 #include "../utils/log_level.hpp"
 
 #include "../blocks/DataBlock.hpp"
+#include "../blocks/DataLayout.hpp"
+#include "BlockDistribution.hpp"
+#include "TransferPlan.hpp"
 using namespace std;
 
+//Maximum number of transfer plans kept by each process
+#define TRANSFER_PLAN_CACHE_SIZE 64
+
 class DataBlockManager {
 private:
 	//Singleton implementation
@@ -18,12 +27,62 @@ private:
 	DataBlockManager(int mpi_world_size);
 
 	int mpi_world_size;
+	//The master stores blocks only when it's 0
+	int firstStorageRank;
 	log4cplus::Logger DataBlockManagerLogger;
 
+	//The plans by number of blocks, layout and chunk size, and their keys from the most recently used
+	typedef tuple<size_t, int, unsigned int, int, size_t> PlanKey;
+	map<PlanKey, pair<TransferPlan *, list<PlanKey>::iterator> > transferPlans;
+	list<PlanKey> planUsage;
+
 public:
 	static DataBlockManager* getInstance(int mpi_world_size);
 
-	void addDataBlocksTo(vector<DataBlock *> &blockList, int nblocks, fuse_ino_t inode);
+	/**
+	 * @brief Exclude the master from the placement of the blocks, it must be invoked by every process with the same value.
+	 *
+	 * The master keeps storing blocks when it's the only process.
+	 */
+	void setMetadataOnlyMaster(bool metadataOnly);
+	bool isMetadataOnlyMaster() { return firstStorageRank > 0; }
+	int getFirstStorageRank() { return firstStorageRank; }
+
+	/**
+	 * @brief Get the plan of the transfers of a file, computing it only if it isn't cached.
+	 *
+	 * The least recently used plan is dropped when the cache is full. Every process taking part in a
+	 * transfer must get its plan, so the caches of all the processes hold the same plans.
+	 *
+	 * @param layout The layout of the file.
+	 * @param nblocks The number of blocks transferred.
+	 * @param chunkBlocks The maximum number of blocks transferred to a process in a round.
+	 * @return The plan, valid until the next call.
+	 */
+	TransferPlan *getTransferPlan(const DataLayout &layout, size_t nblocks, size_t chunkBlocks);
+
+	/**
+	 * @brief Get the plan of a transfer of a file with holes or shared blocks, which moves only the blocks with data not stored yet.
+	 *
+	 * The plans of the holes of each version of a file are different, so they aren't cached.
+	 *
+	 * @param layout The layout of the file.
+	 * @param blockMap The TransferBlockKind of each block of the transfer.
+	 * @param chunkBlocks The maximum number of blocks transferred to a process in a round.
+	 * @return The plan, to be deleted by the caller.
+	 */
+	TransferPlan *getSparseTransferPlan(const DataLayout &layout, const vector<char> &blockMap, size_t chunkBlocks);
+	void addDataBlocksTo(vector<DataBlock *> &blockList, size_t nblocks, fuse_ino_t inode, BlockDistribution &distribution);
+
+	/**
+	 * @brief Save at the master where the blocks of a file have been written.
+	 *
+	 * @param inode The inode of the file.
+	 * @param addresses The address of each block in its storage process, in file order.
+	 * @param nblocks The number of blocks of the file.
+	 * @param distribution The distribution of the blocks among the storage processes.
+	 */
+	void setBlocksOfInode(fuse_ino_t inode, const PointerPacket *addresses, size_t nblocks, BlockDistribution &distribution);
 };
 
 
@@ -0,0 +1,101 @@
+//
+// Created on 10/19/26.
+//
+
+#include "DedupIndex.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "../blocks/data_blocks_info.hpp"
+
+#ifdef DAGONFS_HAVE_OPENSSL
+#include <openssl/evp.h>
+#endif
+
+using namespace std;
+
+using namespace log4cplus;
+
+DedupIndex *DedupIndex::instance = nullptr;
+
+DedupIndex *DedupIndex::getInstance(int mpi_world_size) {
+	if (instance == nullptr) {
+		instance = new DedupIndex(mpi_world_size);
+	}
+
+	return instance;
+}
+
+DedupIndex::DedupIndex(int mpi_world_size) {
+	indexedBlocks = vector<map<Fingerprint, IndexedBlock> >(mpi_world_size);
+	const char *env = getenv(DAGONFS_ENV_DEDUP);
+	enabled = env != nullptr && atoi(env) != 0;
+
+	DedupIndexLogger = Logger::getInstance("DedupIndex.logger - ");
+	LogLevel ll = DAGONFS_LOG_LEVEL;
+	DedupIndexLogger.setLogLevel(ll);
+#ifndef DAGONFS_HAVE_OPENSSL
+	if (enabled) {
+		LOG4CPLUS_WARN(DedupIndexLogger, DedupIndexLogger.getName() << "OpenSSL isn't built in, the blocks aren't deduplicated");
+		enabled = false;
+	}
+#endif
+	if (enabled) {
+		LOG4CPLUS_INFO(DedupIndexLogger, DedupIndexLogger.getName() << "The blocks written by the master are deduplicated");
+	}
+}
+
+Fingerprint DedupIndex::fingerprint([[maybe_unused]] const void *block) {
+	Fingerprint fingerprint = {};
+#ifdef DAGONFS_HAVE_OPENSSL
+	EVP_Digest(block, FILE_SYSTEM_SINGLE_BLOCK_SIZE, fingerprint.digest, nullptr, EVP_sha256(), nullptr);
+#endif
+
+	return fingerprint;
+}
+
+void *DedupIndex::reference(int rank, const Fingerprint &fingerprint) {
+	auto block_it = indexedBlocks[rank].find(fingerprint);
+	if (block_it == indexedBlocks[rank].end())
+		return nullptr;
+
+	block_it->second.references++;
+	return block_it->second.address;
+}
+
+void DedupIndex::add(int rank, const Fingerprint &fingerprint, void *address) {
+	indexedBlocks[rank][fingerprint] = {address, 1};
+}
+
+void DedupIndex::setReferences(fuse_ino_t inode, const vector<pair<int, Fingerprint> > &references) {
+	auto file_it = fileReferences.find(inode);
+	if (file_it != fileReferences.end()) {
+		for (auto &reference : file_it->second) {
+			auto block_it = indexedBlocks[reference.first].find(reference.second);
+			if (block_it == indexedBlocks[reference.first].end() || --block_it->second.references > 0)
+				continue;
+
+			droppedBlocks.push_back({block_it->second.address, reference.first});
+			indexedBlocks[reference.first].erase(block_it);
+		}
+	}
+
+	if (references.empty()) {
+		if (file_it != fileReferences.end()) {
+			fileReferences.erase(file_it);
+		}
+		return;
+	}
+	fileReferences[inode] = references;
+}
+
+vector<BlockLocationPacket> DedupIndex::takeDroppedBlocks() {
+	vector<BlockLocationPacket> blocks;
+	blocks.swap(droppedBlocks);
+	if (!blocks.empty()) {
+		LOG4CPLUS_DEBUG(DedupIndexLogger, DedupIndexLogger.getName() << blocks.size() << " blocks dropped from the index");
+	}
+
+	return blocks;
+}
@@ -0,0 +1,103 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef DEDUPINDEX_HPP
+#define DEDUPINDEX_HPP
+
+#include <map>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+
+#include "../utils/fuse_headers.hpp"
+#include "../utils/log_level.hpp"
+#include "mpi_data.hpp"
+
+using namespace std;
+
+//Set to 1 to deduplicate the blocks written by the master, read by the master
+#define DAGONFS_ENV_DEDUP "DAGONFS_DEDUP"
+//The bytes of a fingerprint, a SHA-256 digest
+#define FINGERPRINT_BYTES 32
+
+typedef struct Fingerprint {
+	unsigned char digest[FINGERPRINT_BYTES];
+
+	bool operator<(const Fingerprint &other) const { return memcmp(digest, other.digest, FINGERPRINT_BYTES) < 0; }
+	bool operator==(const Fingerprint &other) const { return memcmp(digest, other.digest, FINGERPRINT_BYTES) == 0; }
+} Fingerprint;
+
+/**
+ * @brief The blocks stored by each storage process, by fingerprint, so a block already stored isn't sent again.
+ *
+ * It's kept by the master, which decides what each transfer sends: a block whose fingerprint is indexed for the
+ * process of its layout is shared, the file gets the address of the indexed block. Each file version holds a
+ * reference to the indexed blocks it uses, and the index holds one more on the storage process, so a block is
+ * freed only when the index drops it, after the last file using it has been written again. Two blocks with the
+ * same fingerprint are considered equal: the fingerprint is a SHA-256 digest, so a collision can't be crafted, and
+ * the deduplication is disabled if OpenSSL isn't built in (DAGONFS_HAVE_OPENSSL).
+ */
+class DedupIndex {
+private:
+	//Singleton implementation
+	static DedupIndex* instance;
+	DedupIndex(int mpi_world_size);
+
+	typedef struct IndexedBlock {
+		void *address;
+		unsigned int references;
+	} IndexedBlock;
+	//The indexed blocks of each process
+	vector<map<Fingerprint, IndexedBlock> > indexedBlocks;
+	//The indexed blocks used by the current version of each file
+	map<fuse_ino_t, vector<pair<int, Fingerprint> > > fileReferences;
+	//The blocks dropped from the index, to be freed by their processes
+	vector<BlockLocationPacket> droppedBlocks;
+	bool enabled;
+
+	log4cplus::Logger DedupIndexLogger;
+
+public:
+	static DedupIndex* getInstance(int mpi_world_size);
+
+	bool isEnabled() { return enabled; }
+
+	/**
+	 * @brief Compute the fingerprint of a block, the SHA-256 digest of its data.
+	 */
+	static Fingerprint fingerprint(const void *block);
+
+	/**
+	 * @brief Look up a block, taking a reference to it if it's indexed.
+	 *
+	 * @param rank The process which stores the block.
+	 * @param fingerprint The fingerprint of the block.
+	 * @return The address of the indexed block, nullptr if it isn't indexed.
+	 */
+	void *reference(int rank, const Fingerprint &fingerprint);
+
+	/**
+	 * @brief Index a block just stored, with the reference of the file which wrote it.
+	 */
+	void add(int rank, const Fingerprint &fingerprint, void *address);
+
+	/**
+	 * @brief Replace the references of the previous version of a file with the ones of its new version.
+	 *
+	 * The blocks left without references are dropped from the index.
+	 *
+	 * @param inode The inode of the file.
+	 * @param references The process and the fingerprint of each indexed block used by the new version, already taken.
+	 */
+	void setReferences(fuse_ino_t inode, const vector<pair<int, Fingerprint> > &references);
+
+	/**
+	 * @brief Get the blocks dropped from the index since the last call, the master sends them with its next write.
+	 */
+	vector<BlockLocationPacket> takeDroppedBlocks();
+};
+
+
+
+#endif //DEDUPINDEX_HPP
@@ -6,11 +6,15 @@
 #define DISTRIBUTEDWRITE_HPP
 
 #include "../utils/fuse_headers.hpp"
+#include "../blocks/DataLayout.hpp"
 
 class DistributedWrite {
 public:
 	virtual ~DistributedWrite() {};
-	virtual void DAGonFS_Write(void *buffer, fuse_ino_t inode, size_t fileSize) = 0;
+	/**
+	 * @param blocks The address of each block of the file, in file order, significant only at the master.
+	 */
+	virtual void DAGonFS_Write(void *const *blocks, fuse_ino_t inode, size_t fileSize, const DataLayout &layout) = 0;
 };
 
 #endif //DISTRIBUTEDWRITE_HPP
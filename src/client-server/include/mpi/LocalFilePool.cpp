@@ -0,0 +1,133 @@
+//
+// Created on 10/19/26.
+//
+
+#include "LocalFilePool.hpp"
+
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "../blocks/data_blocks_info.hpp"
+
+using namespace std;
+
+using namespace log4cplus;
+
+LocalFilePool *LocalFilePool::instance = nullptr;
+
+LocalFilePool *LocalFilePool::getInstance() {
+	if (instance == nullptr) {
+		instance = new LocalFilePool();
+	}
+
+	return instance;
+}
+
+LocalFilePool::LocalFilePool() {
+	LocalFilePoolLogger = Logger::getInstance("LocalFilePool.logger - ");
+	LogLevel ll = DAGONFS_LOG_LEVEL;
+	LocalFilePoolLogger.setLogLevel(ll);
+}
+
+char *LocalFilePool::allocate(fuse_ino_t inode, size_t fileSize) {
+	string name = "dagonfs-" + to_string(inode);
+	int fd = memfd_create(name.c_str(), MFD_CLOEXEC);
+	if (fd < 0) {
+		LOG4CPLUS_WARN(LocalFilePoolLogger, LocalFilePoolLogger.getName() << "memfd_create() failed for inode " << inode << ": " << strerror(errno));
+		release(inode);
+		return nullptr;
+	}
+
+	//The whole blocks are mapped, the pages past the end of the file are never touched
+	size_t nblocks = fileSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (fileSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
+	LocalFile file = {fd, nullptr, fileSize, nblocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE, 0};
+	if (ftruncate(fd, fileSize) < 0) {
+		LOG4CPLUS_WARN(LocalFilePoolLogger, LocalFilePoolLogger.getName() << "cannot resize the memfd of inode " << inode << ": " << strerror(errno));
+		close(fd);
+		release(inode);
+		return nullptr;
+	}
+	void *base = mmap(nullptr, file.mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		LOG4CPLUS_WARN(LocalFilePoolLogger, LocalFilePoolLogger.getName() << "cannot map the memfd of inode " << inode << ": " << strerror(errno));
+		close(fd);
+		release(inode);
+		return nullptr;
+	}
+	file.base = (char *) base;
+
+	release(inode);
+	files[inode] = file;
+	LOG4CPLUS_DEBUG(LocalFilePoolLogger, LocalFilePoolLogger.getName() << "inode " << inode << " stored in a memfd of " << fileSize << " bytes");
+	return file.base;
+}
+
+void LocalFilePool::unmap(LocalFile &file) {
+	if (file.backingId > 0) {
+		retiredBackingIds.push_back(file.backingId);
+	}
+	munmap(file.base, file.mappedBytes);
+	close(file.fd);
+}
+
+void LocalFilePool::release(fuse_ino_t inode) {
+	auto file_it = files.find(inode);
+	if (file_it == files.end()) {
+		return;
+	}
+
+	unmap(file_it->second);
+	files.erase(file_it);
+}
+
+void LocalFilePool::resize(fuse_ino_t inode, size_t fileSize) {
+	auto file_it = files.find(inode);
+	if (file_it == files.end() || file_it->second.fileSize == fileSize) {
+		return;
+	}
+
+	if (ftruncate(file_it->second.fd, fileSize) < 0) {
+		LOG4CPLUS_WARN(LocalFilePoolLogger, LocalFilePoolLogger.getName() << "cannot resize the memfd of inode " << inode << ": " << strerror(errno));
+		return;
+	}
+	file_it->second.fileSize = fileSize;
+}
+
+/**
+ * The pages of the mapping past the end of the memfd can't be accessed, so the file may be shorter than its size after a
+ * truncate which couldn't resize the memfd.
+ */
+const char *LocalFilePool::getData(fuse_ino_t inode, size_t &dataBytes) {
+	auto file_it = files.find(inode);
+	if (file_it == files.end()) {
+		return nullptr;
+	}
+
+	dataBytes = min(file_it->second.fileSize, file_it->second.mappedBytes);
+	return file_it->second.base;
+}
+
+int LocalFilePool::getFd(fuse_ino_t inode, size_t fileSize) {
+	auto file_it = files.find(inode);
+	if (file_it == files.end() || file_it->second.fileSize != fileSize) {
+		return -1;
+	}
+
+	return file_it->second.fd;
+}
+
+int LocalFilePool::getBackingId(fuse_ino_t inode) {
+	auto file_it = files.find(inode);
+	return file_it == files.end() ? 0 : file_it->second.backingId;
+}
+
+void LocalFilePool::setBackingId(fuse_ino_t inode, int backingId) {
+	auto file_it = files.find(inode);
+	if (file_it != files.end()) {
+		file_it->second.backingId = backingId;
+	}
+}
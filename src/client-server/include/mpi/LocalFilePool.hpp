@@ -0,0 +1,100 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef LOCALFILEPOOL_HPP
+#define LOCALFILEPOOL_HPP
+
+#include <map>
+#include <vector>
+#include <cstddef>
+
+#include "../utils/fuse_headers.hpp"
+#include "../utils/log_level.hpp"
+
+using namespace std;
+
+/**
+ * @brief The files whose blocks are all stored by the master, each kept in its own memfd.
+ *
+ * The blocks of such a file are adjacent in the mapping of its memfd, in file order, and the memfd is
+ * exactly as large as the file: the front end hands it to the kernel as the backing file of the read
+ * only opens (FUSE passthrough), so their reads don't reach the file system. The tail of the last block
+ * is past the end of the memfd, so only the bytes of the file can be accessed.
+ *
+ * A file leaves the pool when its blocks are written again somewhere else, the backing id registered
+ * for it must be closed then, and the front end does it at its next open.
+ */
+class LocalFilePool {
+private:
+	//Singleton implementation
+	static LocalFilePool* instance;
+	LocalFilePool();
+
+	struct LocalFile {
+		int fd;
+		char *base;
+		size_t fileSize;
+		size_t mappedBytes;
+		//The passthrough of the memfd, 0 if it isn't registered
+		int backingId;
+	};
+	map<fuse_ino_t, LocalFile> files;
+	vector<int> retiredBackingIds;
+
+	log4cplus::Logger LocalFilePoolLogger;
+
+	void unmap(LocalFile &file);
+
+public:
+	static LocalFilePool* getInstance();
+
+	/**
+	 * @brief Create the memfd of a file stored entirely by the master, replacing the previous one.
+	 *
+	 * @param inode The inode of the file.
+	 * @param fileSize The size of the file.
+	 * @return The first block of the file, nullptr if the memfd can't be created.
+	 */
+	char *allocate(fuse_ino_t inode, size_t fileSize);
+
+	/**
+	 * @brief Remove a file from the pool, its blocks are no longer stored by the master.
+	 */
+	void release(fuse_ino_t inode);
+
+	/**
+	 * @brief Change the size of the memfd of a file after a truncate, so it never ends before the blocks read from it.
+	 *
+	 * The mapping keeps its size: the blocks past it are holes of the block list.
+	 */
+	void resize(fuse_ino_t inode, size_t fileSize);
+
+	/**
+	 * @brief Get the data of a file of the pool.
+	 *
+	 * @param inode The inode of the file.
+	 * @param dataBytes Set to the bytes which can be read from the first block, the end of the memfd or of its mapping.
+	 * @return The first block, nullptr if the file isn't in the pool.
+	 */
+	const char *getData(fuse_ino_t inode, size_t &dataBytes);
+
+	/**
+	 * @brief Get the memfd of a file of the pool.
+	 *
+	 * @return The file descriptor, -1 if the file isn't in the pool or its size is not fileSize.
+	 */
+	int getFd(fuse_ino_t inode, size_t fileSize);
+
+	int getBackingId(fuse_ino_t inode);
+	void setBackingId(fuse_ino_t inode, int backingId);
+
+	/**
+	 * @brief Get the backing ids of the files which left the pool, to be closed by the front end.
+	 */
+	vector<int> &getRetiredBackingIds() { return retiredBackingIds; }
+};
+
+
+
+#endif //LOCALFILEPOOL_HPP
@@ -6,12 +6,17 @@
 
 #include <iostream>
 #include <cstring>
+#include <climits>
+#include <vector>
+#include <set>
+#include <algorithm>
 #include <unistd.h>
 
 #include <mpi.h>
 #include "mpi_data.hpp"
 
 #include "../blocks/Blocks.hpp"
+#include "../blocks/zero_blocks.hpp"
 
 using namespace std;
 
@@ -19,6 +24,13 @@ using namespace log4cplus;
 
 MasterProcessCode *MasterProcessCode::instance = nullptr;
 
+/**
+ * The blocks past the end of the block list are holes too: a file extended by setattr has a size larger than its list.
+ */
+static bool isHoleOf(vector<DataBlock *> &dataBlockList, size_t block) {
+	return block >= dataBlockList.size() || dataBlockList[block]->isHole();
+}
+
 MasterProcessCode *MasterProcessCode::getInstance(int rank, int mpi_world_size) {
 	if (instance == nullptr) {
 		instance = new MasterProcessCode(rank, mpi_world_size);
@@ -31,14 +43,13 @@ MasterProcessCode::MasterProcessCode(int rank, int mpi_world_size) {
 	this->rank = rank;
 	this->mpi_world_size = mpi_world_size;
 
-	scatterCounts = new int[mpi_world_size];
-	scatterDispls = new int[mpi_world_size];
-	scatterOffset = 0;
-	gatherCounts = new int[mpi_world_size];
-	gatherDispls = new int[mpi_world_size];
-	gatherOffset = 0;
-
 	dataBlockManager = DataBlockManager::getInstance(mpi_world_size);
+	blockPool = BlockPool::getInstance(rank, mpi_world_size);
+	localFilePool = LocalFilePool::getInstance();
+	dedupIndex = DedupIndex::getInstance(mpi_world_size);
+	nodeTopology = NodeTopology::getInstance(rank, mpi_world_size);
+	blockReleaseQueue = BlockReleaseQueue::getInstance(rank, mpi_world_size);
+	dataBlockManager->setMetadataOnlyMaster(nodeTopology->isMetadataOnlyMaster());
 	MasterProcessLogger = Logger::getInstance("MasterProcess.logger - ");
 	LogLevel ll = DAGONFS_LOG_LEVEL;
 	MasterProcessLogger.setLogLevel(ll);
@@ -50,109 +61,250 @@ MasterProcessCode::MasterProcessCode(int rank, int mpi_world_size) {
 }
 
 
-void MasterProcessCode::DAGonFS_Write(void* buffer, fuse_ino_t inode, size_t fileSize) {
+void MasterProcessCode::DAGonFS_Write(void *const *blocks, fuse_ino_t inode, size_t fileSize, const DataLayout &layout) {
 	LOG4CPLUS_TRACE(MasterProcessLogger, MasterProcessLogger.getName() << "Invoked DAGonFS_Write()");
 
-	IORequestPacket ioRequest;
-	ioRequest.inode = inode;
-	ioRequest.fileSize = fileSize;
-	MPI_Bcast(&ioRequest, sizeof(ioRequest), MPI_BYTE, 0, MPI_COMM_WORLD);
-
 	double startWrite = MPI_Wtime();
-	unsigned int numberOfBlocks = fileSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (fileSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
-	unsigned int blockPerProcess = numberOfBlocks / mpi_world_size;
-	unsigned int remainingBlocks = numberOfBlocks % mpi_world_size;
+	size_t numberOfBlocks = fileSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (fileSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
+	BlockDistribution fileDistribution(layout, numberOfBlocks, mpi_world_size, dataBlockManager->getFirstStorageRank());
 
-	//Data for Scatter
-	scatterOffset = 0;
-	for (int i=0; i<mpi_world_size; i++) {
-		//Calculating elements
-		scatterCounts[i] = ( blockPerProcess + (i < remainingBlocks) ) * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+	//A file stored entirely by the master is written in a memfd, where its holes take no memory, so the front end can pass it through to the kernel
+	char *localFile = nullptr;
+	if (fileDistribution.getTouchedRanks().size() == 1 && fileDistribution.getTouchedRanks()[0] == rank) {
+		localFile = localFilePool->allocate(inode, fileSize);
+	}
+	else {
+		localFilePool->release(inode);
+	}
 
-		//Calculating displacements
-		scatterDispls[i] = scatterOffset;
-		scatterOffset += scatterCounts[i];
+	//The blocks never written and the blocks of zeros are holes: they aren't sent, and nobody stores them. With the
+	//deduplication the blocks already stored by their process aren't sent either, they're shared. A memfd has its own blocks
+	bool deduplicate = dedupIndex->isEnabled() && localFile == nullptr;
+	vector<char> blockMap(numberOfBlocks, BLOCK_DATA);
+	vector<Fingerprint> fingerprints(deduplicate ? numberOfBlocks : 0);
+	vector<pair<int, Fingerprint> > references;
+	set<pair<int, Fingerprint> > indexedBlocks;
+	vector<size_t> sentBlocks;
+	vector<BlockLocationPacket> sharedBlocks;
+	size_t mappedBlocks = 0;
+	for (size_t i=0; i < numberOfBlocks; i++) {
+		if (blocks[i] == nullptr || isZeroBlock(blocks[i], FILE_SYSTEM_SINGLE_BLOCK_SIZE)) {
+			blockMap[i] = BLOCK_HOLE;
+			mappedBlocks++;
+			continue;
+		}
+		if (deduplicate) {
+			int blockRank = fileDistribution.getRankOfBlock(i);
+			fingerprints[i] = DedupIndex::fingerprint(blocks[i]);
+			void *address = dedupIndex->reference(blockRank, fingerprints[i]);
+			if (address != nullptr) {
+				blockMap[i] = BLOCK_SHARED;
+				sharedBlocks.push_back({address, blockRank});
+				references.push_back(make_pair(blockRank, fingerprints[i]));
+				mappedBlocks++;
+				continue;
+			}
+			//Only the first copy of a block repeated in the file is indexed, the others are sent again
+			if (indexedBlocks.insert(make_pair(blockRank, fingerprints[i])).second) {
+				blockMap[i] = BLOCK_INDEXED;
+				references.push_back(make_pair(blockRank, fingerprints[i]));
+				mappedBlocks++;
+			}
+		}
+		sentBlocks.push_back(i);
+	}
+	size_t numberOfSkippedBlocks = numberOfBlocks - sentBlocks.size();
+	vector<BlockLocationPacket> droppedBlocks = dedupIndex->takeDroppedBlocks();
+	//With other front ends the blocks of the storage processes are released through the queue, as the front ends may
+	//still be reading them: the storage processes only forget the previous version
+	bool queueReleases = nodeTopology->hasRemoteFrontEnds();
+	if (queueReleases) {
+		for (BlockLocationPacket &droppedBlock : droppedBlocks) {
+			blockReleaseQueue->add(droppedBlock.rank, droppedBlock.address);
+		}
+		erase_if(droppedBlocks, [this](BlockLocationPacket &droppedBlock) { return droppedBlock.rank != rank; });
+		blockReleaseQueue->addBlocksOfInode(inode);
 	}
 
-	//Data for gather
-	PointerPacket *addresses = new PointerPacket[numberOfBlocks];
-	gatherOffset = 0;
-	for (int i=0; i< mpi_world_size; i++) {
-		//Calculating elements
-		gatherCounts[i] = ( blockPerProcess + (i < remainingBlocks) ) * sizeof(PointerPacket);
+	IORequestPacket ioRequest;
+	ioRequest.inode = inode;
+	ioRequest.fileSize = fileSize;
+	ioRequest.reqSize = fileSize;
+	ioRequest.offset = 0;
+	ioRequest.layout = layout;
+	ioRequest.mappedBlocks = mappedBlocks;
+	ioRequest.sharedBlocks = sharedBlocks.size();
+	ioRequest.droppedBlocks = droppedBlocks.size();
+	MPI_Bcast(&ioRequest, sizeof(ioRequest), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
+	if (mappedBlocks > 0) {
+		MPI_Bcast(blockMap.data(), numberOfBlocks, MPI_BYTE, 0, DAGONFS_COMM_WORLD);
+	}
+	if (!sharedBlocks.empty()) {
+		MPI_Bcast(sharedBlocks.data(), sharedBlocks.size() * sizeof(BlockLocationPacket), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
+	}
+	if (!droppedBlocks.empty()) {
+		MPI_Bcast(droppedBlocks.data(), droppedBlocks.size() * sizeof(BlockLocationPacket), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
+	}
+	//The blocks of the master are never in a pool, the ones dropped from the index are freed here
+	for (BlockLocationPacket &droppedBlock : droppedBlocks) {
+		if (droppedBlock.rank == rank) {
+			free(droppedBlock.address);
+		}
+	}
 
-		//Calculating displacements
-		gatherDispls[i] = gatherOffset;
-		gatherOffset += gatherCounts[i];
+	//Counts and displacements of the scatter and of the gather, only the blocks with data not stored yet are transferred
+	TransferPlan *plan;
+	vector<void *> dataBlocks;
+	if (mappedBlocks > 0) {
+		plan = dataBlockManager->getSparseTransferPlan(layout, blockMap, nodeTopology->getChunkBlocks());
+		for (size_t block : sentBlocks) {
+			dataBlocks.push_back(blocks[block]);
+		}
+		//From here the blocks are indexed as the blocks sent
+		blocks = dataBlocks.data();
+		LOG4CPLUS_DEBUG(MasterProcessLogger, MasterProcessLogger.getName() << "inode " << inode << " has " << numberOfSkippedBlocks - sharedBlocks.size() << " holes and " << sharedBlocks.size() << " shared blocks in " << numberOfBlocks << " blocks");
+	}
+	else {
+		plan = dataBlockManager->getTransferPlan(layout, numberOfBlocks, nodeTopology->getChunkBlocks());
+	}
+	BlockDistribution &distribution = plan->getDistribution();
+	PointerPacket *addresses = new PointerPacket[distribution.getNumberOfBlocks()];
+	int rounds = plan->getNumberOfRounds();
+
+	//The blocks of the file aren't adjacent: the ones of the storage processes are staged in transfer order a round at a
+	//time, and the next round is staged while the current one is sent
+	size_t stagedBlocks = 0;
+	for (int round=0; round < rounds; round++) {
+		size_t roundBlocks = 0;
+		for (int i : distribution.getTouchedRanks()) {
+			if (i != rank) {
+				roundBlocks += plan->getBlockCounts(round)[i];
+			}
+		}
+		stagedBlocks = max(stagedBlocks, roundBlocks);
 	}
+	char *stagingBuffers[2] = {(char *) malloc(stagedBlocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE), nullptr};
+	if (rounds > 1) {
+		stagingBuffers[1] = (char *) malloc(stagedBlocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+	}
+	//The displacements of a round must not change until its scatter is completed
+	vector<vector<int> > stagedDispls(2, vector<int>(mpi_world_size, 0));
+	stageRound(plan, 0, blocks, stagingBuffers[0], stagedDispls[0].data());
 
 	//In this code the rank is always 0 due to the fact that this code it's executed only by the master
-	void *localScatBuf = malloc(scatterCounts[rank]);
-	double startScatter = MPI_Wtime();
-	MPI_Scatterv(buffer, scatterCounts, scatterDispls, MPI_BYTE, localScatBuf, scatterCounts[rank], MPI_BYTE, 0, MPI_COMM_WORLD);
-	double endScatter = MPI_Wtime();
-
-	unsigned int effectiveBlocks = blockPerProcess + (rank < remainingBlocks);
+	//The blocks of the master are copied from the file while the blocks of the other processes are sent
+	size_t effectiveBlocks = distribution.getBlocksOfRank(rank);
+	size_t firstSlot = plan->getBlockDispls()[rank];
 	PointerPacket *localGathBuf = new PointerPacket[effectiveBlocks];
-	for (int i=0; i < effectiveBlocks; i++) {
-		void *data_p = malloc(FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-		memcpy(data_p, localScatBuf + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-		localGathBuf[i].address = data_p;
+	double startScatter = MPI_Wtime();
+	for (int round=0; round < rounds; round++) {
+		MPI_Request request;
+		nodeTopology->scatter(stagingBuffers[round % 2], plan->getBlockCounts(round), stagedDispls[round % 2].data(), TransferPlan::getBlockType(), MPI_IN_PLACE, &request);
+		if (round + 1 < rounds) {
+			stageRound(plan, round + 1, blocks, stagingBuffers[(round + 1) % 2], stagedDispls[(round + 1) % 2].data());
+		}
+		size_t firstBlock = round * plan->getChunkBlocks();
+		size_t lastBlock = firstBlock + plan->getBlockCounts(round)[rank];
+		for (size_t i=firstBlock; i < lastBlock; i++) {
+			size_t dataBlock = distribution.getBlockOfSlot(firstSlot + i);
+			size_t block = mappedBlocks > 0 ? sentBlocks[dataBlock] : dataBlock;
+			void *data_p;
+			if (localFile != nullptr) {
+				//The tail of the last block is past the end of the memfd
+				data_p = localFile + block*FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+				memcpy(data_p, blocks[dataBlock], min((size_t) FILE_SYSTEM_SINGLE_BLOCK_SIZE, fileSize - block*FILE_SYSTEM_SINGLE_BLOCK_SIZE));
+			}
+			else {
+				data_p = malloc(FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+				memcpy(data_p, blocks[dataBlock], FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+			}
+			localGathBuf[i].address = data_p;
+		}
+		MPI_Wait(&request, MPI_STATUS_IGNORE);
 	}
+	double endScatter = MPI_Wtime();
+	free(stagingBuffers[0]);
+	free(stagingBuffers[1]);
 
 	double startGather= MPI_Wtime();
-	MPI_Gatherv(localGathBuf, gatherCounts[rank], MPI_BYTE, addresses, gatherCounts, gatherDispls, MPI_BYTE, 0, MPI_COMM_WORLD);
+	plan->gatherPointers(localGathBuf, addresses);
 	double endGather= MPI_Wtime();
 
 	//Time caluculation
 	DAGonFSWriteSGElapsedTime = (endScatter - startScatter) + (endGather - startGather);
 
-	//Saving pointers for later reading
-	Blocks *blocks = Blocks::getInstance();
-	if (!blocks->blockListExistForInode(inode)) {
-		blocks->createEmptyBlockListForInode(inode);
-	}
-	vector<DataBlock *> &inodeBlockList = blocks->getDataBlockListOfInode(inode);
-	int additionBlocks = numberOfBlocks - inodeBlockList.size();
-	LOG4CPLUS_INFO(MasterProcessLogger, MasterProcessLogger.getName() << "Current block list size: " << inodeBlockList.size() );
-	LOG4CPLUS_INFO(MasterProcessLogger, MasterProcessLogger.getName() << "Number of blocks: " << numberOfBlocks);
-	LOG4CPLUS_INFO(MasterProcessLogger, MasterProcessLogger.getName() << "Additional block: " << additionBlocks);
-	if (additionBlocks > 0) {
-		dataBlockManager->addDataBlocksTo(inodeBlockList, additionBlocks, inode);
-		LOG4CPLUS_INFO(MasterProcessLogger, MasterProcessLogger.getName() << "New block list size: " << inodeBlockList.size());
+	if (!distribution.isContiguous()) {
+		PointerPacket *fileOrderAddresses = new PointerPacket[distribution.getNumberOfBlocks()];
+		distribution.unpack(fileOrderAddresses, addresses, sizeof(PointerPacket));
+		delete[] addresses;
+		addresses = fileOrderAddresses;
 	}
 
-	for (int i=0; i < numberOfBlocks; i++) {
-		DataBlock *dataBlock = inodeBlockList[i];
-		dataBlock->setData(addresses[i].address);
+	//Saving pointers for later reading, the holes have no address and keep the process of the layout
+	if (mappedBlocks > 0) {
+		PointerPacket *fileAddresses = new PointerPacket[numberOfBlocks]();
+		for (size_t i=0; i < sentBlocks.size(); i++) {
+			fileAddresses[sentBlocks[i]] = addresses[i];
+		}
+		size_t sharedBlock = 0;
+		for (size_t i=0; i < numberOfBlocks; i++) {
+			if (blockMap[i] == BLOCK_SHARED) {
+				fileAddresses[i].address = sharedBlocks[sharedBlock++].address;
+			}
+			else if (blockMap[i] == BLOCK_INDEXED) {
+				dedupIndex->add(fileDistribution.getRankOfBlock(i), fingerprints[i], fileAddresses[i].address);
+			}
+		}
+		delete[] addresses;
+		addresses = fileAddresses;
+		delete plan;
+	}
+	dataBlockManager->setBlocksOfInode(inode, addresses, numberOfBlocks, fileDistribution);
+	if (queueReleases) {
+		blockReleaseQueue->flush();
 	}
+	//The blocks of the previous version lose their references only now, so the ones it shares with the new version stay indexed
+	dedupIndex->setReferences(inode, references);
 
 	double endWrite = MPI_Wtime();
 	lastWriteTime = endWrite - startWrite;
 
-	delete[] localScatBuf;
 	delete[] localGathBuf;
 	delete[] addresses;
 
 	LOG4CPLUS_TRACE(MasterProcessLogger, MasterProcessLogger.getName() << "DAGonFS_Write() completed!");
 }
 
-void *MasterProcessCode::DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset) {
+/**
+ * The master receives its own blocks in place, so it takes no space in the staging buffer.
+ */
+void MasterProcessCode::stageRound(TransferPlan *plan, int round, void *const *blocks, char *staging, int *displs) {
+	BlockDistribution &distribution = plan->getDistribution();
+	const int *counts = plan->getBlockCounts(round);
+	const int *slots = plan->getBlockDispls(round);
+	size_t staged = 0;
+	for (int i : distribution.getTouchedRanks()) {
+		if (i == rank) {
+			continue;
+		}
+		displs[i] = staged;
+		for (int j=0; j < counts[i]; j++) {
+			memcpy(staging + (staged + j)*FILE_SYSTEM_SINGLE_BLOCK_SIZE, blocks[distribution.getBlockOfSlot(slots[i] + j)], FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+		}
+		staged += counts[i];
+	}
+}
+
+void *MasterProcessCode::DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset, const DataLayout &layout) {
 	LOG4CPLUS_TRACE(MasterProcessLogger, MasterProcessLogger.getName() << "Invoked DAGonFS_Read()");
 	LOG4CPLUS_TRACE(MasterProcessLogger, MasterProcessLogger.getName() << "\tRead request size="<<reqSize<<", file size="<<fileSize<<", starting offset="<<offset);
 
-	IORequestPacket ioRequest;
-	ioRequest.inode = inode;
-	ioRequest.fileSize = fileSize;
-	ioRequest.reqSize = reqSize;
-	ioRequest.offset = offset;
-	MPI_Bcast(&ioRequest, sizeof(ioRequest), MPI_BYTE, 0, MPI_COMM_WORLD);
-
-	double startRead = MPI_Wtime();
-
+	//The storage processes have nothing to send for an empty file
 	if (fileSize == 0)
 		return nullptr;
 
+	double startRead = MPI_Wtime();
+
 	size_t numberOfBlocksForRequest;
 	if (reqSize > fileSize)
 		numberOfBlocksForRequest = fileSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (fileSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
@@ -166,58 +318,201 @@ void *MasterProcessCode::DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t
 		abort();
 	}
 
-	unsigned int blockPerProcess = numberOfBlocksForRequest / mpi_world_size;
-	unsigned int remainingBlocks = numberOfBlocksForRequest % mpi_world_size;
-	unsigned int effectiveBlocks = numberOfBlocksForRequest / mpi_world_size + (rank < remainingBlocks);
-	PointerPacket *addressesToScat = new PointerPacket[numberOfBlocksForRequest];
+	//A file stored entirely by the master is copied from its memfd, the storage processes have nothing to send. Nothing is
+	//copied past the end of the memfd, the rest of the file is a hole
+	size_t localBytes = 0;
+	const char *localFile = localFilePool->getData(inode, localBytes);
+	if (localFile != nullptr) {
+		size_t readBytes = numberOfBlocksForRequest * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+		localBytes = min(localBytes, min(fileSize, readBytes));
+		memcpy(readBuff, localFile, localBytes);
+		memset((char *) readBuff + localBytes, 0, readBytes - localBytes);
+		double endRead = MPI_Wtime();
+		lastReadTime = endRead - startRead;
+		return readBuff;
+	}
+
+	if (readFromPools(inode, numberOfBlocksForRequest, readBuff)) {
+		double endRead = MPI_Wtime();
+		lastReadTime = endRead - startRead;
+		return readBuff;
+	}
+
+	//The holes are zeros, only the blocks with data are read
 	Blocks *blocks = Blocks::getInstance();
 	vector<DataBlock *> &dataBlockList = blocks->getDataBlockListOfInode(inode);
-	for (int i=0; i< numberOfBlocksForRequest; i++) {
-		addressesToScat[i].address = dataBlockList[i]->getData();
+	vector<char> blockMap(numberOfBlocksForRequest, BLOCK_DATA);
+	vector<size_t> blocksWithData;
+	for (size_t i=0; i < numberOfBlocksForRequest; i++) {
+		if (isHoleOf(dataBlockList, i)) {
+			blockMap[i] = BLOCK_HOLE;
+		}
+		else {
+			blocksWithData.push_back(i);
+		}
 	}
-	int *scatterCounts = new int[mpi_world_size];
-	int *scatterDispls = new int[mpi_world_size];
-	int scatterOffset = 0;
-	for (int i=0; i < mpi_world_size; i++) {
-		scatterCounts[i] = ( blockPerProcess + (i < remainingBlocks) )* sizeof(PointerPacket);
-		scatterDispls[i] = scatterOffset;
-		scatterOffset += scatterCounts[i];
+	size_t numberOfHoles = numberOfBlocksForRequest - blocksWithData.size();
+	if (blocksWithData.empty()) {
+		memset(readBuff, 0, numberOfBlocksForRequest * FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+		double endRead = MPI_Wtime();
+		lastReadTime = endRead - startRead;
+		return readBuff;
 	}
 
-	int *gatherCounts = new int[mpi_world_size];
-	int *gatherDispls = new int[mpi_world_size];
-	int gatherOffset = 0;
-	for (int i=0; i < mpi_world_size; i++) {
-		gatherCounts[i] = ( blockPerProcess + (i < remainingBlocks) )* FILE_SYSTEM_SINGLE_BLOCK_SIZE;
-		gatherDispls[i] = gatherOffset;
-		gatherOffset += gatherCounts[i];
+	//Some blocks are outside the pools: the storage processes take part in the read
+	sendReadRequest();
+	IORequestPacket ioRequest;
+	ioRequest.inode = inode;
+	ioRequest.fileSize = fileSize;
+	ioRequest.reqSize = reqSize;
+	ioRequest.offset = offset;
+	ioRequest.layout = layout;
+	//The shared blocks are read as any other block, and the index changes only with the writes
+	ioRequest.mappedBlocks = numberOfHoles;
+	ioRequest.sharedBlocks = 0;
+	ioRequest.droppedBlocks = 0;
+	MPI_Bcast(&ioRequest, sizeof(ioRequest), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
+
+	TransferPlan *plan;
+	if (numberOfHoles > 0) {
+		MPI_Bcast(blockMap.data(), numberOfBlocksForRequest, MPI_BYTE, 0, DAGONFS_COMM_WORLD);
+		plan = dataBlockManager->getSparseTransferPlan(layout, blockMap, nodeTopology->getChunkBlocks());
+	}
+	else {
+		plan = dataBlockManager->getTransferPlan(layout, numberOfBlocksForRequest, nodeTopology->getChunkBlocks());
+	}
+	BlockDistribution &distribution = plan->getDistribution();
+	size_t numberOfBlocksWithData = blocksWithData.size();
+	PointerPacket *addressesToScat = new PointerPacket[numberOfBlocksWithData];
+	for (size_t i=0; i < numberOfBlocksWithData; i++) {
+		addressesToScat[i].address = dataBlockList[blocksWithData[i]]->getData();
+	}
+	if (!distribution.isContiguous()) {
+		PointerPacket *transferOrderAddresses = new PointerPacket[numberOfBlocksWithData];
+		distribution.pack(transferOrderAddresses, addressesToScat, sizeof(PointerPacket));
+		delete[] addressesToScat;
+		addressesToScat = transferOrderAddresses;
 	}
 
-	double startScatter = MPI_Wtime();
-	MPI_Scatterv(addressesToScat, scatterCounts, scatterDispls, MPI_BYTE, MPI_IN_PLACE, scatterDispls[rank], MPI_BYTE, 0, MPI_COMM_WORLD);
-	double endScatter = MPI_Wtime();
-	void *localGathBuf = malloc(effectiveBlocks*FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-	for (int i=0;i < effectiveBlocks; i++) {
-		memcpy(localGathBuf+i*FILE_SYSTEM_SINGLE_BLOCK_SIZE,addressesToScat[i].address, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+	//Non contiguous blocks and the blocks of a file with holes are gathered apart, and copied in file order later
+	void *recvBuff = readBuff;
+	if (!distribution.isContiguous() || numberOfHoles > 0) {
+		recvBuff = malloc(numberOfBlocksWithData * FILE_SYSTEM_SINGLE_BLOCK_SIZE);
 	}
 
+	double startScatter = MPI_Wtime();
+	plan->scatterPointers(addressesToScat, nullptr);
+	double endScatter = MPI_Wtime();
+	//The pointers of the master remain in its portion of the send buffer
+	PointerPacket *localAddresses = addressesToScat + plan->getBlockDispls()[rank];
+	//The blocks of the master are copied in place, the ones of a round while the previous round is gathered
+	char *localData = (char *) recvBuff + (size_t) plan->getBlockDispls()[rank] * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
 	double startGather = MPI_Wtime();
-	MPI_Gatherv(localGathBuf, gatherCounts[rank], MPI_BYTE, readBuff,gatherCounts, gatherDispls, MPI_BYTE, 0, MPI_COMM_WORLD);
+	for (int round=0; round <= plan->getNumberOfRounds(); round++) {
+		MPI_Request request = MPI_REQUEST_NULL;
+		if (round > 0) {
+			plan->gatherBlocks(round - 1, MPI_IN_PLACE, recvBuff, &request);
+		}
+		if (round < plan->getNumberOfRounds()) {
+			size_t firstBlock = round * plan->getChunkBlocks();
+			size_t lastBlock = firstBlock + plan->getBlockCounts(round)[rank];
+			for (size_t i=firstBlock; i < lastBlock; i++) {
+				memcpy(localData + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE, localAddresses[i].address, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+			}
+		}
+		MPI_Wait(&request, MPI_STATUS_IGNORE);
+	}
 	double endGather = MPI_Wtime();
 	DAGonFSReadSGElapsedTime = (endGather - startGather) + (endScatter - startScatter);
 
+	if (numberOfHoles > 0) {
+		char *dataBuff = (char *) recvBuff;
+		if (!distribution.isContiguous()) {
+			dataBuff = (char *) malloc(numberOfBlocksWithData * FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+			distribution.unpack(dataBuff, recvBuff, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+			free(recvBuff);
+		}
+		size_t nextData = 0;
+		for (size_t i=0; i < numberOfBlocksForRequest; i++) {
+			char *dst = (char *) readBuff + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+			if (blockMap[i] == BLOCK_HOLE) {
+				memset(dst, 0, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+			}
+			else {
+				memcpy(dst, dataBuff + nextData++ * FILE_SYSTEM_SINGLE_BLOCK_SIZE, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+			}
+		}
+		free(dataBuff);
+		delete plan;
+	}
+	else if (!distribution.isContiguous()) {
+		distribution.unpack(readBuff, recvBuff, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+		free(recvBuff);
+	}
+
 	double endRead = MPI_Wtime();
 	lastReadTime = endRead - startRead;
 
-	delete[] scatterCounts;
-	delete[] scatterDispls;
-	delete[] gatherCounts;
-	delete[] gatherDispls;
-	delete[] localGathBuf;
+	delete[] addressesToScat;
 
 	return readBuff;
 }
 
+/**
+ * The blocks of the processes of this node are copied through the shared memory. The adjacent blocks of a process
+ * of another node which are adjacent in its pool too are read with a single get.
+ */
+bool MasterProcessCode::readFromPools(fuse_ino_t inode, size_t nblocks, void *readBuff) {
+	if (!blockPool->hasRemotePools())
+		return false;
+
+	Blocks *blocks = Blocks::getInstance();
+	vector<DataBlock *> &dataBlockList = blocks->getDataBlockListOfInode(inode);
+	vector<MPI_Aint> displacements(nblocks);
+	vector<void *> sharedAddresses(nblocks, nullptr);
+	for (size_t i=0; i < nblocks; i++) {
+		if (isHoleOf(dataBlockList, i) || (int) dataBlockList[i]->getRank() == rank)
+			continue;
+		DataBlock *dataBlock = dataBlockList[i];
+		if (!blockPool->locate(dataBlock->getRank(), dataBlock->getData(), displacements[i]))
+			return false;
+		sharedAddresses[i] = blockPool->getSharedAddress(dataBlock->getRank(), dataBlock->getData());
+	}
+
+	double startGet = MPI_Wtime();
+	blockPool->synchronize();
+	vector<MPI_Request> requests;
+	const int maxBlocksPerGet = INT_MAX / FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+	size_t i = 0;
+	while (i < nblocks) {
+		char *dst = (char *) readBuff + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+		if (isHoleOf(dataBlockList, i)) {
+			memset(dst, 0, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+			i++;
+			continue;
+		}
+		DataBlock *dataBlock = dataBlockList[i];
+		int owner = dataBlock->getRank();
+		if (owner == rank || sharedAddresses[i] != nullptr) {
+			memcpy(dst, owner == rank ? dataBlock->getData() : sharedAddresses[i], FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+			i++;
+			continue;
+		}
+
+		int run = 1;
+		while (i + run < nblocks && run < maxBlocksPerGet && !isHoleOf(dataBlockList, i + run) && (int) dataBlockList[i + run]->getRank() == owner && displacements[i + run] == displacements[i] + run) {
+			run++;
+		}
+		requests.push_back(MPI_REQUEST_NULL);
+		blockPool->getBlocks(dst, owner, displacements[i], run, &requests.back());
+		i += run;
+	}
+	MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+	DAGonFSReadSGElapsedTime = MPI_Wtime() - startGet;
+
+	return true;
+}
+
 MasterProcessCode::~MasterProcessCode() {
 
 }
@@ -225,25 +520,26 @@ MasterProcessCode::~MasterProcessCode() {
 void MasterProcessCode::sendWriteRequest() {
 	RequestPacket request;
 	request.type = WRITE;
-	MPI_Bcast(&request, sizeof(RequestPacket), MPI_BYTE, 0, MPI_COMM_WORLD);
+	MPI_Bcast(&request, sizeof(RequestPacket), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
 }
 
 void MasterProcessCode::sendReadRequest() {
 	RequestPacket request;
 	request.type = READ;
-	MPI_Bcast(&request, sizeof(RequestPacket), MPI_BYTE, 0, MPI_COMM_WORLD);
+	MPI_Bcast(&request, sizeof(RequestPacket), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
 }
 
 void MasterProcessCode::sendTermination() {
 	RequestPacket request;
 	request.type = TERMINATE;
-	MPI_Bcast(&request, sizeof(RequestPacket), MPI_BYTE, 0, MPI_COMM_WORLD);
+	MPI_Bcast(&request, sizeof(RequestPacket), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
+	blockPool->close();
 }
 
 void MasterProcessCode::sendChangedir() {
 	RequestPacket request;
 	request.type = CHANGE_DIR;
-	MPI_Bcast(&request, sizeof(RequestPacket), MPI_BYTE, 0, MPI_COMM_WORLD);
+	MPI_Bcast(&request, sizeof(RequestPacket), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
 }
 
 void MasterProcessCode::createFileDump() {
@@ -6,6 +6,11 @@
 #define MASTERPROCESSCODE_HPP
 
 #include "DataBlockManager.hpp"
+#include "BlockPool.hpp"
+#include "LocalFilePool.hpp"
+#include "DedupIndex.hpp"
+#include "NodeTopology.hpp"
+#include "BlockReleaseQueue.hpp"
 #include "DistributedRead.hpp"
 #include "DistributedWrite.hpp"
 
@@ -20,16 +25,35 @@ private:
 	int rank;
 	int mpi_world_size;
 
-	int *scatterCounts;
-	int *scatterDispls;
-	int scatterOffset;
-	int *gatherCounts;
-	int *gatherDispls;
-	int gatherOffset;
-
 	DataBlockManager *dataBlockManager;
+	BlockPool *blockPool;
+	LocalFilePool *localFilePool;
+	DedupIndex *dedupIndex;
+	NodeTopology *nodeTopology;
+	BlockReleaseQueue *blockReleaseQueue;
 	log4cplus::Logger MasterProcessLogger;
 
+	/**
+	 * @brief Read the blocks of a file with one-sided gets, without involving the storage processes.
+	 *
+	 * @param inode The inode of the file.
+	 * @param nblocks The number of blocks to read.
+	 * @param readBuff The destination buffer, in file order.
+	 * @return FALSE if some blocks aren't in the pools of their processes, nothing is read in this case.
+	 */
+	bool readFromPools(fuse_ino_t inode, size_t nblocks, void *readBuff);
+
+	/**
+	 * @brief Copy the blocks sent to the storage processes in a round of a write, in transfer order.
+	 *
+	 * @param plan The plan of the write.
+	 * @param round The round.
+	 * @param blocks The address of each block of the file, in file order.
+	 * @param staging The destination buffer.
+	 * @param displs Set to the displacement of the blocks of each storage process in staging.
+	 */
+	void stageRound(TransferPlan *plan, int round, void *const *blocks, char *staging, int *displs);
+
 public:
 	double DAGonFSWriteSGElapsedTime;
 	double DAGonFSReadSGElapsedTime;;
@@ -38,8 +62,8 @@ public:
 	static MasterProcessCode* getInstance(int rank, int mpi_world_size);
 
 	~MasterProcessCode() override;
-	void DAGonFS_Write(void* buffer, fuse_ino_t inode, size_t fileSize) override;
-	void* DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset) override;
+	void DAGonFS_Write(void *const *blocks, fuse_ino_t inode, size_t fileSize, const DataLayout &layout) override;
+	void* DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset, const DataLayout &layout) override;
 
 	void sendWriteRequest();
 	void sendReadRequest();
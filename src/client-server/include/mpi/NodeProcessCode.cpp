@@ -8,10 +8,12 @@
 #include <unistd.h>
 #include <dirent.h>
 #include <cstring>
+#include <algorithm>
 
 #include <mpi.h>
 #include "mpi_data.hpp"
 #include "../blocks/Blocks.hpp"
+#include "../blocks/BlockCompressor.hpp"
 
 using namespace std;
 
@@ -32,6 +34,10 @@ NodeProcessCode::NodeProcessCode(int rank, int mpi_world_size) {
 	this->mpi_world_size = mpi_world_size;
 	dataBlockPointers = map<fuse_ino_t, vector<DataBlock *> >();
 	dataBlockManager = DataBlockManager::getInstance(mpi_world_size);
+	blockPool = BlockPool::getInstance(rank, mpi_world_size);
+	blockCompressor = BlockCompressor::getInstance();
+	nodeTopology = NodeTopology::getInstance(rank, mpi_world_size);
+	dataBlockManager->setMetadataOnlyMaster(nodeTopology->isMetadataOnlyMaster());
 	LogLevel ll = DAGONFS_LOG_LEVEL;
 	NodeProcessLogger = Logger::getInstance("NodeProcess.logger ");
 	NodeProcessLogger.setLogLevel(ll);
@@ -48,21 +54,24 @@ void NodeProcessCode::start() {
 		LOG4CPLUS_TRACE(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - Waiting for a request..." );
 		RequestPacket request;
 		IORequestPacket ioRequest;
-		MPI_Bcast(&request, sizeof(request), MPI_BYTE, 0, MPI_COMM_WORLD);
+		MPI_Bcast(&request, sizeof(request), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
 		switch (request.type) {
 			case WRITE:
 				LOG4CPLUS_TRACE(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - Recived WRITE request");
-				MPI_Bcast(&ioRequest, sizeof(ioRequest), MPI_BYTE, 0, MPI_COMM_WORLD);
-				DAGonFS_Write(nullptr,ioRequest.inode,ioRequest.fileSize);
+				MPI_Bcast(&ioRequest, sizeof(ioRequest), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
+				receiveBlockMap(ioRequest);
+				DAGonFS_Write(nullptr,ioRequest.inode,ioRequest.fileSize, ioRequest.layout);
 				break;
 			case READ:
 				LOG4CPLUS_TRACE(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - Recived READ request");
-				MPI_Bcast(&ioRequest, sizeof(ioRequest), MPI_BYTE, 0, MPI_COMM_WORLD);
-				DAGonFS_Read(ioRequest.inode,ioRequest.fileSize, ioRequest.reqSize, ioRequest.offset);
+				MPI_Bcast(&ioRequest, sizeof(ioRequest), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
+				receiveBlockMap(ioRequest);
+				DAGonFS_Read(ioRequest.inode,ioRequest.fileSize, ioRequest.reqSize, ioRequest.offset, ioRequest.layout);
 				break;
 			case TERMINATE:
 				LOG4CPLUS_TRACE(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - Recived TERMINATION request");
 				running = false;
+				blockPool->close();
 				break;
 			default:
 				break;
@@ -72,74 +81,131 @@ void NodeProcessCode::start() {
 	//createFileDump();
 }
 
-void NodeProcessCode::DAGonFS_Write(void* buffer, fuse_ino_t inode, size_t fileSize) {
+void NodeProcessCode::DAGonFS_Write([[maybe_unused]] void *const *blocks, fuse_ino_t inode, size_t fileSize, const DataLayout &layout) {
 	LOG4CPLUS_TRACE(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - Invoked DAGonFS_Write()");
+	lock_guard<mutex> lock(blocksMutex);
 
-	unsigned int numberOfBlocks = fileSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (fileSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
-	unsigned int blockPerProcess = numberOfBlocks / mpi_world_size;
-	unsigned int remainingBlocks = numberOfBlocks % mpi_world_size;
-	unsigned int effectiveBlocks = blockPerProcess + (rank < remainingBlocks);
-
-	//Data for Scatter
-	int *scatterCounts = new int[mpi_world_size];
-	int *scatterDispls = new int[mpi_world_size];
-	int scatterOffset = 0;
-	for (int i=0; i<mpi_world_size; i++) {
-		//Calculating elements
-		scatterCounts[i] = ( blockPerProcess + (i < remainingBlocks) ) * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
-
-		//Calculating displacements
-		scatterDispls[i] = scatterOffset;
-		scatterOffset += scatterCounts[i];
-	}
+	size_t numberOfBlocks = fileSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (fileSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
+	TransferPlan *plan = getTransferPlan(layout, numberOfBlocks);
+	size_t effectiveBlocks = plan->getDistribution().getBlocksOfRank(rank);
+	int rounds = plan->getNumberOfRounds();
+	size_t chunkBlocks = plan->getChunkBlocks();
 
 	//Data for gather
 	PointerPacket *addresses = new PointerPacket[effectiveBlocks];
-	int *gatherCounts = new int[mpi_world_size];
-	int *gatherDispls = new int[mpi_world_size];
-	int gatherOffset = 0;
-	for (int i=0; i< mpi_world_size; i++) {
-		//Calculating elements
-		gatherCounts[i] = ( blockPerProcess + (i < remainingBlocks) ) * sizeof(PointerPacket);
 
-		//Calculating displacements
-		gatherDispls[i] = gatherOffset;
-		gatherOffset += gatherCounts[i];
+	//The blocks dropped from the index are freed, and the shared blocks get the reference of the file before the previous
+	//version is released, as they may be its own blocks
+	for (BlockLocationPacket &droppedBlock : droppedBlocks) {
+		if (droppedBlock.rank == rank) {
+			releaseBlock(droppedBlock.address);
+		}
+	}
+	for (BlockLocationPacket &sharedBlock : sharedBlocks) {
+		if (sharedBlock.rank == rank) {
+			blockReferences[sharedBlock.address]++;
+		}
 	}
-
 	//In this code the rank is always 0 due to the fact that this code it's executed only by the master
-	void *localScatBuf = malloc(scatterCounts[rank]);
-	MPI_Scatterv(MPI_IN_PLACE, scatterCounts, scatterDispls, MPI_BYTE, localScatBuf, scatterCounts[rank], MPI_BYTE, 0, MPI_COMM_WORLD);
-	for (int i=0; i< effectiveBlocks; i++) {
-		void *data_p = malloc(FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-		memcpy(data_p,localScatBuf+i*FILE_SYSTEM_SINGLE_BLOCK_SIZE,FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-		addresses[i].address = data_p;
+	//The master writes the whole file, the blocks of the previous version are no longer referenced. With other front ends
+	//the master releases them when no front end is reading them (see BlockReleaseQueue)
+	if (nodeTopology->hasRemoteFrontEnds()) {
+		forgetBlocksOfInode(inode);
 	}
-	MPI_Gatherv(addresses, gatherCounts[rank], MPI_BYTE, MPI_IN_PLACE, gatherCounts, gatherDispls, MPI_BYTE, 0, MPI_COMM_WORLD);
+	else {
+		releaseBlocksOfInode(inode);
+	}
+	//If there are enough adjacent free blocks in the pool the data is received directly in place
+	char *poolRun = blockPool->allocateRun(effectiveBlocks);
+	//Otherwise the chunks arrive alternately in two buffers, and a chunk is copied in the blocks while the next one arrives
+	char *chunkBuffers[2] = {nullptr, nullptr};
+	if (poolRun == nullptr) {
+		size_t chunkBytes = min(chunkBlocks, effectiveBlocks) * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+		chunkBuffers[0] = (char *) malloc(chunkBytes);
+		chunkBuffers[1] = rounds > 1 ? (char *) malloc(chunkBytes) : nullptr;
+	}
+	vector<char *> roundBuffers(rounds);
+	for (int round=0; round < rounds; round++) {
+		roundBuffers[round] = poolRun != nullptr ? poolRun + round * chunkBlocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE : chunkBuffers[round % 2];
+	}
+
+	MPI_Request request;
+	nodeTopology->scatter(nullptr, plan->getBlockCounts(0), plan->getBlockDispls(0), TransferPlan::getBlockType(), roundBuffers[0], &request);
+	for (int round=0; round < rounds; round++) {
+		MPI_Wait(&request, MPI_STATUS_IGNORE);
+		if (round + 1 < rounds) {
+			nodeTopology->scatter(nullptr, plan->getBlockCounts(round + 1), plan->getBlockDispls(round + 1), TransferPlan::getBlockType(), roundBuffers[round + 1], &request);
+		}
+
+		char *localScatBuf = roundBuffers[round];
+		size_t firstBlock = round * chunkBlocks;
+		for (size_t i=0; i < (size_t) plan->getBlockCounts(round)[rank]; i++) {
+			if (poolRun != nullptr) {
+				addresses[firstBlock + i].address = localScatBuf + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+				continue;
+			}
+			void *data_p = blockPool->allocateBlock();
+			memcpy(data_p,localScatBuf+i*FILE_SYSTEM_SINGLE_BLOCK_SIZE,FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+			addresses[firstBlock + i].address = data_p;
+		}
+	}
+	free(chunkBuffers[0]);
+	free(chunkBuffers[1]);
+	sealBlocks(inode, addresses, effectiveBlocks, layout.compression);
+	for (size_t i=0; i < effectiveBlocks; i++) {
+		liveBlocks.insert(addresses[i].address);
+	}
+	//The blocks indexed by the master are kept until it drops them from the index
+	if (!blockMap.empty()) {
+		vector<size_t> sentBlocks;
+		for (size_t i=0; i < blockMap.size(); i++) {
+			if (blockMap[i] == BLOCK_DATA || blockMap[i] == BLOCK_INDEXED) {
+				sentBlocks.push_back(i);
+			}
+		}
+		BlockDistribution &distribution = plan->getDistribution();
+		size_t firstSlot = plan->getBlockDispls()[rank];
+		for (size_t i=0; i < effectiveBlocks; i++) {
+			if (blockMap[sentBlocks[distribution.getBlockOfSlot(firstSlot + i)]] == BLOCK_INDEXED) {
+				blockReferences[addresses[i].address] = 2;
+			}
+		}
+	}
+	//The gather tells the master where the blocks are, so they must be visible to its reads first
+	blockPool->publish();
+	plan->gatherPointers(addresses, nullptr);
 
 	if (dataBlockPointers.find(inode) == dataBlockPointers.end()) {
 		createEmptyBlockListForInode(inode);
 	}
 	vector<DataBlock *> *inodeBlockList = &dataBlockPointers[inode];
-	for (int i=0;i<effectiveBlocks;i++) {
+	for (size_t i=0;i<effectiveBlocks;i++) {
 		DataBlock *newDataBlock = new DataBlock(inode);
 		newDataBlock->setData(addresses[i].address);
 		newDataBlock->setRank(rank);
 		inodeBlockList->push_back(newDataBlock);
 	}
+	for (BlockLocationPacket &sharedBlock : sharedBlocks) {
+		if (sharedBlock.rank == rank) {
+			DataBlock *newDataBlock = new DataBlock(inode);
+			newDataBlock->setData(sharedBlock.address);
+			newDataBlock->setRank(rank);
+			inodeBlockList->push_back(newDataBlock);
+		}
+	}
 
-	delete[] scatterCounts;
-	delete[] scatterDispls;
-	delete[] gatherCounts;
-	delete[] gatherDispls;
 	delete[] addresses;
+	if (!blockMap.empty()) {
+		delete plan;
+	}
 
 }
 
-void* NodeProcessCode::DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset) {
+void* NodeProcessCode::DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, [[maybe_unused]] off_t offset, const DataLayout &layout) {
 	LOG4CPLUS_TRACE(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - Invoked DAGonFS_Read()");
 	if (fileSize == 0)
 		return nullptr;
+	lock_guard<mutex> lock(blocksMutex);
 
 	size_t numberOfBlocksForRequest;
 	if (reqSize > fileSize)
@@ -147,49 +213,299 @@ void* NodeProcessCode::DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t re
 	else
 		numberOfBlocksForRequest = reqSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (reqSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
 
-	unsigned int blockPerProcess = numberOfBlocksForRequest / mpi_world_size;
-	unsigned int remainingBlocks = numberOfBlocksForRequest % mpi_world_size;
-	unsigned int effectiveBlocks = numberOfBlocksForRequest / mpi_world_size + (rank < remainingBlocks);
+	TransferPlan *plan = getTransferPlan(layout, numberOfBlocksForRequest);
+	size_t effectiveBlocks = plan->getDistribution().getBlocksOfRank(rank);
+	int rounds = plan->getNumberOfRounds();
+	size_t chunkBlocks = plan->getChunkBlocks();
 
 	PointerPacket *addressesFromScat = new PointerPacket[effectiveBlocks];
-	int *scatterCounts = new int[mpi_world_size];
-	int *scatterDispls = new int[mpi_world_size];
-	int scatterOffset = 0;
-	for (int i=0; i< mpi_world_size; i++) {
-		scatterCounts[i] = ( blockPerProcess + (i < remainingBlocks) ) * sizeof(PointerPacket);
-		scatterDispls[i] = scatterOffset;
-		scatterOffset += scatterCounts[i];
+	plan->scatterPointers(nullptr, addressesFromScat);
+
+	//A chunk is copied in a buffer while the previous one is gathered from the other buffer
+	size_t chunkBytes = min(chunkBlocks, effectiveBlocks) * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+	char *chunkBuffers[2] = {(char *) malloc(chunkBytes), rounds > 1 ? (char *) malloc(chunkBytes) : nullptr};
+	MPI_Request requests[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+	for (int round=0; round < rounds; round++) {
+		char *dataToGath = chunkBuffers[round % 2];
+		//The buffer is free when the gather of two rounds ago is completed
+		MPI_Wait(&requests[round % 2], MPI_STATUS_IGNORE);
+		size_t firstBlock = round * chunkBlocks;
+		for (size_t i=0; i < (size_t) plan->getBlockCounts(round)[rank]; i++) {
+			if (!blockCompressor->load(addressesFromScat[firstBlock + i].address, dataToGath + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE)) {
+				LOG4CPLUS_ERROR(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - A compressed block of inode " << inode << " is corrupted");
+			}
+		}
+		plan->gatherBlocks(round, dataToGath, nullptr, &requests[round % 2]);
+	}
+	MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+
+	delete[] addressesFromScat;
+	free(chunkBuffers[0]);
+	free(chunkBuffers[1]);
+	if (!blockMap.empty()) {
+		delete plan;
 	}
 
-	void *dataToGath = malloc(effectiveBlocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-	int *gatherCounts = new int[mpi_world_size];
-	int *gatherDispls = new int[mpi_world_size];
-	int gatherOffset = 0;
-	for (int i=0; i< mpi_world_size; i++) {
-		gatherCounts[i] = ( blockPerProcess + (i < remainingBlocks) ) * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
-		gatherDispls[i] = gatherOffset;
-		gatherOffset += gatherCounts[i];
+	return nullptr;
+}
+
+void NodeProcessCode::receiveBlockMap(const IORequestPacket &ioRequest) {
+	blockMap.clear();
+	sharedBlocks.resize(ioRequest.sharedBlocks);
+	droppedBlocks.resize(ioRequest.droppedBlocks);
+	if (ioRequest.mappedBlocks > 0) {
+		size_t nblocks = ioRequest.fileSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (ioRequest.fileSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
+		if (ioRequest.reqSize < ioRequest.fileSize)
+			nblocks = ioRequest.reqSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (ioRequest.reqSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
+		blockMap.resize(nblocks);
+		MPI_Bcast(blockMap.data(), nblocks, MPI_BYTE, 0, DAGONFS_COMM_WORLD);
 	}
+	if (!sharedBlocks.empty()) {
+		MPI_Bcast(sharedBlocks.data(), sharedBlocks.size() * sizeof(BlockLocationPacket), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
+	}
+	if (!droppedBlocks.empty()) {
+		MPI_Bcast(droppedBlocks.data(), droppedBlocks.size() * sizeof(BlockLocationPacket), MPI_BYTE, 0, DAGONFS_COMM_WORLD);
+	}
+}
 
-	MPI_Scatterv(MPI_IN_PLACE, scatterCounts, scatterDispls, MPI_BYTE, addressesFromScat, scatterCounts[rank], MPI_BYTE, 0, MPI_COMM_WORLD);
-	for (int i=0; i< effectiveBlocks; i++) {
-		memcpy(dataToGath + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE, addressesFromScat[i].address, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+/**
+ * Only the blocks with data not stored yet are transferred, the holes are recorded by the master alone.
+ */
+TransferPlan *NodeProcessCode::getTransferPlan(const DataLayout &layout, size_t nblocks) {
+	if (blockMap.empty())
+		return dataBlockManager->getTransferPlan(layout, nblocks, nodeTopology->getChunkBlocks());
+
+	return dataBlockManager->getSparseTransferPlan(layout, blockMap, nodeTopology->getChunkBlocks());
+}
+
+void NodeProcessCode::serveFrontEnds() {
+	MPI_Comm frontEndComm = nodeTopology->getFrontEndComm();
+	MPI_Datatype blockType;
+	MPI_Type_contiguous(FILE_SYSTEM_SINGLE_BLOCK_SIZE, MPI_BYTE, &blockType);
+	MPI_Type_commit(&blockType);
+
+	bool serving = true;
+	while (serving) {
+		BlockRequestPacket request;
+		MPI_Status status;
+		MPI_Recv(&request, sizeof(request), MPI_BYTE, MPI_ANY_SOURCE, BLOCK_REQUEST_TAG, frontEndComm, &status);
+		switch (request.type) {
+			case WRITE_BLOCKS:
+				LOG4CPLUS_TRACE(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - Received " << request.nblocks << " blocks of inode " << request.inode << " from " << status.MPI_SOURCE);
+				writeBlocksFor(status.MPI_SOURCE, request, blockType);
+				break;
+			case READ_BLOCKS:
+				LOG4CPLUS_TRACE(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - Sending " << request.nblocks << " blocks of inode " << request.inode << " to " << status.MPI_SOURCE);
+				readBlocksFor(status.MPI_SOURCE, request, blockType);
+				break;
+			case RELEASE_BLOCKS:
+				LOG4CPLUS_TRACE(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - Releasing " << request.nblocks << " blocks replaced by the writes");
+				releaseBlocksFor(status.MPI_SOURCE, request);
+				break;
+			case STOP_SERVING:
+				serving = false;
+				break;
+			default:
+				break;
+		}
 	}
-	MPI_Gatherv(dataToGath, gatherCounts[rank], MPI_BYTE, MPI_IN_PLACE, gatherCounts, gatherDispls, MPI_BYTE, 0, MPI_COMM_WORLD);
 
-	delete[] scatterCounts;
-	delete[] scatterDispls;
-	delete[] gatherCounts;
-	delete[] gatherDispls;
-	free(dataToGath);
+	MPI_Type_free(&blockType);
+}
+
+void NodeProcessCode::stopServing() {
+	BlockRequestPacket request;
+	request.type = STOP_SERVING;
+	request.nblocks = 0;
+	MPI_Send(&request, sizeof(request), MPI_BYTE, rank, BLOCK_REQUEST_TAG, nodeTopology->getFrontEndComm());
+}
 
-	return nullptr;
+/**
+ * The front end writes the whole file, and it sends a request to every storage process. The blocks of the previous
+ * version are only forgotten here, the master releases them when the new version is committed, as until then its reads
+ * and the ones of the other front ends may use them. The data is received without holding the lock, so the transfers
+ * of the master proceed.
+ */
+void NodeProcessCode::writeBlocksFor(int frontEnd, BlockRequestPacket &request, MPI_Datatype blockType) {
+	MPI_Comm frontEndComm = nodeTopology->getFrontEndComm();
+	size_t nblocks = request.nblocks;
+	char *poolRun;
+	{
+		lock_guard<mutex> lock(blocksMutex);
+		forgetBlocksOfInode(request.inode);
+		poolRun = blockPool->allocateRun(nblocks);
+	}
+
+	char *data = poolRun != nullptr ? poolRun : (char *) malloc(nblocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+	if (nblocks > 0) {
+		MPI_Recv(data, nblocks, blockType, frontEnd, BLOCK_DATA_TAG, frontEndComm, MPI_STATUS_IGNORE);
+	}
+
+	PointerPacket *addresses = new PointerPacket[nblocks];
+	{
+		lock_guard<mutex> lock(blocksMutex);
+		if (dataBlockPointers.find(request.inode) == dataBlockPointers.end()) {
+			createEmptyBlockListForInode(request.inode);
+		}
+		vector<DataBlock *> &inodeBlockList = dataBlockPointers[request.inode];
+		for (size_t i=0; i < nblocks; i++) {
+			if (poolRun != nullptr) {
+				addresses[i].address = poolRun + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+			}
+			else {
+				addresses[i].address = blockPool->allocateBlock();
+				memcpy(addresses[i].address, data + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+			}
+		}
+		sealBlocks(request.inode, addresses, nblocks, request.compression);
+		for (size_t i=0; i < nblocks; i++) {
+			liveBlocks.insert(addresses[i].address);
+			DataBlock *newDataBlock = new DataBlock(request.inode);
+			newDataBlock->setData(addresses[i].address);
+			newDataBlock->setRank(rank);
+			inodeBlockList.push_back(newDataBlock);
+		}
+		//The front end tells the master where the blocks are, so they must be visible to its reads first
+		blockPool->publish();
+	}
+	if (poolRun == nullptr) {
+		free(data);
+	}
+
+	MPI_Send(addresses, nblocks * sizeof(PointerPacket), MPI_BYTE, frontEnd, BLOCK_REPLY_TAG, frontEndComm);
+	delete[] addresses;
+}
+
+/**
+ * The blocks are sent from where they are with a datatype made of their addresses. The master doesn't release them
+ * while the front end is reading them (see BlockReleaseQueue), still the addresses are checked against the blocks
+ * stored here, and the lock is held until they're sent. When some blocks are compressed, all of them are copied in a
+ * buffer, decompressing them, and sent from there.
+ */
+void NodeProcessCode::readBlocksFor(int frontEnd, BlockRequestPacket &request, MPI_Datatype blockType) {
+	MPI_Comm frontEndComm = nodeTopology->getFrontEndComm();
+	size_t nblocks = request.nblocks;
+	PointerPacket *addresses = new PointerPacket[nblocks];
+	MPI_Recv(addresses, nblocks * sizeof(PointerPacket), MPI_BYTE, frontEnd, BLOCK_DATA_TAG, frontEndComm, MPI_STATUS_IGNORE);
+
+	lock_guard<mutex> lock(blocksMutex);
+	bool compressed = false;
+	for (size_t i=0; i < nblocks; i++) {
+		if (liveBlocks.find(addresses[i].address) == liveBlocks.end()) {
+			LOG4CPLUS_ERROR(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - A block of inode " << request.inode << " read by " << frontEnd << " isn't stored anymore");
+			MPI_Send(nullptr, 0, blockType, frontEnd, BLOCK_REPLY_TAG, frontEndComm);
+			delete[] addresses;
+			return;
+		}
+		compressed = compressed || blockCompressor->isCompressed(addresses[i].address);
+	}
+
+	if (compressed) {
+		char *data = (char *) malloc(nblocks * FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+		for (size_t i=0; i < nblocks; i++) {
+			if (!blockCompressor->load(addresses[i].address, data + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE)) {
+				LOG4CPLUS_ERROR(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - A compressed block of inode " << request.inode << " is corrupted");
+			}
+		}
+		MPI_Send(data, nblocks, blockType, frontEnd, BLOCK_REPLY_TAG, frontEndComm);
+		free(data);
+		delete[] addresses;
+		return;
+	}
+
+	vector<MPI_Aint> displacements(nblocks);
+	for (size_t i=0; i < nblocks; i++) {
+		MPI_Get_address(addresses[i].address, &displacements[i]);
+	}
+	MPI_Datatype blocksType;
+	MPI_Type_create_hindexed_block(nblocks, 1, displacements.data(), blockType, &blocksType);
+	MPI_Type_commit(&blocksType);
+	MPI_Send(MPI_BOTTOM, 1, blocksType, frontEnd, BLOCK_REPLY_TAG, frontEndComm);
+	MPI_Type_free(&blocksType);
+	delete[] addresses;
+}
+
+void NodeProcessCode::releaseBlocksFor(int master, BlockRequestPacket &request) {
+	vector<PointerPacket> addresses(request.nblocks);
+	MPI_Recv(addresses.data(), request.nblocks * sizeof(PointerPacket), MPI_BYTE, master, BLOCK_DATA_TAG, nodeTopology->getFrontEndComm(), MPI_STATUS_IGNORE);
+
+	lock_guard<mutex> lock(blocksMutex);
+	for (PointerPacket &address : addresses) {
+		releaseBlock(address.address);
+	}
+}
+
+/**
+ * The raw blocks replaced by their compressed copies go back to the pool, so the compression frees space in it.
+ */
+void NodeProcessCode::sealBlocks(fuse_ino_t inode, PointerPacket *addresses, size_t nblocks, int compression) {
+	if (compression == DAGONFS_COMPRESSION_NONE || nblocks == 0)
+		return;
+
+	vector<void *> blocks(nblocks);
+	for (size_t i=0; i < nblocks; i++) {
+		blocks[i] = addresses[i].address;
+	}
+	vector<void *> replaced;
+	size_t savedBytes = blockCompressor->seal(blocks, compression, replaced);
+	for (void *block : replaced) {
+		blockPool->releaseBlock(block);
+	}
+	for (size_t i=0; i < nblocks; i++) {
+		addresses[i].address = blocks[i];
+	}
+
+	LOG4CPLUS_DEBUG(NodeProcessLogger, NodeProcessLogger.getName() << "Process " << rank << " - Compressed " << replaced.size() << " of " << nblocks << " blocks of inode " << inode << ", " << savedBytes << " bytes saved");
 }
 
 void NodeProcessCode::createEmptyBlockListForInode(fuse_ino_t inode) {
 	dataBlockPointers[inode] = vector<DataBlock *>();
 }
 
+void NodeProcessCode::releaseBlocksOfInode(fuse_ino_t inode) {
+	auto blockList = dataBlockPointers.find(inode);
+	if (blockList == dataBlockPointers.end()) {
+		return;
+	}
+
+	//Released from the last one, so the next file gets them back in increasing order
+	for (auto dataBlock_it = blockList->second.rbegin(); dataBlock_it != blockList->second.rend(); dataBlock_it++) {
+		DataBlock *dataBlock = *dataBlock_it;
+		releaseBlock(dataBlock->getData());
+		//The data is released by the pool or by the compressor, not by the block
+		dataBlock->setData(nullptr);
+		delete dataBlock;
+	}
+	blockList->second.clear();
+}
+
+void NodeProcessCode::forgetBlocksOfInode(fuse_ino_t inode) {
+	auto blockList = dataBlockPointers.find(inode);
+	if (blockList == dataBlockPointers.end()) {
+		return;
+	}
+
+	for (DataBlock *dataBlock : blockList->second) {
+		dataBlock->setData(nullptr);
+		delete dataBlock;
+	}
+	blockList->second.clear();
+}
+
+void NodeProcessCode::releaseBlock(void *block) {
+	auto reference_it = blockReferences.find(block);
+	if (reference_it != blockReferences.end()) {
+		if (--reference_it->second > 0)
+			return;
+		blockReferences.erase(reference_it);
+	}
+
+	liveBlocks.erase(block);
+	if (!blockCompressor->release(block)) {
+		blockPool->releaseBlock(block);
+	}
+}
+
 vector<DataBlock*>& NodeProcessCode::getDataBlockPointers(fuse_ino_t inode) {
 	return dataBlockPointers[inode];
 }
@@ -5,10 +5,16 @@
 #ifndef NODEPROCESSCODE_HPP
 #define NODEPROCESSCODE_HPP
 #include <map>
+#include <mutex>
+#include <unordered_set>
 
 #include "DataBlockManager.hpp"
+#include "BlockPool.hpp"
+#include "../blocks/BlockCompressor.hpp"
+#include "NodeTopology.hpp"
 #include "DistributedWrite.hpp"
 #include "DistributedRead.hpp"
+#include "mpi_data.hpp"
 #include "../utils/log_level.hpp"
 
 class NodeProcessCode: public DistributedWrite, public DistributedRead {
@@ -21,21 +27,96 @@ private:
 	int mpi_world_size;
 
 	map<fuse_ino_t, vector<DataBlock *> > dataBlockPointers;
+	//Held by the transfers of the master and by the requests of the front ends, they share the blocks and the pool
+	mutex blocksMutex;
+	//The kind of each block of the transfer of the master in progress, empty if all of them are plain data
+	vector<char> blockMap;
+	//The shared blocks and the blocks dropped from the dedup index of the write of the master in progress
+	vector<BlockLocationPacket> sharedBlocks;
+	vector<BlockLocationPacket> droppedBlocks;
+	//The references to the blocks indexed by the master, one for each file using them and one for the index
+	map<void *, unsigned int> blockReferences;
+	//The blocks stored by this process and not released yet, the reads of the front ends are checked against them
+	unordered_set<void *> liveBlocks;
 
 	DataBlockManager *dataBlockManager;
+	BlockPool *blockPool;
+	BlockCompressor *blockCompressor;
+	NodeTopology *nodeTopology;
 	log4cplus::Logger NodeProcessLogger;
 
+	/**
+	 * @brief Store the blocks of a file sent by a front end, replacing the ones of the previous version.
+	 *
+	 * @param frontEnd The rank of the front end, it receives the address of each block.
+	 * @param request The request of the front end.
+	 * @param blockType The datatype of a data block.
+	 */
+	void writeBlocksFor(int frontEnd, BlockRequestPacket &request, MPI_Datatype blockType);
+
+	/**
+	 * @brief Send some blocks to a front end, it sends the address of each block first.
+	 *
+	 * An empty message is sent if a block isn't stored anymore.
+	 */
+	void readBlocksFor(int frontEnd, BlockRequestPacket &request, MPI_Datatype blockType);
+
+	/**
+	 * @brief Release the blocks replaced by the writes, sent by the master when no front end is reading them.
+	 */
+	void releaseBlocksFor(int master, BlockRequestPacket &request);
+
+	/**
+	 * @brief Drop the blocks of a file without releasing them, the master releases them later.
+	 */
+	void forgetBlocksOfInode(fuse_ino_t inode);
+
+	/**
+	 * @brief Compress the blocks just received, if the file has a compression policy.
+	 *
+	 * @param inode The inode of the file.
+	 * @param addresses The address of each block, replaced by the address of its compressed copy.
+	 * @param nblocks The number of blocks.
+	 * @param compression The compression of the layout of the file.
+	 */
+	void sealBlocks(fuse_ino_t inode, PointerPacket *addresses, size_t nblocks, int compression);
+
+	/**
+	 * @brief Receive the map of the blocks of a transfer of the master, and the shared and the dropped blocks of a write.
+	 */
+	void receiveBlockMap(const IORequestPacket &ioRequest);
+
+	/**
+	 * @brief Release a block of a file, it's freed only when it has no references left.
+	 */
+	void releaseBlock(void *block);
+
+	/**
+	 * @brief Get the plan of the transfer of the master in progress, it's deleted by the caller if the transfer has a map.
+	 */
+	TransferPlan *getTransferPlan(const DataLayout &layout, size_t nblocks);
+
 public:
 	static NodeProcessCode *getInstance(int rank, int mpi_world_size);
 
 	~NodeProcessCode() override;
-	void DAGonFS_Write(void* buffer, fuse_ino_t inode, size_t fileSize) override;
-	void* DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset) override;
+	void DAGonFS_Write(void *const *blocks, fuse_ino_t inode, size_t fileSize, const DataLayout &layout) override;
+	void* DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset, const DataLayout &layout) override;
 
 	void createEmptyBlockListForInode(fuse_ino_t inode);
+	void releaseBlocksOfInode(fuse_ino_t inode);
 	vector<DataBlock *> &getDataBlockPointers(fuse_ino_t inode);
 
 	void start();
+
+	/**
+	 * @brief Serve the block requests of the front ends until stopServing() is invoked.
+	 *
+	 * It runs in its own thread, next to start(): the front ends send the blocks of their writes and
+	 * get the blocks of their reads with point to point messages, without involving the master.
+	 */
+	void serveFrontEnds();
+	void stopServing();
 	void createFileDump();
 };
 
@@ -0,0 +1,208 @@
+//
+// Created on 10/19/26.
+//
+
+#include "NodeTopology.hpp"
+
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+using namespace log4cplus;
+
+NodeTopology *NodeTopology::instance = nullptr;
+
+NodeTopology *NodeTopology::getInstance(int rank, int mpi_world_size) {
+	if (instance == nullptr) {
+		instance = new NodeTopology(rank, mpi_world_size);
+	}
+
+	return instance;
+}
+
+NodeTopology::NodeTopology(int rank, int mpi_world_size) {
+	this->rank = rank;
+	this->mpi_world_size = mpi_world_size;
+
+	NodeTopologyLogger = Logger::getInstance("NodeTopology.logger Process " + to_string(rank) + " - ");
+	LogLevel ll = DAGONFS_LOG_LEVEL;
+	NodeTopologyLogger.setLogLevel(ll);
+
+	//The master chooses for everyone: ranks per node (0 for the shared memory domains), distribution (-1 for automatic),
+	//chunk size, whether it stores blocks and number of front ends
+	long long settings[5] = {0, -1, DEFAULT_TRANSFER_CHUNK_BYTES, 0, 1};
+	if (rank == 0) {
+		const char *env = getenv(DAGONFS_ENV_RANKS_PER_NODE);
+		if (env != nullptr) {
+			settings[0] = atoi(env);
+		}
+		env = getenv(DAGONFS_ENV_DISTRIBUTION);
+		if (env != nullptr && string(env) == "flat") {
+			settings[1] = 0;
+		}
+		else if (env != nullptr && string(env) == "hierarchical") {
+			settings[1] = 1;
+		}
+		env = getenv(DAGONFS_ENV_TRANSFER_CHUNK_BYTES);
+		if (env != nullptr) {
+			settings[2] = atoll(env);
+		}
+		env = getenv(DAGONFS_ENV_METADATA_ONLY_MASTER);
+		if (env != nullptr) {
+			settings[3] = atoi(env) != 0;
+		}
+		env = getenv(DAGONFS_ENV_FRONT_ENDS);
+		if (env != nullptr) {
+			settings[4] = max(atoi(env), 1);
+		}
+	}
+	MPI_Bcast(settings, 5, MPI_LONG_LONG, 0, DAGONFS_COMM_WORLD);
+	chunkBlocks = settings[2] > FILE_SYSTEM_SINGLE_BLOCK_SIZE ? settings[2] / FILE_SYSTEM_SINGLE_BLOCK_SIZE : 1;
+
+	//The key is the world rank: the master has rank 0 on its node, and the leader of a node is its lowest rank
+	if (settings[0] > 0) {
+		MPI_Comm_split(DAGONFS_COMM_WORLD, rank / settings[0], rank, &nodeComm);
+	}
+	else {
+		MPI_Comm_split_type(DAGONFS_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm);
+	}
+	MPI_Comm_rank(nodeComm, &nodeRank);
+	MPI_Comm_size(nodeComm, &nodeSize);
+	nodeRanks = vector<int>(nodeSize);
+	MPI_Allgather(&rank, 1, MPI_INT, nodeRanks.data(), 1, MPI_INT, nodeComm);
+	MPI_Comm_dup(DAGONFS_COMM_WORLD, &leaderComm);
+
+	int isLeader = nodeRank == 0;
+	int largestNode;
+	MPI_Allreduce(&isLeader, &numberOfNodes, 1, MPI_INT, MPI_SUM, DAGONFS_COMM_WORLD);
+	MPI_Allreduce(&nodeSize, &largestNode, 1, MPI_INT, MPI_MAX, DAGONFS_COMM_WORLD);
+
+	vector<int> leaderOf(rank == 0 ? mpi_world_size : 0);
+	MPI_Gather(&nodeRanks[0], 1, MPI_INT, leaderOf.data(), 1, MPI_INT, 0, DAGONFS_COMM_WORLD);
+	if (rank == 0) {
+		for (int i=0; i < mpi_world_size; i++) {
+			if (leaderOf[i] == 0) {
+				continue;
+			}
+			if (leaderOf[i] == i) {
+				leaders.push_back(i);
+				leaderMembers.push_back(vector<int>());
+			}
+			//The ranks are visited in increasing order, the same order of the ranks on their node
+			for (size_t j=0; j < leaders.size(); j++) {
+				if (leaders[j] == leaderOf[i]) {
+					leaderMembers[j].push_back(i);
+					break;
+				}
+			}
+		}
+	}
+
+	//The front ends are on different nodes, so their mounts don't collide
+	frontEnds.push_back(0);
+	if (rank == 0) {
+		for (size_t i=0; i < leaders.size() && (long long) frontEnds.size() < settings[4]; i++) {
+			frontEnds.push_back(leaders[i]);
+		}
+		if ((long long) frontEnds.size() < settings[4]) {
+			LOG4CPLUS_WARN(NodeTopologyLogger, NodeTopologyLogger.getName() << settings[4] << " front ends requested, but there are only " << numberOfNodes << " nodes");
+		}
+	}
+	int numberOfFrontEnds = frontEnds.size();
+	MPI_Bcast(&numberOfFrontEnds, 1, MPI_INT, 0, DAGONFS_COMM_WORLD);
+	frontEnds.resize(numberOfFrontEnds);
+	MPI_Bcast(frontEnds.data(), numberOfFrontEnds, MPI_INT, 0, DAGONFS_COMM_WORLD);
+	//The clients take part in the creation of this communicator only, then they call the master and the storage processes
+	int fullWorldSize;
+	MPI_Comm_dup(MPI_COMM_WORLD, &frontEndComm);
+	MPI_Comm_size(frontEndComm, &fullWorldSize);
+	numberOfClients = fullWorldSize - mpi_world_size;
+	//The data written through the other front ends goes straight to the storage processes
+	metadataOnlyMaster = settings[3] != 0 || numberOfFrontEnds > 1 || numberOfClients > 0;
+	int storage[2] = {mpi_world_size, metadataOnlyMaster ? 1 : 0};
+	MPI_Bcast(storage, 2, MPI_INT, 0, frontEndComm);
+
+	hierarchical = settings[1] == -1 ? numberOfNodes > 1 && largestNode > 1 : settings[1] == 1;
+	LOG4CPLUS_INFO(NodeTopologyLogger, NodeTopologyLogger.getName() << numberOfNodes << " nodes, " << nodeSize << " processes on this node, "
+	                << (hierarchical ? "hierarchical" : "flat") << " distribution, chunks of " << chunkBlocks << " blocks, " << frontEnds.size() << " front ends, " << numberOfClients << " clients");
+}
+
+bool NodeTopology::isFrontEnd(int rank) {
+	return find(frontEnds.begin(), frontEnds.end(), rank) != frontEnds.end();
+}
+
+void NodeTopology::scatter(void *sendBuf, const int *counts, const int *displs, MPI_Datatype type, void *recvBuf, MPI_Request *request) {
+	if (!hierarchical) {
+		MPI_Iscatterv(sendBuf, counts, displs, type, recvBuf, counts[rank], type, 0, DAGONFS_COMM_WORLD, request);
+		return;
+	}
+
+	//The scatter on a node starts only when its leader has received the data, so this one is blocking
+	if (rank == 0) {
+		scatterFromMaster(sendBuf, counts, displs, type, recvBuf);
+	}
+	else {
+		scatterFromLeader(counts, type, recvBuf);
+	}
+	*request = MPI_REQUEST_NULL;
+}
+
+/**
+ * The data of the processes of a node is described by an indexed datatype, so it's sent to the leader without packing it.
+ * The sends to the leaders proceed while the master scatters the data of its own node.
+ */
+void NodeTopology::scatterFromMaster(void *sendBuf, const int *counts, const int *displs, MPI_Datatype type, void *recvBuf) {
+	MPI_Aint lowerBound, extent;
+	MPI_Type_get_extent(type, &lowerBound, &extent);
+
+	vector<MPI_Request> requests(leaders.size());
+	for (size_t i=0; i < leaders.size(); i++) {
+		vector<int> lengths;
+		vector<MPI_Aint> offsets;
+		for (int member : leaderMembers[i]) {
+			lengths.push_back(counts[member]);
+			offsets.push_back(displs[member] * extent);
+		}
+
+		MPI_Datatype nodeType;
+		MPI_Type_create_hindexed(lengths.size(), lengths.data(), offsets.data(), type, &nodeType);
+		MPI_Type_commit(&nodeType);
+		MPI_Isend(sendBuf, 1, nodeType, leaders[i], 0, leaderComm, &requests[i]);
+		MPI_Type_free(&nodeType);
+	}
+
+	vector<int> nodeCounts(nodeSize);
+	vector<int> nodeDispls(nodeSize);
+	for (int i=0; i < nodeSize; i++) {
+		nodeCounts[i] = counts[nodeRanks[i]];
+		nodeDispls[i] = displs[nodeRanks[i]];
+	}
+	MPI_Scatterv(sendBuf, nodeCounts.data(), nodeDispls.data(), type, recvBuf, counts[rank], type, 0, nodeComm);
+
+	MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+}
+
+void NodeTopology::scatterFromLeader(const int *counts, MPI_Datatype type, void *recvBuf) {
+	MPI_Aint lowerBound, extent;
+	MPI_Type_get_extent(type, &lowerBound, &extent);
+
+	//The data of the node arrives in the order of the ranks on the node
+	vector<int> nodeCounts(nodeSize);
+	vector<int> nodeDispls(nodeSize);
+	int nodeElements = 0;
+	for (int i=0; i < nodeSize; i++) {
+		nodeCounts[i] = counts[nodeRanks[i]];
+		nodeDispls[i] = nodeElements;
+		nodeElements += nodeCounts[i];
+	}
+
+	void *nodeBuf = nullptr;
+	if (nodeRank == 0) {
+		nodeBuf = malloc((size_t) nodeElements * extent);
+		MPI_Recv(nodeBuf, nodeElements, type, 0, 0, leaderComm, MPI_STATUS_IGNORE);
+	}
+	MPI_Scatterv(nodeBuf, nodeCounts.data(), nodeDispls.data(), type, recvBuf, counts[rank], type, 0, nodeComm);
+	free(nodeBuf);
+}
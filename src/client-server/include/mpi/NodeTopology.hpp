@@ -0,0 +1,156 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef NODETOPOLOGY_HPP
+#define NODETOPOLOGY_HPP
+
+#include <mpi.h>
+#include <vector>
+#include <cstddef>
+
+#include "dagonfs_comm.hpp"
+#include "../blocks/data_blocks_info.hpp"
+#include "../utils/log_level.hpp"
+
+using namespace std;
+
+//Environment variables selecting how the master distributes the data (read by the master only)
+#define DAGONFS_ENV_DISTRIBUTION    "DAGONFS_DISTRIBUTION"
+#define DAGONFS_ENV_RANKS_PER_NODE  "DAGONFS_RANKS_PER_NODE"
+#define DAGONFS_ENV_TRANSFER_CHUNK_BYTES "DAGONFS_TRANSFER_CHUNK_BYTES"
+#define DAGONFS_ENV_METADATA_ONLY_MASTER "DAGONFS_METADATA_ONLY_MASTER"
+#define DAGONFS_ENV_FRONT_ENDS "DAGONFS_FRONT_ENDS"
+
+//Default size of the chunks transferred to each process at a time: 64MB
+#define DEFAULT_TRANSFER_CHUNK_BYTES 67108864
+
+/**
+ * @brief The grouping of the processes by node, used for distributing the data of a write.
+ *
+ * With the flat distribution (DAGONFS_DISTRIBUTION=flat) the master scatters the data to every process
+ * over DAGONFS_COMM_WORLD, sending one message per process. With the hierarchical distribution
+ * (DAGONFS_DISTRIBUTION=hierarchical) the master sends a single message to the leader of each node (its
+ * lowest rank), carrying the data of all the processes of the node, and every leader scatters it over
+ * the shared memory of its node. By default the distribution is hierarchical when there are several
+ * nodes and at least one of them runs more than a process.
+ *
+ * The nodes are the shared memory domains, DAGONFS_RANKS_PER_NODE=n groups instead the processes in
+ * nodes of n consecutive ranks, for emulating a cluster on a single host.
+ *
+ * The transfers are split in chunks of at most DAGONFS_TRANSFER_CHUNK_BYTES bytes for each process
+ * (rounded down to whole blocks). With the flat distribution a process copies a chunk while it receives
+ * the next one; the hierarchical distribution transfers a chunk at a time instead, since a leader can
+ * scatter the data of its node only after receiving it, so its transfers don't overlap the copies.
+ *
+ * With DAGONFS_METADATA_ONLY_MASTER=1 the master stores no blocks: it serves only the metadata, so
+ * the requests of the other users of the mount don't wait for its copies of the data.
+ *
+ * With DAGONFS_FRONT_ENDS=n the file system is mounted by the leaders of the first n nodes, the master
+ * included: the master keeps the metadata and stores no blocks, every other process stores blocks.
+ * The client processes started after DAGonFS in the same job are served in the same way.
+ */
+class NodeTopology {
+private:
+	//Singleton implementation
+	static NodeTopology* instance;
+	NodeTopology(int rank, int mpi_world_size);
+
+	int rank;
+	int mpi_world_size;
+	bool hierarchical;
+	size_t chunkBlocks;
+	bool metadataOnlyMaster;
+	//The processes mounting the file system, the master first
+	vector<int> frontEnds;
+	//Requests of the front ends and of the clients to the master and to the storage processes
+	MPI_Comm frontEndComm;
+	int numberOfClients;
+
+	//The processes of this node, the master has rank 0 on its node
+	MPI_Comm nodeComm;
+	int nodeRank;
+	int nodeSize;
+	//World rank of each process of this node
+	vector<int> nodeRanks;
+	//Transfers between the master and the leaders
+	MPI_Comm leaderComm;
+
+	//Master only: the leaders of the other nodes and the world ranks of their processes
+	vector<int> leaders;
+	vector<vector<int> > leaderMembers;
+	int numberOfNodes;
+
+	log4cplus::Logger NodeTopologyLogger;
+
+	void scatterFromMaster(void *sendBuf, const int *counts, const int *displs, MPI_Datatype type, void *recvBuf);
+	void scatterFromLeader(const int *counts, MPI_Datatype type, void *recvBuf);
+
+public:
+	/**
+	 * @brief Get the topology, the first call is collective over DAGONFS_COMM_WORLD.
+	 */
+	static NodeTopology* getInstance(int rank, int mpi_world_size);
+
+	bool isHierarchical() { return hierarchical; }
+
+	/**
+	 * @brief Select the distribution, it must be invoked by every process with the same value.
+	 */
+	void setHierarchical(bool hierarchical) { this->hierarchical = hierarchical; }
+
+	int getNumberOfNodes() { return numberOfNodes; }
+
+	/**
+	 * @brief Get the maximum number of blocks transferred to a process at a time, the same for every process.
+	 */
+	size_t getChunkBlocks() { return chunkBlocks; }
+
+	/**
+	 * @brief Check if the master must be excluded from the placement of the blocks.
+	 */
+	bool isMetadataOnlyMaster() { return metadataOnlyMaster; }
+
+	/**
+	 * @brief Get the ranks of the processes mounting the file system, the master first.
+	 */
+	const vector<int> &getFrontEnds() { return frontEnds; }
+	bool isFrontEnd(int rank);
+
+	/**
+	 * @brief Get the communicator of the point to point requests of the front ends, a duplicate of MPI_COMM_WORLD.
+	 *
+	 * The ranks of DAGonFS are the same of DAGONFS_COMM_WORLD, the clients follow them.
+	 */
+	MPI_Comm getFrontEndComm() { return frontEndComm; }
+
+	/**
+	 * @brief Get the number of processes of the job using DAGonFS through dagonfs::Client.
+	 */
+	int getNumberOfClients() { return numberOfClients; }
+
+	/**
+	 * @brief Check if the master and the storage processes serve requests of other processes.
+	 */
+	bool hasRemoteFrontEnds() { return frontEnds.size() > 1 || numberOfClients > 0; }
+
+	/**
+	 * @brief Start the scatter of the data of a write from the master, it's collective over DAGONFS_COMM_WORLD.
+	 *
+	 * The arguments are the same of an MPI_Iscatterv rooted at the master over DAGONFS_COMM_WORLD. The flat
+	 * distribution returns as soon as the transfer is started, the hierarchical one when it's completed, with
+	 * request set to MPI_REQUEST_NULL: only the flat distribution overlaps the transfer with the caller's work.
+	 *
+	 * @param sendBuf The data, significant only at the master.
+	 * @param counts The number of elements for each process.
+	 * @param displs The displacement of the data of each process in sendBuf, in elements, significant only at the master.
+	 * @param type The type of the elements.
+	 * @param recvBuf The buffer receiving counts[rank] elements, MPI_IN_PLACE at the master leaves its data in sendBuf.
+	 * @param request Set to the request completed when the data is in recvBuf.
+	 */
+	void scatter(void *sendBuf, const int *counts, const int *displs, MPI_Datatype type, void *recvBuf, MPI_Request *request);
+};
+
+
+
+#endif //NODETOPOLOGY_HPP
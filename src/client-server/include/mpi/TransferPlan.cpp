@@ -0,0 +1,131 @@
+//
+// Created on 10/19/26.
+//
+
+#include "TransferPlan.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+#include "../blocks/data_blocks_info.hpp"
+
+using namespace std;
+
+MPI_Datatype TransferPlan::blockType = MPI_DATATYPE_NULL;
+MPI_Datatype TransferPlan::pointerType = MPI_DATATYPE_NULL;
+
+TransferPlan::TransferPlan(const DataLayout &layout, size_t nblocks, int mpi_world_size, int firstStorageRank, size_t chunkBlocks)
+	: distribution(layout, nblocks, mpi_world_size, firstStorageRank) {
+	init(mpi_world_size, chunkBlocks);
+}
+
+TransferPlan::TransferPlan(const vector<int> &blockRanks, int mpi_world_size, size_t chunkBlocks)
+	: distribution(blockRanks, mpi_world_size) {
+	init(mpi_world_size, chunkBlocks);
+}
+
+void TransferPlan::init(int mpi_world_size, size_t chunkBlocks) {
+	MPI_Comm_rank(DAGONFS_COMM_WORLD, &rank);
+	this->mpi_world_size = mpi_world_size;
+	this->nblocks = distribution.getNumberOfBlocks();
+	this->chunkBlocks = chunkBlocks;
+
+	if (blockType == MPI_DATATYPE_NULL) {
+		MPI_Type_contiguous(FILE_SYSTEM_SINGLE_BLOCK_SIZE, MPI_BYTE, &blockType);
+		MPI_Type_commit(&blockType);
+		MPI_Type_contiguous(sizeof(PointerPacket), MPI_BYTE, &pointerType);
+		MPI_Type_commit(&pointerType);
+	}
+
+	blockCounts = vector<int>(mpi_world_size, 0);
+	blockDispls = vector<int>(mpi_world_size, 0);
+	distribution.fillCountsAndDispls(blockCounts.data(), blockDispls.data(), 1);
+
+	size_t largestShare = 0;
+	for (int i : distribution.getTouchedRanks()) {
+		largestShare = max(largestShare, distribution.getBlocksOfRank(i));
+	}
+	numberOfRounds = largestShare > chunkBlocks ? (largestShare + chunkBlocks - 1) / chunkBlocks : 1;
+	if (numberOfRounds > 1) {
+		roundCounts = vector<vector<int> >(numberOfRounds, vector<int>(mpi_world_size, 0));
+		roundDispls = vector<vector<int> >(numberOfRounds, vector<int>(mpi_world_size, 0));
+		for (int i : distribution.getTouchedRanks()) {
+			size_t blocks = distribution.getBlocksOfRank(i);
+			for (int round=0; round * chunkBlocks < blocks; round++) {
+				roundCounts[round][i] = min(chunkBlocks, blocks - round * chunkBlocks);
+				roundDispls[round][i] = blockDispls[i] + round * chunkBlocks;
+			}
+		}
+	}
+
+#if MPI_VERSION >= 4
+	pointers = vector<PointerPacket>(rank == 0 ? nblocks : distribution.getBlocksOfRank(rank));
+	pointerGather = MPI_REQUEST_NULL;
+	pointerScatter = MPI_REQUEST_NULL;
+#endif
+}
+
+TransferPlan::~TransferPlan() {
+#if MPI_VERSION >= 4
+	//The requests are inactive between two operations, so they can be freed locally
+	if (pointerGather != MPI_REQUEST_NULL) {
+		MPI_Request_free(&pointerGather);
+	}
+	if (pointerScatter != MPI_REQUEST_NULL) {
+		MPI_Request_free(&pointerScatter);
+	}
+#endif
+}
+
+void TransferPlan::gatherPointers(const PointerPacket *localPointers, PointerPacket *pointers) {
+#if MPI_VERSION >= 4
+	PointerPacket *boundPointers = this->pointers.data();
+	if (rank == 0) {
+		memcpy(boundPointers + blockDispls[rank], localPointers, blockCounts[rank] * sizeof(PointerPacket));
+	}
+	else {
+		memcpy(boundPointers, localPointers, blockCounts[rank] * sizeof(PointerPacket));
+	}
+	if (pointerGather == MPI_REQUEST_NULL) {
+		MPI_Gatherv_init(rank == 0 ? MPI_IN_PLACE : boundPointers, blockCounts[rank], pointerType, boundPointers, blockCounts.data(), blockDispls.data(), pointerType, 0,
+		                 DAGONFS_COMM_WORLD, MPI_INFO_NULL, &pointerGather);
+	}
+	MPI_Start(&pointerGather);
+	MPI_Wait(&pointerGather, MPI_STATUS_IGNORE);
+	if (rank == 0) {
+		memcpy(pointers, boundPointers, nblocks * sizeof(PointerPacket));
+	}
+#else
+	MPI_Gatherv(localPointers, blockCounts[rank], pointerType, pointers, blockCounts.data(), blockDispls.data(), pointerType, 0, DAGONFS_COMM_WORLD);
+#endif
+}
+
+void TransferPlan::scatterPointers(const PointerPacket *pointers, PointerPacket *localPointers) {
+#if MPI_VERSION >= 4
+	PointerPacket *boundPointers = this->pointers.data();
+	if (rank == 0) {
+		memcpy(boundPointers, pointers, nblocks * sizeof(PointerPacket));
+	}
+	if (pointerScatter == MPI_REQUEST_NULL) {
+		MPI_Scatterv_init(boundPointers, blockCounts.data(), blockDispls.data(), pointerType, rank == 0 ? MPI_IN_PLACE : boundPointers, blockCounts[rank], pointerType, 0,
+		                  DAGONFS_COMM_WORLD, MPI_INFO_NULL, &pointerScatter);
+	}
+	MPI_Start(&pointerScatter);
+	MPI_Wait(&pointerScatter, MPI_STATUS_IGNORE);
+	if (rank != 0) {
+		memcpy(localPointers, boundPointers, blockCounts[rank] * sizeof(PointerPacket));
+	}
+#else
+	if (rank == 0) {
+		MPI_Scatterv(pointers, blockCounts.data(), blockDispls.data(), pointerType, MPI_IN_PLACE, blockCounts[rank], pointerType, 0, DAGONFS_COMM_WORLD);
+	}
+	else {
+		MPI_Scatterv(nullptr, blockCounts.data(), blockDispls.data(), pointerType, localPointers, blockCounts[rank], pointerType, 0, DAGONFS_COMM_WORLD);
+	}
+#endif
+}
+
+void TransferPlan::gatherBlocks(int round, const void *localData, void *data, MPI_Request *request) {
+	const int *counts = getBlockCounts(round);
+	MPI_Igatherv(localData, counts[rank], blockType, data, counts, getBlockDispls(round), blockType, 0, DAGONFS_COMM_WORLD, request);
+}
@@ -0,0 +1,130 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef TRANSFERPLAN_HPP
+#define TRANSFERPLAN_HPP
+
+#include <mpi.h>
+#include <vector>
+#include <cstddef>
+
+#include "../blocks/DataLayout.hpp"
+#include "BlockDistribution.hpp"
+#include "mpi_data.hpp"
+#include "dagonfs_comm.hpp"
+
+using namespace std;
+
+/**
+ * @brief The precomputed arguments of the collective transfers of a file with a given size and layout.
+ *
+ * The counts and displacements of the data blocks and of their pointers are computed once, writing
+ * only the entries of the processes storing some blocks, and reused by every read and write of a file
+ * with the same number of blocks and the same layout. With MPI 4 the exchanges of the pointers use
+ * persistent collectives (MPI_Gatherv_init/MPI_Scatterv_init), created at the first use of the plan:
+ * every process uses the same plans in the same operations, so the creation is collective.
+ * The data of the blocks lives in the file buffers, which change at every operation, so it's always
+ * transferred with non persistent collectives.
+ *
+ * The counts and displacements are expressed in blocks (or pointers) with a derived datatype, so they
+ * don't overflow for files larger than 2GB. The data is transferred in rounds: in each round a process
+ * receives or sends at most a chunk of its blocks, so it can copy a chunk while the next one is in flight.
+ */
+class TransferPlan {
+private:
+	int rank;
+	int mpi_world_size;
+	size_t nblocks;
+	size_t chunkBlocks;
+	BlockDistribution distribution;
+
+	//Blocks of each process in the whole transfer, the same for the pointers
+	vector<int> blockCounts;
+	vector<int> blockDispls;
+	//Blocks of each process in each round, when there's more than a round
+	int numberOfRounds;
+	vector<vector<int> > roundCounts;
+	vector<vector<int> > roundDispls;
+
+	static MPI_Datatype blockType;
+	static MPI_Datatype pointerType;
+
+#if MPI_VERSION >= 4
+	//The buffer bound to the persistent requests: every pointer at the master, the local ones elsewhere
+	vector<PointerPacket> pointers;
+	MPI_Request pointerGather;
+	MPI_Request pointerScatter;
+#endif
+
+	void init(int mpi_world_size, size_t chunkBlocks);
+
+public:
+	TransferPlan(const DataLayout &layout, size_t nblocks, int mpi_world_size, int firstStorageRank, size_t chunkBlocks);
+
+	/**
+	 * @brief The plan of a transfer of blocks which are already placed, such as the blocks with data of a file with holes.
+	 *
+	 * @param blockRanks The rank of each block transferred.
+	 * @param mpi_world_size The number of processes.
+	 * @param chunkBlocks The maximum number of blocks transferred to a process in a round.
+	 */
+	TransferPlan(const vector<int> &blockRanks, int mpi_world_size, size_t chunkBlocks);
+	~TransferPlan();
+
+	/**
+	 * @brief Get the datatype of a data block, the unit of the counts and displacements of the data.
+	 */
+	static MPI_Datatype getBlockType() { return blockType; }
+
+	BlockDistribution &getDistribution() { return distribution; }
+	size_t getChunkBlocks() { return chunkBlocks; }
+	int getNumberOfRounds() { return numberOfRounds; }
+
+	/**
+	 * @brief Get the displacement of the first block of each process in the whole transfer, in blocks.
+	 */
+	const int *getBlockDispls() { return blockDispls.data(); }
+
+	/**
+	 * @brief Get the number of blocks transferred to or from each process in a round.
+	 */
+	const int *getBlockCounts(int round) { return numberOfRounds == 1 ? blockCounts.data() : roundCounts[round].data(); }
+
+	/**
+	 * @brief Get the displacement of the blocks of each process in a round, in blocks.
+	 */
+	const int *getBlockDispls(int round) { return numberOfRounds == 1 ? blockDispls.data() : roundDispls[round].data(); }
+
+	/**
+	 * @brief Gather the pointers of the blocks stored by each process at the master, in transfer order.
+	 *
+	 * @param localPointers The pointers of the blocks of this process.
+	 * @param pointers The pointers of every block, significant only at the master.
+	 */
+	void gatherPointers(const PointerPacket *localPointers, PointerPacket *pointers);
+
+	/**
+	 * @brief Scatter the pointers of the blocks from the master to the processes storing them.
+	 *
+	 * The pointers of the master remain in its portion of the pointers buffer.
+	 *
+	 * @param pointers The pointers of every block in transfer order, significant only at the master.
+	 * @param localPointers The buffer receiving the pointers of this process, ignored at the master.
+	 */
+	void scatterPointers(const PointerPacket *pointers, PointerPacket *localPointers);
+
+	/**
+	 * @brief Start the gather of the blocks of a round at the master, in transfer order.
+	 *
+	 * @param round The round.
+	 * @param localData The blocks of this process in the round, MPI_IN_PLACE at the master if they're already in data.
+	 * @param data The buffer receiving every block of the transfer, significant only at the master.
+	 * @param request Set to the request completed when the blocks are in data.
+	 */
+	void gatherBlocks(int round, const void *localData, void *data, MPI_Request *request);
+};
+
+
+
+#endif //TRANSFERPLAN_HPP
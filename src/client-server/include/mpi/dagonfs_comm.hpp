@@ -0,0 +1,13 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef DAGONFS_COMM_HPP
+#define DAGONFS_COMM_HPP
+
+#include <mpi.h>
+
+//The processes of DAGonFS: MPI_COMM_WORLD without the client processes started in the same job (see dagonfs::Client)
+extern MPI_Comm DAGONFS_COMM_WORLD;
+
+#endif //DAGONFS_COMM_HPP
@@ -5,8 +5,14 @@
 #ifndef MPI_DATA_HPP
 #define MPI_DATA_HPP
 
+#include "../utils/fuse_headers.hpp"
+#include "../blocks/DataLayout.hpp"
+
 typedef enum {WRITE, READ, CHANGE_DIR, REDUCE_BLOCKS, TERMINATE} RequestType;
 
+//The kind of each block of a transfer of the master, in the map which follows its request
+typedef enum {BLOCK_DATA, BLOCK_HOLE, BLOCK_INDEXED, BLOCK_SHARED} TransferBlockKind;
+
 typedef struct RequstPacket {
 	RequestType type;
 } RequestPacket;
@@ -16,10 +22,76 @@ typedef struct IORequestPacket {
 	size_t fileSize;
 	size_t reqSize;
 	off_t offset;
+	DataLayout layout;
+	//The blocks of the transfer which aren't plain data, when there are some a map with the kind of each block follows the packet
+	size_t mappedBlocks;
+	//The shared blocks of a write, their BlockLocationPacket in file order follow the map
+	size_t sharedBlocks;
+	//The blocks dropped from the dedup index, their BlockLocationPacket follow the shared blocks
+	size_t droppedBlocks;
 } IORequestPacket;
 
 typedef struct PointerPacket {
 	void *address;
 } PointerPacket;
 
+//Tags of the messages on the communicator of the front ends
+#define METADATA_REQUEST_TAG 1
+#define METADATA_REPLY_TAG 2
+#define BLOCK_REQUEST_TAG 3
+#define BLOCK_DATA_TAG 4
+#define BLOCK_REPLY_TAG 5
+
+//Requests of a front end to a storage process, followed by the data or by the pointers of the blocks. The master
+//sends RELEASE_BLOCKS with the blocks replaced by the writes, when no front end is reading (see BlockReleaseQueue)
+typedef enum {WRITE_BLOCKS, READ_BLOCKS, RELEASE_BLOCKS, STOP_SERVING} BlockRequestType;
+
+typedef struct BlockRequestPacket {
+	BlockRequestType type;
+	fuse_ino_t inode;
+	size_t nblocks;
+	//The compression of the layout of the file, for the blocks written
+	int compression;
+} BlockRequestPacket;
+
+//Requests of a front end to the master, followed by the names, the value of an extended attribute or the pointers of the blocks.
+//UNPIN_BLOCKS ends the read of the blocks got with OPEN_BLOCKS
+typedef enum {LOOKUP, FORGET, GETATTR, SETATTR, READLINK, MKNOD, MKDIR, UNLINK, RMDIR, SYMLINK, RENAME, LINK, OPENDIR, READDIR, RELEASEDIR,
+              FSYNCDIR, STATFS, SETXATTR, GETXATTR, LISTXATTR, REMOVEXATTR, ACCESS, CREATE, OPEN_BLOCKS, COMMIT_BLOCKS, DETACH,
+              UNPIN_BLOCKS} MetadataOperation;
+
+typedef struct MetadataRequestPacket {
+	MetadataOperation operation;
+	//The inode, or the parent of the name
+	fuse_ino_t ino;
+	fuse_ino_t newparent;
+	struct stat attr;
+	int toSet;
+	mode_t mode;
+	dev_t rdev;
+	int flags;
+	size_t size;
+	off_t offset;
+	uint64_t nlookup;
+	struct fuse_ctx context;
+	DataLayout layout;
+} MetadataRequestPacket;
+
+//The reply of a FUSE handler of the master, followed by the data of the buffer or by the locations of the blocks
+typedef enum {REPLY_ERR, REPLY_NONE, REPLY_ENTRY, REPLY_ATTR, REPLY_BUF, REPLY_OPEN, REPLY_CREATE, REPLY_READLINK, REPLY_STATFS, REPLY_XATTR, REPLY_WRITE} ReplyType;
+
+typedef struct MetadataReplyPacket {
+	ReplyType type;
+	int error;
+	struct fuse_entry_param entry;
+	struct statvfs statfs;
+	size_t count;
+	DataLayout layout;
+} MetadataReplyPacket;
+
+typedef struct BlockLocationPacket {
+	void *address;
+	int rank;
+} BlockLocationPacket;
+
 #endif //MPI_DATA_HPP
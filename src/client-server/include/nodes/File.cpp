@@ -13,10 +13,7 @@
 using namespace std;
 
 File::File() {
-    m_buf = nullptr;
-    isWaitingForDistributedWrite = false;
 }
 
 File::~File() {
-    if (m_buf) free(m_buf);
 }
@@ -7,18 +7,11 @@
 
 #include "inodes_data_structures.hpp"
 
+//The data of an open file is shared by its handles (see OpenFiles)
 class File final: public INode {
-public:
-    void * m_buf;
-    bool isWaitingForDistributedWrite;
-
 public:
     File();
     ~File();
-    void *getData(){return m_buf;};
-    bool isWaitingForWriting() { return isWaitingForDistributedWrite; };
-    void setWaiting(){isWaitingForDistributedWrite = true;};
-    void removeWaiting(){isWaitingForDistributedWrite = false;};
 };
 
 
@@ -13,6 +13,8 @@
 using namespace std;
 
 Nodes *Nodes::_instance = nullptr;
+double Nodes::AttrTimeout = 1.0;
+double Nodes::EntryTimeout = 1.0;
 
 Nodes::Nodes() {
     INodes = vector<INode *>();
@@ -70,8 +72,8 @@ void Nodes::InitializeINode(INode *inode, fuse_ino_t ino, mode_t mode, nlink_t n
     inode->inodeNumber = ino;
 
     inode->m_fuseEntryParam.ino = ino;
-    inode->m_fuseEntryParam.attr_timeout = 1.0;
-    inode->m_fuseEntryParam.entry_timeout = 1.0;
+    inode->m_fuseEntryParam.attr_timeout = Nodes::AttrTimeout;
+    inode->m_fuseEntryParam.entry_timeout = Nodes::EntryTimeout;
     inode->m_fuseEntryParam.attr.st_mode = mode;
     inode->m_fuseEntryParam.attr.st_gid = gid;
     inode->m_fuseEntryParam.attr.st_uid = uid;
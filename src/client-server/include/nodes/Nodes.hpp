@@ -50,6 +50,12 @@ public:
      */
     static const size_t INodeBufBlockSize = FILE_SYSTEM_SINGLE_BLOCK_SIZE;
 
+    /**
+     * @brief The seconds the kernel keeps the attributes and the directory entries of the inodes (-o attr_timeout, -o entry_timeout).
+     */
+    static double AttrTimeout;
+    static double EntryTimeout;
+
     //Singleton
     /**
      * @brief The method which give the instance of the singleton.
@@ -0,0 +1,93 @@
+//
+// Created on 10/19/26.
+//
+
+#include "FileBuffer.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "../blocks/data_blocks_info.hpp"
+#include "../blocks/zero_blocks.hpp"
+
+using namespace std;
+
+void FileBuffer::adopt(void *buf, size_t nblocks) {
+	if (buf == nullptr) {
+		return;
+	}
+
+	allocations.push_back(buf);
+	for (size_t i=0; i < nblocks; i++) {
+		blocks.push_back((char *) buf + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+	}
+}
+
+void FileBuffer::reserve(size_t nblocks) {
+	if (blocks.size() < nblocks) {
+		blocks.resize(nblocks, nullptr);
+	}
+}
+
+bool FileBuffer::write(const char *buf, size_t size, off_t off) {
+	while (size > 0) {
+		size_t block = off / FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+		size_t blockOffset = off % FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+		size_t bytes = min(size, FILE_SYSTEM_SINGLE_BLOCK_SIZE - blockOffset);
+		if (blocks[block] == nullptr) {
+			blocks[block] = (char *) calloc(FILE_SYSTEM_SINGLE_BLOCK_SIZE, 1);
+			if (blocks[block] == nullptr) {
+				return false;
+			}
+			allocations.push_back(blocks[block]);
+		}
+		memcpy(blocks[block] + blockOffset, buf, bytes);
+		buf += bytes;
+		off += bytes;
+		size -= bytes;
+	}
+
+	return true;
+}
+
+void FileBuffer::zero(size_t size, off_t off) {
+	while (size > 0 && (size_t) off / FILE_SYSTEM_SINGLE_BLOCK_SIZE < blocks.size()) {
+		size_t block = off / FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+		size_t blockOffset = off % FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+		size_t bytes = min(size, FILE_SYSTEM_SINGLE_BLOCK_SIZE - blockOffset);
+		if (blocks[block] != nullptr) {
+			memset(blocks[block] + blockOffset, 0, bytes);
+		}
+		off += bytes;
+		size -= bytes;
+	}
+}
+
+bool FileBuffer::isHole(size_t block) {
+	return block >= blocks.size() || blocks[block] == nullptr || isZeroBlock(blocks[block], FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+}
+
+vector<struct iovec> FileBuffer::getRange(size_t size, off_t off) {
+	vector<struct iovec> range;
+	while (size > 0) {
+		size_t block = off / FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+		size_t blockOffset = off % FILE_SYSTEM_SINGLE_BLOCK_SIZE;
+		size_t bytes = min(size, FILE_SYSTEM_SINGLE_BLOCK_SIZE - blockOffset);
+		//The holes are read from a shared block of zeros, as the blocks past the buffer of a file extended by setattr
+		char *data = block < blocks.size() && blocks[block] != nullptr ? blocks[block] : (char *) getZeroBlock();
+		range.push_back({data + blockOffset, bytes});
+		off += bytes;
+		size -= bytes;
+	}
+
+	return range;
+}
+
+void FileBuffer::clear() {
+	for (void *allocation : allocations) {
+		free(allocation);
+	}
+	allocations.clear();
+	blocks.clear();
+}
@@ -0,0 +1,78 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef FILEBUFFER_HPP
+#define FILEBUFFER_HPP
+
+#include <vector>
+#include <cstddef>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+using namespace std;
+
+/**
+ * @brief The content of an open file, as a list of blocks of FILE_SYSTEM_SINGLE_BLOCK_SIZE bytes.
+ *
+ * The file grows a block at a time, so a write copies only its own data, and the blocks of a large file
+ * don't need to be adjacent. The buffer of a read can be adopted whole, as the first blocks of the file.
+ * The new blocks are holes, which take no memory until they're written and are read as zeros.
+ */
+class FileBuffer {
+private:
+	//Each block of the file, in file order, nullptr for the holes
+	vector<char *> blocks;
+	//The memory to free: the buffers adopted and the blocks allocated one at a time
+	vector<void *> allocations;
+
+public:
+	size_t getNumberOfBlocks() { return blocks.size(); }
+
+	/**
+	 * @brief Get the address of each block, in file order, nullptr for the holes.
+	 */
+	void *const *getBlocks() { return (void *const *) blocks.data(); }
+
+	/**
+	 * @brief Use a buffer of adjacent blocks as the first blocks of an empty file, it's freed by clear().
+	 */
+	void adopt(void *buf, size_t nblocks);
+
+	/**
+	 * @brief Grow the file to at least nblocks blocks, adding holes.
+	 */
+	void reserve(size_t nblocks);
+
+	/**
+	 * @brief Copy data in the file, its blocks must be already reserved.
+	 *
+	 * @return FALSE if there's no memory for the holes written.
+	 */
+	bool write(const char *buf, size_t size, off_t off);
+
+	/**
+	 * @brief Fill a range of the file with zeros, as the part cut by a truncate. The holes and the blocks past the buffer
+	 * are already zeros.
+	 */
+	void zero(size_t size, off_t off);
+
+	/**
+	 * @brief Check if a block of the file is a hole, or is all zeros. The blocks past the buffer are holes.
+	 */
+	bool isHole(size_t block);
+
+	/**
+	 * @brief Get the parts of the blocks holding a range of the file, the blocks past the buffer are read as holes.
+	 */
+	vector<struct iovec> getRange(size_t size, off_t off);
+
+	/**
+	 * @brief Free all the blocks.
+	 */
+	void clear();
+};
+
+
+
+#endif //FILEBUFFER_HPP
@@ -7,16 +7,23 @@
 //
 
 #include "FileSystem.hpp"
+#include "FrontEnd.hpp"
+#include "MetadataServer.hpp"
+#include "RemoteRequest.hpp"
 #include "../utils/ArgumentParser.hpp"
+#include "../mpi/LocalFilePool.hpp"
 
 #include <iostream>
 #include <cstdio>
 #include <cstdlib>
 #include <unistd.h>
 #include <string>
+#include <vector>
 #include <cstring>
 #include <cassert>
 #include <thread>
+#include <cstddef>
+#include <algorithm>
 
 //For logging
 #include <dirent.h>
@@ -39,12 +46,26 @@ Nodes *FileSystem::INodeManager = nullptr;
 
 Blocks *FileSystem::BlocksManager = nullptr;
 
+OpenFiles *FileSystem::OpenFileManager = nullptr;
+
 MasterProcessCode *FileSystem::MasterProcess = nullptr;
 
 Logger FileSystem::FSLogger = Logger::getInstance("FuseFileSystem.logger - ");
 
 int FileSystem::mpiWorldSize = 0;
 
+int FileSystem::mpiRank = 0;
+
+shared_mutex FileSystem::m_metadataMutex;
+
+mutex FileSystem::m_atimeMutex;
+
+struct fuse_lowlevel_ops FileSystem::m_lockedOperations;
+
+double FileSystem::m_negativeTimeout = 0.0;
+
+bool FileSystem::m_passthrough = false;
+
 FILE *FileSystem::timeFile1 = nullptr;
 double FileSystem::startWriteTime = 0.0;
 double FileSystem::endWriteTime = 0.0;
@@ -56,6 +77,14 @@ FILE *FileSystem::timeFile2 = nullptr;
  * Constructor of our file system in RAM. It initializes all fuse operation to its methods.
  */
 FileSystem::FileSystem(int rank, int mpi_world_size) {
+    mpiRank = rank;
+    mpiWorldSize = mpi_world_size;
+    //The other front ends forward the metadata operations to the master
+    if (rank != 0) {
+        FrontEnd::getInstance(rank, mpi_world_size)->setOperations(FuseOperations);
+        return;
+    }
+
     FuseOperations.init        = FileSystem::FuseInit;
     FuseOperations.getattr     = FileSystem::FuseGetAttr;
     FuseOperations.lookup      = FileSystem::FuseLookup;
@@ -87,6 +116,7 @@ FileSystem::FileSystem(int rank, int mpi_world_size) {
     FuseOperations.access      = FileSystem::FuseAccess;
     FuseOperations.create      = FileSystem::FuseCreate;
     FuseOperations.getlk       = FileSystem::FuseGetLock;
+    FuseOperations.lseek       = FileSystem::FuseLseek;
 
     m_stbuf.f_bsize   = Nodes::INodeBufBlockSize;      // File system block size
     m_stbuf.f_frsize  = Nodes::INodeBufBlockSize;      // Fundamental file system block size
@@ -102,6 +132,7 @@ FileSystem::FileSystem(int rank, int mpi_world_size) {
 
     INodeManager = Nodes::getInstance();
     BlocksManager = Blocks::getInstance();
+    OpenFileManager = OpenFiles::getInstance();
     MasterProcess = MasterProcessCode::getInstance(rank, mpi_world_size);
 
     LogLevel ll = DAGONFS_LOG_LEVEL;
@@ -157,6 +188,62 @@ int FileSystem::start(int argc,char *argv[]) {
     fuse_args args_for_fuse = FUSE_ARGS_INIT(argc, copied_argv_for_fuse);
     fuse_cmdline_opts fuse_options;
 
+    //LIBFUSE
+    //Timeouts of the kernel caches: the options are removed from the args, fuse_session_new() doesn't know them.
+    //Every change goes through this mount, so the kernel caches can't become stale and the timeouts can be long.
+    typedef struct CacheTimeouts {
+        double attr;
+        double entry;
+        double negative;
+    } CacheTimeouts;
+    CacheTimeouts timeouts = {Nodes::AttrTimeout, Nodes::EntryTimeout, m_negativeTimeout};
+    const fuse_opt timeoutOptions[] = {
+        {"attr_timeout=%lf", offsetof(CacheTimeouts, attr), 0},
+        {"entry_timeout=%lf", offsetof(CacheTimeouts, entry), 0},
+        {"negative_timeout=%lf", offsetof(CacheTimeouts, negative), 0},
+        FUSE_OPT_END
+    };
+    if (fuse_opt_parse(&args_for_fuse, &timeouts, timeoutOptions, nullptr) != 0) {
+        show_usage(argv[0]);
+        return ret;
+    }
+    Nodes::AttrTimeout = timeouts.attr;
+    Nodes::EntryTimeout = timeouts.entry;
+    m_negativeTimeout = timeouts.negative;
+    LOG4CPLUS_INFO(FSLogger, FSLogger.getName() << "attr_timeout " << Nodes::AttrTimeout << " s, entry_timeout " << Nodes::EntryTimeout << " s, negative_timeout " << m_negativeTimeout << " s");
+
+    //LIBFUSE
+    //Loop of the requests: the single thread loop by default, the multithreaded loop keeping N idle handlers with -o queues=N, over io_uring with -o io_uring
+    typedef struct LoopOptions {
+        unsigned int queues;
+        int ioUring;
+    } LoopOptions;
+    LoopOptions loopOptions = {0, 0};
+    const fuse_opt loopOptionsTemplates[] = {
+        {"queues=%u", offsetof(LoopOptions, queues), 0},
+        {"io_uring", offsetof(LoopOptions, ioUring), 1},
+        FUSE_OPT_END
+    };
+    if (fuse_opt_parse(&args_for_fuse, &loopOptions, loopOptionsTemplates, nullptr) != 0) {
+        show_usage(argv[0]);
+        return ret;
+    }
+    if (loopOptions.ioUring && loopOptions.queues == 0) {
+        loopOptions.queues = max(thread::hardware_concurrency(), 1u);
+    }
+    if (loopOptions.ioUring) {
+#if FUSE_VERSION >= FUSE_MAKE_VERSION(3, 18)
+        //The queues of io_uring are per CPU, the handler pool serves them
+        fuse_opt_add_arg(&args_for_fuse, "-oio_uring");
+#else
+        LOG4CPLUS_WARN(FSLogger, FSLogger.getName() << "FUSE over io_uring needs libfuse 3.18, the handler pool reads /dev/fuse");
+#endif
+    }
+    if (loopOptions.queues > 0) {
+        LockOperations(FuseOperations);
+        LOG4CPLUS_INFO(FSLogger, FSLogger.getName() << "Pool of handlers, up to " << loopOptions.queues << " idle" << (loopOptions.ioUring ? ", over io_uring" : ""));
+    }
+
     //LIBFUSE
     //CLI arguments parsing to fill the options
     if(fuse_parse_cmdline(&args_for_fuse,&fuse_options) != 0){
@@ -211,10 +298,12 @@ int FileSystem::start(int argc,char *argv[]) {
             //LIBFUSE
             //Entering a single-block-event loop
             fuse_daemonize(fuse_options.foreground);
-            ret = fuse_session_loop(session);
+            ret = loopOptions.queues > 0 ? SessionLoopMT(session, loopOptions.queues) : SessionLoop(session);
             LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "***** Loop terminated *****");
 
-            MasterProcess->createFileDump();
+            if (MasterProcess != nullptr) {
+                MasterProcess->createFileDump();
+            }
 
 
             //LIBFUSE
@@ -241,6 +330,14 @@ int FileSystem::start(int argc,char *argv[]) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "--> Step 8: Removing mountpoint directory");
     rmdir(argv[2]);
 
+    //The storage processes keep serving the other front ends until they're unmounted too
+    if (mpiRank != 0) {
+        LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "--> Step 9: tell the master that this front end has been unmounted");
+        FrontEnd::getInstance(mpiRank, mpiWorldSize)->detach();
+        return ret;
+    }
+    MetadataServer::getInstance(mpiRank, mpiWorldSize)->join();
+
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "--> Step 9: tell other MPI process that the file system has been unmounted");
     MasterProcess->sendTermination();
 
@@ -248,6 +345,83 @@ int FileSystem::start(int argc,char *argv[]) {
     return ret;
 }
 
+/**
+ * The same loop of fuse_session_loop(), the metadata lock is held while a request is processed.
+ */
+int FileSystem::SessionLoop(fuse_session *session) {
+    int ret = 0;
+    struct fuse_buf buf;
+    memset(&buf, 0, sizeof(buf));
+
+    while (!fuse_session_exited(session)) {
+        ret = fuse_session_receive_buf(session, &buf);
+        if (ret == -EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+
+        lock_guard<shared_mutex> lock(m_metadataMutex);
+        fuse_session_process_buf(session, &buf);
+    }
+
+    free(buf.mem);
+    fuse_session_reset(session);
+    return ret > 0 ? 0 : ret;
+}
+
+/**
+ * Every thread reads its own clone of /dev/fuse, so the kernel spreads the requests among the threads.
+ * With FUSE_USE_VERSION 32 the loop can't bound the number of threads: libfuse starts a new one whenever
+ * all of them are busy, and stops the ones exceeding the idle threads.
+ */
+int FileSystem::SessionLoopMT(fuse_session *session, unsigned int queues) {
+    struct fuse_loop_config config;
+    config.clone_fd = 1;
+    config.max_idle_threads = queues;
+    return fuse_session_loop_mt(session, &config);
+}
+
+void FileSystem::LockOperations(struct fuse_lowlevel_ops &operations) {
+    m_lockedOperations = operations;
+    //The initialization comes before any other request
+    if (operations.lookup)      operations.lookup      = ExclusiveOperation<&fuse_lowlevel_ops::lookup>;
+    if (operations.forget)      operations.forget      = ExclusiveOperation<&fuse_lowlevel_ops::forget>;
+    if (operations.getattr)     operations.getattr     = ExclusiveOperation<&fuse_lowlevel_ops::getattr>;
+    if (operations.setattr)     operations.setattr     = ExclusiveOperation<&fuse_lowlevel_ops::setattr>;
+    if (operations.readlink)    operations.readlink    = ExclusiveOperation<&fuse_lowlevel_ops::readlink>;
+    if (operations.mknod)       operations.mknod       = ExclusiveOperation<&fuse_lowlevel_ops::mknod>;
+    if (operations.mkdir)       operations.mkdir       = ExclusiveOperation<&fuse_lowlevel_ops::mkdir>;
+    if (operations.unlink)      operations.unlink      = ExclusiveOperation<&fuse_lowlevel_ops::unlink>;
+    if (operations.rmdir)       operations.rmdir       = ExclusiveOperation<&fuse_lowlevel_ops::rmdir>;
+    if (operations.symlink)     operations.symlink     = ExclusiveOperation<&fuse_lowlevel_ops::symlink>;
+    if (operations.rename)      operations.rename      = ExclusiveOperation<&fuse_lowlevel_ops::rename>;
+    if (operations.link)        operations.link        = ExclusiveOperation<&fuse_lowlevel_ops::link>;
+    if (operations.open)        operations.open        = ExclusiveOperation<&fuse_lowlevel_ops::open>;
+    if (operations.read)        operations.read        = SharedOperation<&fuse_lowlevel_ops::read>;
+    if (operations.write)       operations.write       = ExclusiveOperation<&fuse_lowlevel_ops::write>;
+    if (operations.flush)       operations.flush       = ExclusiveOperation<&fuse_lowlevel_ops::flush>;
+    if (operations.release)     operations.release     = ExclusiveOperation<&fuse_lowlevel_ops::release>;
+    if (operations.fsync)       operations.fsync       = ExclusiveOperation<&fuse_lowlevel_ops::fsync>;
+    if (operations.opendir)     operations.opendir     = ExclusiveOperation<&fuse_lowlevel_ops::opendir>;
+    if (operations.readdir)     operations.readdir     = ExclusiveOperation<&fuse_lowlevel_ops::readdir>;
+    if (operations.releasedir)  operations.releasedir  = ExclusiveOperation<&fuse_lowlevel_ops::releasedir>;
+    if (operations.fsyncdir)    operations.fsyncdir    = ExclusiveOperation<&fuse_lowlevel_ops::fsyncdir>;
+    if (operations.statfs)      operations.statfs      = ExclusiveOperation<&fuse_lowlevel_ops::statfs>;
+    if (operations.setxattr)    operations.setxattr    = ExclusiveOperation<&fuse_lowlevel_ops::setxattr>;
+    if (operations.getxattr)    operations.getxattr    = ExclusiveOperation<&fuse_lowlevel_ops::getxattr>;
+    if (operations.listxattr)   operations.listxattr   = ExclusiveOperation<&fuse_lowlevel_ops::listxattr>;
+    if (operations.removexattr) operations.removexattr = ExclusiveOperation<&fuse_lowlevel_ops::removexattr>;
+    if (operations.access)      operations.access      = ExclusiveOperation<&fuse_lowlevel_ops::access>;
+    if (operations.create)      operations.create      = ExclusiveOperation<&fuse_lowlevel_ops::create>;
+    if (operations.getlk)       operations.getlk       = ExclusiveOperation<&fuse_lowlevel_ops::getlk>;
+    if (operations.setlk)       operations.setlk       = ExclusiveOperation<&fuse_lowlevel_ops::setlk>;
+    if (operations.bmap)        operations.bmap        = ExclusiveOperation<&fuse_lowlevel_ops::bmap>;
+    if (operations.fallocate)   operations.fallocate   = ExclusiveOperation<&fuse_lowlevel_ops::fallocate>;
+    if (operations.lseek)       operations.lseek       = ExclusiveOperation<&fuse_lowlevel_ops::lseek>;
+}
+
 void FileSystem::show_usage(const char *progname){
     printf("usage: %s [options] <mount point>\n\n",progname);
     printf("options\n"
@@ -255,6 +429,11 @@ void FileSystem::show_usage(const char *progname){
             "       -V\n"
             "       --help \t\tdisplay help information"
             "       --ho"
+            "       -o attr_timeout=S \tseconds the kernel caches the attributes (1.0)\n"
+            "       -o entry_timeout=S \tseconds the kernel caches the directory entries (1.0)\n"
+            "       -o negative_timeout=S \tseconds the kernel remembers the missing names (0.0)\n"
+            "       -o queues=N \t\tserve the requests with a pool of threads started on demand, keeping up to N idle\n"
+            "       -o io_uring \t\treceive the requests over io_uring (libfuse 3.18), queues is the number of CPUs if it isn't set\n"
             "\n");
 }
 
@@ -266,6 +445,14 @@ void FileSystem::FuseInit(void *userdata, struct fuse_conn_info *conn) {
 
     FileSystem::m_reclaimingINodes = false;
 
+#ifdef FUSE_CAP_PASSTHROUGH
+    if (conn->capable & FUSE_CAP_PASSTHROUGH) {
+        conn->want |= FUSE_CAP_PASSTHROUGH;
+        m_passthrough = true;
+        LOG4CPLUS_INFO(FSLogger, FSLogger.getName() << "The read only opens of the files stored by the master are passed through to the kernel");
+    }
+#endif
+
     m_stbuf.f_bfree  = m_stbuf.f_blocks;	//Free blocks
     m_stbuf.f_bavail = m_stbuf.f_blocks;	//Blocks available to non-root
     m_stbuf.f_ffree  = m_stbuf.f_files;     //Free inodes
@@ -291,6 +478,11 @@ void FileSystem::FuseInit(void *userdata, struct fuse_conn_info *conn) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "FuseInit() completed!");
 
     MasterProcess->sendChangedir();
+
+    //The root directory exists: the other front ends and the clients can be served
+    if (NodeTopology::getInstance(mpiRank, mpiWorldSize)->hasRemoteFrontEnds()) {
+        MetadataServer::getInstance(mpiRank, mpiWorldSize)->start();
+    }
 }
 
 /**
@@ -323,17 +515,30 @@ fuse_ino_t FileSystem::RegisterINode(INodeType type, mode_t mode, nlink_t nlink,
     return ino;
 }
 
+/**
+ * The child gets the same layout of the parent directory, as the Lustre default striping. The layout extended attributes
+ * are copied too, so they can be read back with getxattr() on the child.
+ */
+void FileSystem::InheritLayout(INode *parent, INode *child) {
+    child->m_layout = parent->m_layout;
+    for (auto &xattr: parent->GetXAttr()) {
+        if (DataLayout::isLayoutAttribute(xattr.first)) {
+            child->SetXAttr(xattr.first, xattr.second.first, xattr.second.second, 0, 0);
+        }
+    }
+}
+
 void FileSystem::FuseGetAttr(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi){
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Getting Attributes -> FuseRamFs::FuseGetAttr()");
     //Fail if the inode hasn't been created yet
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
     }
 
     //TODO: What do we do if the inode was deleted?
     INode *inode = INodeManager->getINodeByINodeNumber(ino);
 
-    fuse_reply_attr(req, &(inode->m_fuseEntryParam.attr), 1.0);
+    ReplyAttr(req, &(inode->m_fuseEntryParam.attr), Nodes::AttrTimeout);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Getting Attributes -> FuseRamFs::FuseGetAttr() completed!");
 }
@@ -342,7 +547,7 @@ void FileSystem::FuseLookup(fuse_req_t req, fuse_ino_t parent, const char* name)
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Lookup -> FuseRamFs::FuseLookup()");
 
     if (parent >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -350,13 +555,13 @@ void FileSystem::FuseLookup(fuse_req_t req, fuse_ino_t parent, const char* name)
     Directory *dir = dynamic_cast<Directory *>(parentInode);
     if (dir == nullptr) {
         // The parent wasn't a directory. It can't have any children.
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
     fuse_ino_t ino = dir->ChildINodeNumberWithName(string(name));
     if (ino == -1) {
-        fuse_reply_err(req, ENOENT);
+        ReplyNegativeEntry(req);
         return;
     }
 
@@ -365,11 +570,164 @@ void FileSystem::FuseLookup(fuse_req_t req, fuse_ino_t parent, const char* name)
     INodeManager->LookupINode(ino);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tLookup for: " << ino << "-" << name << " nlookup++");
-    fuse_reply_entry(req, &(inode->m_fuseEntryParam));
+    ReplyEntry(req, &(inode->m_fuseEntryParam));
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Lookup -> FuseRamFs::FuseLookup() completed!");
 }
 
+/**
+ * A negative entry is an entry with inode number 0: the kernel answers ENOENT by itself until it expires, or until
+ * the name is created through the mount.
+ */
+void FileSystem::ReplyNegativeEntry(fuse_req_t req) {
+    if (m_negativeTimeout <= 0) {
+        ReplyErr(req, ENOENT);
+        return;
+    }
+
+    fuse_entry_param entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.ino = 0;
+    entry.entry_timeout = m_negativeTimeout;
+    ReplyEntry(req, &entry);
+}
+
+/**
+ * The replies to the requests of the other front ends are recorded in their RemoteRequest, the others go to the kernel.
+ */
+int FileSystem::ReplyErr(fuse_req_t req, int err) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        remote->replyErr(err);
+        return 0;
+    }
+
+    return fuse_reply_err(req, err);
+}
+
+void FileSystem::ReplyNone(fuse_req_t req) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        remote->replyNone();
+        return;
+    }
+
+    fuse_reply_none(req);
+}
+
+int FileSystem::ReplyEntry(fuse_req_t req, const struct fuse_entry_param *e) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        remote->replyEntry(e);
+        return 0;
+    }
+
+    return fuse_reply_entry(req, e);
+}
+
+int FileSystem::ReplyCreate(fuse_req_t req, const struct fuse_entry_param *e, const struct fuse_file_info *fi) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        remote->replyCreate(e);
+        return 0;
+    }
+
+    return fuse_reply_create(req, e, fi);
+}
+
+int FileSystem::ReplyAttr(fuse_req_t req, const struct stat *attr, double attr_timeout) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        remote->replyAttr(attr, attr_timeout);
+        return 0;
+    }
+
+    return fuse_reply_attr(req, attr, attr_timeout);
+}
+
+int FileSystem::ReplyReadLink(fuse_req_t req, const char *link) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        remote->replyReadLink(link);
+        return 0;
+    }
+
+    return fuse_reply_readlink(req, link);
+}
+
+int FileSystem::ReplyOpen(fuse_req_t req, const struct fuse_file_info *fi) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        remote->replyOpen();
+        return 0;
+    }
+
+    return fuse_reply_open(req, fi);
+}
+
+int FileSystem::ReplyWrite(fuse_req_t req, size_t count) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        remote->replyWrite(count);
+        return 0;
+    }
+
+    return fuse_reply_write(req, count);
+}
+
+int FileSystem::ReplyBuf(fuse_req_t req, const char *buf, size_t size) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        remote->replyBuf(buf, size);
+        return 0;
+    }
+
+    return fuse_reply_buf(req, buf, size);
+}
+
+int FileSystem::ReplyIov(fuse_req_t req, const struct iovec *iov, int count) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        string buf;
+        for (int i=0; i < count; i++) {
+            buf.append((const char *) iov[i].iov_base, iov[i].iov_len);
+        }
+        remote->replyBuf(buf.data(), buf.size());
+        return 0;
+    }
+
+    return fuse_reply_iov(req, iov, count);
+}
+
+int FileSystem::ReplyStatfs(fuse_req_t req, const struct statvfs *stbuf) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        remote->replyStatfs(stbuf);
+        return 0;
+    }
+
+    return fuse_reply_statfs(req, stbuf);
+}
+
+int FileSystem::ReplyXAttr(fuse_req_t req, size_t count) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        remote->replyXAttr(count);
+        return 0;
+    }
+
+    return fuse_reply_xattr(req, count);
+}
+
+const struct fuse_ctx *FileSystem::RequestContext(fuse_req_t req) {
+    RemoteRequest *remote = RemoteRequest::fromRequest(req);
+    if (remote != nullptr) {
+        return remote->getContext();
+    }
+
+    return fuse_req_ctx(req);
+}
+
 /**
  * Check if the i-node is forgotten. If an i-node has no hard links, it's added to the deleted i-node list.
  * Check if the number of deleted i-node is greater than a threshold, the file system active reclaiming mode.
@@ -382,7 +740,7 @@ void FileSystem::FuseForget(fuse_req_t req, fuse_ino_t ino, unsigned long nlooku
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\tforget per " << ino << ". nlookup -= " << nlookup);
     inode_p->Forget(nlookup);
 
-    fuse_reply_none(req);
+    ReplyNone(req);
 
     if (inode_p->Forgotten()){
         LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\ti-node: " << inode_p << "forgotten");
@@ -412,7 +770,7 @@ void FileSystem::FuseSetAttr(fuse_req_t req, fuse_ino_t ino, struct stat* attr,
 
     // Fail if the inode hasn't been created yet
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
     }
 
     // TODO: What do we do if the inode was deleted?
@@ -420,7 +778,11 @@ void FileSystem::FuseSetAttr(fuse_req_t req, fuse_ino_t ino, struct stat* attr,
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tsetattr per: " << ino);
     INodeManager->SetINodeAttributes(inode, attr, to_set);
-    fuse_reply_attr(req, &(inode->m_fuseEntryParam.attr), 1.0);
+    //The memfd of a file stored by the master follows its size, its reads must not reach the pages past its end
+    if (to_set & FUSE_SET_ATTR_SIZE) {
+        LocalFilePool::getInstance()->resize(ino, inode->m_fuseEntryParam.attr.st_size);
+    }
+    ReplyAttr(req, &(inode->m_fuseEntryParam.attr), Nodes::AttrTimeout);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Setting -> FuseRamFs::FuseSetAttr() completed!");
 }
@@ -429,7 +791,7 @@ void FileSystem::FuseReadLink(fuse_req_t req, fuse_ino_t ino) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Reading Link -> FuseRamFs::FuseReadLink()");
 
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -438,18 +800,18 @@ void FileSystem::FuseReadLink(fuse_req_t req, fuse_ino_t ino) {
     // You can only readlink on a symlink
     SymbolicLink *link_p = dynamic_cast<SymbolicLink *>(inode_p);
     if (link_p == nullptr) {
-        fuse_reply_err(req, EPERM);
+        ReplyErr(req, EPERM);
         return;
     }
 
     // TODO: Handle permissions.
     //    else if ((fi->flags & 3) != O_RDONLY)
-    //        fuse_reply_err(req, EACCES);
+    //        ReplyErr(req, EACCES);
 
     // TODO: Is reply_entry only for directories? What about files?
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\treadlink per: " << ino);
 
-    fuse_reply_readlink(req, link_p->Link().c_str());
+    ReplyReadLink(req, link_p->Link().c_str());
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Reading Link -> FuseRamFs::FuseReadLink() completed!");
 }
@@ -458,7 +820,7 @@ void FileSystem::FuseMknod(fuse_req_t req, fuse_ino_t parent, const char* name,
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Making node -> FuseRamFs::FuseMknod()");
 
     if (parent >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -467,21 +829,21 @@ void FileSystem::FuseMknod(fuse_req_t req, fuse_ino_t parent, const char* name,
     // You can only make something inside a directory
     Directory *parentDir_p = dynamic_cast<Directory *>(parentInode);
     if (parentDir_p == nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     string tmp_string = string(name);
     if (tmp_string.length() > kMaxFilenameLength) {
-        fuse_reply_err(req, ENAMETOOLONG);
+        ReplyErr(req, ENAMETOOLONG);
         return;
     }
 
     // TODO: Handle permissions on dirs. You can't just create anything you please!:
     //    else if ((fi->flags & 3) != O_RDONLY)
-    //        fuse_reply_err(req, EACCES);
+    //        ReplyErr(req, EACCES);
 
-    const struct fuse_ctx* ctx_p = fuse_req_ctx(req);
+    const struct fuse_ctx* ctx_p = RequestContext(req);
 
     INodeType inode_type;
     nlink_t nlink = 0;
@@ -508,7 +870,7 @@ void FileSystem::FuseMknod(fuse_req_t req, fuse_ino_t parent, const char* name,
         // S_ISLNK
         // S_ISSOCK
         // ...instead of returning this error.
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -518,13 +880,15 @@ void FileSystem::FuseMknod(fuse_req_t req, fuse_ino_t parent, const char* name,
     // TODO: Handle: S_ISCHR S_ISBLK S_ISFIFO S_ISLNK S_ISSOCK S_TYPEISMQ S_TYPEISSEM S_TYPEISSHM
     assert(inode_p != nullptr);
 
+    InheritLayout(parentDir_p, inode_p);
+
     // Insert the inode into the directory. TODO: What if it already exists?
     parentDir_p->UpdateChild(string(name), ino);
 
     // TODO: Is reply_entry only for directories? What about files?
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tmknod for " << ino << ". nlookup++");
     inode_p->Lookup();
-    fuse_reply_entry(req, &(inode_p->m_fuseEntryParam));
+    ReplyEntry(req, &(inode_p->m_fuseEntryParam));
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Making node -> FuseRamFs::FuseMknod() completed!");
 }
@@ -533,7 +897,7 @@ void FileSystem::FuseMkdir(fuse_req_t req, fuse_ino_t parent, const char* name,
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Making directory -> FuseRamFs::FuseMkdir()");
 
     if (parent >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -542,16 +906,17 @@ void FileSystem::FuseMkdir(fuse_req_t req, fuse_ino_t parent, const char* name,
     // You can only make something inside a directory
     Directory *parentDir_p = dynamic_cast<Directory *>(parentInode);
     if (parentDir_p == nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     // TODO: Handle permissions on dirs. You can't just create anything you please!:
     //    else if ((fi->flags & 3) != O_RDONLY)
-    //        fuse_reply_err(req, EACCES);
+    //        ReplyErr(req, EACCES);
 
     fuse_ino_t ino = RegisterINode(DIRECTORY, S_IFDIR | 0777, 2, getgid(), getuid());
     Directory *dir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(ino));
+    InheritLayout(parentDir_p, dir_p);
 
     // Insert the inode into the directory. TODO: What if it already exists?
     parentDir_p->UpdateChild(string(name), ino);
@@ -562,7 +927,7 @@ void FileSystem::FuseMkdir(fuse_req_t req, fuse_ino_t parent, const char* name,
     // TODO: Is reply_entry only for directories? What about files?
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tmkdir for " << ino << ". nlookup++");
     dir_p->Lookup();
-    fuse_reply_entry(req, &(dir_p->m_fuseEntryParam));
+    ReplyEntry(req, &(dir_p->m_fuseEntryParam));
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tAll child of parentDir: " << parentDir_p);
     for (auto child: parentDir_p->Children()) {
@@ -583,7 +948,7 @@ void FileSystem::FuseUnlink(fuse_req_t req, fuse_ino_t parent, const char* name)
 
     // TODO: Node may also be deleted.
     if (parent >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -592,18 +957,18 @@ void FileSystem::FuseUnlink(fuse_req_t req, fuse_ino_t parent, const char* name)
     // You can only delete something inside a directory
     Directory *parentDir_p = dynamic_cast<Directory *>(parentInode);
     if (parentDir_p == nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     // TODO: Handle permissions on dirs. You can't just delete anything you please!:
     //    else if ((fi->flags & 3) != O_RDONLY)
-    //        fuse_reply_err(req, EACCES);
+    //        ReplyErr(req, EACCES);
 
     // Return an error if the child doesn't exist.
     fuse_ino_t ino = parentDir_p->ChildINodeNumberWithName(string(name));
     if (ino == -1) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -616,7 +981,7 @@ void FileSystem::FuseUnlink(fuse_req_t req, fuse_ino_t parent, const char* name)
     parentDir_p->DeleteChild(string(name));
 
     // Reply with no error. TODO: Where is ESUCCESS?
-    fuse_reply_err(req, 0);
+    ReplyErr(req, 0);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Unlinking inode-> FuseRamFs::FuseUnlink() completed!");
 }
@@ -629,7 +994,7 @@ void FileSystem::FuseRmdir(fuse_req_t req, fuse_ino_t parent, const char *name)
 
     if (parent >= INodeManager->getNumberOfINodes()) {
         LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tparent >= INodes.size()");
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -639,19 +1004,19 @@ void FileSystem::FuseRmdir(fuse_req_t req, fuse_ino_t parent, const char *name)
     Directory *parentDir_p = dynamic_cast<Directory *>(parentInode);
     if (parentDir_p == nullptr) {
         LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() << "\tparentDir_p == nullptr");
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     // TODO: Handle permissions on dirs. You can't just delete anything you please!:
     //    else if ((fi->flags & 3) != O_RDONLY)
-    //        fuse_reply_err(req, EACCES);
+    //        ReplyErr(req, EACCES);
 
     // Return an error if the child doesn't exist.
     fuse_ino_t ino = parentDir_p->ChildINodeNumberWithName(string(name));
     if (ino == -1) {
         LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() << "\tino == -1");
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -663,14 +1028,14 @@ void FileSystem::FuseRmdir(fuse_req_t req, fuse_ino_t parent, const char *name)
     if (dir_p == nullptr) {
         LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() << "\tdir_p == nullptr");
         // Someone tried to rmdir on something that wasn't a directory.
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     // Remove the directory only if is empty
     if (dir_p->hasChildren()) {
         LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() << "\tDirectory contains children");
-        fuse_reply_err(req, EPERM);
+        ReplyErr(req, EPERM);
         return;
     }
 
@@ -686,7 +1051,7 @@ void FileSystem::FuseRmdir(fuse_req_t req, fuse_ino_t parent, const char *name)
     parentDir_p->DeleteChild(string(name));
 
     // Reply with no error. TODO: Where is ESUCCESS?
-    fuse_reply_err(req, 0);
+    ReplyErr(req, 0);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Removing directory -> FuseRamFs::FuseRmdir completed!");
 }
@@ -694,7 +1059,7 @@ void FileSystem::FuseRmdir(fuse_req_t req, fuse_ino_t parent, const char *name)
 void FileSystem::FuseSymlink(fuse_req_t req, const char* link, fuse_ino_t parent, const char* name) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Creating symbolic link -> FuseRamFs::FuseSymlink");
     if (parent >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -703,15 +1068,15 @@ void FileSystem::FuseSymlink(fuse_req_t req, const char* link, fuse_ino_t parent
     // You can only make something inside a directory
     Directory *dir = dynamic_cast<Directory *>(parent_p);
     if (dir == nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     // TODO: Handle permissions on dirs. You can't just make symlinks anywhere:
     //    else if ((fi->flags & 3) != O_RDONLY)
-    //        fuse_reply_err(req, EACCES);
+    //        ReplyErr(req, EACCES);
 
-    const struct fuse_ctx* ctx_p = fuse_req_ctx(req);
+    const struct fuse_ctx* ctx_p = RequestContext(req);
 
     fuse_ino_t ino = RegisterINode(SYMBOLIC_LINK, S_IFLNK | 0755, 1, ctx_p->gid, ctx_p->uid);
     SymbolicLink *symLink = dynamic_cast<SymbolicLink *>(INodeManager->getINodeByINodeNumber(ino));
@@ -724,7 +1089,7 @@ void FileSystem::FuseSymlink(fuse_req_t req, const char* link, fuse_ino_t parent
     // TODO: Is reply_entry only for directories? What about files?
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\tsymlink for " << ino << ". nlookup++");
     inode_p->Lookup();
-    fuse_reply_entry(req,&(inode_p->m_fuseEntryParam));
+    ReplyEntry(req,&(inode_p->m_fuseEntryParam));
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Creating symbolic link -> FuseRamFs::FuseSymlink completed!");
 }
@@ -733,7 +1098,7 @@ void FileSystem::FuseRename(fuse_req_t req, fuse_ino_t parent, const char* name,
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Renaming new inode -> FuseRamFs::FuseRename()");
     // Make sure the parent still exists.
     if (parent >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -742,24 +1107,24 @@ void FileSystem::FuseRename(fuse_req_t req, fuse_ino_t parent, const char* name,
     // You can only rename something inside a directory
     Directory *parentDir = dynamic_cast<Directory *>(parentInode);
     if (parentDir == nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     // TODO: Handle permissions on dirs. You can't just rename anything you please!:
     //    else if ((fi->flags & 3) != O_RDONLY)
-    //        fuse_reply_err(req, EACCES);
+    //        ReplyErr(req, EACCES);
 
     // Return an error if the child doesn't exist.
     fuse_ino_t ino = parentDir->ChildINodeNumberWithName(string(name));
     if (ino == -1) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
     // Make sure the new parent still exists.
     if (newparent >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -769,7 +1134,7 @@ void FileSystem::FuseRename(fuse_req_t req, fuse_ino_t parent, const char* name,
     // ever give us a parent that isn't a dir? Test this.
     Directory *newParentDir = dynamic_cast<Directory *>(newParentInode);
     if (newParentDir == nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
@@ -796,7 +1161,7 @@ void FileSystem::FuseRename(fuse_req_t req, fuse_ino_t parent, const char* name,
     parentDir->DeleteChild(string(name));
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tRename " << name << " in " << parent << " to " << newname << " in " << newparent);
-    fuse_reply_err(req, 0);
+    ReplyErr(req, 0);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Renaming new inode -> FuseRamFs::FuseRename() completed!");
 }
@@ -806,7 +1171,7 @@ void FileSystem::FuseLink(fuse_req_t req, fuse_ino_t ino, fuse_ino_t newparent,
 
     // Make sure the new parent still exists.
     if (newparent >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -816,13 +1181,13 @@ void FileSystem::FuseLink(fuse_req_t req, fuse_ino_t ino, fuse_ino_t newparent,
     // ever give us a parent that isn't a dir? Test this.
     Directory *newParentDir_p = dynamic_cast<Directory *>(inode_p);
     if (newParentDir_p == nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     // Make target still exists.
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -834,7 +1199,7 @@ void FileSystem::FuseLink(fuse_req_t req, fuse_ino_t ino, fuse_ino_t newparent,
     // Type is unsigned so we have to explicitly check for largest value. TODO: Refactor please.
     if (existingIno != -1 && existingIno > 0) {
         // There's already a child with that name. Return an error.
-        fuse_reply_err(req, EEXIST);
+        ReplyErr(req, EEXIST);
     }
 
     // Create the new name and point it to the inode.
@@ -845,7 +1210,7 @@ void FileSystem::FuseLink(fuse_req_t req, fuse_ino_t ino, fuse_ino_t newparent,
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tlink " << newname << " in " << newparent << " to " << ino);
     inode_p->Lookup();
-    fuse_reply_entry(req, &(inode_p->m_fuseEntryParam));
+    ReplyEntry(req, &(inode_p->m_fuseEntryParam));
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Creating hard link -> FuseRamFs::FuseLink completed");
 }
 
@@ -854,7 +1219,7 @@ void FileSystem::FuseOpen(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info*
 
     // TODO: Node may also be deleted.
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -863,70 +1228,126 @@ void FileSystem::FuseOpen(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info*
     // You can't open a dir with 'open'. Check for this.
     Directory *dir = dynamic_cast<Directory *>(inode);
     if (dir != nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     File *file_p = dynamic_cast<File *>(inode);
     if (file_p == nullptr) {
-        fuse_reply_err(req, EPERM);
+        ReplyErr(req, EPERM);
         return;
     }
 
     // TODO: Handle permissions on files:
     //    else if ((fi->flags & 3) != O_RDONLY)
-    //        fuse_reply_err(req, EACCES);
+    //        ReplyErr(req, EACCES);
     if ( fi->flags & (O_WRONLY | O_TRUNC) ) {
         startWriteTime = MPI_Wtime();
         LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << "\tFile opened in write only mode or with O_TRUNC mode, the content must be deleted");
         file_p->m_fuseEntryParam.attr.st_size = 0;
         file_p->m_fuseEntryParam.attr.st_blocks = 0;
+        FileData *data;
+        fi->fh = OpenFileManager->open(ino, data);
+        //The handles still open share the old content, it's dropped with the size
+        data->buffer.clear();
+        data->dirty = true;
+    }
+    //The memfd doesn't have the data written through the handles still open
+    else if ((fi->flags & O_ACCMODE) == O_RDONLY && OpenFileManager->find(ino) == nullptr && OpenPassthrough(req, ino, file_p, fi)) {
+        LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << "\tFile opened in read only mode, the kernel reads it from its memfd");
+        //The reads of a passthrough open don't reach the file system, it needs no handle
+        fi->fh = 0;
     }
     else {
-        LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << "\tFile opened in read and write or a mode that not erase the file content, the content must be loaded");
-        MasterProcess->sendReadRequest();
-        //4KB
-        startReadTime = MPI_Wtime();
-        file_p->m_buf = MasterProcess->DAGonFS_Read(ino,
-                                                    file_p->m_fuseEntryParam.attr.st_size,
-                                                    file_p->m_fuseEntryParam.attr.st_size,
-                                                    0);
-        //
+        FileData *data;
+        fi->fh = OpenFileManager->open(ino, data);
+        if (data->opens > 1) {
+            LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << "\tFile already open, the content is shared by " << data->opens << " handles");
+        }
+        else {
+            LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << "\tFile opened in read and write or a mode that not erase the file content, the content must be loaded");
+            //4KB
+            startReadTime = MPI_Wtime();
+            size_t fileSize = file_p->m_fuseEntryParam.attr.st_size;
+            data->buffer.adopt(MasterProcess->DAGonFS_Read(ino, fileSize, fileSize, 0, file_p->m_layout),
+                               fileSize / Nodes::INodeBufBlockSize + (fileSize % Nodes::INodeBufBlockSize != 0));
+            //
+        }
     }
 
     // TODO: We seem to be able to delete a file and copy it back without a new inode being created. The only evidence is the open call. How do we handle this?
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\topen for " << ino << ". with flags " << fi->flags);
 
-    fuse_reply_open(req, fi);
+    ReplyOpen(req, fi);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Opening file -> FuseRamFs::FuseOpen completed!");
 }
 
+bool FileSystem::OpenPassthrough(fuse_req_t req, fuse_ino_t ino, File *file_p, struct fuse_file_info *fi) {
+#ifdef FUSE_CAP_PASSTHROUGH
+    //The other front ends read the blocks themselves
+    if (!m_passthrough || RemoteRequest::fromRequest(req) != nullptr) {
+        return false;
+    }
+
+    //The files written again since their last open have a new memfd
+    LocalFilePool *localFilePool = LocalFilePool::getInstance();
+    for (int backingId : localFilePool->getRetiredBackingIds()) {
+        fuse_passthrough_close(req, backingId);
+    }
+    localFilePool->getRetiredBackingIds().clear();
+
+    int fd = localFilePool->getFd(ino, file_p->m_fuseEntryParam.attr.st_size);
+    if (fd < 0) {
+        return false;
+    }
+    int backingId = localFilePool->getBackingId(ino);
+    if (backingId == 0) {
+        backingId = fuse_passthrough_open(req, fd);
+        if (backingId <= 0) {
+            //The registration of the backing files needs CAP_SYS_ADMIN
+            LOG4CPLUS_WARN(FSLogger, FSLogger.getName() << "Cannot pass " << ino << " through to the kernel, the reads are served by the file system");
+            m_passthrough = false;
+            return false;
+        }
+        localFilePool->setBackingId(ino, backingId);
+    }
+
+    fi->backing_id = backingId;
+    return true;
+#else
+    return false;
+#endif
+}
+
 void FileSystem::FuseFlush(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info* fi) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Flushing file -> FuseRamFs::FuseFlush");
 
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
-    // TODO: Handle info in fi.
-
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tflush for " << ino);
 
     File *file_p = dynamic_cast<File *>(INodeManager->getINodeByINodeNumber(ino));
+    //The data stays with the other handles of the file, it's freed by the release of the last one
+    FileData *data = OpenFileManager->getData(fi->fh);
     string fileContent = "Timing for distributed operation on inode="+to_string(ino)+"\n";
-    if (file_p->m_buf != nullptr) {
-        if (file_p->isWaitingForWriting()) {
+    if (data != nullptr && data->buffer.getNumberOfBlocks() > 0) {
+        size_t fileSize = file_p->m_fuseEntryParam.attr.st_size;
+        if (data->dirty) {
+            //A file extended by setattr has holes after its blocks, they aren't sent
+            data->buffer.reserve(fileSize / Nodes::INodeBufBlockSize + (fileSize % Nodes::INodeBufBlockSize != 0));
             LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << ino << " will flush with distributed write");
             MasterProcess->sendWriteRequest();
-            MasterProcess->DAGonFS_Write(file_p->m_buf, ino, file_p->m_fuseEntryParam.attr.st_size);
+            MasterProcess->DAGonFS_Write(data->buffer.getBlocks(), ino, fileSize, file_p->m_layout);
             endWriteTime = MPI_Wtime();
             fileContent += "Total write time: "+to_string(endWriteTime - startWriteTime)+"\n";
             fileContent += "Time for Scat-Gath in DAGonFS_Write: "+ to_string(MasterProcess->DAGonFSWriteSGElapsedTime) +"\n";
             fileContent += "Time for entire DAGonFS_Write: "+ to_string(MasterProcess->lastWriteTime) +"\n";
-            file_p->removeWaiting();
+            data->dirty = false;
         }
         else {
             endReadTime = MPI_Wtime();
@@ -934,12 +1355,9 @@ void FileSystem::FuseFlush(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info
             fileContent += "Time for Scat-Gath in DAGonFS_Read: "+ to_string(MasterProcess->DAGonFSReadSGElapsedTime) +"\n";
             fileContent += "Time for entire DAGonFS_Read: "+ to_string(MasterProcess->lastReadTime) +"\n";
         }
-        LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << "Freeing file_p->m_buf");
-        free(file_p->m_buf);
-        file_p->m_buf = nullptr;
     }
 
-    fuse_reply_err(req, 0);
+    ReplyErr(req, 0);
 
     fileContent += "\n";
     fwrite(fileContent.c_str(),sizeof(char),fileContent.length(),timeFile1);
@@ -954,7 +1372,7 @@ void FileSystem::FuseRelease(fuse_req_t req, fuse_ino_t ino, struct fuse_file_in
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Releasing file -> FuseRamFs::FuseRelease completed!");
 
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -963,26 +1381,19 @@ void FileSystem::FuseRelease(fuse_req_t req, fuse_ino_t ino, struct fuse_file_in
     // You can't release a dir with 'close'. Check for this.
     Directory *dir = dynamic_cast<Directory *>(inode_p);
     if (dir != nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     // TODO: Handle permissions on files:
     //    else if ((fi->flags & 3) != O_RDONLY)
-    //        fuse_reply_err(req, EACCES);
+    //        ReplyErr(req, EACCES);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\trelease for " << ino);
 
-    File *file_p = dynamic_cast<File *>(INodeManager->getINodeByINodeNumber(ino));
-    if (file_p != nullptr) {
-        if (file_p->m_buf != nullptr) {
-            LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << "\tFreeing file_p->m_buf");
-            free(file_p->m_buf);
-            file_p->m_buf = nullptr;
-        }
-    }
+    OpenFileManager->release(fi->fh);
 
-    fuse_reply_err(req, 0);
+    ReplyErr(req, 0);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Releasing file -> FuseRamFs::FuseRelease completed!");
 }
@@ -994,12 +1405,12 @@ void FileSystem::FuseFsync(fuse_req_t req, fuse_ino_t ino, int datasync, struct
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Synchronizing file -> FuseRamFs::Fsync");
 
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\tfysnc for " << ino);
-    fuse_reply_err(req, 0);
+    ReplyErr(req, 0);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Synchronizing file -> FuseRamFs::Fsync completed");
 }
@@ -1008,7 +1419,7 @@ void FileSystem::FuseOpenDir(fuse_req_t req, fuse_ino_t ino, struct fuse_file_in
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Opening directory -> FuseRamFs::FuseOpenDir()");
 
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -1017,16 +1428,16 @@ void FileSystem::FuseOpenDir(fuse_req_t req, fuse_ino_t ino, struct fuse_file_in
     // You can't open a file with 'opendir'. Check for this.
     File *file = dynamic_cast<File *>(inode);
     if (file != nullptr) {
-        fuse_reply_err(req, ENOTDIR);
+        ReplyErr(req, ENOTDIR);
         return;
     }
 
     // TODO: Handle permissions on files:
     //    else if ((fi->flags & 3) != O_RDONLY)
-    //        fuse_reply_err(req, EACCES);
+    //        ReplyErr(req, EACCES);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\topendir for " << ino);
-    fuse_reply_open(req, fi);
+    ReplyOpen(req, fi);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Opening directory -> FuseRamFs::FuseOpenDir() completed!");
 }
@@ -1044,14 +1455,14 @@ void FileSystem::FuseReadDir(fuse_req_t req, fuse_ino_t ino, size_t size, off_t
     size_t numInodes = INodeManager->getNumberOfINodes();
     // TODO: Node may also be deleted.
     if (ino >= numInodes) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
     INode *inode = INodeManager->getINodeByINodeNumber(ino);
     Directory *dir = dynamic_cast<Directory *>(inode);
     if (dir == nullptr) {
-        fuse_reply_err(req, ENOTDIR);
+        ReplyErr(req, ENOTDIR);
         return;
     }
 
@@ -1062,7 +1473,7 @@ void FileSystem::FuseReadDir(fuse_req_t req, fuse_ino_t ino, size_t size, off_t
         //delete childIterator;
         // This is the case where we've been called after we've sent all the children. End
         // with an empty buffer.
-        fuse_reply_buf(req, NULL, 0);
+        ReplyBuf(req, NULL, 0);
         return;
     }
 
@@ -1154,7 +1565,7 @@ void FileSystem::FuseReadDir(fuse_req_t req, fuse_ino_t ino, size_t size, off_t
         }
     }
 
-    fuse_reply_buf(req, buf, bytesAdded);
+    ReplyBuf(req, buf, bytesAdded);
     if (buf) free(buf);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Reading directory -> FuseRamFs::FuseReadDir() completed!");
@@ -1167,7 +1578,7 @@ void FileSystem::FuseReleaseDir(fuse_req_t req, fuse_ino_t ino, struct fuse_file
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Closing directory -> FuseRamFs::ReleaseDir");
 
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -1176,16 +1587,16 @@ void FileSystem::FuseReleaseDir(fuse_req_t req, fuse_ino_t ino, struct fuse_file
     // You can't close a file with 'closedir'. Check for this.
     File *file = dynamic_cast<File *>(inode);
     if (file != nullptr) {
-        fuse_reply_err(req, ENOTDIR);
+        ReplyErr(req, ENOTDIR);
         return;
     }
 
     // TODO: Handle permissions on files:
     //    else if ((fi->flags & 3) != O_RDONLY)
-    //        fuse_reply_err(req, EACCES);
+    //        ReplyErr(req, EACCES);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\treleasedir for " << ino);
-    fuse_reply_err(req, 0);
+    ReplyErr(req, 0);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Closing directory -> FuseRamFs::ReleaseDir completed!");
 }
@@ -1197,12 +1608,12 @@ void FileSystem::FuseFsyncDir(fuse_req_t req, fuse_ino_t ino, int datasync, stru
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Synchronizing directory -> FuseRamFs::FuseFsyncDir");
 
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\tfysncdir for " << ino);
-    fuse_reply_err(req, 0);
+    ReplyErr(req, 0);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Synchronizing directory -> FuseRamFs::FuseFsyncDir completed");
 }
@@ -1214,13 +1625,13 @@ void FileSystem::FuseStatfs(fuse_req_t req, fuse_ino_t ino) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Getting FS information -> FuseRam::FuseStatfs");
     // TODO: Why were we given an inode? What do we do with it?
     //    if (ino >= Inodes.size()) {
-    //        fuse_reply_err(req, ENOENT);
+    //        ReplyErr(req, ENOENT);
     //        return;
     //    }
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\tstatfs for " << ino);
 
-    fuse_reply_statfs(req, &m_stbuf);
+    ReplyStatfs(req, &m_stbuf);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Getting FS information -> FuseRamFs::FuseStatfs completed");
 }
@@ -1234,7 +1645,7 @@ void FileSystem::FuseSetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name,
 {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Setting " << name << "attribute with value " << value <<" -> FuseRamFs::FuseSetXAttr");
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -1246,9 +1657,28 @@ void FileSystem::FuseSetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name,
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\tsetxattr for " << ino);
 
-    int ret_val = inode_p->SetXAttr(string(name), value, size, flags, position);
+    int ret_val = 0;
+    bool isLayout = DataLayout::isLayoutAttribute(name);
+    // The layout is applied only once the attribute is stored
+    DataLayout layout = inode_p->m_layout;
+    if (isLayout) {
+        // As in Lustre, the layout of a file can't change once the file has data
+        if (dynamic_cast<File *>(inode_p) != nullptr && inode_p->m_fuseEntryParam.attr.st_size > 0) {
+            ret_val = EBUSY;
+        }
+        else {
+            ret_val = layout.setAttribute(string(name), value, size, mpiWorldSize);
+        }
+    }
+
+    if (ret_val == 0) {
+        ret_val = inode_p->SetXAttr(string(name), value, size, flags, position);
+    }
+    if (ret_val == 0 && isLayout) {
+        inode_p->m_layout = layout;
+    }
 
-    fuse_reply_err(req, ret_val);
+    ReplyErr(req, ret_val);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Setting " << name << "attribute with value " << value <<" -> FuseRamFs::FuseSetXAttr completed");
 }
@@ -1261,7 +1691,7 @@ void FileSystem::FuseGetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name,
 {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Getting " << name << "attribute -> FuseRamFs::FuseSetXAttr");
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -1278,16 +1708,16 @@ void FileSystem::FuseGetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name,
     if (xattrs.find(name) == xattrs.end()) {
         LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() <<  "xattr named '"<< name << "' not found");
         #ifdef __APPLE__
-        fuse_reply_err(req, ENOATTR);
+        ReplyErr(req, ENOATTR);
         #else
-        fuse_reply_err(req, ENODATA);
+        ReplyErr(req, ENODATA);
         #endif
         return;
     }
 
     // The requestor wanted the size. TODO: How does position figure into this?
     if (size == 0) {
-        fuse_reply_xattr(req, xattrs[name].second);
+        ReplyXAttr(req, xattrs[name].second);
         return;
     }
 
@@ -1296,14 +1726,14 @@ void FileSystem::FuseGetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name,
 
     // TODO: Is this the case where "the size is to small for the value"?
     if (xattrs[name].second < newExtent) {
-        fuse_reply_err(req, ERANGE);
+        ReplyErr(req, ERANGE);
         return;
     }
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tGetting "<< name << "attribute -> INode::GetXAttrAndReply completed!");
 
     // TODO: It's fine for someone to just read part of a value, right (i.e. size is less than m_xattr[name].second)?
-    fuse_reply_buf(req, (char *) xattrs[name].first + position, size);
+    ReplyBuf(req, (char *) xattrs[name].first + position, size);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Getting " << name << "attribute -> FuseRamFs::FuseSetXAttr completed");
 }
@@ -1312,7 +1742,7 @@ void FileSystem::FuseListXAttr(fuse_req_t req, fuse_ino_t ino, size_t size) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Listing attributes -> FuseRamFs::FuseListXAttr");
 
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -1328,19 +1758,19 @@ void FileSystem::FuseListXAttr(fuse_req_t req, fuse_ino_t ino, size_t size) {
 
     // The requestor wanted the size
     if (size == 0) {
-        fuse_reply_xattr(req, listSize);
+        ReplyXAttr(req, listSize);
     }
 
     // "If the size is too small for the list, the ERANGE error should be sent"
     if (size < listSize) {
-        fuse_reply_err(req, ERANGE);
+        ReplyErr(req, ERANGE);
         return ; //A
     }
 
     // TODO: Is EIO really the best error to return if we ran out of memory?
     void *buf = malloc(listSize);
     if (buf == NULL) {
-        fuse_reply_err(req, EIO);
+        ReplyErr(req, EIO);
         return ; //A
     }
 
@@ -1351,7 +1781,7 @@ void FileSystem::FuseListXAttr(fuse_req_t req, fuse_ino_t ino, size_t size) {
         position += (it->first.size() + 1);
     }
 
-    fuse_reply_buf(req, (char *) buf, position);
+    ReplyBuf(req, (char *) buf, position);
     if (buf) free(buf);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tListing attributes -> INode::ListXAttrAndReply completed!");
@@ -1362,16 +1792,28 @@ void FileSystem::FuseListXAttr(fuse_req_t req, fuse_ino_t ino, size_t size) {
 void FileSystem::FuseRemoveXAttr(fuse_req_t req, fuse_ino_t ino, const char* name) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Removing " << name << "attribute -> FuseRamFs::FuseRemoveXAttr");
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
     INode *inode_p = INodeManager->getINodeByINodeNumber(ino);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tremovexattr for " << ino);
-    int ret_val = inode_p->RemoveXAttr(string(name));
+    int ret_val = 0;
+    bool isLayout = DataLayout::isLayoutAttribute(name);
+    // As for FuseSetXAttr, the layout of a file can't change once the file has data
+    if (isLayout && dynamic_cast<File *>(inode_p) != nullptr && inode_p->m_fuseEntryParam.attr.st_size > 0) {
+        ret_val = EBUSY;
+    }
+
+    if (ret_val == 0) {
+        ret_val = inode_p->RemoveXAttr(string(name));
+    }
+    if (ret_val == 0 && isLayout) {
+        inode_p->m_layout.resetAttribute(string(name));
+    }
 
-    fuse_reply_err(req,ret_val);
+    ReplyErr(req,ret_val);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Removing " << name << "attribute -> FuseRamFs::FuseRemoveXAttr completed!");
 }
@@ -1381,7 +1823,7 @@ void FileSystem::FuseAccess(fuse_req_t req, fuse_ino_t ino, int mask) {
 
     if (ino >= INodeManager->getNumberOfINodes()) {
         LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() <<  "\tino >= size");
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -1389,23 +1831,23 @@ void FileSystem::FuseAccess(fuse_req_t req, fuse_ino_t ino, int mask) {
 
     if (inode_p->isDeleted()) {
         LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() << "Deleted inode");
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
-    const struct fuse_ctx* ctx_p = fuse_req_ctx(req);
+    const struct fuse_ctx* ctx_p = RequestContext(req);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\taccess for " << ino);
 
     // If all the user wanted was to know if the file existed, it does.
     if (mask == F_OK) {
-        fuse_reply_err(req, 0);
+        ReplyErr(req, 0);
         return;
     }
 
     // Check other
     if ((inode_p->m_fuseEntryParam.attr.st_mode & mask) == mask) {
-        fuse_reply_err(req,0);
+        ReplyErr(req,0);
         return;
     }
     mask <<= 3;
@@ -1414,7 +1856,7 @@ void FileSystem::FuseAccess(fuse_req_t req, fuse_ino_t ino, int mask) {
     if ((inode_p->m_fuseEntryParam.attr.st_mode & mask) == mask) {
         // Go ahead if the user's main group is the same as the file's
         if (ctx_p->gid == inode_p->m_fuseEntryParam.attr.st_gid) {
-            fuse_reply_err(req,0);
+            ReplyErr(req,0);
             return;
         }
 
@@ -1426,11 +1868,11 @@ void FileSystem::FuseAccess(fuse_req_t req, fuse_ino_t ino, int mask) {
 
     // Check owner.
     if ((ctx_p->uid == inode_p->m_fuseEntryParam.attr.st_uid) && (inode_p->m_fuseEntryParam.attr.st_mode & mask) == mask) {
-        fuse_reply_err(req,0);
+        ReplyErr(req,0);
         return;
     }
 
-    fuse_reply_err(req, EACCES);
+    ReplyErr(req, EACCES);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Accessing -> FuseRamFs::FuseAccess completed!");
 }
@@ -1439,7 +1881,7 @@ void FileSystem::FuseCreate(fuse_req_t req, fuse_ino_t parent, const char* name,
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Creating " << name << " -> FuseRamFs::FuseCreate");
 
     if (parent >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -1447,23 +1889,24 @@ void FileSystem::FuseCreate(fuse_req_t req, fuse_ino_t parent, const char* name,
     Directory *parentDir_p = dynamic_cast<Directory *>(parent_p);
     if (parentDir_p == nullptr) {
         // The parent wasn't a directory. It can't have any children.
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
     string tmp_string = string(name);
     if (tmp_string.length() > kMaxFilenameLength) {
-        fuse_reply_err(req, ENAMETOOLONG);
+        ReplyErr(req, ENAMETOOLONG);
         return;
     }
 
-    const struct fuse_ctx* ctx_p = fuse_req_ctx(req);
+    const struct fuse_ctx* ctx_p = RequestContext(req);
 
     // TODO: It looks like, according to the documentation, that this will never be called to
     // make a dir--only a file. Test to make sure this is true.
     fuse_ino_t ino = RegisterINode(REGULAR_FILE, S_IFREG | 0777, 1, ctx_p->gid, ctx_p->uid);
     BlocksManager->createEmptyBlockListForInode(ino);
     INode *inode_p = INodeManager->getINodeByINodeNumber(ino);
+    InheritLayout(parentDir_p, inode_p);
 
     // Insert the inode into the directory. TODO: What if it already exists?
     parentDir_p->UpdateChild(string(name), ino);
@@ -1479,7 +1922,12 @@ void FileSystem::FuseCreate(fuse_req_t req, fuse_ino_t parent, const char* name,
             file_p->m_fuseEntryParam.attr.st_blocks = 0;
         }
     }
-    fuse_reply_create(req, &(inode_p->m_fuseEntryParam), fi);
+    //The other front ends keep the data of their handles
+    if (RemoteRequest::fromRequest(req) == nullptr) {
+        FileData *data;
+        fi->fh = OpenFileManager->open(ino, data);
+    }
+    ReplyCreate(req, &(inode_p->m_fuseEntryParam), fi);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Creating " << name << " -> FuseRamFs::FuseCreate completed!");
 
@@ -1489,7 +1937,7 @@ void FileSystem::FuseGetLock(fuse_req_t req, fuse_ino_t ino, struct fuse_file_in
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Getting the lock -> FuseRamFs::FuseGetLock");
 
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -1502,7 +1950,7 @@ void FileSystem::FuseGetLock(fuse_req_t req, fuse_ino_t ino, struct fuse_file_in
 }
 
 /**
- * The data of the inode (when it's a File inode) are stored in its member attribute "m_buf", since
+ * The data of the inode (when it's a File inode) are stored in the data shared by its open handles, since
  * the file system is in RAM.
  */
 void FileSystem::FuseRead(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off, struct fuse_file_info* fi) {
@@ -1510,77 +1958,85 @@ void FileSystem::FuseRead(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off
 
     // TODO: Node may also be deleted.
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
     INode *inode_p = INodeManager->getINodeByINodeNumber(ino);
 
-    // TODO: Handle info in fi.
-
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tread for " << size << " at " << off << " from " << ino);
 
     //Directory
     Directory *dir_p = dynamic_cast<Directory *>(inode_p);
     if (dir_p != nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     //SpecialINode
     SpecialINode *special_p = dynamic_cast<SpecialINode *>(inode_p);
     if (special_p != nullptr) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
     //SymbolicLink
     SymbolicLink *symlink_p = dynamic_cast<SymbolicLink *>(inode_p);
     if (symlink_p != nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     //File
     File *file_p = dynamic_cast<File *>(inode_p);
+    FileData *data = fi != nullptr ? OpenFileManager->getData(fi->fh) : nullptr;
+    if (data == nullptr) {
+        ReplyErr(req, EBADF);
+        return;
+    }
 
     // Don't start the read past our file size
     if (off > file_p->m_fuseEntryParam.attr.st_size) {
-        fuse_reply_buf(req, (const char *) file_p->m_buf, 0);
+        ReplyBuf(req, nullptr, 0);
+        return;
     }
 
     // Update access time. TODO: This could get very intensive. Some
     // filesystems buffer this with options at mount time. Look into this.
     // TODO: What do we do if this fails? Do we care? Log the event?
-    #ifdef __APPLE__
-    clock_gettime(CLOCK_REALTIME, &(m_fuseEntryParam.attr.st_atimespec));
-    #else
-    clock_gettime(CLOCK_REALTIME, &(file_p->m_fuseEntryParam.attr.st_atim));
-    #endif
+    {
+        lock_guard<mutex> atimeLock(m_atimeMutex);
+        #ifdef __APPLE__
+        clock_gettime(CLOCK_REALTIME, &(m_fuseEntryParam.attr.st_atimespec));
+        #else
+        clock_gettime(CLOCK_REALTIME, &(file_p->m_fuseEntryParam.attr.st_atim));
+        #endif
+    }
 
     // Handle reading past the file size as well as inside the size.
     size_t bytesRead = off + size > file_p->m_fuseEntryParam.attr.st_size ? file_p->m_fuseEntryParam.attr.st_size - off : size;
 
-    // TODO: There are all sorts of other replies. What about them?
-    fuse_reply_buf(req, (const char *) file_p->m_buf + off, bytesRead);
+    // The range can span several blocks of the file
+    vector<struct iovec> range = data->buffer.getRange(bytesRead, off);
+    ReplyIov(req, range.data(), range.size());
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Reading " << ino << " -> FuseRamFs::FuseRead completed!");
 }
 
 /**
- * The data will be written in the inode member attribute "m_buf", since the file system is in RAM.
+ * The data will be written in the data shared by the open handles of the inode, since the file system is in RAM.
  */
 void FileSystem::FuseWrite(fuse_req_t req, fuse_ino_t ino, const char* buf, size_t size, off_t off, struct fuse_file_info* fi) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Writing " << ino << " -> FuseRamFs::FuseWrite");
 
     // TODO: Fuse seems to have problems writing with a null (buf) buffer.
     if (buf == nullptr) {
-        fuse_reply_err(req, EPERM);
+        ReplyErr(req, EPERM);
         return;
     }
 
     // TODO: Node may also be deleted.
     if (ino >= INodeManager->getNumberOfINodes()) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
@@ -1588,58 +2044,52 @@ void FileSystem::FuseWrite(fuse_req_t req, fuse_ino_t ino, const char* buf, size
 
     Directory *dir_p = dynamic_cast<Directory *>(inode_p);
     if (dir_p != nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
     SymbolicLink *symlink_p = dynamic_cast<SymbolicLink *>(inode_p);
     if (symlink_p != nullptr) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
     SpecialINode *special_p = dynamic_cast<SpecialINode *>(inode_p);
     if (special_p != nullptr) {
-        fuse_reply_err(req, EISDIR);
+        ReplyErr(req, EISDIR);
         return;
     }
 
     File *file_p = dynamic_cast<File *>(inode_p);
     if (file_p == nullptr) {
-        fuse_reply_err(req, ENOENT);
+        ReplyErr(req, ENOENT);
         return;
     }
 
-    if (!file_p->isWaitingForWriting()) {
-        file_p->setWaiting();
+    FileData *data = fi != nullptr ? OpenFileManager->getData(fi->fh) : nullptr;
+    if (data == nullptr) {
+        ReplyErr(req, EBADF);
+        return;
     }
-
-    // TODO: Handle info in fi
+    data->dirty = true;
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tWrite request for " << size << " bytes at " << off << " to " << ino);
     //LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tcontent: '" << buf << "'");
 
-    //Allocate more memory if we don't have space.
+    //Add the missing blocks as holes, the ones already there are never moved.
     size_t newSize = off + size;
-    size_t originalCapacity = Nodes::INodeBufBlockSize * file_p->m_fuseEntryParam.attr.st_blocks;
-    if (newSize > originalCapacity) {
-        size_t newBlocks = newSize/Nodes::INodeBufBlockSize + (newSize % Nodes::INodeBufBlockSize != 0);
-        void *newBuf = realloc(file_p->m_buf, newBlocks * Nodes::INodeBufBlockSize);
-        // If we ran out of memory, let the caller know that no bytes were
-        // written.
-        if (newBuf == nullptr) {
-            fuse_reply_write(req, 0);
-        }
+    size_t newBlocks = newSize/Nodes::INodeBufBlockSize + (newSize % Nodes::INodeBufBlockSize != 0);
+    data->buffer.reserve(newBlocks);
 
-        // Update our buffer size
-        file_p->m_buf = newBuf;
+    // Write to the blocks. TODO: Check if SRC and DST overlap.
+    // If we ran out of memory, let the caller know that no bytes were
+    // written.
+    if (!data->buffer.write(buf, size, off)) {
+        ReplyWrite(req, 0);
+        return;
+    }
+    if (newBlocks > (size_t) file_p->m_fuseEntryParam.attr.st_blocks) {
         FileSystem::UpdateUsedBlocks(newBlocks - file_p->m_fuseEntryParam.attr.st_blocks);
         file_p->m_fuseEntryParam.attr.st_blocks = newBlocks;
     }
-
-    // Write to the buffer. TODO: Check if SRC and DST overlap.
-    // We assume that there can be no buffer overflow since realloc has already
-    // been called with the new size and offset. If realloc failed, we wouldn't
-    // be here.
-    memcpy((char *) file_p->m_buf + off, buf, size);
     if (newSize > file_p->m_fuseEntryParam.attr.st_size) {
         file_p->m_fuseEntryParam.attr.st_size = newSize;
     }
@@ -1654,7 +2104,64 @@ void FileSystem::FuseWrite(fuse_req_t req, fuse_ino_t ino, const char* buf, size
     file_p->m_fuseEntryParam.attr.st_mtim = file_p->m_fuseEntryParam.attr.st_ctim;
     #endif
 
-    fuse_reply_write(req, size);
+    ReplyWrite(req, size);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Writing " << ino << " -> FuseRamFs::FuseWrite completed!");
 }
+
+/**
+ * The holes are found in the blocks of the open file, or in the block map when the handle has no data. The blocks of
+ * zeros are holes too, since they're never stored. Only the kernel seeks in the files, the other front ends keep
+ * the offsets of their files.
+ */
+void FileSystem::FuseLseek(fuse_req_t req, fuse_ino_t ino, off_t off, int whence, struct fuse_file_info *fi) {
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Seeking " << ino << " -> FuseRamFs::FuseLseek");
+
+    if (ino >= INodeManager->getNumberOfINodes()) {
+        ReplyErr(req, ENOENT);
+        return;
+    }
+
+    File *file_p = dynamic_cast<File *>(INodeManager->getINodeByINodeNumber(ino));
+    if (file_p == nullptr || (whence != SEEK_DATA && whence != SEEK_HOLE)) {
+        ReplyErr(req, EINVAL);
+        return;
+    }
+
+    off_t fileSize = file_p->m_fuseEntryParam.attr.st_size;
+    if (off < 0 || off >= fileSize) {
+        ReplyErr(req, ENXIO);
+        return;
+    }
+
+    FileData *data = fi != nullptr ? OpenFileManager->getData(fi->fh) : nullptr;
+    vector<DataBlock *> *dataBlockList = nullptr;
+    if (data == nullptr && BlocksManager->blockListExistForInode(ino)) {
+        dataBlockList = &BlocksManager->getDataBlockListOfInode(ino);
+    }
+
+    //The end of the file is a hole
+    off_t found = fileSize;
+    size_t nblocks = fileSize / Nodes::INodeBufBlockSize + (fileSize % Nodes::INodeBufBlockSize != 0);
+    for (size_t block = off / Nodes::INodeBufBlockSize; block < nblocks; block++) {
+        bool hole;
+        if (data != nullptr) {
+            hole = block >= data->buffer.getNumberOfBlocks() || data->buffer.isHole(block);
+        }
+        else {
+            hole = dataBlockList == nullptr || block >= dataBlockList->size() || (*dataBlockList)[block]->isHole();
+        }
+        if (hole == (whence == SEEK_HOLE)) {
+            found = max(off, (off_t) (block * Nodes::INodeBufBlockSize));
+            break;
+        }
+    }
+
+    if (whence == SEEK_DATA && found == fileSize) {
+        ReplyErr(req, ENXIO);
+        return;
+    }
+
+    fuse_reply_lseek(req, found);
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tlseek for " << ino << " from " << off << " to " << found);
+}
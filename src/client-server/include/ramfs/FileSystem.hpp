@@ -9,10 +9,14 @@
 #ifndef FILESYSTEM_HPP
 #define FILESYSTEM_HPP
 
+#include <mutex>
+#include <shared_mutex>
+
 #include "../utils/fuse_headers.hpp"
 #include "../nodes/Nodes.hpp"
 
 #include "../blocks/Blocks.hpp"
+#include "OpenFiles.hpp"
 #include "../mpi/MasterProcessCode.hpp"
 
 #include "../utils/log_level.hpp"
@@ -74,12 +78,45 @@ private:
 
     static Blocks *BlocksManager;
 
+    /**
+     * The open handles of the files and their shared data
+     */
+    static OpenFiles *OpenFileManager;
+
     static MasterProcessCode *MasterProcess;
 
     static log4cplus::Logger FSLogger;
 
     static int mpiWorldSize;
 
+    static int mpiRank;
+
+    /**
+     * Held while a request of the kernel or of another front end is processed, the metadata is shared by both.
+     * The reads of the handler pool hold it shared.
+     */
+    static std::shared_mutex m_metadataMutex;
+
+    /**
+     * Serializes the updates of the access times made by the reads running together in the handler pool.
+     */
+    static std::mutex m_atimeMutex;
+
+    /**
+     * The operations called by the wrappers of the handler pool.
+     */
+    static struct fuse_lowlevel_ops m_lockedOperations;
+
+    /**
+     * The seconds the kernel remembers that a name doesn't exist (-o negative_timeout), 0 disables the negative entries.
+     */
+    static double m_negativeTimeout;
+
+    /**
+     * True if the kernel accepts backing files (FUSE passthrough) for the files stored entirely by the master.
+     */
+    static bool m_passthrough;
+
     //Methods
     /**
      * @brief Show the usage of the program.
@@ -88,6 +125,72 @@ private:
     */
     void show_usage(const char *progname);
 
+    /**
+     * @brief Reply to a lookup of a name which doesn't exist, with a negative entry if they are enabled.
+     *
+     * @param req The FUSE request.
+     */
+    static void ReplyNegativeEntry(fuse_req_t req);
+
+    /**
+     * @brief Process the requests of the kernel until the file system is unmounted.
+     *
+     * @param session The FUSE session.
+     * @return The same value of fuse_session_loop().
+     */
+    static int SessionLoop(fuse_session *session);
+
+    /**
+     * @brief Process the requests of the kernel with a pool of threads, each with its own queue, until the file system is unmounted.
+     *
+     * The requests are received and replied in parallel, the handlers still hold the metadata lock (see LockOperations()).
+     * The threads are started on demand, the pool isn't bounded.
+     *
+     * @param session The FUSE session, with the locked operations.
+     * @param queues The maximum number of idle threads.
+     * @return The same value of fuse_session_loop_mt().
+     */
+    static int SessionLoopMT(fuse_session *session, unsigned int queues);
+
+    /**
+     * @brief Replace the operations with wrappers holding the metadata lock, before the session is created.
+     *
+     * The reads hold it shared, so they run together, every other operation holds it exclusively.
+     */
+    static void LockOperations(struct fuse_lowlevel_ops &operations);
+
+    template <auto Operation, typename... Args>
+    static void ExclusiveOperation(fuse_req_t req, Args... args) {
+        std::lock_guard<std::shared_mutex> lock(m_metadataMutex);
+        (m_lockedOperations.*Operation)(req, args...);
+    }
+
+    template <auto Operation, typename... Args>
+    static void SharedOperation(fuse_req_t req, Args... args) {
+        std::shared_lock<std::shared_mutex> lock(m_metadataMutex);
+        (m_lockedOperations.*Operation)(req, args...);
+    }
+
+    //  Replies
+    //The same as the fuse_reply_* functions, the replies to another front end are recorded in its RemoteRequest
+    static int ReplyErr(fuse_req_t req, int err);
+    static void ReplyNone(fuse_req_t req);
+    static int ReplyEntry(fuse_req_t req, const struct fuse_entry_param *e);
+    static int ReplyCreate(fuse_req_t req, const struct fuse_entry_param *e, const struct fuse_file_info *fi);
+    static int ReplyAttr(fuse_req_t req, const struct stat *attr, double attr_timeout);
+    static int ReplyReadLink(fuse_req_t req, const char *link);
+    static int ReplyOpen(fuse_req_t req, const struct fuse_file_info *fi);
+    static int ReplyWrite(fuse_req_t req, size_t count);
+    static int ReplyBuf(fuse_req_t req, const char *buf, size_t size);
+    static int ReplyIov(fuse_req_t req, const struct iovec *iov, int count);
+    static int ReplyStatfs(fuse_req_t req, const struct statvfs *stbuf);
+    static int ReplyXAttr(fuse_req_t req, size_t count);
+
+    /**
+     * @brief The same as fuse_req_ctx(), the context of a request of another front end is the one of its caller.
+     */
+    static const struct fuse_ctx *RequestContext(fuse_req_t req);
+
     /**
      * @brief Create a new i-node and insert it into the ram file system.
      *
@@ -99,6 +202,27 @@ private:
      * @return The i-node number of the new i-node.
      */
     static fuse_ino_t RegisterINode(INodeType type, mode_t mode, nlink_t nlink, gid_t gid, uid_t uid);
+
+    /**
+     * @brief Copy the layout policy (and its extended attributes) of a directory into a new child.
+     *
+     * @param parent The parent directory.
+     * @param child The new i-node.
+     */
+    static void InheritLayout(INode *parent, INode *child);
+
+    /**
+     * @brief Pass a read only open through to the memfd of the file, if the master stores the whole file.
+     *
+     * The backing file is registered at the first open and shared by the next ones, until the file changes.
+     *
+     * @param req The FUSE request.
+     * @param ino The inode of the file.
+     * @param file_p The file.
+     * @param fi The file info, its backing id is set.
+     * @return TRUE if the reads of this open don't reach the file system.
+     */
+    static bool OpenPassthrough(fuse_req_t req, fuse_ino_t ino, File *file_p, struct fuse_file_info *fi);
 public:
     //Attributes
     /**
@@ -120,6 +244,11 @@ public:
 
     static int getMpiWorldSize() { return mpiWorldSize; }
 
+    /**
+     * @brief Get the lock of the metadata, the requests of the other front ends are processed holding it.
+     */
+    static std::shared_mutex &getMetadataMutex() { return m_metadataMutex; }
+
     /**
      * @brief Ram file system Stating method.
      *
@@ -443,6 +572,17 @@ public:
      */
     static void FuseWrite(fuse_req_t req, fuse_ino_t ino, const char *buf, size_t size, off_t off, struct fuse_file_info *fi);
 
+    /**
+     * @brief Find the next hole or the next data of a file (SEEK_HOLE/SEEK_DATA).
+     *
+     * @param req The FUSE request.
+     * @param ino The inode.
+     * @param off The offset to start from.
+     * @param whence SEEK_HOLE or SEEK_DATA, the other kinds of seek are done by the kernel.
+     * @param fi The file information (information of an open file).
+     */
+    static void FuseLseek(fuse_req_t req, fuse_ino_t ino, off_t off, int whence, struct fuse_file_info *fi);
+
     /**
      * @brief Update the number of used blocks decrementing the number of the free blocks
      *
@@ -0,0 +1,334 @@
+//
+// Created on 10/19/26.
+//
+
+#include "FrontEnd.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+#include "../mpi/NodeTopology.hpp"
+#include "../mpi/DataBlockManager.hpp"
+
+using namespace std;
+
+FrontEnd *FrontEnd::instance = nullptr;
+
+FrontEnd *FrontEnd::getInstance(int rank, int mpi_world_size) {
+	if (instance == nullptr) {
+		instance = new FrontEnd(rank, mpi_world_size);
+	}
+
+	return instance;
+}
+
+FrontEnd::FrontEnd(int rank, int mpi_world_size)
+	: RemoteStore(NodeTopology::getInstance(rank, mpi_world_size)->getFrontEndComm(), mpi_world_size,
+	              DataBlockManager::getInstance(mpi_world_size)->getFirstStorageRank()) {
+}
+
+void FrontEnd::setOperations(struct fuse_lowlevel_ops &operations) {
+	operations.lookup      = FrontEnd::FuseLookup;
+	operations.forget      = FrontEnd::FuseForget;
+	operations.getattr     = FrontEnd::FuseGetAttr;
+	operations.setattr     = FrontEnd::FuseSetAttr;
+	operations.readlink    = FrontEnd::FuseReadLink;
+	operations.mknod       = FrontEnd::FuseMknod;
+	operations.mkdir       = FrontEnd::FuseMkdir;
+	operations.unlink      = FrontEnd::FuseUnlink;
+	operations.rmdir       = FrontEnd::FuseRmdir;
+	operations.symlink     = FrontEnd::FuseSymlink;
+	operations.rename      = FrontEnd::FuseRename;
+	operations.link        = FrontEnd::FuseLink;
+	operations.open        = FrontEnd::FuseOpen;
+	operations.read        = FrontEnd::FuseRead;
+	operations.write       = FrontEnd::FuseWrite;
+	operations.flush       = FrontEnd::FuseFlush;
+	operations.release     = FrontEnd::FuseRelease;
+	operations.fsync       = FrontEnd::FuseFsync;
+	operations.opendir     = FrontEnd::FuseOpenDir;
+	operations.readdir     = FrontEnd::FuseReadDir;
+	operations.releasedir  = FrontEnd::FuseReleaseDir;
+	operations.fsyncdir    = FrontEnd::FuseFsyncDir;
+	operations.statfs      = FrontEnd::FuseStatfs;
+	operations.setxattr    = FrontEnd::FuseSetXAttr;
+	operations.getxattr    = FrontEnd::FuseGetXAttr;
+	operations.listxattr   = FrontEnd::FuseListXAttr;
+	operations.removexattr = FrontEnd::FuseRemoveXAttr;
+	operations.access      = FrontEnd::FuseAccess;
+	operations.create      = FrontEnd::FuseCreate;
+}
+
+MetadataRequestPacket FrontEnd::newRequest(fuse_req_t req, MetadataOperation operation, fuse_ino_t ino) {
+	MetadataRequestPacket packet{};
+	packet.operation = operation;
+	packet.ino = ino;
+	packet.context = *fuse_req_ctx(req);
+	return packet;
+}
+
+void FrontEnd::forward(fuse_req_t req, MetadataRequestPacket &packet, const char *name, const char *secondName, const void *value, size_t valueBytes, struct fuse_file_info *fi) {
+	vector<char> reply = call(packet, name, secondName, value, valueBytes);
+	replay(req, packet.ino, reply, fi);
+}
+
+void FrontEnd::replay(fuse_req_t req, fuse_ino_t ino, vector<char> &reply, struct fuse_file_info *fi) {
+	MetadataReplyPacket *packet = (MetadataReplyPacket *) reply.data();
+	const char *payload = reply.data() + sizeof(MetadataReplyPacket);
+
+	switch (packet->type) {
+		case REPLY_ERR:
+			fuse_reply_err(req, packet->error);
+			break;
+		case REPLY_NONE:
+			fuse_reply_none(req);
+			break;
+		case REPLY_ENTRY:
+			patchSize(packet->entry.ino, &packet->entry.attr);
+			fuse_reply_entry(req, &packet->entry);
+			break;
+		case REPLY_CREATE:
+			fuse_reply_create(req, &packet->entry, fi);
+			break;
+		case REPLY_ATTR:
+			patchSize(ino, &packet->entry.attr);
+			fuse_reply_attr(req, &packet->entry.attr, packet->entry.attr_timeout);
+			break;
+		case REPLY_READLINK:
+			fuse_reply_readlink(req, payload);
+			break;
+		case REPLY_OPEN:
+			fuse_reply_open(req, fi);
+			break;
+		case REPLY_WRITE:
+			fuse_reply_write(req, packet->count);
+			break;
+		case REPLY_BUF:
+			fuse_reply_buf(req, payload, packet->count);
+			break;
+		case REPLY_STATFS:
+			fuse_reply_statfs(req, &packet->statfs);
+			break;
+		case REPLY_XATTR:
+			fuse_reply_xattr(req, packet->count);
+			break;
+		default:
+			fuse_reply_err(req, EIO);
+			break;
+	}
+}
+
+void FrontEnd::FuseLookup(fuse_req_t req, fuse_ino_t parent, const char *name) {
+	MetadataRequestPacket packet = instance->newRequest(req, LOOKUP, parent);
+	instance->forward(req, packet, name);
+}
+
+void FrontEnd::FuseForget(fuse_req_t req, fuse_ino_t ino, unsigned long nlookup) {
+	MetadataRequestPacket packet = instance->newRequest(req, FORGET, ino);
+	packet.nlookup = nlookup;
+	instance->forward(req, packet);
+}
+
+void FrontEnd::FuseGetAttr(fuse_req_t req, fuse_ino_t ino, [[maybe_unused]] struct fuse_file_info *fi) {
+	MetadataRequestPacket packet = instance->newRequest(req, GETATTR, ino);
+	instance->forward(req, packet);
+}
+
+/**
+ * A truncation of an open file changes its data here too.
+ */
+void FrontEnd::FuseSetAttr(fuse_req_t req, fuse_ino_t ino, struct stat *attr, int to_set, [[maybe_unused]] struct fuse_file_info *fi) {
+	if (to_set & FUSE_SET_ATTR_SIZE) {
+		int err = instance->resizeFile(ino, attr->st_size);
+		if (err != 0) {
+			fuse_reply_err(req, err);
+			return;
+		}
+	}
+
+	MetadataRequestPacket packet = instance->newRequest(req, SETATTR, ino);
+	packet.attr = *attr;
+	packet.toSet = to_set;
+	instance->forward(req, packet);
+}
+
+void FrontEnd::FuseReadLink(fuse_req_t req, fuse_ino_t ino) {
+	MetadataRequestPacket packet = instance->newRequest(req, READLINK, ino);
+	instance->forward(req, packet);
+}
+
+void FrontEnd::FuseMknod(fuse_req_t req, fuse_ino_t parent, const char *name, mode_t mode, dev_t rdev) {
+	MetadataRequestPacket packet = instance->newRequest(req, MKNOD, parent);
+	packet.mode = mode;
+	packet.rdev = rdev;
+	instance->forward(req, packet, name);
+}
+
+void FrontEnd::FuseMkdir(fuse_req_t req, fuse_ino_t parent, const char *name, mode_t mode) {
+	MetadataRequestPacket packet = instance->newRequest(req, MKDIR, parent);
+	packet.mode = mode;
+	instance->forward(req, packet, name);
+}
+
+void FrontEnd::FuseUnlink(fuse_req_t req, fuse_ino_t parent, const char *name) {
+	MetadataRequestPacket packet = instance->newRequest(req, UNLINK, parent);
+	instance->forward(req, packet, name);
+}
+
+void FrontEnd::FuseRmdir(fuse_req_t req, fuse_ino_t parent, const char *name) {
+	MetadataRequestPacket packet = instance->newRequest(req, RMDIR, parent);
+	instance->forward(req, packet, name);
+}
+
+void FrontEnd::FuseSymlink(fuse_req_t req, const char *link, fuse_ino_t parent, const char *name) {
+	MetadataRequestPacket packet = instance->newRequest(req, SYMLINK, parent);
+	instance->forward(req, packet, link, name);
+}
+
+void FrontEnd::FuseRename(fuse_req_t req, fuse_ino_t parent, const char *name, fuse_ino_t newparent, const char *newname, unsigned int flags) {
+	MetadataRequestPacket packet = instance->newRequest(req, RENAME, parent);
+	packet.newparent = newparent;
+	packet.flags = flags;
+	instance->forward(req, packet, name, newname);
+}
+
+void FrontEnd::FuseLink(fuse_req_t req, fuse_ino_t ino, fuse_ino_t newparent, const char *newname) {
+	MetadataRequestPacket packet = instance->newRequest(req, LINK, ino);
+	packet.newparent = newparent;
+	instance->forward(req, packet, newname);
+}
+
+void FrontEnd::FuseOpen(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi) {
+	MetadataRequestPacket packet = instance->newRequest(req, OPEN_BLOCKS, ino);
+	packet.flags = fi->flags;
+	int err = instance->openFile(packet);
+	if (err != 0) {
+		fuse_reply_err(req, err);
+		return;
+	}
+
+	fuse_reply_open(req, fi);
+}
+
+void FrontEnd::FuseFlush(fuse_req_t req, fuse_ino_t ino, [[maybe_unused]] struct fuse_file_info *fi) {
+	fuse_reply_err(req, instance->flushFile(ino));
+}
+
+void FrontEnd::FuseRelease(fuse_req_t req, fuse_ino_t ino, [[maybe_unused]] struct fuse_file_info *fi) {
+	instance->releaseFile(ino);
+	fuse_reply_err(req, 0);
+}
+
+void FrontEnd::FuseFsync(fuse_req_t req, fuse_ino_t ino, [[maybe_unused]] int datasync, struct fuse_file_info *fi) {
+	FuseFlush(req, ino, fi);
+}
+
+void FrontEnd::FuseOpenDir(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi) {
+	MetadataRequestPacket packet = instance->newRequest(req, OPENDIR, ino);
+	packet.flags = fi->flags;
+	instance->forward(req, packet, nullptr, nullptr, nullptr, 0, fi);
+}
+
+void FrontEnd::FuseReadDir(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off, [[maybe_unused]] struct fuse_file_info *fi) {
+	MetadataRequestPacket packet = instance->newRequest(req, READDIR, ino);
+	packet.size = size;
+	packet.offset = off;
+	instance->forward(req, packet);
+}
+
+void FrontEnd::FuseReleaseDir(fuse_req_t req, fuse_ino_t ino, [[maybe_unused]] struct fuse_file_info *fi) {
+	MetadataRequestPacket packet = instance->newRequest(req, RELEASEDIR, ino);
+	instance->forward(req, packet);
+}
+
+void FrontEnd::FuseFsyncDir(fuse_req_t req, fuse_ino_t ino, int datasync, [[maybe_unused]] struct fuse_file_info *fi) {
+	MetadataRequestPacket packet = instance->newRequest(req, FSYNCDIR, ino);
+	packet.flags = datasync;
+	instance->forward(req, packet);
+}
+
+void FrontEnd::FuseStatfs(fuse_req_t req, fuse_ino_t ino) {
+	MetadataRequestPacket packet = instance->newRequest(req, STATFS, ino);
+	instance->forward(req, packet);
+}
+
+#ifdef __APPLE__
+void FrontEnd::FuseSetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name, const char *value, size_t size, int flags, uint32_t position)
+#else
+void FrontEnd::FuseSetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name, const char *value, size_t size, int flags)
+#endif
+{
+	MetadataRequestPacket packet = instance->newRequest(req, SETXATTR, ino);
+	packet.size = size;
+	packet.flags = flags;
+	instance->forward(req, packet, name, nullptr, value, size);
+}
+
+#ifdef __APPLE__
+void FrontEnd::FuseGetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name, size_t size, uint32_t position)
+#else
+void FrontEnd::FuseGetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name, size_t size)
+#endif
+{
+	MetadataRequestPacket packet = instance->newRequest(req, GETXATTR, ino);
+	packet.size = size;
+	instance->forward(req, packet, name);
+}
+
+void FrontEnd::FuseListXAttr(fuse_req_t req, fuse_ino_t ino, size_t size) {
+	MetadataRequestPacket packet = instance->newRequest(req, LISTXATTR, ino);
+	packet.size = size;
+	instance->forward(req, packet);
+}
+
+void FrontEnd::FuseRemoveXAttr(fuse_req_t req, fuse_ino_t ino, const char *name) {
+	MetadataRequestPacket packet = instance->newRequest(req, REMOVEXATTR, ino);
+	instance->forward(req, packet, name);
+}
+
+void FrontEnd::FuseAccess(fuse_req_t req, fuse_ino_t ino, int mask) {
+	MetadataRequestPacket packet = instance->newRequest(req, ACCESS, ino);
+	packet.flags = mask;
+	instance->forward(req, packet);
+}
+
+void FrontEnd::FuseCreate(fuse_req_t req, fuse_ino_t parent, const char *name, mode_t mode, struct fuse_file_info *fi) {
+	MetadataRequestPacket packet = instance->newRequest(req, CREATE, parent);
+	packet.mode = mode;
+	packet.flags = fi->flags;
+	vector<char> reply = instance->call(packet, name, nullptr, nullptr, 0);
+	MetadataReplyPacket *replyPacket = (MetadataReplyPacket *) reply.data();
+	if (replyPacket->type == REPLY_CREATE) {
+		instance->addCreatedFile(replyPacket->entry.ino, replyPacket->layout);
+	}
+
+	instance->replay(req, parent, reply, fi);
+}
+
+void FrontEnd::FuseRead(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off, [[maybe_unused]] struct fuse_file_info *fi) {
+	auto file_it = instance->openFiles.find(ino);
+	if (file_it == instance->openFiles.end()) {
+		fuse_reply_err(req, EBADF);
+		return;
+	}
+
+	OpenFile &file = file_it->second;
+	if ((size_t) off >= file.size) {
+		fuse_reply_buf(req, nullptr, 0);
+		return;
+	}
+
+	//The range can span several blocks of the file
+	vector<struct iovec> range = file.buffer.getRange(min(size, file.size - off), off);
+	fuse_reply_iov(req, range.data(), range.size());
+}
+
+void FrontEnd::FuseWrite(fuse_req_t req, fuse_ino_t ino, const char *buf, size_t size, off_t off, [[maybe_unused]] struct fuse_file_info *fi) {
+	int err = instance->writeFile(ino, buf, size, off);
+	if (err != 0) {
+		fuse_reply_err(req, err);
+		return;
+	}
+
+	fuse_reply_write(req, size);
+}
@@ -0,0 +1,87 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef FRONTEND_HPP
+#define FRONTEND_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "RemoteStore.hpp"
+
+using namespace std;
+
+/**
+ * @brief The FUSE operations of a front end other than the master (DAGONFS_FRONT_ENDS=n).
+ *
+ * The metadata operations are forwarded to the master, which executes them with its own handlers and
+ * sends back their replies. The data of an open file is kept by the front end (see RemoteStore).
+ *
+ * The files are consistent at open and close, as with NFS: the changes made through a front end are
+ * seen by the others when the file is closed there and opened again here, after the kernel caches of
+ * the attributes expire. Locks aren't forwarded, so they're local to each front end.
+ */
+class FrontEnd : public RemoteStore {
+private:
+	//Singleton implementation
+	static FrontEnd* instance;
+	FrontEnd(int rank, int mpi_world_size);
+
+	MetadataRequestPacket newRequest(fuse_req_t req, MetadataOperation operation, fuse_ino_t ino);
+
+	/**
+	 * @brief Send a request to the master and forward its reply to the kernel.
+	 */
+	void forward(fuse_req_t req, MetadataRequestPacket &packet, const char *name = nullptr, const char *secondName = nullptr,
+	             const void *value = nullptr, size_t valueBytes = 0, struct fuse_file_info *fi = nullptr);
+	void replay(fuse_req_t req, fuse_ino_t ino, vector<char> &reply, struct fuse_file_info *fi);
+
+public:
+	static FrontEnd *getInstance(int rank, int mpi_world_size);
+
+	/**
+	 * @brief Fill the FUSE operations of the session of this front end.
+	 */
+	void setOperations(struct fuse_lowlevel_ops &operations);
+
+	//  FS operations, with the same arguments of the ones of FileSystem
+	static void FuseLookup(fuse_req_t req, fuse_ino_t parent, const char *name);
+	static void FuseForget(fuse_req_t req, fuse_ino_t ino, unsigned long nlookup);
+	static void FuseGetAttr(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi);
+	static void FuseSetAttr(fuse_req_t req, fuse_ino_t ino, struct stat *attr, int to_set, struct fuse_file_info *fi);
+	static void FuseReadLink(fuse_req_t req, fuse_ino_t ino);
+	static void FuseMknod(fuse_req_t req, fuse_ino_t parent, const char *name, mode_t mode, dev_t rdev);
+	static void FuseMkdir(fuse_req_t req, fuse_ino_t parent, const char *name, mode_t mode);
+	static void FuseUnlink(fuse_req_t req, fuse_ino_t parent, const char *name);
+	static void FuseRmdir(fuse_req_t req, fuse_ino_t parent, const char *name);
+	static void FuseSymlink(fuse_req_t req, const char *link, fuse_ino_t parent, const char *name);
+	static void FuseRename(fuse_req_t req, fuse_ino_t parent, const char *name, fuse_ino_t newparent, const char *newname, unsigned int flags);
+	static void FuseLink(fuse_req_t req, fuse_ino_t ino, fuse_ino_t newparent, const char *newname);
+	static void FuseOpen(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi);
+	static void FuseFlush(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi);
+	static void FuseRelease(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi);
+	static void FuseFsync(fuse_req_t req, fuse_ino_t ino, int datasync, struct fuse_file_info *fi);
+	static void FuseOpenDir(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi);
+	static void FuseReadDir(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off, struct fuse_file_info *fi);
+	static void FuseReleaseDir(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi);
+	static void FuseFsyncDir(fuse_req_t req, fuse_ino_t ino, int datasync, struct fuse_file_info *fi);
+	static void FuseStatfs(fuse_req_t req, fuse_ino_t ino);
+	#ifdef __APPLE__
+	static void FuseSetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name, const char *value, size_t size, int flags, uint32_t position);
+	static void FuseGetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name, size_t size, uint32_t position);
+	#else
+	static void FuseSetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name, const char *value, size_t size, int flags);
+	static void FuseGetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name, size_t size);
+	#endif
+	static void FuseListXAttr(fuse_req_t req, fuse_ino_t ino, size_t size);
+	static void FuseRemoveXAttr(fuse_req_t req, fuse_ino_t ino, const char *name);
+	static void FuseAccess(fuse_req_t req, fuse_ino_t ino, int mask);
+	static void FuseCreate(fuse_req_t req, fuse_ino_t parent, const char *name, mode_t mode, struct fuse_file_info *fi);
+	static void FuseRead(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off, struct fuse_file_info *fi);
+	static void FuseWrite(fuse_req_t req, fuse_ino_t ino, const char *buf, size_t size, off_t off, struct fuse_file_info *fi);
+};
+
+
+
+#endif //FRONTEND_HPP
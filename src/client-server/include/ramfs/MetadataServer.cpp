@@ -0,0 +1,281 @@
+//
+// Created on 10/19/26.
+//
+
+#include "MetadataServer.hpp"
+
+#include <vector>
+#include <mutex>
+#include <cstring>
+#include <fcntl.h>
+
+#include "FileSystem.hpp"
+#include "../blocks/Blocks.hpp"
+#include "../mpi/BlockDistribution.hpp"
+#include "../mpi/LocalFilePool.hpp"
+#include "../mpi/DedupIndex.hpp"
+
+using namespace std;
+
+using namespace log4cplus;
+
+MetadataServer *MetadataServer::instance = nullptr;
+
+MetadataServer *MetadataServer::getInstance(int rank, int mpi_world_size) {
+	if (instance == nullptr) {
+		instance = new MetadataServer(rank, mpi_world_size);
+	}
+
+	return instance;
+}
+
+MetadataServer::MetadataServer(int rank, int mpi_world_size) {
+	this->rank = rank;
+	this->mpi_world_size = mpi_world_size;
+	nodeTopology = NodeTopology::getInstance(rank, mpi_world_size);
+	dataBlockManager = DataBlockManager::getInstance(mpi_world_size);
+	blockReleaseQueue = BlockReleaseQueue::getInstance(rank, mpi_world_size);
+	attachedFrontEnds = nodeTopology->getFrontEnds().size() - 1 + nodeTopology->getNumberOfClients();
+
+	MetadataServerLogger = Logger::getInstance("MetadataServer.logger - ");
+	LogLevel ll = DAGONFS_LOG_LEVEL;
+	MetadataServerLogger.setLogLevel(ll);
+}
+
+void MetadataServer::start() {
+	if (!server.joinable()) {
+		server = thread(&MetadataServer::serve, this);
+	}
+}
+
+void MetadataServer::join() {
+	if (server.joinable()) {
+		server.join();
+	}
+}
+
+void MetadataServer::serve() {
+	MPI_Comm frontEndComm = nodeTopology->getFrontEndComm();
+	LOG4CPLUS_INFO(MetadataServerLogger, MetadataServerLogger.getName() << "Serving " << attachedFrontEnds << " front ends");
+
+	while (attachedFrontEnds > 0) {
+		MPI_Message message;
+		MPI_Status status;
+		int bytes;
+		MPI_Mprobe(MPI_ANY_SOURCE, METADATA_REQUEST_TAG, frontEndComm, &message, &status);
+		MPI_Get_count(&status, MPI_BYTE, &bytes);
+		//The payload is followed by two null characters, so a request without names has two empty names
+		vector<char> request(bytes + 2, 0);
+		MPI_Mrecv(request.data(), bytes, MPI_BYTE, &message, MPI_STATUS_IGNORE);
+
+		MetadataRequestPacket packet;
+		memcpy(&packet, request.data(), sizeof(packet));
+		RemoteRequest remote(packet.context);
+		{
+			lock_guard<shared_mutex> lock(FileSystem::getMetadataMutex());
+			execute(remote, packet, request.data() + sizeof(packet));
+		}
+		vector<char> &reply = remote.getReply();
+		MPI_Send(reply.data(), reply.size(), MPI_BYTE, status.MPI_SOURCE, METADATA_REPLY_TAG, frontEndComm);
+	}
+
+	LOG4CPLUS_INFO(MetadataServerLogger, MetadataServerLogger.getName() << "Every front end has been unmounted");
+}
+
+/**
+ * The names follow the arguments terminated by a null character, in the order of the arguments of the handler, and the
+ * value of an extended attribute follows its name.
+ */
+void MetadataServer::execute(RemoteRequest &remote, MetadataRequestPacket &packet, const char *payload) {
+	fuse_req_t req = remote.getRequest();
+	const char *name = payload;
+	const char *secondName = payload + strlen(payload) + 1;
+	struct fuse_file_info fi;
+	memset(&fi, 0, sizeof(fi));
+	fi.flags = packet.flags;
+
+	switch (packet.operation) {
+		case LOOKUP:
+			FileSystem::FuseLookup(req, packet.ino, name);
+			break;
+		case FORGET:
+			FileSystem::FuseForget(req, packet.ino, packet.nlookup);
+			break;
+		case GETATTR:
+			FileSystem::FuseGetAttr(req, packet.ino, nullptr);
+			break;
+		case SETATTR:
+			FileSystem::FuseSetAttr(req, packet.ino, &packet.attr, packet.toSet, nullptr);
+			break;
+		case READLINK:
+			FileSystem::FuseReadLink(req, packet.ino);
+			break;
+		case MKNOD:
+			FileSystem::FuseMknod(req, packet.ino, name, packet.mode, packet.rdev);
+			break;
+		case MKDIR:
+			FileSystem::FuseMkdir(req, packet.ino, name, packet.mode);
+			break;
+		case UNLINK:
+			FileSystem::FuseUnlink(req, packet.ino, name);
+			break;
+		case RMDIR:
+			FileSystem::FuseRmdir(req, packet.ino, name);
+			break;
+		case SYMLINK:
+			FileSystem::FuseSymlink(req, name, packet.ino, secondName);
+			break;
+		case RENAME:
+			FileSystem::FuseRename(req, packet.ino, name, packet.newparent, secondName, packet.flags);
+			break;
+		case LINK:
+			FileSystem::FuseLink(req, packet.ino, packet.newparent, name);
+			break;
+		case OPENDIR:
+			FileSystem::FuseOpenDir(req, packet.ino, &fi);
+			break;
+		case READDIR:
+			FileSystem::FuseReadDir(req, packet.ino, packet.size, packet.offset, &fi);
+			break;
+		case RELEASEDIR:
+			FileSystem::FuseReleaseDir(req, packet.ino, &fi);
+			break;
+		case FSYNCDIR:
+			FileSystem::FuseFsyncDir(req, packet.ino, packet.flags, &fi);
+			break;
+		case STATFS:
+			FileSystem::FuseStatfs(req, packet.ino);
+			break;
+		case SETXATTR:
+			#ifdef __APPLE__
+			FileSystem::FuseSetXAttr(req, packet.ino, name, secondName, packet.size, packet.flags, 0);
+			#else
+			FileSystem::FuseSetXAttr(req, packet.ino, name, secondName, packet.size, packet.flags);
+			#endif
+			break;
+		case GETXATTR:
+			#ifdef __APPLE__
+			FileSystem::FuseGetXAttr(req, packet.ino, name, packet.size, 0);
+			#else
+			FileSystem::FuseGetXAttr(req, packet.ino, name, packet.size);
+			#endif
+			break;
+		case LISTXATTR:
+			FileSystem::FuseListXAttr(req, packet.ino, packet.size);
+			break;
+		case REMOVEXATTR:
+			FileSystem::FuseRemoveXAttr(req, packet.ino, name);
+			break;
+		case ACCESS:
+			FileSystem::FuseAccess(req, packet.ino, packet.flags);
+			break;
+		case CREATE:
+			FileSystem::FuseCreate(req, packet.ino, name, packet.mode, &fi);
+			//The front end needs the layout inherited from the parent for placing the blocks
+			if (remote.getReplyPacket()->type == REPLY_CREATE) {
+				remote.getReplyPacket()->layout = Nodes::getInstance()->getINodeByINodeNumber(remote.getReplyPacket()->entry.ino)->m_layout;
+			}
+			break;
+		case OPEN_BLOCKS:
+			openBlocks(remote, packet);
+			break;
+		case COMMIT_BLOCKS:
+			commitBlocks(remote, packet, (const PointerPacket *) payload);
+			break;
+		case UNPIN_BLOCKS:
+			blockReleaseQueue->unpin();
+			remote.replyErr(0);
+			break;
+		case DETACH:
+			attachedFrontEnds--;
+			remote.replyErr(0);
+			break;
+		default:
+			remote.replyErr(ENOSYS);
+			break;
+	}
+}
+
+void MetadataServer::openBlocks(RemoteRequest &remote, MetadataRequestPacket &packet) {
+	Nodes *nodes = Nodes::getInstance();
+	if (packet.ino >= (fuse_ino_t) nodes->getNumberOfINodes()) {
+		remote.replyErr(ENOENT);
+		return;
+	}
+
+	INode *inode = nodes->getINodeByINodeNumber(packet.ino);
+	if (dynamic_cast<Directory *>(inode) != nullptr) {
+		remote.replyErr(EISDIR);
+		return;
+	}
+	File *file_p = dynamic_cast<File *>(inode);
+	if (file_p == nullptr) {
+		remote.replyErr(EPERM);
+		return;
+	}
+
+	if (packet.flags & (O_WRONLY | O_TRUNC)) {
+		file_p->m_fuseEntryParam.attr.st_size = 0;
+		file_p->m_fuseEntryParam.attr.st_blocks = 0;
+	}
+
+	size_t fileSize = file_p->m_fuseEntryParam.attr.st_size;
+	size_t nblocks = fileSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (fileSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
+	Blocks *blocks = Blocks::getInstance();
+	if (nblocks > 0 && (!blocks->blockListExistForInode(packet.ino) || blocks->getDataBlockListOfInode(packet.ino).size() < nblocks)) {
+		LOG4CPLUS_ERROR(MetadataServerLogger, MetadataServerLogger.getName() << "inode " << packet.ino << " has fewer blocks than its size");
+		remote.replyErr(EIO);
+		return;
+	}
+
+	remote.replyEntry(&file_p->m_fuseEntryParam);
+	remote.getReplyPacket()->layout = file_p->m_layout;
+	vector<BlockLocationPacket> locations(nblocks);
+	if (nblocks > 0) {
+		vector<DataBlock *> &dataBlockList = blocks->getDataBlockListOfInode(packet.ino);
+		for (size_t i=0; i < nblocks; i++) {
+			locations[i].address = dataBlockList[i]->getData();
+			locations[i].rank = dataBlockList[i]->getRank();
+		}
+	}
+	remote.appendPayload(locations.data(), nblocks * sizeof(BlockLocationPacket));
+	remote.getReplyPacket()->count = nblocks;
+	//The front end reads the blocks after this reply, a write must not release them before it's done
+	if (nblocks > 0) {
+		blockReleaseQueue->pin();
+	}
+}
+
+void MetadataServer::commitBlocks(RemoteRequest &remote, MetadataRequestPacket &packet, const PointerPacket *addresses) {
+	Nodes *nodes = Nodes::getInstance();
+	if (packet.ino >= (fuse_ino_t) nodes->getNumberOfINodes()) {
+		remote.replyErr(ENOENT);
+		return;
+	}
+	File *file_p = dynamic_cast<File *>(nodes->getINodeByINodeNumber(packet.ino));
+	if (file_p == nullptr) {
+		remote.replyErr(EPERM);
+		return;
+	}
+
+	//The storage processes keep the blocks of the previous version until the new one is committed and no front end
+	//is reading them, the reads of the master and of the other front ends may still use them
+	blockReleaseQueue->addBlocksOfInode(packet.ino);
+
+	//The front end placed the blocks with the same distribution of the collective writes
+	size_t nblocks = packet.size / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (packet.size % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
+	BlockDistribution distribution(packet.layout, nblocks, mpi_world_size, dataBlockManager->getFirstStorageRank());
+	dataBlockManager->setBlocksOfInode(packet.ino, addresses, nblocks, distribution);
+	blockReleaseQueue->flush();
+	LocalFilePool::getInstance()->release(packet.ino);
+	//The blocks of the front ends aren't deduplicated, the new version uses no indexed block
+	DedupIndex::getInstance(mpi_world_size)->setReferences(packet.ino, vector<pair<int, Fingerprint> >());
+
+	FileSystem::UpdateUsedBlocks(nblocks - file_p->m_fuseEntryParam.attr.st_blocks);
+	file_p->m_fuseEntryParam.attr.st_blocks = nblocks;
+	file_p->m_fuseEntryParam.attr.st_size = packet.size;
+	clock_gettime(CLOCK_REALTIME, &(file_p->m_fuseEntryParam.attr.st_ctim));
+	file_p->m_fuseEntryParam.attr.st_mtim = file_p->m_fuseEntryParam.attr.st_ctim;
+
+	remote.replyErr(0);
+}
@@ -0,0 +1,87 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef METADATASERVER_HPP
+#define METADATASERVER_HPP
+
+#include <mpi.h>
+#include <thread>
+#include <cstddef>
+
+#include "RemoteRequest.hpp"
+#include "../mpi/NodeTopology.hpp"
+#include "../mpi/DataBlockManager.hpp"
+#include "../mpi/BlockReleaseQueue.hpp"
+#include "../utils/log_level.hpp"
+
+using namespace std;
+
+/**
+ * @brief The thread of the master serving the metadata requests of the other front ends and of the clients.
+ *
+ * A request is executed by the same FUSE handler of a request of the kernel, holding the metadata
+ * lock, and its reply is sent back to the front end. The data of the files doesn't pass through the
+ * master: a front end gets from it where the blocks of a file are when the file is opened, and tells
+ * it where the new blocks are after writing them to the storage processes.
+ */
+class MetadataServer {
+private:
+	//Singleton implementation
+	static MetadataServer* instance;
+	MetadataServer(int rank, int mpi_world_size);
+
+	int rank;
+	int mpi_world_size;
+	thread server;
+	//The front ends, other than the master, and the clients which haven't detached yet
+	int attachedFrontEnds;
+
+	NodeTopology *nodeTopology;
+	DataBlockManager *dataBlockManager;
+	BlockReleaseQueue *blockReleaseQueue;
+	log4cplus::Logger MetadataServerLogger;
+
+	void serve();
+
+	/**
+	 * @brief Execute a request of a front end, recording its reply.
+	 *
+	 * @param remote The request.
+	 * @param packet The arguments of the request.
+	 * @param payload The names, the value or the pointers following the arguments.
+	 */
+	void execute(RemoteRequest &remote, MetadataRequestPacket &packet, const char *payload);
+
+	/**
+	 * @brief Open a file for a front end, truncating it as FileSystem::FuseOpen() does.
+	 *
+	 * The reply carries the attributes and the layout of the file, followed by the location of each block. The blocks
+	 * are pinned until the front end sends UNPIN_BLOCKS.
+	 */
+	void openBlocks(RemoteRequest &remote, MetadataRequestPacket &packet);
+
+	/**
+	 * @brief Save the blocks of a file written by a front end, and update its size.
+	 *
+	 * @param addresses The address of each block in its storage process, in file order.
+	 */
+	void commitBlocks(RemoteRequest &remote, MetadataRequestPacket &packet, const PointerPacket *addresses);
+
+public:
+	static MetadataServer *getInstance(int rank, int mpi_world_size);
+
+	/**
+	 * @brief Start serving the other front ends.
+	 */
+	void start();
+
+	/**
+	 * @brief Wait until every other front end is unmounted, it returns immediately if the server isn't started.
+	 */
+	void join();
+};
+
+
+
+#endif //METADATASERVER_HPP
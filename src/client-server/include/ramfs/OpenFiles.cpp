@@ -0,0 +1,57 @@
+//
+// Created on 10/19/26.
+//
+
+#include "OpenFiles.hpp"
+
+using namespace std;
+
+OpenFiles *OpenFiles::instance = nullptr;
+
+OpenFiles *OpenFiles::getInstance() {
+	if (instance == nullptr) {
+		instance = new OpenFiles();
+	}
+
+	return instance;
+}
+
+OpenFiles::OpenFiles() {
+	nextHandle = 1;
+}
+
+FileData *OpenFiles::find(fuse_ino_t ino) {
+	auto file_it = files.find(ino);
+	return file_it == files.end() ? nullptr : &file_it->second;
+}
+
+uint64_t OpenFiles::open(fuse_ino_t ino, FileData *&data) {
+	data = &files[ino];
+	if (data->opens == 0) {
+		data->dirty = false;
+	}
+	data->opens++;
+
+	uint64_t handle = nextHandle++;
+	handles[handle] = ino;
+	return handle;
+}
+
+FileData *OpenFiles::getData(uint64_t handle) {
+	auto handle_it = handles.find(handle);
+	return handle_it == handles.end() ? nullptr : find(handle_it->second);
+}
+
+void OpenFiles::release(uint64_t handle) {
+	auto handle_it = handles.find(handle);
+	if (handle_it == handles.end()) {
+		return;
+	}
+
+	auto file_it = files.find(handle_it->second);
+	if (--file_it->second.opens == 0) {
+		file_it->second.buffer.clear();
+		files.erase(file_it);
+	}
+	handles.erase(handle_it);
+}
@@ -0,0 +1,78 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef OPENFILES_HPP
+#define OPENFILES_HPP
+
+#include <map>
+#include <cstdint>
+
+#include "../utils/fuse_headers.hpp"
+#include "FileBuffer.hpp"
+
+using namespace std;
+
+/**
+ * @brief The data of a file open on the master, shared by all its handles.
+ */
+typedef struct FileData {
+	FileBuffer buffer;
+	//Written through a handle and not yet written to the storage processes
+	bool dirty;
+	int opens;
+} FileData;
+
+/**
+ * @brief The open handles of the files of the master, the values of fi->fh.
+ *
+ * The data of a file is read from the storage processes by its first open, the next opens share it
+ * without another transfer, and it's freed when the last of its handles is released. The handle 0 is
+ * never used, it marks the opens which don't need the data.
+ */
+class OpenFiles {
+private:
+	//Singleton implementation
+	static OpenFiles* instance;
+	OpenFiles();
+
+	map<fuse_ino_t, FileData> files;
+	//The inode of each handle
+	map<uint64_t, fuse_ino_t> handles;
+	uint64_t nextHandle;
+
+public:
+	static OpenFiles* getInstance();
+
+	/**
+	 * @brief Get the data of a file, if it's open.
+	 *
+	 * @return The data, nullptr if the file has no handles.
+	 */
+	FileData *find(fuse_ino_t ino);
+
+	/**
+	 * @brief Add a handle of a file, creating its data (with no blocks) if it's the first one.
+	 *
+	 * @param ino The inode of the file.
+	 * @param data Set to the data of the file.
+	 * @return The new handle.
+	 */
+	uint64_t open(fuse_ino_t ino, FileData *&data);
+
+	/**
+	 * @brief Get the data of the file of a handle.
+	 *
+	 * @return The data, nullptr if the handle isn't open.
+	 */
+	FileData *getData(uint64_t handle);
+
+	/**
+	 * @brief Drop a handle, the data of its file is freed with the last one.
+	 */
+	void release(uint64_t handle);
+};
+
+
+
+#endif //OPENFILES_HPP
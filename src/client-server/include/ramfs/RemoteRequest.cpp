@@ -0,0 +1,101 @@
+//
+// Created on 10/19/26.
+//
+
+#include "RemoteRequest.hpp"
+
+#include <cstring>
+
+using namespace std;
+
+thread_local RemoteRequest *RemoteRequest::current = nullptr;
+
+RemoteRequest::RemoteRequest(const struct fuse_ctx &context) {
+	this->context = context;
+	//Until the handler replies
+	setReply(REPLY_NONE, nullptr, 0);
+}
+
+RemoteRequest::~RemoteRequest() {
+	if (current == this) {
+		current = nullptr;
+	}
+}
+
+fuse_req_t RemoteRequest::getRequest() {
+	current = this;
+	return (fuse_req_t) this;
+}
+
+RemoteRequest *RemoteRequest::fromRequest(fuse_req_t req) {
+	if (current == nullptr || req != (fuse_req_t) current) {
+		return nullptr;
+	}
+
+	return current;
+}
+
+void RemoteRequest::setReply(ReplyType type, const void *payload, size_t payloadBytes) {
+	reply.assign(sizeof(MetadataReplyPacket), 0);
+	getReplyPacket()->type = type;
+	getReplyPacket()->count = payloadBytes;
+	appendPayload(payload, payloadBytes);
+}
+
+void RemoteRequest::appendPayload(const void *payload, size_t payloadBytes) {
+	if (payloadBytes > 0) {
+		reply.insert(reply.end(), (const char *) payload, (const char *) payload + payloadBytes);
+	}
+}
+
+void RemoteRequest::replyErr(int err) {
+	setReply(REPLY_ERR, nullptr, 0);
+	getReplyPacket()->error = err;
+}
+
+void RemoteRequest::replyNone() {
+	setReply(REPLY_NONE, nullptr, 0);
+}
+
+void RemoteRequest::replyEntry(const struct fuse_entry_param *e) {
+	setReply(REPLY_ENTRY, nullptr, 0);
+	getReplyPacket()->entry = *e;
+}
+
+void RemoteRequest::replyCreate(const struct fuse_entry_param *e) {
+	setReply(REPLY_CREATE, nullptr, 0);
+	getReplyPacket()->entry = *e;
+}
+
+void RemoteRequest::replyAttr(const struct stat *attr, double attr_timeout) {
+	setReply(REPLY_ATTR, nullptr, 0);
+	getReplyPacket()->entry.attr = *attr;
+	getReplyPacket()->entry.attr_timeout = attr_timeout;
+}
+
+void RemoteRequest::replyReadLink(const char *link) {
+	setReply(REPLY_READLINK, link, strlen(link) + 1);
+}
+
+void RemoteRequest::replyOpen() {
+	setReply(REPLY_OPEN, nullptr, 0);
+}
+
+void RemoteRequest::replyWrite(size_t count) {
+	setReply(REPLY_WRITE, nullptr, 0);
+	getReplyPacket()->count = count;
+}
+
+void RemoteRequest::replyBuf(const char *buf, size_t size) {
+	setReply(REPLY_BUF, buf, size);
+}
+
+void RemoteRequest::replyStatfs(const struct statvfs *stbuf) {
+	setReply(REPLY_STATFS, nullptr, 0);
+	getReplyPacket()->statfs = *stbuf;
+}
+
+void RemoteRequest::replyXAttr(size_t count) {
+	setReply(REPLY_XATTR, nullptr, 0);
+	getReplyPacket()->count = count;
+}
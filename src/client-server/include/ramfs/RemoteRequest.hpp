@@ -0,0 +1,76 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef REMOTEREQUEST_HPP
+#define REMOTEREQUEST_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "../utils/fuse_headers.hpp"
+#include "../mpi/mpi_data.hpp"
+
+using namespace std;
+
+/**
+ * @brief A request of another front end, executed by the FUSE handlers of the master.
+ *
+ * The handlers receive it as a fuse_req_t and reply through the Reply* methods of FileSystem, which
+ * record the reply in the request instead of sending it to the kernel. The reply is sent back to the
+ * front end, which forwards it to its own kernel.
+ */
+class RemoteRequest {
+private:
+	//The request whose handler is running in this thread
+	static thread_local RemoteRequest *current;
+
+	struct fuse_ctx context;
+	//The reply packet followed by its payload
+	vector<char> reply;
+
+	void setReply(ReplyType type, const void *payload, size_t payloadBytes);
+
+public:
+	RemoteRequest(const struct fuse_ctx &context);
+	~RemoteRequest();
+
+	/**
+	 * @brief Get the request to pass to a FUSE handler, it can be used only by this thread.
+	 */
+	fuse_req_t getRequest();
+
+	/**
+	 * @brief Get the remote request behind a FUSE request.
+	 *
+	 * @return The remote request, nullptr if the request comes from the kernel.
+	 */
+	static RemoteRequest *fromRequest(fuse_req_t req);
+
+	const struct fuse_ctx *getContext() { return &context; }
+
+	MetadataReplyPacket *getReplyPacket() { return (MetadataReplyPacket *) reply.data(); }
+	vector<char> &getReply() { return reply; }
+
+	/**
+	 * @brief Append data after the reply packet.
+	 */
+	void appendPayload(const void *payload, size_t payloadBytes);
+
+	//The replies of the handlers, with the arguments of the fuse_reply_* functions
+	void replyErr(int err);
+	void replyNone();
+	void replyEntry(const struct fuse_entry_param *e);
+	void replyCreate(const struct fuse_entry_param *e);
+	void replyAttr(const struct stat *attr, double attr_timeout);
+	void replyReadLink(const char *link);
+	void replyOpen();
+	void replyWrite(size_t count);
+	void replyBuf(const char *buf, size_t size);
+	void replyStatfs(const struct statvfs *stbuf);
+	void replyXAttr(size_t count);
+};
+
+
+
+#endif //REMOTEREQUEST_HPP
@@ -0,0 +1,315 @@
+//
+// Created on 10/19/26.
+//
+
+#include "RemoteStore.hpp"
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <fcntl.h>
+
+#include "../mpi/BlockDistribution.hpp"
+
+using namespace std;
+
+using namespace log4cplus;
+
+RemoteStore::RemoteStore(MPI_Comm frontEndComm, int mpi_world_size, int firstStorageRank) {
+	this->frontEndComm = frontEndComm;
+	this->mpi_world_size = mpi_world_size;
+	this->firstStorageRank = firstStorageRank;
+	MPI_Type_contiguous(FILE_SYSTEM_SINGLE_BLOCK_SIZE, MPI_BYTE, &blockType);
+	MPI_Type_commit(&blockType);
+
+	int rank;
+	MPI_Comm_rank(frontEndComm, &rank);
+	RemoteStoreLogger = Logger::getInstance("RemoteStore.logger Process " + to_string(rank) + " - ");
+	LogLevel ll = DAGONFS_LOG_LEVEL;
+	RemoteStoreLogger.setLogLevel(ll);
+}
+
+void RemoteStore::detach() {
+	MetadataRequestPacket packet{};
+	packet.operation = DETACH;
+	call(packet, nullptr, nullptr, nullptr, 0);
+	LOG4CPLUS_INFO(RemoteStoreLogger, RemoteStoreLogger.getName() << "Detached from the master");
+}
+
+vector<char> RemoteStore::call(MetadataRequestPacket &packet, const char *name, const char *secondName, const void *value, size_t valueBytes) {
+	vector<char> request((char *) &packet, (char *) &packet + sizeof(packet));
+	if (name != nullptr) {
+		request.insert(request.end(), name, name + strlen(name) + 1);
+	}
+	if (secondName != nullptr) {
+		request.insert(request.end(), secondName, secondName + strlen(secondName) + 1);
+	}
+	if (valueBytes > 0) {
+		request.insert(request.end(), (const char *) value, (const char *) value + valueBytes);
+	}
+	MPI_Send(request.data(), request.size(), MPI_BYTE, 0, METADATA_REQUEST_TAG, frontEndComm);
+
+	MPI_Status status;
+	int bytes;
+	MPI_Probe(0, METADATA_REPLY_TAG, frontEndComm, &status);
+	MPI_Get_count(&status, MPI_BYTE, &bytes);
+	vector<char> reply(bytes);
+	MPI_Recv(reply.data(), bytes, MPI_BYTE, 0, METADATA_REPLY_TAG, frontEndComm, MPI_STATUS_IGNORE);
+	return reply;
+}
+
+void RemoteStore::patchSize(fuse_ino_t ino, struct stat *attr) {
+	auto file_it = openFiles.find(ino);
+	if (file_it != openFiles.end() && file_it->second.dirty) {
+		attr->st_size = file_it->second.size;
+		attr->st_blocks = file_it->second.buffer.getNumberOfBlocks();
+	}
+}
+
+
+/**
+ * The master checks the file and truncates it, as for its own open(). The data is read only by the first open of the
+ * file through this process, the others share it. The master pins the blocks of the reply until they're unpinned here,
+ * so they aren't released while they're read.
+ */
+int RemoteStore::openFile(MetadataRequestPacket &packet) {
+	vector<char> reply = call(packet, nullptr, nullptr, nullptr, 0);
+	MetadataReplyPacket *replyPacket = (MetadataReplyPacket *) reply.data();
+	if (replyPacket->type == REPLY_ERR) {
+		return replyPacket->error;
+	}
+
+	fuse_ino_t ino = packet.ino;
+	OpenFile &file = openFiles[ino];
+	int err = 0;
+	if (file.opens == 0) {
+		file.size = replyPacket->entry.attr.st_size;
+		file.layout = replyPacket->layout;
+		file.dirty = false;
+		err = readBlocks(ino, file, (const BlockLocationPacket *) (reply.data() + sizeof(MetadataReplyPacket)), replyPacket->count);
+	}
+	if (replyPacket->count > 0) {
+		MetadataRequestPacket unpinPacket{};
+		unpinPacket.operation = UNPIN_BLOCKS;
+		unpinPacket.ino = ino;
+		unpinPacket.context = packet.context;
+		call(unpinPacket, nullptr, nullptr, nullptr, 0);
+	}
+	if (err != 0) {
+		file.buffer.clear();
+		openFiles.erase(ino);
+		return err;
+	}
+
+	if (file.opens > 0 && (packet.flags & (O_WRONLY | O_TRUNC))) {
+		//The handles still open share the old content, it's dropped with the size
+		file.buffer.clear();
+		file.size = 0;
+		file.dirty = true;
+	}
+	file.opens++;
+
+	LOG4CPLUS_TRACE(RemoteStoreLogger, RemoteStoreLogger.getName() << "open for " << ino << " with flags " << packet.flags << ", " << file.size << " bytes");
+	return 0;
+}
+
+void RemoteStore::addCreatedFile(fuse_ino_t ino, const DataLayout &layout) {
+	OpenFile &file = openFiles[ino];
+	if (file.opens == 0) {
+		file.size = 0;
+		file.layout = layout;
+		file.dirty = false;
+	}
+	file.opens++;
+}
+
+int RemoteStore::writeFile(fuse_ino_t ino, const char *buf, size_t size, off_t off) {
+	auto file_it = openFiles.find(ino);
+	if (file_it == openFiles.end()) {
+		return EBADF;
+	}
+
+	OpenFile &file = file_it->second;
+	size_t end = off + size;
+	file.buffer.reserve(end / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (end % FILE_SYSTEM_SINGLE_BLOCK_SIZE != 0));
+	if (!file.buffer.write(buf, size, off)) {
+		return ENOMEM;
+	}
+
+	file.size = max(file.size, off + size);
+	file.dirty = true;
+	return 0;
+}
+
+int RemoteStore::resizeFile(fuse_ino_t ino, size_t size) {
+	auto file_it = openFiles.find(ino);
+	if (file_it == openFiles.end()) {
+		return 0;
+	}
+
+	//The blocks added by an extension are holes, the part cut by a truncate is zeroed for a later extension
+	OpenFile &file = file_it->second;
+	file.buffer.reserve(size / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (size % FILE_SYSTEM_SINGLE_BLOCK_SIZE != 0));
+	if (size < file.size) {
+		file.buffer.zero(file.size - size, size);
+	}
+	file.size = size;
+	file.dirty = true;
+	return 0;
+}
+
+int RemoteStore::flushFile(fuse_ino_t ino) {
+	auto file_it = openFiles.find(ino);
+	if (file_it == openFiles.end() || !file_it->second.dirty) {
+		return 0;
+	}
+
+	return writeBlocks(ino, file_it->second);
+}
+
+void RemoteStore::releaseFile(fuse_ino_t ino) {
+	auto file_it = openFiles.find(ino);
+	if (file_it != openFiles.end() && --file_it->second.opens == 0) {
+		file_it->second.buffer.clear();
+		openFiles.erase(file_it);
+	}
+}
+
+/**
+ * Every storage process sends its blocks in a single message, received in place with an indexed datatype, or an empty
+ * message if it doesn't store one of them anymore. The blocks are received in a buffer of adjacent blocks adopted by the
+ * file, where the holes are zeros.
+ */
+int RemoteStore::readBlocks(fuse_ino_t ino, OpenFile &file, const BlockLocationPacket *locations, size_t nblocks) {
+	size_t fileBlocks = file.size / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (file.size % FILE_SYSTEM_SINGLE_BLOCK_SIZE != 0);
+	if (nblocks == 0) {
+		file.buffer.reserve(fileBlocks);
+		return 0;
+	}
+	char *buf = (char *) calloc(nblocks, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+	if (buf == nullptr) {
+		return ENOMEM;
+	}
+
+	vector<vector<int> > indices(mpi_world_size);
+	vector<vector<PointerPacket> > addresses(mpi_world_size);
+	for (size_t i=0; i < nblocks; i++) {
+		if (locations[i].address == nullptr) {
+			continue;
+		}
+		indices[locations[i].rank].push_back(i);
+		addresses[locations[i].rank].push_back({locations[i].address});
+	}
+
+	vector<BlockRequestPacket> headers(mpi_world_size);
+	vector<MPI_Request> requests;
+	//The position of the receive of each storage process among the requests
+	vector<size_t> receives;
+	for (int i=0; i < mpi_world_size; i++) {
+		if (indices[i].empty()) {
+			continue;
+		}
+
+		headers[i].type = READ_BLOCKS;
+		headers[i].inode = ino;
+		headers[i].nblocks = indices[i].size();
+		requests.push_back(MPI_REQUEST_NULL);
+		MPI_Isend(&headers[i], sizeof(BlockRequestPacket), MPI_BYTE, i, BLOCK_REQUEST_TAG, frontEndComm, &requests.back());
+		requests.push_back(MPI_REQUEST_NULL);
+		MPI_Isend(addresses[i].data(), addresses[i].size() * sizeof(PointerPacket), MPI_BYTE, i, BLOCK_DATA_TAG, frontEndComm, &requests.back());
+
+		MPI_Datatype blocksType;
+		MPI_Type_create_indexed_block(indices[i].size(), 1, indices[i].data(), blockType, &blocksType);
+		MPI_Type_commit(&blocksType);
+		receives.push_back(requests.size());
+		requests.push_back(MPI_REQUEST_NULL);
+		MPI_Irecv(buf, 1, blocksType, i, BLOCK_REPLY_TAG, frontEndComm, &requests.back());
+		MPI_Type_free(&blocksType);
+	}
+	vector<MPI_Status> statuses(requests.size());
+	MPI_Waitall(requests.size(), requests.data(), statuses.data());
+
+	for (size_t receive : receives) {
+		int bytes;
+		MPI_Get_count(&statuses[receive], MPI_BYTE, &bytes);
+		if (bytes == 0) {
+			LOG4CPLUS_ERROR(RemoteStoreLogger, RemoteStoreLogger.getName() << "process " << statuses[receive].MPI_SOURCE << " doesn't store the blocks of inode " << ino << " anymore");
+			free(buf);
+			return EIO;
+		}
+	}
+
+	file.buffer.adopt(buf, nblocks);
+	file.buffer.reserve(fileBlocks);
+	return 0;
+}
+
+/**
+ * The blocks are placed as the collective write does, so the master can read them with the collective read too.
+ * Every storage process gets a request, also without blocks, so it releases the blocks of the previous version.
+ * The blocks of zeros are holes, they aren't sent and the master records them without an address. The other blocks
+ * aren't adjacent in the buffer, they're sent from their addresses.
+ */
+int RemoteStore::writeBlocks(fuse_ino_t ino, OpenFile &file) {
+	size_t nblocks = file.size / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (file.size % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
+	BlockDistribution distribution(file.layout, nblocks, mpi_world_size, firstStorageRank);
+	vector<vector<int> > indices(mpi_world_size);
+	for (size_t i=0; i < nblocks; i++) {
+		if (file.buffer.isHole(i)) {
+			continue;
+		}
+		indices[distribution.getRankOfBlock(i)].push_back(i);
+	}
+
+	void *const *blocks = file.buffer.getBlocks();
+	vector<BlockRequestPacket> headers(mpi_world_size);
+	vector<vector<PointerPacket> > addresses(mpi_world_size);
+	vector<MPI_Request> requests;
+	for (int i=firstStorageRank; i < mpi_world_size; i++) {
+		headers[i].type = WRITE_BLOCKS;
+		headers[i].inode = ino;
+		headers[i].nblocks = indices[i].size();
+		headers[i].compression = file.layout.compression;
+		requests.push_back(MPI_REQUEST_NULL);
+		MPI_Isend(&headers[i], sizeof(BlockRequestPacket), MPI_BYTE, i, BLOCK_REQUEST_TAG, frontEndComm, &requests.back());
+
+		if (!indices[i].empty()) {
+			vector<MPI_Aint> displacements(indices[i].size());
+			for (size_t j=0; j < indices[i].size(); j++) {
+				MPI_Get_address(blocks[indices[i][j]], &displacements[j]);
+			}
+			MPI_Datatype blocksType;
+			MPI_Type_create_hindexed_block(displacements.size(), 1, displacements.data(), blockType, &blocksType);
+			MPI_Type_commit(&blocksType);
+			requests.push_back(MPI_REQUEST_NULL);
+			MPI_Isend(MPI_BOTTOM, 1, blocksType, i, BLOCK_DATA_TAG, frontEndComm, &requests.back());
+			MPI_Type_free(&blocksType);
+		}
+
+		addresses[i].resize(indices[i].size());
+		requests.push_back(MPI_REQUEST_NULL);
+		MPI_Irecv(addresses[i].data(), addresses[i].size() * sizeof(PointerPacket), MPI_BYTE, i, BLOCK_REPLY_TAG, frontEndComm, &requests.back());
+	}
+	MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+
+	vector<PointerPacket> fileOrderAddresses(nblocks);
+	for (int i=firstStorageRank; i < mpi_world_size; i++) {
+		for (size_t j=0; j < indices[i].size(); j++) {
+			fileOrderAddresses[indices[i][j]] = addresses[i][j];
+		}
+	}
+
+	MetadataRequestPacket packet{};
+	packet.operation = COMMIT_BLOCKS;
+	packet.ino = ino;
+	packet.size = file.size;
+	packet.layout = file.layout;
+	vector<char> reply = call(packet, nullptr, nullptr, fileOrderAddresses.data(), nblocks * sizeof(PointerPacket));
+	MetadataReplyPacket *replyPacket = (MetadataReplyPacket *) reply.data();
+	if (replyPacket->error == 0) {
+		file.dirty = false;
+	}
+
+	LOG4CPLUS_DEBUG(RemoteStoreLogger, RemoteStoreLogger.getName() << "Written " << nblocks << " blocks of inode " << ino);
+	return replyPacket->error;
+}
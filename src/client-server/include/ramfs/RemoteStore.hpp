@@ -0,0 +1,135 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef REMOTESTORE_HPP
+#define REMOTESTORE_HPP
+
+#include <mpi.h>
+#include <map>
+#include <vector>
+#include <cstddef>
+
+#include "../utils/fuse_headers.hpp"
+#include "../mpi/mpi_data.hpp"
+#include "../utils/log_level.hpp"
+#include "FileBuffer.hpp"
+
+using namespace std;
+
+/**
+ * @brief The files of a process using DAGonFS without being its master: a front end or a client.
+ *
+ * The metadata requests are sent to the master. The data of an open file is kept here: it's read from
+ * the storage processes when the file is opened, and written to them when the file is flushed, with
+ * point to point messages, so the data of different processes moves in parallel. The master is told
+ * where the new blocks are, and the blocks of the previous version are released by the storage processes.
+ */
+class RemoteStore {
+protected:
+	int mpi_world_size;
+	int firstStorageRank;
+	MPI_Comm frontEndComm;
+	MPI_Datatype blockType;
+
+	//The data of a file opened through this process, shared by its open handles
+	typedef struct OpenFile {
+		FileBuffer buffer;
+		size_t size;
+		DataLayout layout;
+		bool dirty;
+		int opens;
+	} OpenFile;
+	map<fuse_ino_t, OpenFile> openFiles;
+
+	log4cplus::Logger RemoteStoreLogger;
+
+	/**
+	 * @param frontEndComm The communicator of the requests to the master and to the storage processes.
+	 * @param mpi_world_size The number of processes of DAGonFS.
+	 * @param firstStorageRank The lowest rank storing blocks.
+	 */
+	RemoteStore(MPI_Comm frontEndComm, int mpi_world_size, int firstStorageRank);
+
+	/**
+	 * @brief Send a request to the master and wait for its reply.
+	 *
+	 * @param packet The arguments of the request.
+	 * @param name The first name, nullptr if there isn't any.
+	 * @param secondName The second name, nullptr if there isn't any.
+	 * @param value The data following the names.
+	 * @param valueBytes The size of the data.
+	 * @return The reply packet followed by its payload.
+	 */
+	vector<char> call(MetadataRequestPacket &packet, const char *name, const char *secondName, const void *value, size_t valueBytes);
+
+	/**
+	 * @brief Open a file through the master, its data is read unless the file is already open here.
+	 *
+	 * @param packet An OPEN_BLOCKS request, with the flags of the open.
+	 * @return 0, or the error of the master.
+	 */
+	int openFile(MetadataRequestPacket &packet);
+
+	/**
+	 * @brief Add an handle of a file just created by the master.
+	 */
+	void addCreatedFile(fuse_ino_t ino, const DataLayout &layout);
+
+	/**
+	 * @brief Write a part of an open file, filling with zeros the gap after its end.
+	 *
+	 * @return 0, or the error.
+	 */
+	int writeFile(fuse_ino_t ino, const char *buf, size_t size, off_t off);
+
+	/**
+	 * @brief Truncate or extend an open file.
+	 *
+	 * @return 0, or the error. Nothing is done if the file isn't open here.
+	 */
+	int resizeFile(fuse_ino_t ino, size_t size);
+
+	/**
+	 * @brief Write an open file to the storage processes if it has been changed.
+	 *
+	 * @return 0, or the error of the master.
+	 */
+	int flushFile(fuse_ino_t ino);
+
+	/**
+	 * @brief Drop an handle of an open file, its data is freed with the last one.
+	 */
+	void releaseFile(fuse_ino_t ino);
+
+	/**
+	 * @brief Replace the size in the attributes of a file with the one of its unflushed data.
+	 */
+	void patchSize(fuse_ino_t ino, struct stat *attr);
+
+private:
+	/**
+	 * @brief Read the blocks of a file from the storage processes into its buffer.
+	 *
+	 * @param locations The location of each block, in file order.
+	 * @return 0, ENOMEM, or EIO if a storage process doesn't store a block anymore.
+	 */
+	int readBlocks(fuse_ino_t ino, OpenFile &file, const BlockLocationPacket *locations, size_t nblocks);
+
+	/**
+	 * @brief Write a file to the storage processes and tell the master where its blocks are.
+	 *
+	 * @return 0, or the error of the master.
+	 */
+	int writeBlocks(fuse_ino_t ino, OpenFile &file);
+
+public:
+	/**
+	 * @brief Tell the master that this process won't send other requests.
+	 */
+	void detach();
+};
+
+
+
+#endif //REMOTESTORE_HPP
@@ -2,12 +2,16 @@
 #include <mpi.h>
 #include <sys/stat.h>
 #include <sstream>
+#include <thread>
+#include <cstdlib>
 
 #include "include/ramfs/FileSystem.hpp"
 #include "include/blocks/Blocks.hpp"
 #include "include/mpi/NodeProcessCode.hpp"
+#include "include/mpi/NodeTopology.hpp"
 
 #include "include/utils/log_level.hpp"
+#include "include/mpi/dagonfs_comm.hpp"
 
 using namespace std;
 
@@ -16,6 +20,8 @@ using namespace log4cplus;
 LogLevel DAGONFS_LOG_LEVEL = OFF_LOG_LEVEL;
 //LogLevel DAGONFS_LOG_LEVEL = ALL_LOG_LEVEL;
 
+MPI_Comm DAGONFS_COMM_WORLD = MPI_COMM_NULL;
+
 static void show_usage(const char *progname);
 
 int main(int argc, char *argv[]){
@@ -43,16 +49,37 @@ int main(int argc, char *argv[]){
 
     //MPI
     //Inizialize MPI
-    int mpiWorldSize, mpiRank;
-    MPI_Init(&argc, &argv);
+    //The front ends serve the kernel and the other front ends from different threads,
+    //the handler pool (-o queues=N) calls MPI from a thread at a time
+    int mpiWorldSize, mpiRank, provided;
+    MPI_Init_thread(&argc, &argv, getenv(DAGONFS_ENV_FRONT_ENDS) != nullptr ? MPI_THREAD_MULTIPLE : MPI_THREAD_SERIALIZED, &provided);
+
+    //MPI
+    //Leave out the clients started in the same job (see dagonfs::Client), they must follow the processes of DAGonFS
+    int worldRank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+    MPI_Comm_split(MPI_COMM_WORLD, 0, worldRank, &DAGONFS_COMM_WORLD);
 
     //MPI
     //Get number of involved processes
-    MPI_Comm_size(MPI_COMM_WORLD, &mpiWorldSize);
+    MPI_Comm_size(DAGONFS_COMM_WORLD, &mpiWorldSize);
 
     //MPI
     //Get the process' rank -> rank = 0 is the main process
-    MPI_Comm_rank(MPI_COMM_WORLD, &mpiRank);
+    MPI_Comm_rank(DAGONFS_COMM_WORLD, &mpiRank);
+    if (mpiRank != worldRank) {
+        cerr << "Error: DAGonFS must be the first application of the job, the clients follow it" << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    NodeTopology *nodeTopology = NodeTopology::getInstance(mpiRank, mpiWorldSize);
+    bool frontEnds = nodeTopology->hasRemoteFrontEnds();
+    if (frontEnds && provided < MPI_THREAD_MULTIPLE) {
+        if (mpiRank == 0) {
+            cerr << "Error: several front ends or clients need MPI_THREAD_MULTIPLE, export " << DAGONFS_ENV_FRONT_ENDS << " to every process (mpirun -x " << DAGONFS_ENV_FRONT_ENDS << ")" << endl;
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
 
     //MPI
     //The master process will manage the RAM FS
@@ -71,7 +98,27 @@ int main(int argc, char *argv[]){
     //Other process will manage the reading and writing operations
     else {
         NodeProcessCode *node = NodeProcessCode::getInstance(mpiRank, mpiWorldSize);
-        node->start();
+        thread service;
+        if (frontEnds) {
+            service = thread(&NodeProcessCode::serveFrontEnds, node);
+        }
+
+        //A front end mounts the file system too, while its node process follows the master
+        if (nodeTopology->isFrontEnd(mpiRank)) {
+            thread nodeThread(&NodeProcessCode::start, node);
+            FileSystem ramfs = FileSystem(mpiRank,mpiWorldSize);
+            ret = ramfs.start(argc, argv);
+            cout << "File system returned value: " << ret << endl;
+            nodeThread.join();
+        }
+        else {
+            node->start();
+        }
+
+        if (frontEnds) {
+            node->stopServing();
+            service.join();
+        }
     }
 
     cout << "Process rank=" << mpiRank << " is about to terminate in main.cpp" <<endl;
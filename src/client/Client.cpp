@@ -0,0 +1,300 @@
+//
+// Created on 10/19/26.
+//
+
+#include "Client.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+using namespace log4cplus;
+
+//The library doesn't log, unless the application sets its own level
+LogLevel DAGONFS_LOG_LEVEL = OFF_LOG_LEVEL;
+
+static Initializer initializer;
+
+namespace dagonfs {
+
+Client *Client::instance = nullptr;
+
+Client *Client::getInstance() {
+	if (instance == nullptr) {
+		//The same collectives of DAGonFS over MPI_COMM_WORLD: the split of its main() and the ones of the NodeTopology constructor
+		int worldRank;
+		MPI_Comm clientComm, frontEndComm;
+		int storage[2];
+		MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+		MPI_Comm_split(MPI_COMM_WORLD, 1, worldRank, &clientComm);
+		MPI_Comm_dup(MPI_COMM_WORLD, &frontEndComm);
+		MPI_Bcast(storage, 2, MPI_INT, 0, frontEndComm);
+		instance = new Client(clientComm, frontEndComm, storage[0], storage[1]);
+	}
+
+	return instance;
+}
+
+Client::Client(MPI_Comm clientComm, MPI_Comm frontEndComm, int mpi_world_size, int firstStorageRank)
+	: RemoteStore(frontEndComm, mpi_world_size, firstStorageRank) {
+	this->clientComm = clientComm;
+
+	//The context of the requests, as the kernel would send it
+	memset(&context, 0, sizeof(context));
+	context.uid = getuid();
+	context.gid = getgid();
+	context.pid = getpid();
+	context.umask = umask(0);
+	umask(context.umask);
+}
+
+MetadataRequestPacket Client::newRequest(MetadataOperation operation, fuse_ino_t ino) {
+	MetadataRequestPacket packet{};
+	packet.operation = operation;
+	packet.ino = ino;
+	packet.context = context;
+	return packet;
+}
+
+int Client::resolve(const char *path, struct fuse_entry_param &entry, string &name) {
+	vector<string> names;
+	string component;
+	for (const char *c = path; ; c++) {
+		if (*c == '/' || *c == '\0') {
+			if (!component.empty() && component != ".") {
+				names.push_back(component);
+			}
+			component.clear();
+			if (*c == '\0') {
+				break;
+			}
+		}
+		else {
+			component += *c;
+		}
+	}
+
+	memset(&entry, 0, sizeof(entry));
+	entry.ino = FUSE_ROOT_ID;
+	name.clear();
+	if (names.empty()) {
+		MetadataRequestPacket packet = newRequest(GETATTR, FUSE_ROOT_ID);
+		vector<char> reply = call(packet, nullptr, nullptr, nullptr, 0);
+		MetadataReplyPacket *replyPacket = (MetadataReplyPacket *) reply.data();
+		if (replyPacket->type != REPLY_ATTR) {
+			return replyPacket->type == REPLY_ERR ? replyPacket->error : EIO;
+		}
+		entry.attr = replyPacket->entry.attr;
+		return 0;
+	}
+
+	for (size_t i=0; i < names.size(); i++) {
+		MetadataRequestPacket packet = newRequest(LOOKUP, entry.ino);
+		vector<char> reply = call(packet, names[i].c_str(), nullptr, nullptr, 0);
+		MetadataReplyPacket *replyPacket = (MetadataReplyPacket *) reply.data();
+		name = names[i];
+		//A negative entry has inode 0
+		if (replyPacket->type != REPLY_ENTRY || replyPacket->entry.ino == 0) {
+			int err = replyPacket->type == REPLY_ERR ? replyPacket->error : ENOENT;
+			if (err != ENOENT || i + 1 < names.size()) {
+				forget(entry.ino);
+				entry.ino = 0;
+			}
+			return err;
+		}
+
+		forget(entry.ino);
+		entry = replyPacket->entry;
+	}
+
+	return 0;
+}
+
+void Client::forget(fuse_ino_t ino) {
+	if (ino == 0 || ino == FUSE_ROOT_ID) {
+		return;
+	}
+
+	MetadataRequestPacket packet = newRequest(FORGET, ino);
+	packet.nlookup = 1;
+	call(packet, nullptr, nullptr, nullptr, 0);
+}
+
+Client::Handle *Client::getHandle(int fd) {
+	if (fd < 0 || (size_t) fd >= handles.size() || handles[fd].ino == 0) {
+		return nullptr;
+	}
+
+	return &handles[fd];
+}
+
+int Client::open(const char *path, int flags, mode_t mode) {
+	struct fuse_entry_param entry;
+	string name;
+	int err = resolve(path, entry, name);
+	if (err == ENOENT && entry.ino != 0 && (flags & O_CREAT)) {
+		fuse_ino_t parent = entry.ino;
+		MetadataRequestPacket packet = newRequest(CREATE, parent);
+		packet.mode = mode & ~context.umask;
+		packet.flags = flags;
+		vector<char> reply = call(packet, name.c_str(), nullptr, nullptr, 0);
+		forget(parent);
+		MetadataReplyPacket *replyPacket = (MetadataReplyPacket *) reply.data();
+		if (replyPacket->type != REPLY_CREATE) {
+			errno = replyPacket->type == REPLY_ERR ? replyPacket->error : EIO;
+			return -1;
+		}
+		entry = replyPacket->entry;
+		addCreatedFile(entry.ino, replyPacket->layout);
+	}
+	else if (err == 0 && (flags & O_CREAT) && (flags & O_EXCL)) {
+		err = EEXIST;
+	}
+	else if (err == 0) {
+		MetadataRequestPacket packet = newRequest(OPEN_BLOCKS, entry.ino);
+		packet.flags = flags;
+		err = openFile(packet);
+	}
+
+	if (err != 0) {
+		forget(entry.ino);
+		errno = err;
+		return -1;
+	}
+
+	size_t fd = 0;
+	while (fd < handles.size() && handles[fd].ino != 0) {
+		fd++;
+	}
+	if (fd == handles.size()) {
+		handles.push_back(Handle());
+	}
+	handles[fd].ino = entry.ino;
+	handles[fd].flags = flags;
+	return fd;
+}
+
+int Client::close(int fd) {
+	Handle *handle = getHandle(fd);
+	if (handle == nullptr) {
+		errno = EBADF;
+		return -1;
+	}
+
+	int err = flushFile(handle->ino);
+	releaseFile(handle->ino);
+	forget(handle->ino);
+	handle->ino = 0;
+	if (err != 0) {
+		errno = err;
+		return -1;
+	}
+
+	return 0;
+}
+
+ssize_t Client::pread(int fd, void *buf, size_t count, off_t offset) {
+	Handle *handle = getHandle(fd);
+	if (handle == nullptr || (handle->flags & O_ACCMODE) == O_WRONLY) {
+		errno = EBADF;
+		return -1;
+	}
+
+	OpenFile &file = openFiles[handle->ino];
+	if ((size_t) offset >= file.size) {
+		return 0;
+	}
+
+	size_t bytes = min(count, file.size - offset);
+	char *dest = (char *) buf;
+	for (struct iovec &part : file.buffer.getRange(bytes, offset)) {
+		memcpy(dest, part.iov_base, part.iov_len);
+		dest += part.iov_len;
+	}
+	return bytes;
+}
+
+ssize_t Client::pwrite(int fd, const void *buf, size_t count, off_t offset) {
+	Handle *handle = getHandle(fd);
+	if (handle == nullptr || (handle->flags & O_ACCMODE) == O_RDONLY) {
+		errno = EBADF;
+		return -1;
+	}
+
+	int err = writeFile(handle->ino, (const char *) buf, count, offset);
+	if (err != 0) {
+		errno = err;
+		return -1;
+	}
+
+	return count;
+}
+
+int Client::fsync(int fd) {
+	Handle *handle = getHandle(fd);
+	if (handle == nullptr) {
+		errno = EBADF;
+		return -1;
+	}
+
+	int err = flushFile(handle->ino);
+	if (err != 0) {
+		errno = err;
+		return -1;
+	}
+
+	return 0;
+}
+
+int Client::stat(const char *path, struct stat *statbuf) {
+	struct fuse_entry_param entry;
+	string name;
+	int err = resolve(path, entry, name);
+	if (err != 0) {
+		forget(entry.ino);
+		errno = err;
+		return -1;
+	}
+
+	*statbuf = entry.attr;
+	patchSize(entry.ino, statbuf);
+	forget(entry.ino);
+	return 0;
+}
+
+int Client::fstat(int fd, struct stat *statbuf) {
+	Handle *handle = getHandle(fd);
+	if (handle == nullptr) {
+		errno = EBADF;
+		return -1;
+	}
+
+	MetadataRequestPacket packet = newRequest(GETATTR, handle->ino);
+	vector<char> reply = call(packet, nullptr, nullptr, nullptr, 0);
+	MetadataReplyPacket *replyPacket = (MetadataReplyPacket *) reply.data();
+	if (replyPacket->type != REPLY_ATTR) {
+		errno = replyPacket->type == REPLY_ERR ? replyPacket->error : EIO;
+		return -1;
+	}
+
+	*statbuf = replyPacket->entry.attr;
+	patchSize(handle->ino, statbuf);
+	return 0;
+}
+
+void Client::detach() {
+	for (size_t fd=0; fd < handles.size(); fd++) {
+		if (handles[fd].ino != 0) {
+			close(fd);
+		}
+	}
+
+	RemoteStore::detach();
+}
+
+}
@@ -0,0 +1,102 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef CLIENT_HPP
+#define CLIENT_HPP
+
+#include <mpi.h>
+#include <vector>
+#include <cstddef>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "../client-server/include/ramfs/RemoteStore.hpp"
+
+using namespace std;
+
+namespace dagonfs {
+
+/**
+ * @brief The file system of DAGonFS (client-server) for the processes of an application started in its same MPI job.
+ *
+ * The files are accessed without FUSE: the metadata requests go to the master, the data is moved between the
+ * client and the storage processes, as for a front end (see RemoteStore). The application is started after
+ * DAGonFS, with a thread safe MPI on the side of DAGonFS:
+ *
+ *     mpirun -x DAGONFS_FRONT_ENDS=1 -np <n> DAGonFS_CS.exe -f <mountpoint> : -np <m> <application>
+ *
+ * MPI_COMM_WORLD spans DAGonFS too, so every process of the application must get the client right after
+ * MPI_Init and use getComm() in place of MPI_COMM_WORLD. The paths are relative to the root of the file
+ * system, the functions behave as the POSIX ones: they return -1 and set errno on errors.
+ *
+ * The data is written to the storage processes when the file is synced or closed, and read from them when
+ * it's opened for the first time by the process. The client isn't thread safe.
+ */
+class Client : private RemoteStore {
+private:
+	//Singleton implementation
+	static Client* instance;
+	Client(MPI_Comm clientComm, MPI_Comm frontEndComm, int mpi_world_size, int firstStorageRank);
+
+	//The processes of the application
+	MPI_Comm clientComm;
+	struct fuse_ctx context;
+
+	//The open files, indexed by descriptor: the looked up inode (0 for a free descriptor) and the open flags
+	typedef struct Handle {
+		fuse_ino_t ino;
+		int flags;
+	} Handle;
+	vector<Handle> handles;
+
+	MetadataRequestPacket newRequest(MetadataOperation operation, fuse_ino_t ino);
+
+	/**
+	 * @brief Find the inode of a path, every step is a lookup on the master.
+	 *
+	 * The last inode stays looked up, it must be forgotten. When the last name doesn't exist, ENOENT is
+	 * returned and the inode of its parent is set, looked up too unless it's the root.
+	 *
+	 * @param path The path, relative to the root of the file system.
+	 * @param entry Set to the entry of the last inode found.
+	 * @param name Set to the last name of the path.
+	 * @return 0, or the error.
+	 */
+	int resolve(const char *path, struct fuse_entry_param &entry, string &name);
+	void forget(fuse_ino_t ino);
+
+	Handle *getHandle(int fd);
+
+public:
+	/**
+	 * @brief Get the client, the first call is collective over MPI_COMM_WORLD with DAGonFS.
+	 */
+	static Client* getInstance();
+
+	/**
+	 * @brief Get the communicator of the processes of the application, to be used in place of MPI_COMM_WORLD.
+	 */
+	MPI_Comm getComm() { return clientComm; }
+
+	int open(const char *path, int flags, mode_t mode = 0);
+	int close(int fd);
+	ssize_t pread(int fd, void *buf, size_t count, off_t offset);
+	ssize_t pwrite(int fd, const void *buf, size_t count, off_t offset);
+	int fsync(int fd);
+	int stat(const char *path, struct stat *statbuf);
+	int fstat(int fd, struct stat *statbuf);
+
+	/**
+	 * @brief Close the open files and tell the master that this process won't use the file system anymore.
+	 *
+	 * It must be invoked by every process of the application before MPI_Finalize.
+	 */
+	void detach();
+};
+
+}
+
+
+
+#endif //CLIENT_HPP
@@ -0,0 +1,493 @@
+//
+// Created on 10/19/26.
+//
+
+/**
+ * LD_PRELOAD shim redirecting the files below a prefix (DAGONFS_CLIENT_PREFIX, /dagonfs by default) to
+ * dagonfs::Client, for programs which don't use MPI themselves:
+ *
+ *     mpirun -x DAGONFS_FRONT_ENDS=1 -np <n> DAGonFS_CS.exe -f <mountpoint> : -np <m> -x LD_PRELOAD=libDAGonFS_Preload.so <program>
+ *
+ * MPI is initialized when the shim is loaded, since DAGonFS waits for its clients from the start, and
+ * finalized when the program exits. Every redirected file gets a real descriptor (of /dev/null), so the
+ * descriptors never collide. dup(), fcntl() and the memory mappings of the redirected files aren't supported,
+ * nor are the paths relative to a directory descriptor given to openat(). fopen() gets a stream over the
+ * redirected descriptor (fopencookie), the other stdio functions opening files aren't redirected.
+ *
+ * The calls to the client are serialized, since MPI is initialized with MPI_THREAD_SERIALIZED, and the
+ * functions of the C library are always called without holding a lock: a blocking read doesn't stop the
+ * other threads.
+ */
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdarg>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <mpi.h>
+
+#include "Client.hpp"
+
+using namespace std;
+
+#define DAGONFS_ENV_CLIENT_PREFIX "DAGONFS_CLIENT_PREFIX"
+#define DEFAULT_CLIENT_PREFIX "/dagonfs"
+
+//A redirected descriptor: the one of the client and the file offset
+typedef struct Redirection {
+	int fd;
+	off_t offset;
+	int flags;
+} Redirection;
+
+static dagonfs::Client *client = nullptr;
+static string prefix;
+static map<int, Redirection> redirections;
+static mutex redirectionsMutex;
+static mutex clientMutex;
+
+//The functions of the C library
+static int (*realOpen)(const char *, int, ...) = nullptr;
+static int (*realOpenat)(int, const char *, int, ...) = nullptr;
+static FILE *(*realFopen)(const char *, const char *) = nullptr;
+static int (*realClose)(int) = nullptr;
+static ssize_t (*realRead)(int, void *, size_t) = nullptr;
+static ssize_t (*realWrite)(int, const void *, size_t) = nullptr;
+static ssize_t (*realPread)(int, void *, size_t, off_t) = nullptr;
+static ssize_t (*realPwrite)(int, const void *, size_t, off_t) = nullptr;
+static off_t (*realLseek)(int, off_t, int) = nullptr;
+static int (*realFsync)(int) = nullptr;
+static int (*realStat)(const char *, struct stat *) = nullptr;
+static int (*realLstat)(const char *, struct stat *) = nullptr;
+static int (*realFstat)(int, struct stat *) = nullptr;
+
+static void resolveRealFunctions() {
+	if (realOpen != nullptr) {
+		return;
+	}
+
+	realClose = (int (*)(int)) dlsym(RTLD_NEXT, "close");
+	realRead = (ssize_t (*)(int, void *, size_t)) dlsym(RTLD_NEXT, "read");
+	realWrite = (ssize_t (*)(int, const void *, size_t)) dlsym(RTLD_NEXT, "write");
+	realPread = (ssize_t (*)(int, void *, size_t, off_t)) dlsym(RTLD_NEXT, "pread");
+	realPwrite = (ssize_t (*)(int, const void *, size_t, off_t)) dlsym(RTLD_NEXT, "pwrite");
+	realLseek = (off_t (*)(int, off_t, int)) dlsym(RTLD_NEXT, "lseek");
+	realFsync = (int (*)(int)) dlsym(RTLD_NEXT, "fsync");
+	realStat = (int (*)(const char *, struct stat *)) dlsym(RTLD_NEXT, "stat");
+	realLstat = (int (*)(const char *, struct stat *)) dlsym(RTLD_NEXT, "lstat");
+	realFstat = (int (*)(int, struct stat *)) dlsym(RTLD_NEXT, "fstat");
+	realOpenat = (int (*)(int, const char *, int, ...)) dlsym(RTLD_NEXT, "openat");
+	realFopen = (FILE *(*)(const char *, const char *)) dlsym(RTLD_NEXT, "fopen");
+	realOpen = (int (*)(const char *, int, ...)) dlsym(RTLD_NEXT, "open");
+}
+
+/**
+ * Get the path of a file in DAGonFS, nullptr if the file isn't redirected.
+ */
+static const char *clientPath(const char *path) {
+	if (client == nullptr || path == nullptr || strncmp(path, prefix.c_str(), prefix.size()) != 0) {
+		return nullptr;
+	}
+	if (path[prefix.size()] != '/' && path[prefix.size()] != '\0') {
+		return nullptr;
+	}
+
+	return path + prefix.size();
+}
+
+/**
+ * Copy the redirection of a descriptor, false if the descriptor isn't redirected.
+ */
+static bool getRedirection(int fd, Redirection &redirection) {
+	lock_guard<mutex> lock(redirectionsMutex);
+	auto redirection_it = redirections.find(fd);
+	if (redirection_it == redirections.end()) {
+		return false;
+	}
+
+	redirection = redirection_it->second;
+	return true;
+}
+
+static void setOffset(int fd, off_t offset) {
+	lock_guard<mutex> lock(redirectionsMutex);
+	auto redirection_it = redirections.find(fd);
+	if (redirection_it != redirections.end()) {
+		redirection_it->second.offset = offset;
+	}
+}
+
+__attribute__((constructor)) static void attachClient() {
+	resolveRealFunctions();
+	const char *env = getenv(DAGONFS_ENV_CLIENT_PREFIX);
+	prefix = env != nullptr ? env : DEFAULT_CLIENT_PREFIX;
+	while (prefix.size() > 1 && prefix.back() == '/') {
+		prefix.pop_back();
+	}
+
+	int provided;
+	MPI_Init_thread(nullptr, nullptr, MPI_THREAD_SERIALIZED, &provided);
+	client = dagonfs::Client::getInstance();
+}
+
+__attribute__((destructor)) static void detachClient() {
+	map<int, Redirection> closed;
+	{
+		lock_guard<mutex> lock(redirectionsMutex);
+		closed.swap(redirections);
+	}
+	for (auto &redirection : closed) {
+		realClose(redirection.first);
+	}
+
+	lock_guard<mutex> lock(clientMutex);
+	client->detach();
+	client = nullptr;
+	MPI_Finalize();
+}
+
+extern "C" {
+
+int open(const char *path, int flags, ...) {
+	mode_t mode = 0;
+	if (flags & (O_CREAT | O_TMPFILE)) {
+		va_list args;
+		va_start(args, flags);
+		mode = va_arg(args, mode_t);
+		va_end(args);
+	}
+
+	resolveRealFunctions();
+	const char *path_ = clientPath(path);
+	if (path_ == nullptr) {
+		return realOpen(path, flags, mode);
+	}
+
+	int clientFd;
+	{
+		lock_guard<mutex> lock(clientMutex);
+		clientFd = client->open(path_, flags, mode);
+	}
+	if (clientFd < 0) {
+		return -1;
+	}
+	int fd = realOpen("/dev/null", O_RDONLY | (flags & O_CLOEXEC));
+	if (fd < 0) {
+		int err = errno;
+		lock_guard<mutex> lock(clientMutex);
+		client->close(clientFd);
+		errno = err;
+		return -1;
+	}
+
+	lock_guard<mutex> lock(redirectionsMutex);
+	redirections[fd] = {clientFd, 0, flags};
+	return fd;
+}
+
+int open64(const char *path, int flags, ...) {
+	mode_t mode = 0;
+	if (flags & (O_CREAT | O_TMPFILE)) {
+		va_list args;
+		va_start(args, flags);
+		mode = va_arg(args, mode_t);
+		va_end(args);
+	}
+
+	return open(path, flags | O_LARGEFILE, mode);
+}
+
+int creat(const char *path, mode_t mode) {
+	return open(path, O_CREAT | O_WRONLY | O_TRUNC, mode);
+}
+
+//Only the absolute paths are redirected, like by open()
+int openat(int dirfd, const char *path, int flags, ...) {
+	mode_t mode = 0;
+	if (flags & (O_CREAT | O_TMPFILE)) {
+		va_list args;
+		va_start(args, flags);
+		mode = va_arg(args, mode_t);
+		va_end(args);
+	}
+
+	resolveRealFunctions();
+	if (clientPath(path) == nullptr) {
+		return realOpenat(dirfd, path, flags, mode);
+	}
+
+	return open(path, flags, mode);
+}
+
+int openat64(int dirfd, const char *path, int flags, ...) {
+	mode_t mode = 0;
+	if (flags & (O_CREAT | O_TMPFILE)) {
+		va_list args;
+		va_start(args, flags);
+		mode = va_arg(args, mode_t);
+		va_end(args);
+	}
+
+	return openat(dirfd, path, flags | O_LARGEFILE, mode);
+}
+
+int close(int fd) {
+	resolveRealFunctions();
+	Redirection redirection;
+	{
+		lock_guard<mutex> lock(redirectionsMutex);
+		auto redirection_it = redirections.find(fd);
+		if (redirection_it == redirections.end()) {
+			redirection.fd = -1;
+		}
+		else {
+			redirection = redirection_it->second;
+			redirections.erase(redirection_it);
+		}
+	}
+	if (redirection.fd < 0) {
+		return realClose(fd);
+	}
+
+	int ret;
+	{
+		lock_guard<mutex> lock(clientMutex);
+		ret = client->close(redirection.fd);
+	}
+	int err = errno;
+	realClose(fd);
+	errno = err;
+	return ret;
+}
+
+ssize_t pread(int fd, void *buf, size_t count, off_t offset) {
+	resolveRealFunctions();
+	Redirection redirection;
+	if (!getRedirection(fd, redirection)) {
+		return realPread(fd, buf, count, offset);
+	}
+
+	lock_guard<mutex> lock(clientMutex);
+	return client->pread(redirection.fd, buf, count, offset);
+}
+
+ssize_t pwrite(int fd, const void *buf, size_t count, off_t offset) {
+	resolveRealFunctions();
+	Redirection redirection;
+	if (!getRedirection(fd, redirection)) {
+		return realPwrite(fd, buf, count, offset);
+	}
+
+	lock_guard<mutex> lock(clientMutex);
+	return client->pwrite(redirection.fd, buf, count, offset);
+}
+
+ssize_t pread64(int fd, void *buf, size_t count, off64_t offset) {
+	return pread(fd, buf, count, offset);
+}
+
+ssize_t pwrite64(int fd, const void *buf, size_t count, off64_t offset) {
+	return pwrite(fd, buf, count, offset);
+}
+
+ssize_t read(int fd, void *buf, size_t count) {
+	resolveRealFunctions();
+	Redirection redirection;
+	if (!getRedirection(fd, redirection)) {
+		return realRead(fd, buf, count);
+	}
+
+	ssize_t bytes;
+	{
+		lock_guard<mutex> lock(clientMutex);
+		bytes = client->pread(redirection.fd, buf, count, redirection.offset);
+	}
+	if (bytes > 0) {
+		setOffset(fd, redirection.offset + bytes);
+	}
+	return bytes;
+}
+
+ssize_t write(int fd, const void *buf, size_t count) {
+	resolveRealFunctions();
+	Redirection redirection;
+	if (!getRedirection(fd, redirection)) {
+		return realWrite(fd, buf, count);
+	}
+
+	ssize_t bytes;
+	{
+		lock_guard<mutex> lock(clientMutex);
+		if (redirection.flags & O_APPEND) {
+			struct stat statbuf;
+			if (client->fstat(redirection.fd, &statbuf) < 0) {
+				return -1;
+			}
+			redirection.offset = statbuf.st_size;
+		}
+		bytes = client->pwrite(redirection.fd, buf, count, redirection.offset);
+	}
+	if (bytes > 0) {
+		setOffset(fd, redirection.offset + bytes);
+	}
+	return bytes;
+}
+
+off_t lseek(int fd, off_t offset, int whence) {
+	resolveRealFunctions();
+	Redirection redirection;
+	if (!getRedirection(fd, redirection)) {
+		return realLseek(fd, offset, whence);
+	}
+
+	off_t base = 0;
+	if (whence == SEEK_CUR) {
+		base = redirection.offset;
+	}
+	else if (whence == SEEK_END) {
+		struct stat statbuf;
+		lock_guard<mutex> lock(clientMutex);
+		if (client->fstat(redirection.fd, &statbuf) < 0) {
+			return -1;
+		}
+		base = statbuf.st_size;
+	}
+	else if (whence != SEEK_SET) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (base + offset < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	setOffset(fd, base + offset);
+	return base + offset;
+}
+
+off64_t lseek64(int fd, off64_t offset, int whence) {
+	return lseek(fd, offset, whence);
+}
+
+int fsync(int fd) {
+	resolveRealFunctions();
+	Redirection redirection;
+	if (!getRedirection(fd, redirection)) {
+		return realFsync(fd);
+	}
+
+	lock_guard<mutex> lock(clientMutex);
+	return client->fsync(redirection.fd);
+}
+
+int fdatasync(int fd) {
+	return fsync(fd);
+}
+
+int stat(const char *path, struct stat *statbuf) {
+	resolveRealFunctions();
+	const char *path_ = clientPath(path);
+	if (path_ == nullptr) {
+		return realStat(path, statbuf);
+	}
+
+	lock_guard<mutex> lock(clientMutex);
+	return client->stat(path_, statbuf);
+}
+
+//The symbolic links are followed by the master, as for stat()
+int lstat(const char *path, struct stat *statbuf) {
+	resolveRealFunctions();
+	const char *path_ = clientPath(path);
+	if (path_ == nullptr) {
+		return realLstat(path, statbuf);
+	}
+
+	lock_guard<mutex> lock(clientMutex);
+	return client->stat(path_, statbuf);
+}
+
+int fstat(int fd, struct stat *statbuf) {
+	resolveRealFunctions();
+	Redirection redirection;
+	if (!getRedirection(fd, redirection)) {
+		return realFstat(fd, statbuf);
+	}
+
+	lock_guard<mutex> lock(clientMutex);
+	return client->fstat(redirection.fd, statbuf);
+}
+
+//The streams opened by fopen() read and write their redirected descriptor
+static ssize_t readStream(void *cookie, char *buf, size_t size) {
+	return read((int) (intptr_t) cookie, buf, size);
+}
+
+static ssize_t writeStream(void *cookie, const char *buf, size_t size) {
+	return write((int) (intptr_t) cookie, buf, size);
+}
+
+static int seekStream(void *cookie, off64_t *offset, int whence) {
+	off_t position = lseek((int) (intptr_t) cookie, *offset, whence);
+	if (position < 0) {
+		return -1;
+	}
+
+	*offset = position;
+	return 0;
+}
+
+static int closeStream(void *cookie) {
+	return close((int) (intptr_t) cookie);
+}
+
+static cookie_io_functions_t streamFunctions = {readStream, writeStream, seekStream, closeStream};
+
+FILE *fopen(const char *path, const char *mode) {
+	resolveRealFunctions();
+	if (clientPath(path) == nullptr) {
+		return realFopen(path, mode);
+	}
+
+	int flags;
+	switch (mode[0]) {
+		case 'r': flags = strchr(mode, '+') != nullptr ? O_RDWR : O_RDONLY; break;
+		case 'w': flags = (strchr(mode, '+') != nullptr ? O_RDWR : O_WRONLY) | O_CREAT | O_TRUNC; break;
+		case 'a': flags = (strchr(mode, '+') != nullptr ? O_RDWR : O_WRONLY) | O_CREAT | O_APPEND; break;
+		default:
+			errno = EINVAL;
+			return nullptr;
+	}
+	if (strchr(mode, 'x') != nullptr) {
+		flags |= O_EXCL;
+	}
+	if (strchr(mode, 'e') != nullptr) {
+		flags |= O_CLOEXEC;
+	}
+
+	int fd = open(path, flags, 0666);
+	if (fd < 0) {
+		return nullptr;
+	}
+	FILE *stream = fopencookie((void *) (intptr_t) fd, mode, streamFunctions);
+	if (stream == nullptr) {
+		int err = errno;
+		close(fd);
+		errno = err;
+	}
+	return stream;
+}
+
+FILE *fopen64(const char *path, const char *mode) {
+	return fopen(path, mode);
+}
+
+}
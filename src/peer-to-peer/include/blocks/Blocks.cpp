@@ -25,6 +25,7 @@ Blocks::~Blocks() {
 }
 
 void Blocks::createEmptyBlockListForInode(fuse_ino_t inode) {
+	lock_guard<mutex> lock(blocksMutex);
 	//if (!FileSystemDataBlocks.contains(inode)) {
 	if (FileSystemDataBlocks.find(inode) == FileSystemDataBlocks.end()) {
 		FileSystemDataBlocks[inode] = vector<DataBlock *>();
@@ -32,20 +33,29 @@ void Blocks::createEmptyBlockListForInode(fuse_ino_t inode) {
 }
 
 void Blocks::setBlockListForInode(fuse_ino_t inode, vector<DataBlock*> &blockList) {
+	lock_guard<mutex> lock(blocksMutex);
 	FileSystemDataBlocks[inode] = blockList;
 }
 
 bool Blocks::blockListExistForInode(fuse_ino_t inode) {
-	return FileSystemDataBlocks.find(inode) == FileSystemDataBlocks.end();
+	lock_guard<mutex> lock(blocksMutex);
+	return FileSystemDataBlocks.find(inode) != FileSystemDataBlocks.end();
 }
 
 
 vector<DataBlock*>& Blocks::getDataBlockListOfInode(fuse_ino_t inode) {
+	lock_guard<mutex> lock(blocksMutex);
 	return FileSystemDataBlocks[inode];
 }
 
+shared_mutex& Blocks::getMutexOfInode(fuse_ino_t inode) {
+	lock_guard<mutex> lock(blocksMutex);
+	return inodeMutexes[inode];
+}
+
 DataBlock* Blocks::addDataBlockToInode(fuse_ino_t inode) {
 	DataBlock *newBlock = new DataBlock(inode);
+	lock_guard<mutex> lock(blocksMutex);
 
 	if (!FileSystemDataBlocks[inode].empty()) {
 		DataBlock *lastBlock = FileSystemDataBlocks[inode].back();
@@ -59,19 +69,23 @@ DataBlock* Blocks::addDataBlockToInode(fuse_ino_t inode) {
 
 
 void Blocks::addDataBlockToInode(fuse_ino_t inode, DataBlock* dataBlock) {
+	lock_guard<mutex> lock(blocksMutex);
 	FileSystemDataBlocks[inode].push_back(dataBlock);
 }
 
 unsigned int Blocks::getNumberOfUsedBlocksOfInode(fuse_ino_t inode) {
+	lock_guard<mutex> lock(blocksMutex);
 	return FileSystemDataBlocks[inode].size();
 }
 
 unsigned int Blocks::getTotalBlockBytesOfInode(fuse_ino_t inode) {
+	lock_guard<mutex> lock(blocksMutex);
 	unsigned int totalBytes = FileSystemDataBlocks[inode].size();
 	return totalBytes * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
 }
 
 bool Blocks::hasNoBlocks(fuse_ino_t inode) {
+	lock_guard<mutex> lock(blocksMutex);
 	return FileSystemDataBlocks[inode].empty();
 }
 
@@ -6,6 +6,8 @@
 #define BLOCKS_HPP
 
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <vector>
 #include "../utils/fuse_headers.hpp"
 
@@ -20,6 +22,11 @@ private:
 	Blocks();
 
 	map<fuse_ino_t, vector<DataBlock *> > FileSystemDataBlocks;
+	//The writes of different processes update the map concurrently
+	mutex blocksMutex;
+	//The lists are returned by reference: a write resizes the list of an inode and replaces the data of its
+	//blocks while the local reads and the reads of other processes copy them, so they hold the lock of the inode
+	map<fuse_ino_t, shared_mutex> inodeMutexes;
 
 public:
 	//Singleton implementation
@@ -31,6 +38,8 @@ public:
 	void setBlockListForInode(fuse_ino_t inode, vector<DataBlock *> &blockList);
 	bool blockListExistForInode(fuse_ino_t inode);
 	vector<DataBlock *> &getDataBlockListOfInode(fuse_ino_t inode);
+	//Exclusive to change the block list of the inode or the data of its blocks, shared to read them
+	shared_mutex &getMutexOfInode(fuse_ino_t inode);
 	DataBlock *addDataBlockToInode(fuse_ino_t inode);
 	void addDataBlockToInode(fuse_ino_t inode, DataBlock *dataBlock);
 	unsigned int getNumberOfUsedBlocksOfInode(fuse_ino_t inode);
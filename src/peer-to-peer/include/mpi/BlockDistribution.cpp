@@ -0,0 +1,28 @@
+//
+// Created on 10/19/26.
+//
+
+#include "BlockDistribution.hpp"
+
+using namespace std;
+
+BlockDistribution::BlockDistribution(const DataLayout &layout, size_t nblocks, int mpi_world_size) {
+	this->nblocks = nblocks;
+	this->mpi_world_size = mpi_world_size;
+	layout.mapBlocks(nblocks, mpi_world_size, blockRanks);
+
+	blocksPerRank = vector<size_t>(mpi_world_size, 0);
+	for (size_t i=0; i < nblocks; i++) {
+		blocksPerRank[blockRanks[i]]++;
+	}
+}
+
+void BlockDistribution::fillDisplsOfRank(int rank, vector<MPI_Aint> &displs, size_t unitSize) {
+	displs.clear();
+	displs.reserve(blocksPerRank[rank]);
+	for (size_t i=0; i < nblocks; i++) {
+		if (blockRanks[i] == rank) {
+			displs.push_back(i * unitSize);
+		}
+	}
+}
@@ -0,0 +1,47 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BLOCKDISTRIBUTION_HPP
+#define BLOCKDISTRIBUTION_HPP
+
+#include <mpi.h>
+#include <vector>
+#include <cstddef>
+
+#include "../blocks/DataLayout.hpp"
+
+using namespace std;
+
+/**
+ * @brief The distribution of the blocks of a single transfer among the MPI processes.
+ *
+ * It translates a DataLayout into the owner of each block. The blocks of a process are transferred in
+ * file order with a single message, whose datatype selects them directly in the file buffer.
+ */
+class BlockDistribution {
+private:
+	size_t nblocks;
+	int mpi_world_size;
+
+	vector<int> blockRanks;
+	vector<size_t> blocksPerRank;
+
+public:
+	BlockDistribution(const DataLayout &layout, size_t nblocks, int mpi_world_size);
+
+	size_t getNumberOfBlocks() { return nblocks; }
+	int getRankOfBlock(size_t block) { return blockRanks[block]; }
+	size_t getBlocksOfRank(int rank) { return blocksPerRank[rank]; }
+
+	/**
+	 * @brief Fill the displacements of the blocks of a process in the file buffer, in file order.
+	 *
+	 * @param rank The process.
+	 * @param displs The displacements, to build a MPI_Type_create_hindexed_block datatype.
+	 * @param unitSize The size of the data transferred for each block.
+	 */
+	void fillDisplsOfRank(int rank, vector<MPI_Aint> &displs, size_t unitSize);
+};
+
+#endif //BLOCKDISTRIBUTION_HPP
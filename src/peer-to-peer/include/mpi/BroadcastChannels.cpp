@@ -0,0 +1,121 @@
+//
+// Created on 10/19/26.
+//
+
+#include "BroadcastChannels.hpp"
+
+using namespace std;
+
+BroadcastChannels *BroadcastChannels::instance = nullptr;
+
+BroadcastChannels *BroadcastChannels::getInstance(int rank, int worldSize) {
+	if (instance == nullptr) {
+		instance = new BroadcastChannels(rank, worldSize);
+	}
+
+	return instance;
+}
+
+BroadcastChannels::BroadcastChannels(int rank, int worldSize) {
+	mpiRank = rank;
+	mpiWorldSize = worldSize;
+
+	channels.resize(mpiWorldSize);
+	receiveRequests.assign(mpiWorldSize, MPI_REQUEST_NULL);
+	for (int i=0; i<mpiWorldSize; i++) {
+		MPI_Comm_dup(MPI_COMM_WORLD, &channels[i].comm);
+		channels[i].state = IDLE;
+	}
+}
+
+void BroadcastChannels::postReceive(int channel) {
+	Channel &c = channels[channel];
+	if (channel == mpiRank) {
+		MPI_Irecv(&c.request, sizeof(RequestPacket), MPI_BYTE, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &receiveRequests[channel]);
+		c.state = RECEIVING_HEADER;
+	}
+	else if (c.state == ACKNOWLEDGE_PENDING) {
+		MPI_Ibarrier(c.comm, &receiveRequests[channel]);
+		c.state = ACKNOWLEDGING;
+	}
+	else {
+		MPI_Ibcast(&c.request, sizeof(RequestPacket), MPI_BYTE, channel, c.comm, &receiveRequests[channel]);
+		c.state = RECEIVING_HEADER;
+	}
+}
+
+void BroadcastChannels::post(RequestPacket *request, const void *payload, vector<MPI_Request> &requests) {
+	lock_guard<mutex> lock(sendMutex);
+	MPI_Comm comm = channels[mpiRank].comm;
+	MPI_Request mpiRequest;
+
+	MPI_Ibcast(request, sizeof(RequestPacket), MPI_BYTE, mpiRank, comm, &mpiRequest);
+	requests.push_back(mpiRequest);
+	if (request->payloadSize > 0) {
+		MPI_Ibcast(const_cast<void *>(payload), request->payloadSize, MPI_BYTE, mpiRank, comm, &mpiRequest);
+		requests.push_back(mpiRequest);
+	}
+	if (request->acknowledge) {
+		MPI_Ibarrier(comm, &mpiRequest);
+		requests.push_back(mpiRequest);
+	}
+}
+
+void BroadcastChannels::broadcast(RequestType type, const void *payload, size_t size) {
+	RequestPacket request;
+	request.type = type;
+	request.payloadSize = size;
+	request.acknowledge = false;
+
+	vector<MPI_Request> requests;
+	post(&request, payload, requests);
+	MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+}
+
+RequestPacket BroadcastChannels::receive(int &sourceRank, vector<char> &payload) {
+	//The receives completed by the previous call are posted again only now: the follow-up messages of a
+	//point-to-point request must not be matched by the receive of the next request
+	for (int i=0; i<mpiWorldSize; i++) {
+		if (channels[i].state == IDLE || channels[i].state == ACKNOWLEDGE_PENDING) {
+			postReceive(i);
+		}
+	}
+
+	while (true) {
+		int index;
+		MPI_Status status;
+		MPI_Waitany(mpiWorldSize, receiveRequests.data(), &index, &status);
+		Channel &c = channels[index];
+
+		if (index == mpiRank) {
+			c.state = IDLE;
+			sourceRank = status.MPI_SOURCE;
+			payload.clear();
+			return c.request;
+		}
+
+		switch (c.state) {
+		case RECEIVING_HEADER:
+			if (c.request.payloadSize > 0) {
+				c.payload.resize(c.request.payloadSize);
+				MPI_Ibcast(c.payload.data(), c.request.payloadSize, MPI_BYTE, index, c.comm, &receiveRequests[index]);
+				c.state = RECEIVING_PAYLOAD;
+				break;
+			}
+			c.payload.clear();
+			[[fallthrough]];
+		case RECEIVING_PAYLOAD:
+			//The acknowledgement is sent with the next call, when the request has been handled
+			c.state = c.request.acknowledge ? ACKNOWLEDGE_PENDING : IDLE;
+			sourceRank = index;
+			payload.swap(c.payload);
+			return c.request;
+		case ACKNOWLEDGING:
+			c.state = IDLE;
+			postReceive(index);
+			break;
+		default:
+			break;
+		}
+	}
+}
@@ -0,0 +1,96 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BROADCASTCHANNELS_HPP
+#define BROADCASTCHANNELS_HPP
+
+#include <mpi.h>
+#include <mutex>
+#include <vector>
+
+#include "mpi_data.hpp"
+
+using namespace std;
+
+/**
+ * @brief The channels carrying the requests which every process sends to all the others (WRITE,
+ * METADATA_BATCH, TERMINATE).
+ *
+ * Each process is the root of its own duplicate of MPI_COMM_WORLD, and a request is a nonblocking
+ * broadcast on the communicator of its sender: the MPI library forwards it along a tree, so the latency
+ * grows with the logarithm of the number of processes instead of linearly, and the sender doesn't wait
+ * for the receivers. The requests of a sender are received in the order they are posted.
+ *
+ * The requests addressed to a single process (READ) are still point-to-point messages on MPI_COMM_WORLD
+ * with tag 0, they are received together with the broadcasts.
+ */
+class BroadcastChannels {
+private:
+	typedef enum {IDLE, RECEIVING_HEADER, RECEIVING_PAYLOAD, ACKNOWLEDGE_PENDING, ACKNOWLEDGING} ChannelState;
+
+	typedef struct Channel {
+		MPI_Comm comm;
+		ChannelState state;
+		RequestPacket request;
+		vector<char> payload;
+	} Channel;
+
+	//Singleton implementation
+	static BroadcastChannels *instance;
+	BroadcastChannels(int rank, int worldSize);
+
+	int mpiRank;
+	int mpiWorldSize;
+
+	//channels[i] receives the broadcasts of process i, channels[mpiRank] the point-to-point requests
+	vector<Channel> channels;
+	//The pending receive of each channel, they are waited together
+	vector<MPI_Request> receiveRequests;
+
+	//The requests of a process are broadcast in the same order by all of its threads
+	mutex sendMutex;
+
+	void postReceive(int channel);
+
+public:
+	/**
+	 * @brief Get the channels, the first call is collective over MPI_COMM_WORLD.
+	 */
+	static BroadcastChannels *getInstance(int rank, int worldSize);
+
+	/**
+	 * @brief Broadcast a request and its payload to all the other processes without waiting.
+	 *
+	 * The request and the payload can't be modified nor released until the returned MPI requests are
+	 * completed. If request->acknowledge is TRUE, the last MPI request completes when every process has
+	 * received the request and handled it.
+	 *
+	 * @param request The request, request->payloadSize is the size of the payload.
+	 * @param payload The payload, it can be nullptr if request->payloadSize is 0.
+	 * @param requests The MPI requests of the broadcast are appended to this vector.
+	 */
+	void post(RequestPacket *request, const void *payload, vector<MPI_Request> &requests);
+
+	/**
+	 * @brief Broadcast a request and its payload to all the other processes, it returns when the buffers
+	 * can be reused.
+	 */
+	void broadcast(RequestType type, const void *payload, size_t size);
+
+	/**
+	 * @brief Wait for the next request, it must be invoked by a single thread.
+	 *
+	 * A point-to-point request may be followed by other messages of the same sender with tag 0: they must
+	 * be received before the next call.
+	 *
+	 * @param sourceRank The rank of the sender.
+	 * @param payload The payload of a broadcast request, empty for point-to-point requests.
+	 * @return The request.
+	 */
+	RequestPacket receive(int &sourceRank, vector<char> &payload);
+};
+
+
+
+#endif //BROADCASTCHANNELS_HPP
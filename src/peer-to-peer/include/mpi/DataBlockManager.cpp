@@ -25,23 +25,28 @@ DataBlockManager::DataBlockManager(int mpi_world_size) {
 	DataBlockManagerLogger.setLogLevel(ll);
 }
 
-void DataBlockManager::addDataBlocksTo(vector<DataBlock*>& blockList, int nblocks, fuse_ino_t inode, int startingRank) {
+BlockDistribution DataBlockManager::getDistribution(const DataLayout &layout, size_t nblocks) {
+	return BlockDistribution(layout, nblocks, mpi_world_size);
+}
+
+void DataBlockManager::addDataBlocksTo(vector<DataBlock*>& blockList, int nblocks, fuse_ino_t inode) {
 	int startingIndex = blockList.size();
-	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Master Process - Starting index for new blocks: " << startingIndex);
+	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Starting index for new local blocks: " << startingIndex);
 	int newSize = blockList.size() + nblocks;
-	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Master Process - New block list size: " << newSize);
-	int lastRank = blockList.size() == 0 ? 0 : blockList[startingIndex - 1]->getRank();
-	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Master Process - Last rank in list " << lastRank);
-	int rank_i = lastRank;
-	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Master Process - Starting rank " << lastRank);
+	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "New local block list size: " << newSize);
 
+	//Rank, progressive number and absolute bytes are set by the write, which knows the position of each block in the file
 	for (int i = startingIndex; i < newSize; i++) {
-		DataBlock *dataBlock = new DataBlock(inode);
-		dataBlock->setRank(rank_i);
-		dataBlock->setProgressiveNumber(i);
-		dataBlock->setAbsoluteBytes(i*FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-		blockList.push_back(dataBlock);
+		blockList.push_back(new DataBlock(inode));
+	}
+}
+
+void DataBlockManager::removeDataBlocksFrom(vector<DataBlock*>& blockList, int nblocks) {
+	LOG4CPLUS_INFO(DataBlockManagerLogger, DataBlockManagerLogger.getName() << "Removing " << nblocks << " local blocks");
 
-		if (++rank_i == mpi_world_size) rank_i = 0;
+	for (int i = 0; i < nblocks && !blockList.empty(); i++) {
+		//The destructor frees the data of the block
+		delete blockList.back();
+		blockList.pop_back();
 	}
 }
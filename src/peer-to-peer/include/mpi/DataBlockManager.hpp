@@ -9,6 +9,8 @@
 #include "../utils/log_level.hpp"
 
 #include "../blocks/DataBlock.hpp"
+#include "../blocks/DataLayout.hpp"
+#include "BlockDistribution.hpp"
 using namespace std;
 
 class DataBlockManager {
@@ -23,7 +25,9 @@ private:
 public:
 	static DataBlockManager* getInstance(int mpi_world_size);
 
-	void addDataBlocksTo(vector<DataBlock *> &blockList, int nblocks, fuse_ino_t inode, int startingRank);
+	BlockDistribution getDistribution(const DataLayout &layout, size_t nblocks);
+	void addDataBlocksTo(vector<DataBlock *> &blockList, int nblocks, fuse_ino_t inode);
+	void removeDataBlocksFrom(vector<DataBlock *> &blockList, int nblocks);
 };
 
 
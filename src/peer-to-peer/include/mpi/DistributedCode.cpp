@@ -11,9 +11,13 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <mpi.h>
+#include <mutex>
+#include <shared_mutex>
 #include <vector>
 
 #include "mpi_data.hpp"
+#include "BroadcastChannels.hpp"
+#include "RequestSender.hpp"
 #include "../ramfs/FileSystem.hpp"
 
 using namespace std;
@@ -25,13 +29,12 @@ string DistributedCode::unmountScript = string();
 
 DistributedCode *DistributedCode::instance = nullptr;
 DataBlockManager *DistributedCode::dataBlockManager = nullptr;
+MetadataLog *DistributedCode::metadataLog = nullptr;
 
-int *DistributedCode::scatterCounts = nullptr;
-int *DistributedCode::scatterDispls = nullptr;
-int DistributedCode::scatterOffset = 0;
-int *DistributedCode::gatherCounts = nullptr;
-int *DistributedCode::gatherDispls = nullptr;
-int DistributedCode::gatherOffset = 0;
+MPI_Comm DistributedCode::writeComm = MPI_COMM_NULL;
+MPI_Comm DistributedCode::replyComm = MPI_COMM_NULL;
+int DistributedCode::tagUpperBound = 32767;
+atomic<unsigned> DistributedCode::nextOperation = 0;
 double DistributedCode::lastWriteTime = 0.0;
 double DistributedCode::lastReadTime = 0.0;
 double DistributedCode::DAGonFSWriteSGElapsedTime = 0.0;
@@ -53,13 +56,20 @@ DistributedCode::DistributedCode(int rank, int worldSize, const char* mountpoint
 	unmountScript = mountpointPath;
 	unmountScript += "/unmount.sh " + fsPath;
 	dataBlockManager = DataBlockManager::getInstance(mpiWorldSize);
-
-	scatterCounts = new int[mpiWorldSize];
-	scatterDispls = new int[mpiWorldSize];
-	scatterOffset = 0;
-	gatherCounts = new int[mpiWorldSize];
-	gatherDispls = new int[mpiWorldSize];
-	gatherOffset = 0;
+	//Collective: every process creates the channels before any request is sent
+	BroadcastChannels::getInstance(mpiRank, mpiWorldSize);
+
+	//Collective: the data of the writes and the replies to the requests (the blocks of a read, the entries of a
+	//sharded namespace) travel on their own communicators, where each request is told apart by the tag chosen
+	//by the process which started it
+	MPI_Comm_dup(MPI_COMM_WORLD, &writeComm);
+	MPI_Comm_dup(MPI_COMM_WORLD, &replyComm);
+	int *tagUpperBound_p;
+	int flag;
+	MPI_Comm_get_attr(MPI_COMM_WORLD, MPI_TAG_UB, &tagUpperBound_p, &flag);
+	if (flag) {
+		tagUpperBound = *tagUpperBound_p;
+	}
 
 	lastWriteTime = 0.0;
 	lastReadTime = 0.0;
@@ -69,70 +79,62 @@ DistributedCode::DistributedCode(int rank, int worldSize, const char* mountpoint
 
 
 void DistributedCode::setup() {
-
+	metadataLog = MetadataLog::getInstance(mpiRank, mpiWorldSize);
+	metadataLog->start();
 }
 
 void DistributedCode::start() {
+	BroadcastChannels *channels = BroadcastChannels::getInstance(mpiRank, mpiWorldSize);
 	bool running = true;
 	while (running) {
 		//cout << "Process " << mpiRank << " - Waiting for a request" <<endl;
-		RequestPacket request;
-		MPI_Status status;
-		MPI_Recv(&request,sizeof(RequestPacket), MPI_BYTE, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
+		int sourceRank;
+		vector<char> payload;
+		RequestPacket request = channels->receive(sourceRank, payload);
 		switch (request.type) {
 		case WRITE:
-			if (mpiRank != status.MPI_SOURCE) {
+			if (mpiRank != sourceRank) {
 				//cout << "Process " << mpiRank << " - Invoking DAGonFS_Write()" <<endl;
 				IORequestPacket ioRequest;
-				MPI_Status status;
-				MPI_Recv(&ioRequest, sizeof(IORequestPacket), MPI_BYTE, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
-				//cout << "Process " << mpiRank << " - Received WRITE from P"<<status.MPI_SOURCE<<": ioRequest.inode="<<ioRequest.inode<<", ioRequest.fileSize="<<ioRequest.fileSize<< endl;
-				DAGonFS_Write(status.MPI_SOURCE, MPI_IN_PLACE, ioRequest.inode, ioRequest.fileSize);
+				memcpy(&ioRequest, payload.data(), sizeof(IORequestPacket));
+				//cout << "Process " << mpiRank << " - Received WRITE from P"<<sourceRank<<": ioRequest.inode="<<ioRequest.inode<<", ioRequest.fileSize="<<ioRequest.fileSize<< endl;
+				DAGonFS_Write(sourceRank, MPI_IN_PLACE, ioRequest.inode, ioRequest.fileSize, ioRequest.layout, ioRequest.tag);
 			}
 			break;
 		case READ:
-			if (mpiRank != status.MPI_SOURCE) {
-				//cout << "Process " << mpiRank << " - Invoking DAGonFS_Read()" <<endl;
+			if (mpiRank != sourceRank) {
+				//cout << "Process " << mpiRank << " - Sending local blocks for READ" <<endl;
+				//The packet is received from the same sender before the next request
 				IORequestPacket ioRequest;
-				MPI_Status status;
-				MPI_Recv(&ioRequest, sizeof(IORequestPacket), MPI_BYTE, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
-				//cout << "Process " << mpiRank << " - Received READ from P"<<status.MPI_SOURCE<<":"<< endl;
+				MPI_Recv(&ioRequest, sizeof(IORequestPacket), MPI_BYTE, sourceRank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+				//cout << "Process " << mpiRank << " - Received READ from P"<<sourceRank<<":"<< endl;
 				//cout << "\tioRequest.inode="<<ioRequest.inode<<endl;
 				//cout << "\tioRequest.fileSize="<<ioRequest.fileSize<<endl;
 				//cout << "\tioRequest.reqSize="<<ioRequest.reqSize<<endl;
 				//cout << "\tioRequest.offset="<<ioRequest.offset<<endl;
-				DAGonFS_Read(status.MPI_SOURCE, ioRequest.inode, ioRequest.fileSize, ioRequest.reqSize, ioRequest.offset);
-			}
-			break;
-		case CREATE_FILE:
-			if (mpiRank != status.MPI_SOURCE) {
-				createFile();
+				sendLocalBlocks(sourceRank, ioRequest);
 			}
 			break;
-		case DELETE_FILE:
-			if (mpiRank != status.MPI_SOURCE) {
-				deleteFile();
+		case METADATA_BATCH:
+			if (mpiRank != sourceRank) {
+				//cout << "Process " << mpiRank << " - Applying " << payload.size() << " bytes of metadata operations from P" << sourceRank << endl;
+				MetadataLog::replay(payload.data(), payload.size());
 			}
 			break;
-		case CREATE_DIR:
-			if (mpiRank != status.MPI_SOURCE) {
-				createDir();
-			}
-			break;
-		case DELETE_DIR:
-			if (mpiRank != status.MPI_SOURCE) {
-				deleteDir();
-			}
-			break;
-		case RENAME:
-			if (mpiRank != status.MPI_SOURCE) {
-				renameHandler();
+		case LOOKUP_ENTRY:
+		case CREATE_ENTRY:
+		case UNLINK_ENTRY:
+		case LIST_ENTRIES:
+			if (mpiRank != sourceRank) {
+				serveNamespaceRequest(sourceRank, request.type);
 			}
 			break;
 		case TERMINATE:
 			//cout << "Process " << mpiRank << " - Received termination request" <<endl;
 			running = false;
-			if (mpiRank != status.MPI_SOURCE) {
+			//The operations of a terminating process are shipped before it sends TERMINATE
+			metadataLog->stop(false);
+			if (mpiRank != sourceRank) {
 				unmountFileSystem();
 			}
 			break;
@@ -147,261 +149,321 @@ void DistributedCode::unmountFileSystem() {
 	system(unmountScript.c_str());
 }
 
-void DistributedCode::DAGonFS_Write(int sourceRank, void *buffer, fuse_ino_t inode, size_t fileSize) {
+void DistributedCode::DAGonFS_Write(int sourceRank, void *buffer, fuse_ino_t inode, size_t fileSize, DataLayout layout, int tag) {
+	//Every process binds the writer affinity to the same rank, so they compute the same distribution
+	layout.resolveAffinity(sourceRank);
+
 	if (mpiRank == sourceRank) {
 		IORequestPacket ioRequest;
 		ioRequest.inode = inode;
 		ioRequest.fileSize = fileSize;
+		ioRequest.layout = layout;
+		ioRequest.tag = tag = nextOperationTag();
 		//cout << "Process " << mpiRank << " - Notify all other process for writing operation: ioRequest.inode="<<ioRequest.inode<<", ioRequest.fileSize="<<ioRequest.fileSize<< endl;
-		for (int i=0; i<mpiWorldSize; i++) {
-			if (i != mpiRank) {
-				MPI_Send(&ioRequest,sizeof(IORequestPacket), MPI_BYTE, i, 0, MPI_COMM_WORLD);
-			}
-		}
+		RequestSender::sendWriteRequest(ioRequest, mpiRank, mpiWorldSize);
 	}
 
 	double startWrite = MPI_Wtime();
 
 	size_t numberOfBlocksForRequest = fileSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (fileSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
-	size_t blockPerProcess = numberOfBlocksForRequest / mpiWorldSize;
-	size_t remainingBlocks = numberOfBlocksForRequest % mpiWorldSize;
-	size_t effectiveBlocks = blockPerProcess + (mpiRank < remainingBlocks);
-
-	//Scatter dei dati
-	void *localScatBuf = malloc(effectiveBlocks*FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-	scatterOffset = 0;
-	for (int i=0; i<mpiWorldSize; i++) {
-		//Calculating elements
-		scatterCounts[i] = ( blockPerProcess + (i < remainingBlocks) ) * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
-
-		//Calculating displacements
-		scatterDispls[i] = scatterOffset;
-		scatterOffset += scatterCounts[i];
-	}
-
-	//Gather dei puntatori
-	PointerPacket *localGathBuf = new PointerPacket[effectiveBlocks];
-	gatherOffset = 0;
-	for (int i=0; i<mpiWorldSize; i++) {
-		//Calculating elements
-		gatherCounts[i] = ( blockPerProcess + (i < remainingBlocks) ) * sizeof(PointerPacket);
-
-		//Calculating displacements
-		gatherDispls[i] = gatherOffset;
-		gatherOffset += gatherCounts[i];
-	}
+	BlockDistribution distribution = dataBlockManager->getDistribution(layout, numberOfBlocksForRequest);
+	size_t effectiveBlocks = distribution.getBlocksOfRank(mpiRank);
 
+	//The writer sends to each process its blocks, selected in the file buffer by a datatype, with the
+	//tag of the request: the writes of different processes proceed concurrently
+	void *localBuf = buffer;
 	double startScatter = MPI_Wtime();
 	if (mpiRank == sourceRank) {
-		//cout << "Process " << mpiRank << "=="<<sourceRank<<" - Sending Scatterv" << endl;
-		MPI_Scatterv(buffer, scatterCounts, scatterDispls, MPI_BYTE, localScatBuf, scatterCounts[mpiRank], MPI_BYTE, sourceRank, MPI_COMM_WORLD);
+		vector<MPI_Request> sendRequests;
+		vector<MPI_Datatype> sendTypes;
+		vector<MPI_Aint> displs;
+		for (int i=0; i<mpiWorldSize; i++) {
+			if (i == mpiRank || distribution.getBlocksOfRank(i) == 0)
+				continue;
+
+			distribution.fillDisplsOfRank(i, displs, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+			MPI_Datatype sendType;
+			MPI_Type_create_hindexed_block(displs.size(), FILE_SYSTEM_SINGLE_BLOCK_SIZE, displs.data(), MPI_BYTE, &sendType);
+			MPI_Type_commit(&sendType);
+			sendTypes.push_back(sendType);
+
+			MPI_Request sendRequest;
+			MPI_Isend(buffer, 1, sendType, i, tag, writeComm, &sendRequest);
+			sendRequests.push_back(sendRequest);
+		}
+		MPI_Waitall(sendRequests.size(), sendRequests.data(), MPI_STATUSES_IGNORE);
+
+		for (MPI_Datatype &sendType : sendTypes) {
+			MPI_Type_free(&sendType);
+		}
 	}
 	else {
-		//cout << "Process " << mpiRank << "!="<<sourceRank<<" - Receiving Scatterv" << endl;
-		MPI_Scatterv(MPI_IN_PLACE, scatterCounts, scatterDispls, MPI_BYTE, localScatBuf, scatterCounts[mpiRank], MPI_BYTE, sourceRank, MPI_COMM_WORLD);
+		localBuf = malloc(effectiveBlocks*FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+		if (effectiveBlocks > 0) {
+			MPI_Recv(localBuf, effectiveBlocks*FILE_SYSTEM_SINGLE_BLOCK_SIZE, MPI_BYTE, sourceRank, tag, writeComm, MPI_STATUS_IGNORE);
+		}
 	}
 	double endScatter = MPI_Wtime();
 
-	for (int i=0; i<effectiveBlocks; i++) {
-		void *data_p = malloc(FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-		memcpy(data_p, localScatBuf+i*FILE_SYSTEM_SINGLE_BLOCK_SIZE, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-		localGathBuf[i].address = data_p;
-	}
-
-	PointerPacket *addresses = new PointerPacket[numberOfBlocksForRequest];
-	double startAllGather = MPI_Wtime();
-	MPI_Allgatherv(localGathBuf, gatherCounts[mpiRank], MPI_BYTE, addresses, gatherCounts, gatherDispls, MPI_BYTE, MPI_COMM_WORLD);
-	double endAllGather = MPI_Wtime();
-
-	DAGonFSWriteSGElapsedTime = (endScatter - startScatter) + (endAllGather - startAllGather);
+	DAGonFSWriteSGElapsedTime = endScatter - startScatter;
 
+	//Each process only keeps the descriptors of the blocks it stores: the owner of any other block
+	//is computed from the layout, so no pointer has to be exchanged. The list is changed under the lock of
+	//the inode, the local reads and the reads of other processes copy its blocks concurrently
 	Blocks *blocksManager = Blocks::getInstance();
+	unique_lock<shared_mutex> blocksLock(blocksManager->getMutexOfInode(inode));
 	vector<DataBlock *> &dataBlockList = blocksManager->getDataBlockListOfInode(inode);
-	int additionBlocks = numberOfBlocksForRequest - dataBlockList.size();
+	int additionBlocks = effectiveBlocks - dataBlockList.size();
 	if (additionBlocks > 0) {
-		dataBlockManager->addDataBlocksTo(dataBlockList, additionBlocks, inode, sourceRank);
+		dataBlockManager->addDataBlocksTo(dataBlockList, additionBlocks, inode);
+	}
+	else if (additionBlocks < 0) {
+		dataBlockManager->removeDataBlocksFrom(dataBlockList, -additionBlocks);
+	}
+
+	size_t slot = 0;
+	for (size_t i=0; i < numberOfBlocksForRequest; i++) {
+		if (distribution.getRankOfBlock(i) != mpiRank)
+			continue;
+
+		//The writer copies from the file buffer, the other processes from the received blocks
+		size_t position = mpiRank == sourceRank ? i : slot;
+		void *data_p = malloc(FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+		memcpy(data_p, (char *) localBuf + position*FILE_SYSTEM_SINGLE_BLOCK_SIZE, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+
+		DataBlock *dataBlock = dataBlockList[slot];
+		dataBlock->freeBlock();
+		dataBlock->setData(data_p);
+		dataBlock->setRank(mpiRank);
+		dataBlock->setProgressiveNumber(i);
+		dataBlock->setAbsoluteBytes(i*FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+		slot++;
 	}
-	for (int i=0; i < numberOfBlocksForRequest; i++) {
-		DataBlock *dataBlock = dataBlockList[i];
-		dataBlock->setData(addresses[i].address);
+	blocksLock.unlock();
+	if (localBuf != buffer) {
+		free(localBuf);
 	}
 
 	double endWrite = MPI_Wtime();
 	lastWriteTime = endWrite - startWrite;
 
+	Nodes *INodeManager = Nodes::getInstance();
+	INode *inode_p = INodeManager->getINodeByINodeNumber(inode);
+	//In a sharded namespace only the owner of the entry and the processes caching it know the inode
+	if (inode_p == nullptr)
+		return;
 	if (mpiRank != sourceRank) {
-		Nodes *INodeManager = Nodes::getInstance();
-		INode *inode_p = INodeManager->getINodeByINodeNumber(inode);
 		inode_p->m_fuseEntryParam.attr.st_size = fileSize;
-		inode_p->m_fuseEntryParam.attr.st_blocks = dataBlockList.size();
+		inode_p->m_fuseEntryParam.attr.st_blocks = numberOfBlocksForRequest;
+		//The local mount may cache the old size and pages of the file
+		KernelNotifier::getInstance()->invalidateINode(inode);
 	}
+	//The (resolved) layout travels with the data, so every peer knows how the file is distributed
+	inode_p->m_layout = layout;
 
 }
 
-void* DistributedCode::DAGonFS_Read(int sourceRank, fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset) {
-	if (mpiRank == sourceRank) {
-		IORequestPacket ioRequest;
-		ioRequest.inode = inode;
-		ioRequest.fileSize = fileSize;
-		ioRequest.reqSize = reqSize;
-		ioRequest.offset = offset;
-		//cout << "Process " << mpiRank << " - Notify all other process for reading operation" << endl;
-		//cout << "\tioRequest.inode="<<ioRequest.inode<<endl;
-		//cout << "\tioRequest.fileSize="<<ioRequest.fileSize<<endl;
-		//cout << "\tioRequest.reqSize="<<ioRequest.reqSize<<endl;
-		//cout << "\tioRequest.offset="<<ioRequest.offset<<endl;
-		for (int i=0; i<mpiWorldSize; i++) {
-			if (i != mpiRank) {
-				MPI_Send(&ioRequest,sizeof(IORequestPacket), MPI_BYTE, i, 0, MPI_COMM_WORLD);
-			}
-		}
-	}
-
+void* DistributedCode::DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset, DataLayout layout) {
 	if (fileSize == 0)
 		return nullptr;
 
 	double startRead = MPI_Wtime();
 
-	size_t numberOfBlocksForRequest;
-	if (reqSize > fileSize)
-		numberOfBlocksForRequest = fileSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (fileSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
-	else
-		numberOfBlocksForRequest = reqSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (reqSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
+	size_t numberOfBlocksForRequest = getNumberOfBlocksForRead(fileSize, reqSize);
+	BlockDistribution distribution = dataBlockManager->getDistribution(layout, numberOfBlocksForRequest);
 
-	void *readBuff = nullptr;
-	if (mpiRank == sourceRank) {
-		readBuff = malloc(numberOfBlocksForRequest * FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-		if (readBuff == nullptr) {
-			abort();
-		}
+	void *readBuff = malloc(numberOfBlocksForRequest * FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+	if (readBuff == nullptr) {
+		abort();
 	}
 
-	size_t blockPerProcess = numberOfBlocksForRequest / mpiWorldSize;
-	size_t remainingBlocks = numberOfBlocksForRequest % mpiWorldSize;
-	size_t effectiveBlocks = blockPerProcess + (mpiRank < remainingBlocks);
-
-	//Scatter dei puntatori
-	PointerPacket *addressesToScat = nullptr;
-	if (mpiRank == sourceRank) {
-		addressesToScat = new PointerPacket[numberOfBlocksForRequest];
-		Blocks *blocksManager = Blocks::getInstance();
-		vector<DataBlock *> &dataBlockList = blocksManager->getDataBlockListOfInode(inode);
-		for (int i=0; i<numberOfBlocksForRequest; i++) {
-			addressesToScat[i].address = dataBlockList[i]->getData();
+	//Only the processes owning at least one of the requested blocks take part to the read
+	vector<int> remoteRanks;
+	for (int i=0; i<mpiWorldSize; i++) {
+		if (i != mpiRank && distribution.getBlocksOfRank(i) > 0) {
+			remoteRanks.push_back(i);
 		}
 	}
 
-	PointerPacket *localScatBuf = new PointerPacket[effectiveBlocks];
-	scatterOffset = 0;
-	for (int i=0; i<mpiWorldSize; i++) {
-		//Calculating elements
-		scatterCounts[i] = ( blockPerProcess + (i < remainingBlocks) ) * sizeof(PointerPacket);
-
-		//Calculating displacements
-		scatterDispls[i] = scatterOffset;
-		scatterOffset += scatterCounts[i];
+	//Every remote process sends its blocks in file order with the tag of the request, they are received
+	//directly in their final position
+	int tag = nextOperationTag();
+	vector<MPI_Request> receiveRequests(remoteRanks.size());
+	vector<MPI_Datatype> receiveTypes(remoteRanks.size());
+	vector<MPI_Aint> displs;
+	for (size_t k=0; k<remoteRanks.size(); k++) {
+		distribution.fillDisplsOfRank(remoteRanks[k], displs, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+		MPI_Type_create_hindexed_block(displs.size(), FILE_SYSTEM_SINGLE_BLOCK_SIZE, displs.data(), MPI_BYTE, &receiveTypes[k]);
+		MPI_Type_commit(&receiveTypes[k]);
+		MPI_Irecv(readBuff, 1, receiveTypes[k], remoteRanks[k], tag, replyComm, &receiveRequests[k]);
 	}
 
-	//Gather dei dati
-	void *localGathBuf = malloc(effectiveBlocks*FILE_SYSTEM_SINGLE_BLOCK_SIZE);
-	gatherOffset = 0;
-	for (int i=0; i<mpiWorldSize; i++) {
-		//Calculating elements
-		gatherCounts[i] = ( blockPerProcess + (i < remainingBlocks) ) * FILE_SYSTEM_SINGLE_BLOCK_SIZE;
-
-		//Calculating displacements
-		gatherDispls[i] = gatherOffset;
-		gatherOffset += gatherCounts[i];
+	if (!remoteRanks.empty()) {
+		IORequestPacket ioRequest;
+		ioRequest.inode = inode;
+		ioRequest.fileSize = fileSize;
+		ioRequest.reqSize = reqSize;
+		ioRequest.offset = offset;
+		ioRequest.layout = layout;
+		ioRequest.tag = tag;
+		RequestSender::sendReadRequest(remoteRanks);
+		for (int rank : remoteRanks) {
+			MPI_Send(&ioRequest, sizeof(IORequestPacket), MPI_BYTE, rank, 0, MPI_COMM_WORLD);
+		}
 	}
 
-	double startScatter = MPI_Wtime();
-	if (mpiRank == sourceRank) {
-		MPI_Scatterv(addressesToScat, scatterCounts, scatterDispls, MPI_BYTE, localScatBuf, scatterCounts[mpiRank], MPI_BYTE, sourceRank, MPI_COMM_WORLD);
-	}
-	else {
-		MPI_Scatterv(MPI_IN_PLACE, scatterCounts, scatterDispls, MPI_BYTE, localScatBuf, scatterCounts[mpiRank], MPI_BYTE, sourceRank, MPI_COMM_WORLD);
+	//Local blocks are copied while the remote ones are in flight, a concurrent write may have changed the list
+	//since the size of the file was read, the blocks it no longer has are read as zeros
+	Blocks *blocksManager = Blocks::getInstance();
+	{
+		shared_lock<shared_mutex> blocksLock(blocksManager->getMutexOfInode(inode));
+		vector<DataBlock *> &dataBlockList = blocksManager->getDataBlockListOfInode(inode);
+		size_t slot = 0;
+		for (size_t i=0; i<numberOfBlocksForRequest; i++) {
+			if (distribution.getRankOfBlock(i) == mpiRank) {
+				if (slot < dataBlockList.size())
+					memcpy((char *) readBuff + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE, dataBlockList[slot]->getData(), FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+				else
+					memset((char *) readBuff + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE, 0, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+				slot++;
+			}
+		}
 	}
-	double endScatter = MPI_Wtime();
 
-	for (int i=0; i<effectiveBlocks; i++) {
-		memcpy(localGathBuf + i*FILE_SYSTEM_SINGLE_BLOCK_SIZE, localScatBuf[i].address, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+	double startWait = MPI_Wtime();
+	MPI_Waitall(receiveRequests.size(), receiveRequests.data(), MPI_STATUSES_IGNORE);
+	double endWait = MPI_Wtime();
+	DAGonFSReadSGElapsedTime = endWait - startWait;
+
+	for (MPI_Datatype &receiveType : receiveTypes) {
+		MPI_Type_free(&receiveType);
 	}
 
-	double startGather = MPI_Wtime();
-	MPI_Gatherv(localGathBuf, gatherCounts[mpiRank], MPI_BYTE, mpiRank == sourceRank ? readBuff : MPI_IN_PLACE, gatherCounts, gatherDispls, MPI_BYTE, sourceRank, MPI_COMM_WORLD);
-	double endGather = MPI_Wtime();
-	DAGonFSReadSGElapsedTime = (endGather - startGather) + (endScatter - startScatter);
 	double endRead = MPI_Wtime();
 	lastReadTime = endRead - startRead;
 	
 	return readBuff;
 }
 
-void DistributedCode::createFile() {
-	FileSystem::createFileFromThread = true;
-	FileCreationRequest fileCreationRequest;
+void DistributedCode::sendLocalBlocks(int destRank, IORequestPacket &ioRequest) {
+	if (ioRequest.fileSize == 0)
+		return;
 
-	MPI_Status status;
-	MPI_Recv(&fileCreationRequest,sizeof(FileCreationRequest), MPI_BYTE, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
+	size_t numberOfBlocksForRequest = getNumberOfBlocksForRead(ioRequest.fileSize, ioRequest.reqSize);
+	BlockDistribution distribution = dataBlockManager->getDistribution(ioRequest.layout, numberOfBlocksForRequest);
+	size_t effectiveBlocks = distribution.getBlocksOfRank(mpiRank);
+	if (effectiveBlocks == 0)
+		return;
 
-	string absPath = fsPath + fileCreationRequest.name;
-	//cout << "Process " << mpiRank << " - Creating file '" << absPath << "'" << endl;
+	//The blocks are copied under the lock of the inode, a write of the local process may replace them concurrently
+	Blocks *blocksManager = Blocks::getInstance();
+	void *localBuf = calloc(effectiveBlocks, FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+	{
+		shared_lock<shared_mutex> blocksLock(blocksManager->getMutexOfInode(ioRequest.inode));
+		vector<DataBlock *> &dataBlockList = blocksManager->getDataBlockListOfInode(ioRequest.inode);
+		size_t slot = 0;
+		for (size_t i=0; i<numberOfBlocksForRequest && slot < dataBlockList.size(); i++) {
+			if (distribution.getRankOfBlock(i) == mpiRank) {
+				memcpy((char *) localBuf + slot*FILE_SYSTEM_SINGLE_BLOCK_SIZE, dataBlockList[slot]->getData(), FILE_SYSTEM_SINGLE_BLOCK_SIZE);
+				slot++;
+			}
+		}
+	}
 
-	FILE *file = fopen(absPath.c_str(), "w");
-	fclose(file);
+	MPI_Send(localBuf, effectiveBlocks*FILE_SYSTEM_SINGLE_BLOCK_SIZE, MPI_BYTE, destRank, ioRequest.tag, replyComm);
+	free(localBuf);
 }
 
-void DistributedCode::deleteFile() {
-	FileSystem::deleteFileFromThread = true;
-	FileDeletionRequest fileDeleteRequest;
-
-	MPI_Status status;
-	MPI_Recv(&fileDeleteRequest,sizeof(FileDeletionRequest), MPI_BYTE, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
+void DistributedCode::serveNamespaceRequest(int sourceRank, RequestType type) {
+	NamespaceRequest request;
+	MPI_Recv(&request, sizeof(NamespaceRequest), MPI_BYTE, sourceRank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
 
-	string absPath = fsPath + fileDeleteRequest.name;
-	//cout << "Process " << mpiRank << " - Deleting file '" << absPath << "'" << endl;
+	if (type == LIST_ENTRIES) {
+		vector<NamespaceReply> entries;
+		FileSystem::ServeList(request.entry.parent, entries);
+		MPI_Send(entries.data(), entries.size()*sizeof(NamespaceReply), MPI_BYTE, sourceRank, request.tag, replyComm);
+		return;
+	}
 
-	unlink(absPath.c_str());
+	NamespaceReply reply;
+	if (type == LOOKUP_ENTRY) {
+		FileSystem::ServeLookup(request.entry.parent, request.entry.name, reply);
+	}
+	else if (type == CREATE_ENTRY) {
+		reply.error = FileSystem::ServeCreate(request);
+	}
+	else {
+		INodeDeletionRequest deletion;
+		deletion.parent = request.entry.parent;
+		deletion.inode = request.entry.inode;
+		deletion.generation = request.entry.generation;
+		memcpy(deletion.name, request.entry.name, sizeof(deletion.name));
+		reply.error = FileSystem::ServeUnlink(deletion);
+	}
+	MPI_Send(&reply, sizeof(NamespaceReply), MPI_BYTE, sourceRank, request.tag, replyComm);
 }
 
-void DistributedCode::createDir() {
-	FileSystem::createDirFromThread = true;
-	DirectoryCreationRequest dirCreateRequest;
+int DistributedCode::callEntryOwner(RequestType type, int owner, NamespaceRequest &request, NamespaceReply &reply) {
+	request.tag = nextOperationTag();
+	RequestSender::sendNamespaceRequest(type, owner, request);
+	MPI_Recv(&reply, sizeof(NamespaceReply), MPI_BYTE, owner, request.tag, replyComm, MPI_STATUS_IGNORE);
+	return reply.error;
+}
 
-	MPI_Status status;
-	MPI_Recv(&dirCreateRequest, sizeof(DirectoryCreationRequest), MPI_BYTE, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
+int DistributedCode::lookupEntry(int owner, fuse_ino_t parent, const char *name, NamespaceReply &reply) {
+	NamespaceRequest request;
+	request.entry.parent = parent;
+	strncpy(request.entry.name, name, sizeof(request.entry.name) - 1);
+	return callEntryOwner(LOOKUP_ENTRY, owner, request, reply);
+}
 
-	string absPath = fsPath + dirCreateRequest.absolutePath;
-	//cout << "Process " << mpiRank << " - Creating directory '" << absPath << "'" << endl;
+int DistributedCode::createEntry(int owner, NamespaceRequest &request) {
+	NamespaceReply reply;
+	return callEntryOwner(CREATE_ENTRY, owner, request, reply);
+}
 
-	mkdir(absPath.c_str(), 0777);
+int DistributedCode::unlinkEntry(int owner, const INodeDeletionRequest &deletion) {
+	NamespaceRequest request;
+	request.entry.parent = deletion.parent;
+	request.entry.inode = deletion.inode;
+	request.entry.generation = deletion.generation;
+	memcpy(request.entry.name, deletion.name, sizeof(request.entry.name));
+	NamespaceReply reply;
+	return callEntryOwner(UNLINK_ENTRY, owner, request, reply);
 }
 
-void DistributedCode::deleteDir() {
-	FileSystem::deleteDirFromThread = true;
-	DirectoryDeletionRequest dirDeleteRequest;
+void DistributedCode::listEntries(fuse_ino_t parent, vector<NamespaceReply> &entries) {
+	NamespaceRequest request;
+	request.tag = nextOperationTag();
+	request.entry.parent = parent;
+	for (int i=0; i<mpiWorldSize; i++) {
+		if (i != mpiRank) {
+			RequestSender::sendNamespaceRequest(LIST_ENTRIES, i, request);
+		}
+	}
 
-	MPI_Status status;
-	MPI_Recv(&dirDeleteRequest, sizeof(DirectoryDeletionRequest), MPI_BYTE, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
+	entries.clear();
+	for (int i=0; i<mpiWorldSize; i++) {
+		if (i == mpiRank)
+			continue;
 
-	string absPath = fsPath + dirDeleteRequest.absolutePath;
-	//cout << "Process " << mpiRank << " - Deleting directory '" << absPath << "'" << endl;
+		MPI_Status status;
+		int replySize;
+		MPI_Probe(i, request.tag, replyComm, &status);
+		MPI_Get_count(&status, MPI_BYTE, &replySize);
 
-	rmdir(absPath.c_str());
+		size_t received = entries.size();
+		entries.resize(received + replySize / sizeof(NamespaceReply));
+		MPI_Recv(entries.data() + received, replySize, MPI_BYTE, i, request.tag, replyComm, MPI_STATUS_IGNORE);
+	}
 }
 
-void DistributedCode::renameHandler() {
-	FileSystem::renameFromThread = true;
-	RenameRequest renameRequest;
-
-	MPI_Status status;
-	MPI_Recv(&renameRequest, sizeof(RenameRequest), MPI_BYTE, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
-
-	string absOldPath = fsPath + renameRequest.oldName;
-	string absNewPath = fsPath + renameRequest.newName;
-
-	rename(absOldPath.c_str(), absNewPath.c_str());
+int DistributedCode::nextOperationTag() {
+	return nextOperation++ % ((unsigned) tagUpperBound + 1);
+}
 
-	cout << "Process " << mpiRank << " - old name: '" << absOldPath << "' new name: '" << absNewPath << "'" << endl;
+size_t DistributedCode::getNumberOfBlocksForRead(size_t fileSize, size_t reqSize) {
+	size_t readSize = reqSize > fileSize ? fileSize : reqSize;
+	return readSize / FILE_SYSTEM_SINGLE_BLOCK_SIZE + (readSize % FILE_SYSTEM_SINGLE_BLOCK_SIZE > 0);
 }
 
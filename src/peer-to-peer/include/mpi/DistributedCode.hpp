@@ -4,9 +4,12 @@
 
 #ifndef DISTRIBUTEDCODE_HPP
 #define DISTRIBUTEDCODE_HPP
+#include <mpi.h>
+#include <atomic>
 #include <string>
 
 #include "DataBlockManager.hpp"
+#include "MetadataLog.hpp"
 #include "mpi_data.hpp"
 #include "../utils/fuse_headers.hpp"
 
@@ -22,32 +25,72 @@ private:
 	DistributedCode(int rank, int worldSize, const char *mountpointPath);
 
 	static DataBlockManager *dataBlockManager;
+	static MetadataLog *metadataLog;
 
-	static int *scatterCounts;
-	static int *scatterDispls;
-	static int scatterOffset;
-	static int *gatherCounts;
-	static int *gatherDispls;
-	static int gatherOffset;
+	static MPI_Comm writeComm;
+	static MPI_Comm replyComm;
+	static int tagUpperBound;
+	static std::atomic<unsigned> nextOperation;
 
 	static double DAGonFSWriteSGElapsedTime;
 	static double lastWriteTime;
 	static double DAGonFSReadSGElapsedTime;
 	static double lastReadTime;
 
+	static size_t getNumberOfBlocksForRead(size_t fileSize, size_t reqSize);
+
+	/**
+	 * @brief Get the tag of a new request started by this process.
+	 */
+	static int nextOperationTag();
+
+	/**
+	 * @brief Apply a request of another process to the entries owned by this process and send back the reply.
+	 */
+	static void serveNamespaceRequest(int sourceRank, RequestType type);
+
+	static int callEntryOwner(RequestType type, int owner, NamespaceRequest &request, NamespaceReply &reply);
+
 public:
 	static DistributedCode *getInstance(int rank, int worldSize, const char *mountpointPath);
 	void setup();
 	static void start();
-	static void DAGonFS_Write(int sourceRank, void *buffer, fuse_ino_t inode, size_t fileSize);
-	static void* DAGonFS_Read(int sourceRank, fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset);
-	static void createFile();
-	static void deleteFile();
-	static void createDir();
-	static void deleteDir();
-	static void renameHandler();
+	/**
+	 * @brief Distribute the blocks of a file, it is invoked by the writer and by every process receiving the WRITE request.
+	 *
+	 * @param tag The tag of the data messages chosen by the writer, ignored on the writer.
+	 */
+	static void DAGonFS_Write(int sourceRank, void *buffer, fuse_ino_t inode, size_t fileSize, DataLayout layout, int tag = 0);
+	static void* DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset, DataLayout layout);
+	/**
+	 * @brief Send to the reading process the requested blocks stored by this process.
+	 *
+	 * @param destRank The rank of the reading process.
+	 * @param ioRequest The read request received from destRank.
+	 */
+	static void sendLocalBlocks(int destRank, IORequestPacket &ioRequest);
 	static void unmountFileSystem();
 
+	//Requests to the owners of the entries of a sharded namespace, they return an errno value
+
+	/**
+	 * @brief Look up an entry on its owner.
+	 *
+	 * @param reply Set to the entry and to the attributes known by the owner.
+	 */
+	static int lookupEntry(int owner, fuse_ino_t parent, const char *name, NamespaceReply &reply);
+	/**
+	 * @brief Create an entry on its owner, EAGAIN if the owner doesn't know the parent directory yet.
+	 *
+	 * @param request The entry, request.replace is TRUE if it replaces an existing one with the same name.
+	 */
+	static int createEntry(int owner, NamespaceRequest &request);
+	static int unlinkEntry(int owner, const INodeDeletionRequest &deletion);
+	/**
+	 * @brief Get from every other process the entries of a directory it owns.
+	 */
+	static void listEntries(fuse_ino_t parent, vector<NamespaceReply> &entries);
+
 	double getDAGonFSWriteSGElapsedTime() { return DAGonFSWriteSGElapsedTime; };
 	double getDAGonFSReadSGElapsedTime() { return DAGonFSReadSGElapsedTime; };
 	double getLastWriteTime() { return lastWriteTime; };
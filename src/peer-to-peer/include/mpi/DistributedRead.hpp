@@ -6,11 +6,12 @@
 #define DISTRIBUTEDREAD_HPP
 
 #include "../utils/fuse_headers.hpp"
+#include "../blocks/DataLayout.hpp"
 
 class DistributedRead {
 public:
 	virtual ~DistributedRead() {};
-	virtual void *DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset) = 0;
+	virtual void *DAGonFS_Read(fuse_ino_t inode, size_t fileSize, size_t reqSize, off_t offset, const DataLayout &layout) = 0;
 };
 
 #endif //DISTRIBUTEDREAD_HPP
@@ -6,11 +6,12 @@
 #define DISTRIBUTEDWRITE_HPP
 
 #include "../utils/fuse_headers.hpp"
+#include "../blocks/DataLayout.hpp"
 
 class DistributedWrite {
 public:
 	virtual ~DistributedWrite() {};
-	virtual void DAGonFS_Write(void *buffer, fuse_ino_t inode, size_t fileSize) = 0;
+	virtual void DAGonFS_Write(void *buffer, fuse_ino_t inode, size_t fileSize, const DataLayout &layout) = 0;
 };
 
 #endif //DISTRIBUTEDWRITE_HPP
@@ -0,0 +1,322 @@
+//
+// Created on 10/19/26.
+//
+
+#include "MetadataLog.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "BroadcastChannels.hpp"
+#include "../ramfs/FileSystem.hpp"
+
+using namespace std;
+using namespace log4cplus;
+
+MetadataLog *MetadataLog::instance = nullptr;
+
+MetadataLog *MetadataLog::getInstance(int rank, int worldSize) {
+	if (instance == nullptr) {
+		instance = new MetadataLog(rank, worldSize);
+	}
+
+	return instance;
+}
+
+MetadataLog::MetadataLog(int rank, int worldSize) {
+	mpiRank = rank;
+	mpiWorldSize = worldSize;
+	running = false;
+	unsynced = false;
+
+	maxBatchBytes = 64*1024;
+	maxBatchDelay = chrono::microseconds(1000);
+	syncOnClose = true;
+
+	const char *env = getenv(DAGONFS_ENV_METADATA_BATCH_BYTES);
+	if (env != nullptr) {
+		maxBatchBytes = strtoull(env, nullptr, 10);
+	}
+	env = getenv(DAGONFS_ENV_METADATA_BATCH_USEC);
+	if (env != nullptr) {
+		maxBatchDelay = chrono::microseconds(strtoll(env, nullptr, 10));
+	}
+	env = getenv(DAGONFS_ENV_METADATA_SYNC);
+	if (env != nullptr && string(env) == "fsync") {
+		syncOnClose = false;
+	}
+
+	MetadataLogLogger = Logger::getInstance("MetadataLog.logger Process " + to_string(mpiRank) + " - ");
+	LogLevel ll = DAGONFS_LOG_LEVEL;
+	MetadataLogLogger.setLogLevel(ll);
+	LOG4CPLUS_INFO(MetadataLogLogger, MetadataLogLogger.getName() << "batch of " << maxBatchBytes << " bytes, " << maxBatchDelay.count() << " us, sync on " << (syncOnClose ? "close" : "fsync"));
+}
+
+void MetadataLog::start() {
+	lock_guard<mutex> lock(logMutex);
+	if (!running) {
+		running = true;
+		flusherThread = thread(&MetadataLog::flusherLoop, this);
+	}
+}
+
+void MetadataLog::stop(bool ship) {
+	{
+		lock_guard<mutex> lock(logMutex);
+		if (!running) {
+			return;
+		}
+		running = false;
+	}
+	flusherCondition.notify_one();
+	flusherThread.join();
+
+	if (ship) {
+		sync();
+	}
+}
+
+void MetadataLog::flusherLoop() {
+	unique_lock<mutex> lock(logMutex);
+	while (running) {
+		if (batch.empty()) {
+			flusherCondition.wait(lock);
+		}
+		else if (chrono::steady_clock::now() >= batchStart + maxBatchDelay) {
+			shipBatch();
+		}
+		else {
+			flusherCondition.wait_until(lock, batchStart + maxBatchDelay);
+		}
+		reapBatches(false);
+	}
+}
+
+void MetadataLog::appendCreation(RequestType type, const INodeCreationRequest &request) {
+	lock_guard<mutex> lock(logMutex);
+	beginRecord(type);
+	appendVarint(request.parent);
+	appendVarint(request.inode);
+	appendVarint(request.generation);
+	appendVarint(request.mode);
+	appendVarint(request.uid);
+	appendVarint(request.gid);
+	appendLayout(request.layout);
+	appendString(request.name);
+	endRecord();
+}
+
+void MetadataLog::appendDeletion(RequestType type, const INodeDeletionRequest &request) {
+	lock_guard<mutex> lock(logMutex);
+	beginRecord(type);
+	appendVarint(request.parent);
+	appendVarint(request.inode);
+	appendVarint(request.generation);
+	appendString(request.name);
+	endRecord();
+}
+
+void MetadataLog::appendRename(const RenameRequest &request) {
+	lock_guard<mutex> lock(logMutex);
+	beginRecord(RENAME);
+	appendVarint(request.parent);
+	appendVarint(request.newParent);
+	appendVarint(request.inode);
+	appendVarint(request.generation);
+	appendString(request.oldName);
+	appendString(request.newName);
+	endRecord();
+}
+
+void MetadataLog::flush() {
+	lock_guard<mutex> lock(logMutex);
+	shipBatch();
+	reapBatches(false);
+}
+
+void MetadataLog::sync() {
+	lock_guard<mutex> lock(logMutex);
+	//The acknowledged batch costs a round with every peer, a close which appended nothing doesn't need it
+	if (!unsynced) {
+		return;
+	}
+	shipBatch(true);
+	reapBatches(true);
+}
+
+void MetadataLog::onClose() {
+	if (syncOnClose) {
+		sync();
+	}
+	else {
+		flush();
+	}
+}
+
+void MetadataLog::beginRecord(RequestType type) {
+	if (batch.empty()) {
+		batchStart = chrono::steady_clock::now();
+	}
+	unsynced = true;
+	appendVarint(type);
+}
+
+void MetadataLog::endRecord() {
+	if (batch.size() >= maxBatchBytes) {
+		shipBatch();
+		reapBatches(false);
+	}
+	else {
+		flusherCondition.notify_one();
+	}
+}
+
+/**
+ * Unsigned LEB128: 7 bits for each byte, the most significant bit tells if another byte follows.
+ */
+void MetadataLog::appendVarint(uint64_t value) {
+	while (value >= 0x80) {
+		batch.push_back((char) ((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	batch.push_back((char) value);
+}
+
+void MetadataLog::appendString(const char *str) {
+	size_t length = strlen(str);
+	appendVarint(length);
+	batch.insert(batch.end(), str, str + length);
+}
+
+void MetadataLog::appendLayout(const DataLayout &layout) {
+	appendVarint(layout.stripeCount);
+	appendVarint(layout.stripeUnit);
+	appendVarint(layout.startRank);
+	appendVarint(layout.affinityMode);
+	appendVarint(layout.affinityRank);
+	appendVarint(layout.affinityStripes);
+}
+
+void MetadataLog::shipBatch(bool acknowledge) {
+	//An acknowledged batch is shipped even if empty, it waits for the delivery of the previous ones
+	if (batch.empty() && !acknowledge) {
+		return;
+	}
+
+	inFlight.emplace_back();
+	InFlightBatch &shipped = inFlight.back();
+	shipped.request.type = METADATA_BATCH;
+	shipped.data.swap(batch);
+	shipped.request.payloadSize = shipped.data.size();
+	shipped.request.acknowledge = acknowledge;
+	if (acknowledge) {
+		unsynced = false;
+	}
+	LOG4CPLUS_DEBUG(MetadataLogLogger, MetadataLogLogger.getName() << "shipping a batch of " << shipped.data.size() << " bytes");
+
+	BroadcastChannels::getInstance(mpiRank, mpiWorldSize)->post(&shipped.request, shipped.data.data(), shipped.requests);
+}
+
+void MetadataLog::reapBatches(bool wait) {
+	while (!inFlight.empty()) {
+		InFlightBatch &shipped = inFlight.front();
+		if (wait) {
+			MPI_Waitall(shipped.requests.size(), shipped.requests.data(), MPI_STATUSES_IGNORE);
+		}
+		else {
+			int completed = 0;
+			MPI_Testall(shipped.requests.size(), shipped.requests.data(), &completed, MPI_STATUSES_IGNORE);
+			if (!completed) {
+				//The batches are released in order
+				return;
+			}
+		}
+		inFlight.pop_front();
+	}
+}
+
+uint64_t MetadataLog::readVarint(const char *&cursor, const char *end) {
+	uint64_t value = 0;
+	int shift = 0;
+	while (cursor < end) {
+		unsigned char byte = (unsigned char) *cursor++;
+		value |= (uint64_t) (byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) {
+			break;
+		}
+		shift += 7;
+	}
+	return value;
+}
+
+void MetadataLog::readString(const char *&cursor, const char *end, char *str, size_t size) {
+	size_t length = readVarint(cursor, end);
+	if (length > (size_t) (end - cursor)) {
+		length = end - cursor;
+	}
+	size_t copied = length < size - 1 ? length : size - 1;
+	memcpy(str, cursor, copied);
+	str[copied] = '\0';
+	cursor += length;
+}
+
+void MetadataLog::readLayout(const char *&cursor, const char *end, DataLayout &layout) {
+	layout.stripeCount = (int) readVarint(cursor, end);
+	layout.stripeUnit = (unsigned int) readVarint(cursor, end);
+	layout.startRank = (int) readVarint(cursor, end);
+	layout.affinityMode = (AffinityMode) readVarint(cursor, end);
+	layout.affinityRank = (int) readVarint(cursor, end);
+	layout.affinityStripes = (unsigned int) readVarint(cursor, end);
+}
+
+void MetadataLog::replay(const char *data, size_t size) {
+	const char *cursor = data;
+	const char *end = data + size;
+	while (cursor < end) {
+		RequestType type = (RequestType) readVarint(cursor, end);
+		switch (type) {
+		case CREATE_FILE:
+		case CREATE_DIR: {
+			INodeCreationRequest request;
+			request.parent = readVarint(cursor, end);
+			request.inode = readVarint(cursor, end);
+			request.generation = readVarint(cursor, end);
+			request.mode = readVarint(cursor, end);
+			request.uid = readVarint(cursor, end);
+			request.gid = readVarint(cursor, end);
+			readLayout(cursor, end, request.layout);
+			readString(cursor, end, request.name, sizeof(request.name));
+			FileSystem::ReplicateCreate(type == CREATE_DIR ? DIRECTORY : REGULAR_FILE, request);
+			break;
+		}
+		case DELETE_FILE:
+		case DELETE_DIR: {
+			INodeDeletionRequest request;
+			request.parent = readVarint(cursor, end);
+			request.inode = readVarint(cursor, end);
+			request.generation = readVarint(cursor, end);
+			readString(cursor, end, request.name, sizeof(request.name));
+			if (type == DELETE_DIR)
+				FileSystem::ReplicateRmdir(request);
+			else
+				FileSystem::ReplicateUnlink(request);
+			break;
+		}
+		case RENAME: {
+			RenameRequest request;
+			request.parent = readVarint(cursor, end);
+			request.newParent = readVarint(cursor, end);
+			request.inode = readVarint(cursor, end);
+			request.generation = readVarint(cursor, end);
+			readString(cursor, end, request.oldName, sizeof(request.oldName));
+			readString(cursor, end, request.newName, sizeof(request.newName));
+			FileSystem::ReplicateRename(request);
+			break;
+		}
+		default:
+			//Unknown record: the rest of the batch can't be decoded
+			return;
+		}
+	}
+}
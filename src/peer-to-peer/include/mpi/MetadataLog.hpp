@@ -0,0 +1,143 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef METADATALOG_HPP
+#define METADATALOG_HPP
+
+#include <mpi.h>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <condition_variable>
+
+#include "mpi_data.hpp"
+#include "../utils/log_level.hpp"
+
+using namespace std;
+
+//Environment variables tuning the metadata log
+#define DAGONFS_ENV_METADATA_BATCH_BYTES "DAGONFS_METADATA_BATCH_BYTES"
+#define DAGONFS_ENV_METADATA_BATCH_USEC  "DAGONFS_METADATA_BATCH_USEC"
+#define DAGONFS_ENV_METADATA_SYNC        "DAGONFS_METADATA_SYNC"
+
+/**
+ * @brief The log of the metadata operations to replicate on the other processes.
+ *
+ * The operations (create, unlink, mkdir, rmdir, rename) are appended to a batch with a variable-length
+ * encoding and the batch is broadcast to every peer (see BroadcastChannels) when it exceeds a size
+ * (DAGONFS_METADATA_BATCH_BYTES, 64 KiB by default) or an age (DAGONFS_METADATA_BATCH_USEC, 1 ms by default).
+ * The peers apply the operations in the order of the log.
+ *
+ * A consistency point ships the batch and waits until every peer has applied it. With
+ * DAGONFS_METADATA_SYNC=close (the default) the consistency point is the close of a file, so a file closed
+ * on a process can be opened on the others (close-to-open consistency); with DAGONFS_METADATA_SYNC=fsync
+ * only fsync() is a consistency point. The batch is always shipped before a distributed write, so the
+ * peers know the inode when the data arrives.
+ */
+class MetadataLog {
+private:
+	typedef struct InFlightBatch {
+		RequestPacket request;
+		vector<char> data;
+		vector<MPI_Request> requests;
+	} InFlightBatch;
+
+	//Singleton implementation
+	static MetadataLog *instance;
+	MetadataLog(int rank, int worldSize);
+
+	int mpiRank;
+	int mpiWorldSize;
+
+	size_t maxBatchBytes;
+	chrono::microseconds maxBatchDelay;
+	bool syncOnClose;
+
+	mutex logMutex;
+	condition_variable flusherCondition;
+	thread flusherThread;
+	bool running;
+
+	vector<char> batch;
+	//Records have been appended since the last acknowledged batch, a consistency point has something to wait for
+	bool unsynced;
+	chrono::steady_clock::time_point batchStart;
+	list<InFlightBatch> inFlight;
+
+	log4cplus::Logger MetadataLogLogger;
+
+	void beginRecord(RequestType type);
+	void endRecord();
+	void appendVarint(uint64_t value);
+	void appendString(const char *str);
+	void appendLayout(const DataLayout &layout);
+
+	/**
+	 * @brief Broadcast the current batch to every peer, logMutex must be held.
+	 *
+	 * @param acknowledge TRUE for a batch whose broadcast completes when every peer has applied it.
+	 */
+	void shipBatch(bool acknowledge = false);
+
+	/**
+	 * @brief Release the batches whose sends are completed, logMutex must be held.
+	 *
+	 * @param wait TRUE for waiting the completion of every batch.
+	 */
+	void reapBatches(bool wait);
+
+	void flusherLoop();
+
+	static uint64_t readVarint(const char *&cursor, const char *end);
+	static void readString(const char *&cursor, const char *end, char *str, size_t size);
+	static void readLayout(const char *&cursor, const char *end, DataLayout &layout);
+
+public:
+	static MetadataLog *getInstance(int rank, int worldSize);
+
+	/**
+	 * @brief Start the thread shipping the batches older than the maximum delay.
+	 */
+	void start();
+
+	/**
+	 * @brief Stop the flusher thread.
+	 *
+	 * @param ship TRUE for shipping the pending operations, FALSE if the peers are already terminating.
+	 */
+	void stop(bool ship);
+
+	void appendCreation(RequestType type, const INodeCreationRequest &request);
+	void appendDeletion(RequestType type, const INodeDeletionRequest &request);
+	void appendRename(const RenameRequest &request);
+
+	/**
+	 * @brief Ship the pending operations without waiting for their delivery.
+	 */
+	void flush();
+
+	/**
+	 * @brief Consistency point: ship the pending operations and wait until every peer has applied them.
+	 *
+	 * Nothing is shipped if no operation has been appended since the last consistency point.
+	 */
+	void sync();
+
+	/**
+	 * @brief Invoked when a file is closed, it is a consistency point with close-to-open consistency.
+	 */
+	void onClose();
+
+	/**
+	 * @brief Apply a batch received from another process to the local namespace.
+	 *
+	 * @param data The encoded batch.
+	 * @param size The size of the batch.
+	 */
+	static void replay(const char *data, size_t size);
+};
+
+#endif //METADATALOG_HPP
@@ -0,0 +1,71 @@
+//
+// Created on 10/19/26.
+//
+
+#include "NamespacePartition.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+NamespacePartition *NamespacePartition::instance = nullptr;
+
+NamespacePartition *NamespacePartition::getInstance(int rank, int worldSize) {
+	if (instance == nullptr) {
+		instance = new NamespacePartition(rank, worldSize);
+	}
+
+	return instance;
+}
+
+NamespacePartition::NamespacePartition(int rank, int worldSize) {
+	mpiRank = rank;
+	mpiWorldSize = worldSize;
+	sharded = false;
+	cacheTimeout = chrono::microseconds(1000000);
+
+	const char *env = getenv(DAGONFS_ENV_NAMESPACE);
+	if (env != nullptr && string(env) == "sharded") {
+		sharded = true;
+	}
+	env = getenv(DAGONFS_ENV_DENTRY_CACHE_USEC);
+	if (env != nullptr) {
+		cacheTimeout = chrono::microseconds(strtoll(env, nullptr, 10));
+	}
+}
+
+int NamespacePartition::getOwner(fuse_ino_t parent, const char *name) {
+	if (!sharded) {
+		return mpiRank;
+	}
+
+	//FNV-1a of the parent inode number followed by the name: the owner of the entries of a directory
+	//doesn't change when the directory is renamed
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (size_t i=0; i<sizeof(parent); i++) {
+		hash = (hash ^ ((parent >> (8*i)) & 0xff)) * 0x100000001b3ULL;
+	}
+	for (const char *c = name; *c != '\0'; c++) {
+		hash = (hash ^ (unsigned char) *c) * 0x100000001b3ULL;
+	}
+
+	return hash % mpiWorldSize;
+}
+
+void NamespacePartition::cacheEntry(fuse_ino_t ino) {
+	lock_guard<mutex> lock(cacheMutex);
+	cachedEntries[ino] = chrono::steady_clock::now();
+}
+
+bool NamespacePartition::isFresh(fuse_ino_t ino) {
+	lock_guard<mutex> lock(cacheMutex);
+	auto entry = cachedEntries.find(ino);
+	return entry != cachedEntries.end() && chrono::steady_clock::now() - entry->second < cacheTimeout;
+}
+
+void NamespacePartition::forgetEntry(fuse_ino_t ino) {
+	lock_guard<mutex> lock(cacheMutex);
+	cachedEntries.erase(ino);
+}
@@ -0,0 +1,81 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef NAMESPACEPARTITION_HPP
+#define NAMESPACEPARTITION_HPP
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+#include "../utils/fuse_headers.hpp"
+
+using namespace std;
+
+//Environment variables selecting the partition of the namespace
+#define DAGONFS_ENV_NAMESPACE          "DAGONFS_NAMESPACE"
+#define DAGONFS_ENV_DENTRY_CACHE_USEC  "DAGONFS_DENTRY_CACHE_USEC"
+
+/**
+ * @brief The partition of the namespace among the processes.
+ *
+ * By default (DAGONFS_NAMESPACE=replicated) every process keeps the whole namespace and every change is
+ * replicated on all the others through the MetadataLog.
+ *
+ * With DAGONFS_NAMESPACE=sharded the directories are still replicated, while the entries of the files are
+ * partitioned by the hash of the parent directory and of the name: the owner of an entry is the only process
+ * which stores it, and the creation, the unlink and the lookup of the entry are routed to it. The other
+ * processes keep a copy of the entries they create or look up (dentry cache), which is revalidated with the
+ * owner when it is older than DAGONFS_DENTRY_CACHE_USEC (1 s by default).
+ */
+class NamespacePartition {
+private:
+	//Singleton implementation
+	static NamespacePartition *instance;
+	NamespacePartition(int rank, int worldSize);
+
+	int mpiRank;
+	int mpiWorldSize;
+	bool sharded;
+	chrono::microseconds cacheTimeout;
+
+	mutex cacheMutex;
+	map<fuse_ino_t, chrono::steady_clock::time_point> cachedEntries;
+
+public:
+	static NamespacePartition *getInstance(int rank, int worldSize);
+
+	bool isSharded() { return sharded; }
+
+	/**
+	 * @brief The seconds a copy of an entry owned by another process can be used without asking the owner.
+	 */
+	double getCacheTimeout() { return chrono::duration<double>(cacheTimeout).count(); }
+
+	/**
+	 * @brief Get the process owning an entry of a file.
+	 *
+	 * @param parent The parent directory.
+	 * @param name The name of the entry.
+	 * @return The rank of the owner, which is the local process if the namespace is replicated.
+	 */
+	int getOwner(fuse_ino_t parent, const char *name);
+
+	/**
+	 * @brief Record a copy of an entry owned by another process.
+	 */
+	void cacheEntry(fuse_ino_t ino);
+
+	/**
+	 * @brief Check if the copy of an entry owned by another process can be used without asking the owner.
+	 */
+	bool isFresh(fuse_ino_t ino);
+
+	void forgetEntry(fuse_ino_t ino);
+};
+
+
+
+#endif //NAMESPACEPARTITION_HPP
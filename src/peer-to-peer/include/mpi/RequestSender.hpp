@@ -6,18 +6,22 @@
 #define REQUESTSENDER_HPP
 
 #include "../utils/fuse_headers.hpp"
+#include "mpi_data.hpp"
 #include <string>
+#include <vector>
 
 class RequestSender {
 public:
-	static void sendWriteRequest(int sourceRank, int mpiWorldSize);
-	static void sendReadRequest(int sourceRank, int mpiWorldSize);
-	static void sendCreateFileRequest(std::string name, int sourceRank, int mpiWorldSize);
-	static void sendDeleteFileRequest(std::string name, int sourceRank, int mpiWorldSize);
-	static void sendCreateDirectoryRequest(std::string dirAbsPath,  int sourceRank, int mpiWorldSize);
-	static void sendDeleteDirectoryRequest(std::string dirAbsPath,  int sourceRank, int mpiWorldSize);
-	static void sendRenameRequest(std::string oldName, std::string newName,  int sourceRank, int mpiWorldSize);
+	/**
+	 * @brief Broadcast the WRITE request to all other processes, they take part to the scatter of the data.
+	 */
+	static void sendWriteRequest(const IORequestPacket &ioRequest, int sourceRank, int mpiWorldSize);
+	static void sendReadRequest(const std::vector<int> &ranks);
 	static void sendTerminationRequest(int sourceRank, int mpiWorldSize);
+	/**
+	 * @brief Send a request to the owner of an entry of a sharded namespace.
+	 */
+	static void sendNamespaceRequest(RequestType type, int destRank, const NamespaceRequest &request);
 };
 
 
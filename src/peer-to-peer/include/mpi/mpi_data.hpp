@@ -6,11 +6,17 @@
 #define MPI_DATA_HPP
 
 #include "../utils/fuse_headers.hpp"
+#include "../blocks/DataLayout.hpp"
 
-typedef enum {WRITE, READ, CREATE_FILE, DELETE_FILE, CREATE_DIR, DELETE_DIR, RENAME,TERMINATE} RequestType;
+typedef enum {WRITE, READ, CREATE_FILE, DELETE_FILE, CREATE_DIR, DELETE_DIR, RENAME,TERMINATE, METADATA_BATCH,
+              LOOKUP_ENTRY, CREATE_ENTRY, UNLINK_ENTRY, LIST_ENTRIES} RequestType;
 
 typedef struct RequstPacket {
 	RequestType type;
+	//Size of the payload of a broadcast request (see BroadcastChannels)
+	size_t payloadSize = 0;
+	//TRUE if the sender waits until every process has handled the request
+	bool acknowledge = false;
 } RequestPacket;
 
 
@@ -20,6 +26,9 @@ typedef struct IORequestPacket {
 	size_t fileSize;
 	size_t reqSize;
 	off_t offset;
+	DataLayout layout;
+	//Tag of the data messages of the request, chosen by the process which started it
+	int tag;
 } IORequestPacket;
 
 
@@ -27,25 +36,57 @@ typedef struct PointerPacket {
 	void *address;
 } PointerPacket;
 
-typedef struct FileCreationRequest {
-	char name[256] = {0};
-} FileCreationRequest;
+//The metadata operations are shipped in batches by MetadataLog, these structures are the decoded records.
+//The metadata operations refer to the inodes by number: every process hands out inode numbers of its own
+//class (see Nodes::setINodeNumbering()), so they are the same on every replica. The generation number
+//tells apart two inodes that have used the same number.
 
-typedef struct FileDeletionRequest {
+typedef struct INodeCreationRequest {
+	fuse_ino_t parent;
+	fuse_ino_t inode;
+	uint64_t generation;
+	mode_t mode;
+	uid_t uid;
+	gid_t gid;
+	DataLayout layout;
 	char name[256] = {0};
-} FileDeletionRequest;
-
-typedef struct DirectoryCreationRequest {
-	char absolutePath[256] = {0};
-} DirectoryCreationRequest;
+} INodeCreationRequest;
 
-typedef struct DirectoryDeletionRequest {
-	char absolutePath[256] = {0};
-} DirectoryDeletionRequest;
+typedef struct INodeDeletionRequest {
+	fuse_ino_t parent;
+	fuse_ino_t inode;
+	uint64_t generation;
+	char name[256] = {0};
+} INodeDeletionRequest;
 
 typedef struct enameRequest {
+	fuse_ino_t parent;
+	fuse_ino_t newParent;
+	fuse_ino_t inode;
+	uint64_t generation;
 	char oldName[256] = {0};
 	char newName[256] = {0};
 } RenameRequest;
 
+//The requests routed to the owner of an entry when the namespace is sharded (see NamespacePartition).
+//The reply is sent with the tag of the request.
+
+typedef struct NamespaceRequest {
+	int tag;
+	//TRUE if CREATE_ENTRY replaces an existing entry with the same name (rename)
+	bool replace = false;
+	//The entry: LOOKUP_ENTRY and LIST_ENTRIES only use parent and name, UNLINK_ENTRY also inode and generation
+	INodeCreationRequest entry;
+	//The attributes of the inode of a renamed entry
+	off_t size = 0;
+	blkcnt_t blocks = 0;
+} NamespaceRequest;
+
+typedef struct NamespaceReply {
+	int error = 0;
+	INodeCreationRequest entry;
+	off_t size = 0;
+	blkcnt_t blocks = 0;
+} NamespaceReply;
+
 #endif //MPI_DATA_HPP
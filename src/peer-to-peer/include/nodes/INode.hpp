@@ -9,6 +9,7 @@
 #include <map>
 #include <string>
 #include "../utils/log_level.hpp"
+#include "../blocks/DataLayout.hpp"
 
 using namespace std;
 
@@ -54,6 +55,14 @@ public:
      */
     map<string, pair<void *, size_t> > m_xattr;
 
+    /**
+     * @brief The layout policy of this inode.
+     *
+     * For a file it describes how its blocks are distributed among the processes, for a directory
+     * it's the layout inherited by the new children.
+     */
+    DataLayout m_layout;
+
     /**
      * @brief Constructor
      */
@@ -13,10 +13,15 @@
 using namespace std;
 
 Nodes *Nodes::_instance = nullptr;
+double Nodes::AttrTimeout = 1.0;
+double Nodes::EntryTimeout = 1.0;
 
 Nodes::Nodes() {
     INodes = vector<INode *>();
     DeletedINodes = queue<fuse_ino_t>();
+    nextINodeNumber = 0;
+    INodeNumberOffset = 0;
+    INodeNumberStride = 1;
 }
 
 Nodes* Nodes::getInstance() {
@@ -27,19 +32,48 @@ Nodes* Nodes::getInstance() {
 }
 
 INode* Nodes::getINodeByINodeNumber(fuse_ino_t inodeNumber) {
+    lock_guard<mutex> lock(INodesMutex);
+    if (inodeNumber >= INodes.size()) {
+        return nullptr;
+    }
     return INodes[inodeNumber];
 }
 
-void Nodes::setINodeAt(fuse_ino_t inodeNummber,INode *inode) {
+INode *Nodes::setINodeAt(fuse_ino_t inodeNummber,INode *inode) {
+    lock_guard<mutex> lock(INodesMutex);
+    if (inodeNummber >= INodes.size()) {
+        INodes.resize(inodeNummber + 1, nullptr);
+    }
+    INode *oldINode = INodes[inodeNummber];
     INodes[inodeNummber] = inode;
+    return oldINode;
 }
 
+/**
+ * The numbers of the other classes are left empty, they are filled when the replicas of the inodes
+ * created by the other processes are installed.
+ */
 fuse_ino_t Nodes::AddINode(INode* newInode) {
-    INodes.push_back(newInode);
-    fuse_ino_t newInodeNumber = INodes.size() - 1;
+    lock_guard<mutex> lock(INodesMutex);
+    fuse_ino_t newInodeNumber = nextINodeNumber;
+    nextINodeNumber += INodeNumberStride;
+    if (newInodeNumber >= INodes.size()) {
+        INodes.resize(newInodeNumber + 1, nullptr);
+    }
+    INodes[newInodeNumber] = newInode;
     return newInodeNumber;
 }
 
+void Nodes::setINodeNumbering(fuse_ino_t offset, fuse_ino_t stride) {
+    lock_guard<mutex> lock(INodesMutex);
+    INodeNumberOffset = offset;
+    INodeNumberStride = stride;
+    nextINodeNumber = offset;
+    while (nextINodeNumber < INodes.size()) {
+        nextINodeNumber += INodeNumberStride;
+    }
+}
+
 INode* Nodes::createEmptyINode(INodeType type) {
     INode *newINode;
 
@@ -70,8 +104,8 @@ void Nodes::InitializeINode(INode *inode, fuse_ino_t ino, mode_t mode, nlink_t n
     inode->inodeNumber = ino;
 
     inode->m_fuseEntryParam.ino = ino;
-    inode->m_fuseEntryParam.attr_timeout = 1.0;
-    inode->m_fuseEntryParam.entry_timeout = 1.0;
+    inode->m_fuseEntryParam.attr_timeout = Nodes::AttrTimeout;
+    inode->m_fuseEntryParam.entry_timeout = Nodes::EntryTimeout;
     inode->m_fuseEntryParam.attr.st_mode = mode;
     inode->m_fuseEntryParam.attr.st_gid = gid;
     inode->m_fuseEntryParam.attr.st_uid = uid;
@@ -103,7 +137,7 @@ void Nodes::InitializeINode(INode *inode, fuse_ino_t ino, mode_t mode, nlink_t n
  * Overloading.
  */
 void Nodes::LookupINode(fuse_ino_t inodeNumber) {
-    LookupINode(INodes[inodeNumber]);
+    LookupINode(getINodeByINodeNumber(inodeNumber));
 }
 
 /**
@@ -117,7 +151,7 @@ void Nodes::LookupINode(INode* inode) {
  * Overloading.
  */
 void Nodes::Forget(fuse_ino_t inodeNumber, unsigned long nlookup) {
-    Forget(INodes[inodeNumber],nlookup);
+    Forget(getINodeByINodeNumber(inodeNumber),nlookup);
 }
 
 /**
@@ -129,9 +163,12 @@ void Nodes::Forget(INode* inode, unsigned long nlookup) {
 
 /**
  * The given inode is not effectively deleted: it's only marked as deleted for reclaiming it later.
+ * Only the numbers owned by this process can be reclaimed, the others are reused by their owner.
  */
 void Nodes::DeleteINode(fuse_ino_t inodeNumber) {
-    DeletedINodes.push(inodeNumber);
+    if (ownsINodeNumber(inodeNumber)) {
+        DeletedINodes.push(inodeNumber);
+    }
 }
 
 /**
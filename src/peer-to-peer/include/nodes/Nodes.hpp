@@ -9,6 +9,7 @@
 
 #include <vector>
 #include <queue>
+#include <mutex>
 
 #include "../utils/fuse_headers.hpp"
 #include "../blocks/data_blocks_info.hpp"
@@ -44,12 +45,34 @@ private:
      */
     queue<fuse_ino_t> DeletedINodes;
 
+    /**
+     * @brief Guard of the inode list, which is also modified by the MPI thread when replicating remote operations.
+     */
+    mutex INodesMutex;
+
+    /**
+     * @brief The next inode number handed out by AddINode().
+     */
+    fuse_ino_t nextINodeNumber;
+
+    /**
+     * @brief The inode numbers handed out by AddINode() are congruent to INodeNumberOffset modulo INodeNumberStride.
+     */
+    fuse_ino_t INodeNumberOffset;
+    fuse_ino_t INodeNumberStride;
+
 public:
     /**
      * @brief The size of a file system block.
      */
     static const size_t INodeBufBlockSize = FILE_SYSTEM_SINGLE_BLOCK_SIZE;
 
+    /**
+     * @brief The seconds the kernel keeps the attributes and the directory entries of the inodes (-o attr_timeout, -o entry_timeout).
+     */
+    static double AttrTimeout;
+    static double EntryTimeout;
+
     //Singleton
     /**
      * @brief The method which give the instance of the singleton.
@@ -79,7 +102,7 @@ public:
      *
      * @return The number of inode in the file system.
      */
-    int getNumberOfINodes(){return INodes.size();}
+    int getNumberOfINodes(){ lock_guard<mutex> lock(INodesMutex); return INodes.size(); }
 
     /**
      * @brief Get the number of deleted inodes.
@@ -91,10 +114,30 @@ public:
     /**
      * @brief Set a new inode object to a previously used (and then deleted) inode number.
      *
+     * The list grows if the inode number is not registered yet, which happens when a replica installs
+     * an inode created by another process.
+     *
      * @param inodeNumber The inode number of the inode to set.
      * @param inode The new inode.
+     * @return The inode previously registered with the same number, nullptr if there wasn't any.
+     */
+    INode *setINodeAt(fuse_ino_t inodeNumber, INode *inode);
+
+    /**
+     * @brief Reserve to this process the inode numbers congruent to offset modulo stride.
+     *
+     * Every process creates inodes with numbers of its own class, so the numbers are the same on every
+     * replica and the operations on an inode can be replicated using its number.
+     *
+     * @param offset The first inode number of the class (the MPI rank).
+     * @param stride The number of classes (the MPI world size).
+     */
+    void setINodeNumbering(fuse_ino_t offset, fuse_ino_t stride);
+
+    /**
+     * @brief Check if the given inode number can be handed out by this process.
      */
-    void setINodeAt(fuse_ino_t inodeNumber, INode *inode);
+    bool ownsINodeNumber(fuse_ino_t inodeNumber) { return inodeNumber % INodeNumberStride == INodeNumberOffset; }
 
     /**
      * @brief Add a new inode object to the inode list.
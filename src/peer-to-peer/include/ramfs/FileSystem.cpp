@@ -17,6 +17,9 @@
 #include <cstring>
 #include <cassert>
 #include <thread>
+#include <set>
+#include <algorithm>
+#include <cstddef>
 
 //For logging
 #include <dirent.h>
@@ -52,13 +55,13 @@ double FileSystem::endWriteTime = 0.0;
 double FileSystem::startReadTime = 0.0;
 double FileSystem::endReadTime = 0.0;
 bool FileSystem::unmountFromThread = false;
-bool FileSystem::createFileFromThread = false;
-bool FileSystem::deleteFileFromThread = false;
-bool FileSystem::createDirFromThread = false;
-bool FileSystem::deleteDirFromThread = false;
-bool FileSystem::renameFromThread = false;
+mutex FileSystem::m_namespaceMutex;
 
 DistributedCode *FileSystem::distributedProcessCode = nullptr;
+MetadataLog *FileSystem::metadataLog = nullptr;
+NamespacePartition *FileSystem::namespacePartition = nullptr;
+KernelNotifier *FileSystem::kernelNotifier = nullptr;
+double FileSystem::m_negativeTimeout = 0.0;
 
 /**
  * Constructor of our file system in RAM. It initializes all fuse operation to its methods.
@@ -114,6 +117,9 @@ FileSystem::FileSystem(int rank, int mpi_world_size) {
     mpiRank = rank;
     mpiWorldSize = mpi_world_size;
     distributedProcessCode = DistributedCode::getInstance(mpiRank,mpiWorldSize,"");
+    metadataLog = MetadataLog::getInstance(mpiRank,mpiWorldSize);
+    namespacePartition = NamespacePartition::getInstance(mpiRank,mpiWorldSize);
+    kernelNotifier = KernelNotifier::getInstance();
 
     LogLevel ll = DAGONFS_LOG_LEVEL;
     FSLogger = Logger::getInstance("FuseFileSystem.logger Process " + to_string(mpiRank) + " - ");
@@ -180,6 +186,29 @@ int FileSystem::start(int argc,char *argv[]) {
     fuse_args args_for_fuse = FUSE_ARGS_INIT(argc, copied_argv_for_fuse);
     fuse_cmdline_opts fuse_options;
 
+    //LIBFUSE
+    //Timeouts of the kernel caches: the options are removed from the args, fuse_session_new() doesn't know them
+    typedef struct CacheTimeouts {
+        double attr;
+        double entry;
+        double negative;
+    } CacheTimeouts;
+    CacheTimeouts timeouts = {Nodes::AttrTimeout, Nodes::EntryTimeout, m_negativeTimeout};
+    const fuse_opt timeoutOptions[] = {
+        {"attr_timeout=%lf", offsetof(CacheTimeouts, attr), 0},
+        {"entry_timeout=%lf", offsetof(CacheTimeouts, entry), 0},
+        {"negative_timeout=%lf", offsetof(CacheTimeouts, negative), 0},
+        FUSE_OPT_END
+    };
+    if (fuse_opt_parse(&args_for_fuse, &timeouts, timeoutOptions, nullptr) != 0) {
+        show_usage(argv[0]);
+        return ret;
+    }
+    Nodes::AttrTimeout = timeouts.attr;
+    Nodes::EntryTimeout = timeouts.entry;
+    m_negativeTimeout = timeouts.negative;
+    LOG4CPLUS_INFO(FSLogger, FSLogger.getName() << "attr_timeout " << Nodes::AttrTimeout << " s, entry_timeout " << Nodes::EntryTimeout << " s, negative_timeout " << m_negativeTimeout << " s");
+
     //LIBFUSE
     //CLI arguments parsing to fill the options
     if(fuse_parse_cmdline(&args_for_fuse,&fuse_options) != 0){
@@ -234,7 +263,9 @@ int FileSystem::start(int argc,char *argv[]) {
             //LIBFUSE
             //Entering a single-block-event loop
             fuse_daemonize(fuse_options.foreground);
+            kernelNotifier->start(session);
             ret = fuse_session_loop(session);
+            kernelNotifier->stop();
             LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "***** Loop terminated *****");
 
 
@@ -265,6 +296,8 @@ int FileSystem::start(int argc,char *argv[]) {
     rmdir(argv[2]);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "--> Step 9: tell other MPI process that the file system has been unmounted");
+    //The pending metadata operations are shipped only if the other processes are still running
+    metadataLog->stop(!unmountFromThread);
     if (!unmountFromThread) {
         //Send termination
         RequestSender::sendTerminationRequest(mpiRank,mpiWorldSize);
@@ -281,6 +314,9 @@ void FileSystem::show_usage(const char *progname){
             "       -V\n"
             "       --help \t\tdisplay help information"
             "       --ho"
+            "       -o attr_timeout=S \tseconds the kernel caches the attributes (1.0)\n"
+            "       -o entry_timeout=S \tseconds the kernel caches the directory entries (1.0)\n"
+            "       -o negative_timeout=S \tseconds the kernel remembers the missing names (0.0)\n"
             "\n");
 }
 
@@ -316,6 +352,10 @@ void FileSystem::FuseInit(void *userdata, struct fuse_conn_info *conn) {
     rootDir->setDirName("/");
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "root directory registered!");
 
+    //The special inode and the root directory are the same on every process, the other inode numbers
+    //are split among the processes so that the numbers created here are valid on every replica
+    INodeManager->setINodeNumbering(mpiRank, mpiWorldSize);
+
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "FuseInit() completed!");
 }
 
@@ -333,10 +373,13 @@ fuse_ino_t FileSystem::RegisterINode(INodeType type, mode_t mode, nlink_t nlink,
 
     //Either re-use a deleted inode or push one back depending on whether we're reclaiming inodes now or not
     fuse_ino_t ino;
+    uint64_t generation = 0;
     if (m_reclaimingINodes) {
         ino = INodeManager->reclaimINode();
         INode *del_p = INodeManager->getINodeByINodeNumber(ino);
         FileSystem::UpdateUsedBlocks(-(del_p->UsedBlocks())); //Operazione della struttura dati Blocks
+        //A new generation tells the replicas (and the kernel) that the number now refers to another inode
+        generation = del_p->m_fuseEntryParam.generation + 1;
         INodeManager->setINodeAt(ino,inode_p);
         delete del_p;
     } else {
@@ -345,10 +388,98 @@ fuse_ino_t FileSystem::RegisterINode(INodeType type, mode_t mode, nlink_t nlink,
     }
 
     INodeManager->InitializeINode(inode_p, ino, mode, nlink, gid, uid);
+    inode_p->m_fuseEntryParam.generation = generation;
 
     return ino;
 }
 
+/**
+ * The child gets the same layout of the parent directory, as the Lustre default striping. The layout extended attributes
+ * are copied too, so they can be read back with getxattr() on the child.
+ */
+void FileSystem::InheritLayout(INode *parent, INode *child) {
+    child->m_layout = parent->m_layout;
+    for (auto &xattr: parent->GetXAttr()) {
+        if (DataLayout::isLayoutAttribute(xattr.first)) {
+            child->SetXAttr(xattr.first, xattr.second.first, xattr.second.second, 0, 0);
+        }
+    }
+}
+
+void FileSystem::LinkDirectory(Directory *parentDir_p, Directory *dir_p, fuse_ino_t ino, const char *name) {
+    // Insert the inode into the directory. TODO: What if it already exists?
+    parentDir_p->UpdateChild(string(name), ino);
+
+    // Update the number of hardlinks in the parent dir
+    parentDir_p->AddHardLink();
+
+    // Set parent dir to new dir
+    dir_p->setParent(parentDir_p);
+
+    // Set dir name
+    string dirName = parentDir_p->getDirName() + name + "/";
+    dir_p->setDirName(dirName.c_str());
+}
+
+void FileSystem::UnlinkDirectory(Directory *parentDir_p, Directory *dir_p, const char *name) {
+    // Update the number of hardlinks in the parent dir
+    parentDir_p->RemoveHardLink();
+
+    // Remove the hard links to this dir so it can be cleaned up later
+    // TODO: What if there's a real hardlink to this dir? Hardlinks to dirs allowed?
+    while (!dir_p->HasNoLinks()) {
+        dir_p->RemoveHardLink();
+    }
+
+    parentDir_p->DeleteChild(string(name));
+}
+
+void FileSystem::MoveChild(Directory *parentDir, const char *name, Directory *newParentDir, const char *newname, fuse_ino_t ino) {
+    // Look for an existing child with the same name in the new parent
+    // directory
+    fuse_ino_t existingIno = newParentDir->ChildINodeNumberWithName(string(newname));
+    // Type is unsigned so we have to explicitly check for largest value. TODO: Refactor please.
+    if (existingIno != -1 && existingIno > 0) {
+        // There's already a child with that name. Replace it.
+        // TODO: What about directories with the same name?
+        INode *existingInode_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(existingIno));
+        if (existingInode_p != nullptr) {
+            parentDir->RemoveHardLink();
+            LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tRemoving hard link to " << existingIno);
+            newParentDir->AddHardLink();
+            LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tAdding hard link to " << existingIno);
+        }
+    }
+
+    // Update (or create) the new name and point it to the inode.
+    newParentDir->UpdateChild(string(newname), ino);
+
+    // Mark the old name as unused. TODO: Should we just delete the old name?
+    parentDir->DeleteChild(string(name));
+}
+
+INodeCreationRequest FileSystem::MakeCreationRequest(fuse_ino_t parent, INode *inode_p, const char *name) {
+    INodeCreationRequest request;
+    request.parent = parent;
+    request.inode = inode_p->m_fuseEntryParam.ino;
+    request.generation = inode_p->m_fuseEntryParam.generation;
+    request.mode = inode_p->m_fuseEntryParam.attr.st_mode;
+    request.uid = inode_p->m_fuseEntryParam.attr.st_uid;
+    request.gid = inode_p->m_fuseEntryParam.attr.st_gid;
+    request.layout = inode_p->m_layout;
+    strncpy(request.name, name, sizeof(request.name) - 1);
+    return request;
+}
+
+INodeDeletionRequest FileSystem::MakeDeletionRequest(fuse_ino_t parent, INode *inode_p, const char *name) {
+    INodeDeletionRequest request;
+    request.parent = parent;
+    request.inode = inode_p->m_fuseEntryParam.ino;
+    request.generation = inode_p->m_fuseEntryParam.generation;
+    strncpy(request.name, name, sizeof(request.name) - 1);
+    return request;
+}
+
 void FileSystem::FuseGetAttr(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi){
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Getting Attributes -> FuseRamFs::FuseGetAttr()");
     //Fail if the inode hasn't been created yet
@@ -359,13 +490,14 @@ void FileSystem::FuseGetAttr(fuse_req_t req, fuse_ino_t ino, struct fuse_file_in
     //TODO: What do we do if the inode was deleted?
     INode *inode = INodeManager->getINodeByINodeNumber(ino);
 
-    fuse_reply_attr(req, &(inode->m_fuseEntryParam.attr), 1.0);
+    fuse_reply_attr(req, &(inode->m_fuseEntryParam.attr), Nodes::AttrTimeout);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Getting Attributes -> FuseRamFs::FuseGetAttr() completed!");
 }
 
 void FileSystem::FuseLookup(fuse_req_t req, fuse_ino_t parent, const char* name) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Lookup -> FuseRamFs::FuseLookup()");
+    unique_lock<mutex> lock(m_namespaceMutex);
 
     if (parent >= INodeManager->getNumberOfINodes()) {
         fuse_reply_err(req, ENOENT);
@@ -381,27 +513,82 @@ void FileSystem::FuseLookup(fuse_req_t req, fuse_ino_t parent, const char* name)
     }
 
     fuse_ino_t ino = dir->ChildINodeNumberWithName(string(name));
-    if (ino == -1) {
-        fuse_reply_err(req, ENOENT);
+    INode *inode = ino == -1 ? nullptr : INodeManager->getINodeByINodeNumber(ino);
+
+    // In a sharded namespace the entry of a file owned by another process is looked up on the owner, unless
+    // the local copy is recent enough. The directories are replicated.
+    int owner = namespacePartition->getOwner(parent, name);
+    bool cachedFile = dynamic_cast<File *>(inode) != nullptr;
+    if (owner != mpiRank && (inode == nullptr || (cachedFile && !namespacePartition->isFresh(ino)))) {
+        lock.unlock();
+        NamespaceReply reply;
+        int error = distributedProcessCode->lookupEntry(owner, parent, name, reply);
+        lock.lock();
+
+        dir = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(parent));
+        if (dir == nullptr) {
+            fuse_reply_err(req, ENOENT);
+            return;
+        }
+        if (error == ENOENT) {
+            DropCachedEntry(dir, name);
+            // The owner doesn't notify the creations to the other processes: the kernel must ask again
+            ReplyNegativeEntry(req, min(m_negativeTimeout, namespacePartition->getCacheTimeout()));
+            return;
+        }
+        if (error != 0) {
+            DropCachedEntry(dir, name);
+            fuse_reply_err(req, error);
+            return;
+        }
+        inode = InstallCachedEntry(dir, reply);
+        ino = reply.entry.inode;
+    }
+
+    if (inode == nullptr) {
+        ReplyNegativeEntry(req, m_negativeTimeout);
         return;
     }
 
     // TODO: What do we do if the inode was deleted?
-    INode *inode = INodeManager->getINodeByINodeNumber(ino);
     INodeManager->LookupINode(ino);
 
+    // The kernel mustn't use the entry of a file owned by another process longer than the local copy
+    fuse_entry_param entry = inode->m_fuseEntryParam;
+    if (owner != mpiRank && dynamic_cast<File *>(inode) != nullptr) {
+        entry.entry_timeout = min(entry.entry_timeout, namespacePartition->getCacheTimeout());
+    }
+
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tLookup for: " << ino << "-" << name << " nlookup++");
-    fuse_reply_entry(req, &(inode->m_fuseEntryParam));
+    fuse_reply_entry(req, &entry);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Lookup -> FuseRamFs::FuseLookup() completed!");
 }
 
+/**
+ * A negative entry is an entry with inode number 0: the kernel answers ENOENT by itself until it expires, or until
+ * the entry is invalidated by the creation of the name on another process.
+ */
+void FileSystem::ReplyNegativeEntry(fuse_req_t req, double timeout) {
+    if (timeout <= 0) {
+        fuse_reply_err(req, ENOENT);
+        return;
+    }
+
+    fuse_entry_param entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.ino = 0;
+    entry.entry_timeout = timeout;
+    fuse_reply_entry(req, &entry);
+}
+
 /**
  * Check if the i-node is forgotten. If an i-node has no hard links, it's added to the deleted i-node list.
  * Check if the number of deleted i-node is greater than a threshold, the file system active reclaiming mode.
  */
 void FileSystem::FuseForget(fuse_req_t req, fuse_ino_t ino, unsigned long nlookup) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Forgetting -> FuseRamFs::FuseForget()");
+    lock_guard<mutex> lock(m_namespaceMutex);
     //TODO: What if the inode doesn't exist!?!?!?!
     INode *inode_p = INodeManager->getINodeByINodeNumber(ino);
 
@@ -446,7 +633,7 @@ void FileSystem::FuseSetAttr(fuse_req_t req, fuse_ino_t ino, struct stat* attr,
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tsetattr per: " << ino);
     INodeManager->SetINodeAttributes(inode, attr, to_set);
-    fuse_reply_attr(req, &(inode->m_fuseEntryParam.attr), 1.0);
+    fuse_reply_attr(req, &(inode->m_fuseEntryParam.attr), Nodes::AttrTimeout);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Setting -> FuseRamFs::FuseSetAttr() completed!");
 }
@@ -482,6 +669,7 @@ void FileSystem::FuseReadLink(fuse_req_t req, fuse_ino_t ino) {
 
 void FileSystem::FuseMknod(fuse_req_t req, fuse_ino_t parent, const char* name, mode_t mode, dev_t rdev) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Making node -> FuseRamFs::FuseMknod()");
+    lock_guard<mutex> lock(m_namespaceMutex);
 
     if (parent >= INodeManager->getNumberOfINodes()) {
         fuse_reply_err(req, ENOENT);
@@ -544,6 +732,8 @@ void FileSystem::FuseMknod(fuse_req_t req, fuse_ino_t parent, const char* name,
     // TODO: Handle: S_ISCHR S_ISBLK S_ISFIFO S_ISLNK S_ISSOCK S_TYPEISMQ S_TYPEISSEM S_TYPEISSHM
     assert(inode_p != nullptr);
 
+    InheritLayout(parentDir_p, inode_p);
+
     // Insert the inode into the directory. TODO: What if it already exists?
     parentDir_p->UpdateChild(string(name), ino);
 
@@ -557,6 +747,7 @@ void FileSystem::FuseMknod(fuse_req_t req, fuse_ino_t parent, const char* name,
 
 void FileSystem::FuseMkdir(fuse_req_t req, fuse_ino_t parent, const char* name, mode_t mode) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Making directory '" << name << "'-> FuseRamFs::FuseMkdir()");
+    unique_lock<mutex> lock(m_namespaceMutex);
 
     if (parent >= INodeManager->getNumberOfINodes()) {
         fuse_reply_err(req, ENOENT);
@@ -578,19 +769,8 @@ void FileSystem::FuseMkdir(fuse_req_t req, fuse_ino_t parent, const char* name,
 
     fuse_ino_t ino = RegisterINode(DIRECTORY, S_IFDIR | 0777, 2, getgid(), getuid());
     Directory *dir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(ino));
-
-    // Insert the inode into the directory. TODO: What if it already exists?
-    parentDir_p->UpdateChild(string(name), ino);
-
-    // Update the number of hardlinks in the parent dir
-    parentDir_p->AddHardLink();
-
-    // Set parent dir to new dir
-    dir_p->setParent(parentDir_p);
-
-    // Set dir name
-    string dirName = parentDir_p->getDirName() + name + "/";
-    dir_p->setDirName(dirName.c_str());
+    InheritLayout(parentDir_p, dir_p);
+    LinkDirectory(parentDir_p, dir_p, ino, name);
     LOG4CPLUS_INFO(FSLogger, FSLogger.getName() << "Absolute path of new directory: '" << dir_p->getDirName() << "'");
 
     // TODO: Is reply_entry only for directories? What about files?
@@ -598,10 +778,9 @@ void FileSystem::FuseMkdir(fuse_req_t req, fuse_ino_t parent, const char* name,
     dir_p->Lookup();
     fuse_reply_entry(req, &(dir_p->m_fuseEntryParam));
 
-    if (!createDirFromThread) {
-        RequestSender::sendCreateDirectoryRequest(dir_p->getDirName(), mpiRank, mpiWorldSize);
-    }
-    createDirFromThread = false;
+    INodeCreationRequest dirCreateRequest = MakeCreationRequest(parent, dir_p, name);
+    lock.unlock();
+    metadataLog->appendCreation(CREATE_DIR, dirCreateRequest);
 
 
     /*
@@ -620,6 +799,7 @@ void FileSystem::FuseMkdir(fuse_req_t req, fuse_ino_t parent, const char* name,
  */
 void FileSystem::FuseUnlink(fuse_req_t req, fuse_ino_t parent, const char* name) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Unlinking inode-> FuseRamFs::FuseUnlink()");
+    unique_lock<mutex> lock(m_namespaceMutex);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tunlink per: " << name << " nella directory padre: " << parent);
 
@@ -653,19 +833,43 @@ void FileSystem::FuseUnlink(fuse_req_t req, fuse_ino_t parent, const char* name)
     // TODO: Any way we can fail here? What if the inode doesn't exist? That probably indicates
     // a problem that happened earlier.
 
+    LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << "File to delete '"<<parentDir_p->getDirName() + name<<"'");
+    INodeDeletionRequest fileDeleteRequest = MakeDeletionRequest(parent, inode_p, name);
+
+    // In a sharded namespace the entry is removed by its owner first, the local copy only if the owner succeeds
+    int owner = namespacePartition->getOwner(parent, name);
+    if (owner != mpiRank && dynamic_cast<File *>(inode_p) != nullptr) {
+        lock.unlock();
+        int error = distributedProcessCode->unlinkEntry(owner, fileDeleteRequest);
+        if (error != 0) {
+            fuse_reply_err(req, error);
+            return;
+        }
+
+        // The entry may have changed while the owner was removing it
+        lock.lock();
+        parentDir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(parent));
+        if (parentDir_p != nullptr && parentDir_p->ChildINodeNumberWithName(string(name)) == ino) {
+            INodeManager->getINodeByINodeNumber(ino)->RemoveHardLink();
+            parentDir_p->DeleteChild(string(name));
+        }
+        lock.unlock();
+        namespacePartition->forgetEntry(ino);
+        fuse_reply_err(req, 0);
+        return;
+    }
+
     // Update the number of hardlinks in the target
     inode_p->RemoveHardLink();
     parentDir_p->DeleteChild(string(name));
+    lock.unlock();
 
     // Reply with no error. TODO: Where is ESUCCESS?
     fuse_reply_err(req, 0);
 
-    string fileName = parentDir_p->getDirName() + name;
-    LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << "File to delete '"<<fileName<<"'");
-    if (!deleteFileFromThread) {
-        RequestSender::sendDeleteFileRequest(fileName, mpiRank, mpiWorldSize);
+    if (!namespacePartition->isSharded()) {
+        metadataLog->appendDeletion(DELETE_FILE, fileDeleteRequest);
     }
-    deleteFileFromThread = false;
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Unlinking inode-> FuseRamFs::FuseUnlink() completed!");
 }
@@ -676,6 +880,23 @@ void FileSystem::FuseUnlink(fuse_req_t req, fuse_ino_t parent, const char* name)
 void FileSystem::FuseRmdir(fuse_req_t req, fuse_ino_t parent, const char *name) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Removing directory -> FuseRamFs::FuseRmdir");
 
+    // In a sharded namespace the directory is empty only if no process owns entries in it
+    if (namespacePartition->isSharded()) {
+        fuse_ino_t dirIno = -1;
+        {
+            lock_guard<mutex> lock(m_namespaceMutex);
+            Directory *parentDir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(parent));
+            if (parentDir_p != nullptr) {
+                dirIno = parentDir_p->ChildINodeNumberWithName(string(name));
+            }
+        }
+        if (dirIno != -1 && dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(dirIno)) != nullptr) {
+            RefreshDirectory(dirIno);
+        }
+    }
+
+    unique_lock<mutex> lock(m_namespaceMutex);
+
     if (parent >= INodeManager->getNumberOfINodes()) {
         LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tparent >= INodes.size()");
         fuse_reply_err(req, ENOENT);
@@ -723,31 +944,21 @@ void FileSystem::FuseRmdir(fuse_req_t req, fuse_ino_t parent, const char *name)
         return;
     }
 
-    // Update the number of hardlinks in the parent dir
-    parentDir_p->RemoveHardLink();
-
-    // Remove the hard links to this dir so it can be cleaned up later
-    // TODO: What if there's a real hardlink to this dir? Hardlinks to dirs allowed?
-    while (!dir_p->HasNoLinks()) {
-        dir_p->RemoveHardLink();
-    }
-
-    parentDir_p->DeleteChild(string(name));
+    UnlinkDirectory(parentDir_p, dir_p, name);
 
     // Reply with no error. TODO: Where is ESUCCESS?
     fuse_reply_err(req, 0);
 
-    string dirName = dir_p->getDirName();
-    if (!deleteDirFromThread) {
-        RequestSender::sendDeleteDirectoryRequest(dirName, mpiRank, mpiWorldSize);
-    }
-    deleteDirFromThread = false;
+    INodeDeletionRequest dirDeleteRequest = MakeDeletionRequest(parent, dir_p, name);
+    lock.unlock();
+    metadataLog->appendDeletion(DELETE_DIR, dirDeleteRequest);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Removing directory -> FuseRamFs::FuseRmdir completed!");
 }
 
 void FileSystem::FuseSymlink(fuse_req_t req, const char* link, fuse_ino_t parent, const char* name) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Creating symbolic link -> FuseRamFs::FuseSymlink");
+    lock_guard<mutex> lock(m_namespaceMutex);
     if (parent >= INodeManager->getNumberOfINodes()) {
         fuse_reply_err(req, ENOENT);
         return;
@@ -786,6 +997,7 @@ void FileSystem::FuseSymlink(fuse_req_t req, const char* link, fuse_ino_t parent
 
 void FileSystem::FuseRename(fuse_req_t req, fuse_ino_t parent, const char* name, fuse_ino_t newparent, const char* newname, unsigned int flags) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Renaming new inode -> FuseRamFs::FuseRename()");
+    unique_lock<mutex> lock(m_namespaceMutex);
     // Make sure the parent still exists.
     if (parent >= INodeManager->getNumberOfINodes()) {
         fuse_reply_err(req, ENOENT);
@@ -828,46 +1040,84 @@ void FileSystem::FuseRename(fuse_req_t req, fuse_ino_t parent, const char* name,
         return;
     }
 
-    // Look for an existing child with the same name in the new parent
-    // directory
-    fuse_ino_t existingIno = newParentDir->ChildINodeNumberWithName(string(newname));
-    // Type is unsigned so we have to explicitly check for largest value. TODO: Refactor please.
-    if (existingIno != -1 && existingIno > 0) {
-        // There's already a child with that name. Replace it.
-        // TODO: What about directories with the same name?
-        INode *existingInode_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(existingIno));
-        if (existingInode_p != nullptr) {
-            parentDir->RemoveHardLink();
-            LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tRemoving hard link to " << existingIno);
-            newParentDir->AddHardLink();
-            LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tAdding hard link to " << existingIno);
+    INode *inode_p = INodeManager->getINodeByINodeNumber(ino);
+    RenameRequest renameRequest;
+    renameRequest.parent = parent;
+    renameRequest.newParent = newparent;
+    renameRequest.inode = ino;
+    renameRequest.generation = inode_p->m_fuseEntryParam.generation;
+    strncpy(renameRequest.oldName, name, sizeof(renameRequest.oldName) - 1);
+    strncpy(renameRequest.newName, newname, sizeof(renameRequest.newName) - 1);
+
+    // In a sharded namespace the entry of a file moves from the owner of the old name to the owner of the new one
+    bool shardedEntry = namespacePartition->isSharded() && dynamic_cast<File *>(inode_p) != nullptr;
+    if (!shardedEntry) {
+        MoveChild(parentDir, name, newParentDir, newname, ino);
+        LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tRename " << name << " in " << parent << " to " << newname << " in " << newparent);
+        lock.unlock();
+        fuse_reply_err(req, 0);
+        metadataLog->appendRename(renameRequest);
+        LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Renaming new inode -> FuseRamFs::FuseRename() completed!");
+        return;
+    }
+
+    INodeDeletionRequest oldEntryRequest = MakeDeletionRequest(parent, inode_p, name);
+    INodeDeletionRequest newEntryDeletion = MakeDeletionRequest(newparent, inode_p, newname);
+    NamespaceRequest newEntryRequest;
+    newEntryRequest.entry = MakeCreationRequest(newparent, inode_p, newname);
+    newEntryRequest.replace = true;
+    newEntryRequest.size = inode_p->m_fuseEntryParam.attr.st_size;
+    newEntryRequest.blocks = inode_p->m_fuseEntryParam.attr.st_blocks;
+    lock.unlock();
+
+    // The owners change first, the local entry moves only if both of them succeed
+    int oldOwner = namespacePartition->getOwner(parent, name);
+    int newOwner = namespacePartition->getOwner(newparent, newname);
+    int error = 0;
+    if (newOwner != mpiRank) {
+        error = distributedProcessCode->createEntry(newOwner, newEntryRequest);
+        if (error == EAGAIN) {
+            // The owner doesn't know the new parent directory yet: deliver the metadata log and retry
+            metadataLog->sync();
+            error = distributedProcessCode->createEntry(newOwner, newEntryRequest);
         }
     }
+    if (error == 0 && oldOwner != mpiRank) {
+        error = distributedProcessCode->unlinkEntry(oldOwner, oldEntryRequest);
+        if (error != 0 && newOwner != mpiRank) {
+            // The new entry is taken back, so the owners keep only the old name
+            distributedProcessCode->unlinkEntry(newOwner, newEntryDeletion);
+        }
+    }
+    if (error != 0) {
+        fuse_reply_err(req, error);
+        return;
+    }
 
-    // Update (or create) the new name and point it to the inode.
-    newParentDir->UpdateChild(string(newname), ino);
-
-    // Mark the old name as unused. TODO: Should we just delete the old name?
-    parentDir->DeleteChild(string(name));
-
-    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tRename " << name << " in " << parent << " to " << newname << " in " << newparent);
-    fuse_reply_err(req, 0);
-
-    if (!renameFromThread) {
-        string oldName = parentDir->getDirName()+name;
-        string newName = newParentDir->getDirName()+newname;
-        cout << oldName << endl;
-        cout << newName << endl;
-        RequestSender::sendRenameRequest(oldName, newName, mpiRank, mpiWorldSize);
+    // The entries may have changed while the owners were updated
+    lock.lock();
+    parentDir = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(parent));
+    newParentDir = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(newparent));
+    if (parentDir != nullptr && newParentDir != nullptr && parentDir->ChildINodeNumberWithName(string(name)) == ino) {
+        MoveChild(parentDir, name, newParentDir, newname, ino);
+        LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tRename " << name << " in " << parent << " to " << newname << " in " << newparent);
     }
-    else renameFromThread = false;
+    lock.unlock();
 
+    if (newOwner != mpiRank) {
+        namespacePartition->cacheEntry(ino);
+    }
+    else {
+        namespacePartition->forgetEntry(ino);
+    }
+    fuse_reply_err(req, 0);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Renaming new inode -> FuseRamFs::FuseRename() completed!");
 }
 
 void FileSystem::FuseLink(fuse_req_t req, fuse_ino_t ino, fuse_ino_t newparent, const char* newname) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Creating hard link -> FuseRamFs::FuseLink");
+    lock_guard<mutex> lock(m_namespaceMutex);
 
     // Make sure the new parent still exists.
     if (newparent >= INodeManager->getNumberOfINodes()) {
@@ -949,13 +1199,13 @@ void FileSystem::FuseOpen(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info*
     }
     else {
         LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << "\tFile opened in read and write or a mode that not erase the file content, the content must be loaded");
-        RequestSender::sendReadRequest(mpiRank, mpiWorldSize);
         //4KB
         startReadTime = MPI_Wtime();
-        file_p->m_buf = distributedProcessCode->DAGonFS_Read(mpiRank, ino,
+        file_p->m_buf = distributedProcessCode->DAGonFS_Read(ino,
                                                     file_p->m_fuseEntryParam.attr.st_size,
                                                     file_p->m_fuseEntryParam.attr.st_size,
-                                                    0);
+                                                    0,
+                                                    file_p->m_layout);
 
         //
     }
@@ -985,8 +1235,9 @@ void FileSystem::FuseFlush(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info
     if (file_p->m_buf != nullptr) {
         if (file_p->isWaitingForWriting()) {
             LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << ino << " will flush with distributed write");
-            RequestSender::sendWriteRequest(mpiRank, mpiWorldSize);
-            distributedProcessCode->DAGonFS_Write(mpiRank, file_p->m_buf, ino, file_p->m_fuseEntryParam.attr.st_size);
+            //The peers must know the inode before its blocks arrive
+            metadataLog->flush();
+            distributedProcessCode->DAGonFS_Write(mpiRank, file_p->m_buf, ino, file_p->m_fuseEntryParam.attr.st_size, file_p->m_layout);
             endWriteTime = MPI_Wtime();
             fileContent += "Total write time: "+to_string(endWriteTime - startWriteTime)+"\n";
             fileContent += "Time for Scat-Gath in DAGonFS_Write: "+ to_string(distributedProcessCode->getDAGonFSWriteSGElapsedTime()) +"\n";
@@ -1004,6 +1255,8 @@ void FileSystem::FuseFlush(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info
         file_p->m_buf = nullptr;
     }
 
+    //Close-to-open consistency: the other processes see the namespace changes once the file is closed
+    metadataLog->onClose();
 
     fuse_reply_err(req, 0);
     fileContent += "\n";
@@ -1063,6 +1316,7 @@ void FileSystem::FuseFsync(fuse_req_t req, fuse_ino_t ino, int datasync, struct
     }
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\tfysnc for " << ino);
+    metadataLog->sync();
     fuse_reply_err(req, 0);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Synchronizing file -> FuseRamFs::Fsync completed");
@@ -1076,6 +1330,11 @@ void FileSystem::FuseOpenDir(fuse_req_t req, fuse_ino_t ino, struct fuse_file_in
         return;
     }
 
+    // In a sharded namespace the listing needs the entries owned by the other processes
+    if (namespacePartition->isSharded() && dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(ino)) != nullptr) {
+        RefreshDirectory(ino);
+    }
+
     INode *inode = INodeManager->getINodeByINodeNumber(ino);
 
     // You can't open a file with 'opendir'. Check for this.
@@ -1100,6 +1359,7 @@ void FileSystem::FuseOpenDir(fuse_req_t req, fuse_ino_t ino, struct fuse_file_in
  */
 void FileSystem::FuseReadDir(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off, struct fuse_file_info* fi) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Reading directory -> FuseRamFs::FuseReadDir()");
+    lock_guard<mutex> lock(m_namespaceMutex);
 
     (void) fi;
 
@@ -1266,6 +1526,7 @@ void FileSystem::FuseFsyncDir(fuse_req_t req, fuse_ino_t ino, int datasync, stru
     }
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\tfysncdir for " << ino);
+    metadataLog->sync();
     fuse_reply_err(req, 0);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Synchronizing directory -> FuseRamFs::FuseFsyncDir completed");
@@ -1310,7 +1571,26 @@ void FileSystem::FuseSetXAttr(fuse_req_t req, fuse_ino_t ino, const char *name,
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\tsetxattr for " << ino);
 
-    int ret_val = inode_p->SetXAttr(string(name), value, size, flags, position);
+    int ret_val = 0;
+    bool isLayout = DataLayout::isLayoutAttribute(name);
+    // The layout is applied only once the attribute is stored
+    DataLayout layout = inode_p->m_layout;
+    if (isLayout) {
+        // As in Lustre, the layout of a file can't change once the file has data
+        if (dynamic_cast<File *>(inode_p) != nullptr && inode_p->m_fuseEntryParam.attr.st_size > 0) {
+            ret_val = EBUSY;
+        }
+        else {
+            ret_val = layout.setAttribute(string(name), value, size, mpiWorldSize);
+        }
+    }
+
+    if (ret_val == 0) {
+        ret_val = inode_p->SetXAttr(string(name), value, size, flags, position);
+    }
+    if (ret_val == 0 && isLayout) {
+        inode_p->m_layout = layout;
+    }
 
     fuse_reply_err(req, ret_val);
 
@@ -1433,7 +1713,19 @@ void FileSystem::FuseRemoveXAttr(fuse_req_t req, fuse_ino_t ino, const char* nam
     INode *inode_p = INodeManager->getINodeByINodeNumber(ino);
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "\tremovexattr for " << ino);
-    int ret_val = inode_p->RemoveXAttr(string(name));
+    int ret_val = 0;
+    bool isLayout = DataLayout::isLayoutAttribute(name);
+    // As for FuseSetXAttr, the layout of a file can't change once the file has data
+    if (isLayout && dynamic_cast<File *>(inode_p) != nullptr && inode_p->m_fuseEntryParam.attr.st_size > 0) {
+        ret_val = EBUSY;
+    }
+
+    if (ret_val == 0) {
+        ret_val = inode_p->RemoveXAttr(string(name));
+    }
+    if (ret_val == 0 && isLayout) {
+        inode_p->m_layout.resetAttribute(string(name));
+    }
 
     fuse_reply_err(req,ret_val);
 
@@ -1501,6 +1793,7 @@ void FileSystem::FuseAccess(fuse_req_t req, fuse_ino_t ino, int mask) {
 
 void FileSystem::FuseCreate(fuse_req_t req, fuse_ino_t parent, const char* name, mode_t mode, struct fuse_file_info* fi) {
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "Creating " << name << " -> FuseRamFs::FuseCreate");
+    unique_lock<mutex> lock(m_namespaceMutex);
 
     if (parent >= INodeManager->getNumberOfINodes()) {
         fuse_reply_err(req, ENOENT);
@@ -1528,10 +1821,40 @@ void FileSystem::FuseCreate(fuse_req_t req, fuse_ino_t parent, const char* name,
     fuse_ino_t ino = RegisterINode(REGULAR_FILE, S_IFREG | 0777, 1, ctx_p->gid, ctx_p->uid);
     BlocksManager->createEmptyBlockListForInode(ino);
     INode *inode_p = INodeManager->getINodeByINodeNumber(ino);
+    InheritLayout(parentDir_p, inode_p);
 
     // Insert the inode into the directory. TODO: What if it already exists?
     parentDir_p->UpdateChild(string(name), ino);
 
+    INodeCreationRequest fileCreateRequest = MakeCreationRequest(parent, inode_p, name);
+
+    // In a sharded namespace the entry is created by its owner, this process keeps a copy
+    int owner = namespacePartition->getOwner(parent, name);
+    if (owner != mpiRank) {
+        lock.unlock();
+        NamespaceRequest entryRequest;
+        entryRequest.entry = fileCreateRequest;
+        int error = distributedProcessCode->createEntry(owner, entryRequest);
+        if (error == EAGAIN) {
+            // The owner doesn't know the parent directory yet: deliver the metadata log and retry
+            metadataLog->sync();
+            error = distributedProcessCode->createEntry(owner, entryRequest);
+        }
+        lock.lock();
+
+        if (error != 0) {
+            parentDir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(parent));
+            if (parentDir_p != nullptr) {
+                parentDir_p->DeleteChild(string(name));
+            }
+            inode_p->RemoveHardLink();
+            INodeManager->DeleteINode(ino);
+            fuse_reply_err(req, error);
+            return;
+        }
+        namespacePartition->cacheEntry(ino);
+    }
+
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() <<  "\tcreate for " << ino << " with name " << name << " in " << parent);
     inode_p->Lookup();
     if ( fi->flags & (O_WRONLY | O_TRUNC) ) {
@@ -1560,15 +1883,19 @@ void FileSystem::FuseCreate(fuse_req_t req, fuse_ino_t parent, const char* name,
     cout << fi->poll_events <<endl;
     cout << fi->writepage <<endl;
     */
+    fuse_entry_param entry = inode_p->m_fuseEntryParam;
+    if (owner != mpiRank) {
+        entry.entry_timeout = min(entry.entry_timeout, namespacePartition->getCacheTimeout());
+    }
+
     LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << " E' QUI CHE MI BLOCCO?");
-    fuse_reply_create(req, &(inode_p->m_fuseEntryParam), fi);
+    fuse_reply_create(req, &entry, fi);
     LOG4CPLUS_DEBUG(FSLogger, FSLogger.getName() << " NO SUPERATO");
 
-    string fileName = parentDir_p->getDirName() + name;
-    if (!createFileFromThread) {
-        RequestSender::sendCreateFileRequest(fileName, mpiRank, mpiWorldSize);
+    lock.unlock();
+    if (!namespacePartition->isSharded()) {
+        metadataLog->appendCreation(CREATE_FILE, fileCreateRequest);
     }
-    createFileFromThread = false;
 
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Creating " << name << " -> FuseRamFs::FuseCreate completed!");
@@ -1748,3 +2075,330 @@ void FileSystem::FuseWrite(fuse_req_t req, fuse_ino_t ino, const char* buf, size
 
     LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Writing " << ino << " -> FuseRamFs::FuseWrite completed!");
 }
+
+/**
+ * The inode is installed with the number and generation chosen by the creator. If the number was used by
+ * an inode deleted on the creator, the old replica is replaced, unless the kernel still uses it.
+ */
+void FileSystem::ReplicateCreate(INodeType type, const INodeCreationRequest &request) {
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Replicating creation of '" << request.name << "' -> FuseRamFs::ReplicateCreate");
+    lock_guard<mutex> lock(m_namespaceMutex);
+
+    if (InstallINode(type, request) != nullptr) {
+        // The kernel may remember that the name doesn't exist
+        kernelNotifier->invalidateEntry(request.parent, request.name);
+    }
+
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Replicating creation of '" << request.name << "' -> FuseRamFs::ReplicateCreate completed!");
+}
+
+INode *FileSystem::InstallINode(INodeType type, const INodeCreationRequest &request) {
+    Directory *parentDir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(request.parent));
+    if (parentDir_p == nullptr) {
+        LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() << "\tparent " << request.parent << " of '" << request.name << "' is not a directory");
+        return nullptr;
+    }
+
+    // The kernel may still use an inode deleted here: its number can't be reused until it's forgotten
+    INode *old_p = INodeManager->getINodeByINodeNumber(request.inode);
+    if (old_p != nullptr && !(old_p->HasNoLinks() && old_p->Forgotten())) {
+        LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() << "\tinode " << request.inode << " of '" << request.name << "' is still in use");
+        return nullptr;
+    }
+
+    INode *inode_p = INodeManager->createEmptyINode(type);
+    INodeManager->setINodeAt(request.inode, inode_p);
+    if (old_p != nullptr) {
+        FileSystem::UpdateUsedBlocks(-(old_p->UsedBlocks()));
+        delete old_p;
+    }
+    else {
+        FileSystem::UpdateUsedINodes(1);
+    }
+
+    nlink_t nlink = type == DIRECTORY ? 2 : 1;
+    INodeManager->InitializeINode(inode_p, request.inode, request.mode, nlink, request.gid, request.uid);
+    inode_p->m_fuseEntryParam.generation = request.generation;
+    inode_p->m_layout = request.layout;
+
+    if (type == DIRECTORY) {
+        LinkDirectory(parentDir_p, dynamic_cast<Directory *>(inode_p), request.inode, request.name);
+    }
+    else {
+        BlocksManager->createEmptyBlockListForInode(request.inode);
+        parentDir_p->UpdateChild(string(request.name), request.inode);
+    }
+
+    return inode_p;
+}
+
+INode *FileSystem::FindReplicaChild(fuse_ino_t parent, const char *name, fuse_ino_t ino, uint64_t generation, Directory **parentDir_p) {
+    *parentDir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(parent));
+    if (*parentDir_p == nullptr || (*parentDir_p)->ChildINodeNumberWithName(string(name)) != ino) {
+        LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() << "\t'" << name << "' in " << parent << " is not the inode " << ino);
+        return nullptr;
+    }
+
+    INode *inode_p = INodeManager->getINodeByINodeNumber(ino);
+    if (inode_p == nullptr || inode_p->m_fuseEntryParam.generation != generation) {
+        LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() << "\tstale request for inode " << ino << " generation " << generation);
+        return nullptr;
+    }
+
+    return inode_p;
+}
+
+void FileSystem::ReplicateUnlink(const INodeDeletionRequest &request) {
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Replicating unlink of '" << request.name << "' -> FuseRamFs::ReplicateUnlink");
+    lock_guard<mutex> lock(m_namespaceMutex);
+
+    Directory *parentDir_p;
+    INode *inode_p = FindReplicaChild(request.parent, request.name, request.inode, request.generation, &parentDir_p);
+    if (inode_p == nullptr) {
+        return;
+    }
+
+    inode_p->RemoveHardLink();
+    parentDir_p->DeleteChild(string(request.name));
+    kernelNotifier->invalidateEntry(request.parent, request.name);
+    kernelNotifier->invalidateINode(request.inode);
+
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Replicating unlink of '" << request.name << "' -> FuseRamFs::ReplicateUnlink completed!");
+}
+
+void FileSystem::ReplicateRmdir(const INodeDeletionRequest &request) {
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Replicating rmdir of '" << request.name << "' -> FuseRamFs::ReplicateRmdir");
+    lock_guard<mutex> lock(m_namespaceMutex);
+
+    Directory *parentDir_p;
+    Directory *dir_p = dynamic_cast<Directory *>(FindReplicaChild(request.parent, request.name, request.inode, request.generation, &parentDir_p));
+    if (dir_p == nullptr) {
+        return;
+    }
+
+    UnlinkDirectory(parentDir_p, dir_p, request.name);
+    kernelNotifier->invalidateEntry(request.parent, request.name);
+    kernelNotifier->invalidateINode(request.parent);
+
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Replicating rmdir of '" << request.name << "' -> FuseRamFs::ReplicateRmdir completed!");
+}
+
+void FileSystem::ReplicateRename(const RenameRequest &request) {
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Replicating rename of '" << request.oldName << "' -> FuseRamFs::ReplicateRename");
+    lock_guard<mutex> lock(m_namespaceMutex);
+
+    Directory *parentDir_p;
+    if (FindReplicaChild(request.parent, request.oldName, request.inode, request.generation, &parentDir_p) == nullptr) {
+        return;
+    }
+
+    Directory *newParentDir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(request.newParent));
+    if (newParentDir_p == nullptr) {
+        LOG4CPLUS_ERROR(FSLogger, FSLogger.getName() << "\tnew parent " << request.newParent << " is not a directory");
+        return;
+    }
+
+    MoveChild(parentDir_p, request.oldName, newParentDir_p, request.newName, request.inode);
+    kernelNotifier->invalidateEntry(request.parent, request.oldName);
+    kernelNotifier->invalidateEntry(request.newParent, request.newName);
+
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Replicating rename of '" << request.oldName << "' -> FuseRamFs::ReplicateRename completed!");
+}
+
+NamespaceReply FileSystem::MakeEntryReply(fuse_ino_t parent, INode *inode_p, const char *name) {
+    NamespaceReply reply;
+    reply.entry = MakeCreationRequest(parent, inode_p, name);
+    reply.size = inode_p->m_fuseEntryParam.attr.st_size;
+    reply.blocks = inode_p->m_fuseEntryParam.attr.st_blocks;
+    return reply;
+}
+
+/**
+ * The copy is replaced if the owner has another inode (or another generation) with the same name. The size is refreshed
+ * only if the file isn't open on this process, whose content would be written back on close.
+ */
+INode *FileSystem::InstallCachedEntry(Directory *parentDir_p, const NamespaceReply &reply) {
+    const INodeCreationRequest &entry = reply.entry;
+    fuse_ino_t existingIno = parentDir_p->ChildINodeNumberWithName(string(entry.name));
+    INode *inode_p = INodeManager->getINodeByINodeNumber(entry.inode);
+    if (inode_p == nullptr || inode_p->m_fuseEntryParam.generation != entry.generation) {
+        if (existingIno != -1 && existingIno != entry.inode) {
+            DropCachedEntry(parentDir_p, entry.name);
+        }
+        inode_p = InstallINode(REGULAR_FILE, entry);
+        if (inode_p == nullptr) {
+            return nullptr;
+        }
+    }
+    else if (existingIno != entry.inode) {
+        if (existingIno != -1) {
+            DropCachedEntry(parentDir_p, entry.name);
+        }
+        parentDir_p->UpdateChild(string(entry.name), entry.inode);
+        inode_p->AddHardLink();
+    }
+
+    File *file_p = dynamic_cast<File *>(inode_p);
+    if (file_p != nullptr && file_p->m_buf == nullptr) {
+        if (file_p->m_fuseEntryParam.attr.st_size != reply.size) {
+            kernelNotifier->invalidateINode(entry.inode);
+        }
+        file_p->m_fuseEntryParam.attr.st_size = reply.size;
+        file_p->m_fuseEntryParam.attr.st_blocks = reply.blocks;
+        file_p->m_layout = entry.layout;
+    }
+
+    namespacePartition->cacheEntry(entry.inode);
+    return inode_p;
+}
+
+void FileSystem::DropCachedEntry(Directory *parentDir_p, const char *name) {
+    fuse_ino_t ino = parentDir_p->ChildINodeNumberWithName(string(name));
+    if (ino == -1) {
+        return;
+    }
+
+    INode *inode_p = INodeManager->getINodeByINodeNumber(ino);
+    if (inode_p != nullptr) {
+        inode_p->RemoveHardLink();
+    }
+    parentDir_p->DeleteChild(string(name));
+    namespacePartition->forgetEntry(ino);
+    kernelNotifier->invalidateEntry(parentDir_p->m_fuseEntryParam.ino, name);
+}
+
+/**
+ * The owners are asked without holding the namespace lock, since they may be asking this process at the same time.
+ * The copies of the entries which are no longer listed by their owners are dropped.
+ */
+void FileSystem::RefreshDirectory(fuse_ino_t ino) {
+    vector<NamespaceReply> entries;
+    distributedProcessCode->listEntries(ino, entries);
+
+    lock_guard<mutex> lock(m_namespaceMutex);
+    Directory *dir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(ino));
+    if (dir_p == nullptr) {
+        return;
+    }
+
+    set<fuse_ino_t> listed;
+    for (NamespaceReply &entry : entries) {
+        InstallCachedEntry(dir_p, entry);
+        listed.insert(entry.entry.inode);
+    }
+
+    vector<string> stale;
+    for (auto &child : dir_p->Children()) {
+        INode *child_p = INodeManager->getINodeByINodeNumber(child.second);
+        if (dynamic_cast<Directory *>(child_p) != nullptr) {
+            continue;
+        }
+        if (namespacePartition->getOwner(ino, child.first.c_str()) != mpiRank && listed.find(child.second) == listed.end()) {
+            stale.push_back(child.first);
+        }
+    }
+    for (string &name : stale) {
+        DropCachedEntry(dir_p, name.c_str());
+    }
+}
+
+void FileSystem::ServeLookup(fuse_ino_t parent, const char *name, NamespaceReply &reply) {
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Serving lookup of '" << name << "' -> FuseRamFs::ServeLookup");
+    lock_guard<mutex> lock(m_namespaceMutex);
+
+    reply.error = ENOENT;
+    Directory *parentDir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(parent));
+    if (parentDir_p == nullptr) {
+        return;
+    }
+
+    fuse_ino_t ino = parentDir_p->ChildINodeNumberWithName(string(name));
+    INode *inode_p = ino == -1 ? nullptr : INodeManager->getINodeByINodeNumber(ino);
+    //Only the entries of the files are partitioned, the directories are replicated
+    if (dynamic_cast<File *>(inode_p) == nullptr) {
+        return;
+    }
+
+    reply = MakeEntryReply(parent, inode_p, name);
+}
+
+int FileSystem::ServeCreate(const NamespaceRequest &namespaceRequest) {
+    const INodeCreationRequest &request = namespaceRequest.entry;
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Serving creation of '" << request.name << "' -> FuseRamFs::ServeCreate");
+    lock_guard<mutex> lock(m_namespaceMutex);
+
+    Directory *parentDir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(request.parent));
+    if (parentDir_p == nullptr) {
+        //The creation of the directory is still in the metadata log of the other process
+        return EAGAIN;
+    }
+
+    fuse_ino_t existingIno = parentDir_p->ChildINodeNumberWithName(string(request.name));
+    if (existingIno != -1) {
+        INode *existing_p = INodeManager->getINodeByINodeNumber(existingIno);
+        if (existingIno == request.inode && existing_p != nullptr && existing_p->m_fuseEntryParam.generation == request.generation) {
+            return 0;
+        }
+        if (!namespaceRequest.replace || dynamic_cast<Directory *>(existing_p) != nullptr) {
+            return EEXIST;
+        }
+        DropCachedEntry(parentDir_p, request.name);
+    }
+
+    //A renamed entry keeps its inode, which may already be known by this process: every local name of an inode,
+    //even a cached one, counts as a hard link
+    INode *inode_p = INodeManager->getINodeByINodeNumber(request.inode);
+    if (inode_p != nullptr && inode_p->m_fuseEntryParam.generation == request.generation) {
+        parentDir_p->UpdateChild(string(request.name), request.inode);
+        inode_p->AddHardLink();
+    }
+    else {
+        inode_p = InstallINode(REGULAR_FILE, request);
+        if (inode_p == nullptr) {
+            //The number may be freed by a deletion still in the metadata log of the other process
+            return EAGAIN;
+        }
+    }
+    if (namespaceRequest.replace) {
+        inode_p->m_fuseEntryParam.attr.st_size = namespaceRequest.size;
+        inode_p->m_fuseEntryParam.attr.st_blocks = namespaceRequest.blocks;
+    }
+    namespacePartition->forgetEntry(request.inode);
+    kernelNotifier->invalidateEntry(request.parent, request.name);
+
+    return 0;
+}
+
+int FileSystem::ServeUnlink(const INodeDeletionRequest &request) {
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Serving unlink of '" << request.name << "' -> FuseRamFs::ServeUnlink");
+    lock_guard<mutex> lock(m_namespaceMutex);
+
+    Directory *parentDir_p;
+    INode *inode_p = FindReplicaChild(request.parent, request.name, request.inode, request.generation, &parentDir_p);
+    if (inode_p == nullptr) {
+        return ENOENT;
+    }
+
+    inode_p->RemoveHardLink();
+    parentDir_p->DeleteChild(string(request.name));
+    kernelNotifier->invalidateEntry(request.parent, request.name);
+    kernelNotifier->invalidateINode(request.inode);
+    return 0;
+}
+
+void FileSystem::ServeList(fuse_ino_t parent, vector<NamespaceReply> &entries) {
+    LOG4CPLUS_TRACE(FSLogger, FSLogger.getName() << "Serving list of " << parent << " -> FuseRamFs::ServeList");
+    lock_guard<mutex> lock(m_namespaceMutex);
+
+    Directory *dir_p = dynamic_cast<Directory *>(INodeManager->getINodeByINodeNumber(parent));
+    if (dir_p == nullptr) {
+        return;
+    }
+
+    for (auto &child : dir_p->Children()) {
+        INode *child_p = INodeManager->getINodeByINodeNumber(child.second);
+        if (dynamic_cast<File *>(child_p) != nullptr && namespacePartition->getOwner(parent, child.first.c_str()) == mpiRank) {
+            entries.push_back(MakeEntryReply(parent, child_p, child.first.c_str()));
+        }
+    }
+}
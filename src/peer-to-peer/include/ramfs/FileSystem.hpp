@@ -9,11 +9,15 @@
 #ifndef FILESYSTEM_HPP
 #define FILESYSTEM_HPP
 
+#include <mutex>
+
 #include "../utils/fuse_headers.hpp"
 #include "../nodes/Nodes.hpp"
 
 #include "../blocks/Blocks.hpp"
 #include "../mpi/DistributedCode.hpp"
+#include "../mpi/NamespacePartition.hpp"
+#include "KernelNotifier.hpp"
 
 #include "../utils/log_level.hpp"
 
@@ -78,6 +82,17 @@ private:
 
 	static DistributedCode *distributedProcessCode;
 
+	static MetadataLog *metadataLog;
+
+	static NamespacePartition *namespacePartition;
+
+	static KernelNotifier *kernelNotifier;
+
+    /**
+     * The seconds the kernel remembers that a name doesn't exist (-o negative_timeout), 0 disables the negative entries.
+     */
+    static double m_negativeTimeout;
+
 	static int mpiRank;
 
 	static int mpiWorldSize;
@@ -90,6 +105,14 @@ private:
     */
     static void show_usage(const char *progname);
 
+    /**
+     * @brief Reply to a lookup of a name which doesn't exist, with a negative entry if they are enabled.
+     *
+     * @param req The FUSE request.
+     * @param timeout The seconds the kernel can remember the negative entry.
+     */
+    static void ReplyNegativeEntry(fuse_req_t req, double timeout);
+
     /**
      * @brief Create a new i-node and insert it into the ram file system.
      *
@@ -101,6 +124,107 @@ private:
      * @return The i-node number of the new i-node.
      */
     static fuse_ino_t RegisterINode(INodeType type, mode_t mode, nlink_t nlink, gid_t gid, uid_t uid);
+
+    /**
+     * @brief Copy the layout policy (and its extended attributes) of a directory into a new child.
+     *
+     * @param parent The parent directory.
+     * @param child The new i-node.
+     */
+    static void InheritLayout(INode *parent, INode *child);
+
+    /**
+     * Guard of the directories and of the inode life cycle: the namespace is modified by the FUSE
+     * thread and by the MPI thread when it replicates the operations of the other processes.
+     */
+    static std::mutex m_namespaceMutex;
+
+    /**
+     * @brief Link a new directory into its parent directory.
+     *
+     * @param parentDir_p The parent directory.
+     * @param dir_p The new directory.
+     * @param ino The inode number of the new directory.
+     * @param name The name of the new directory.
+     */
+    static void LinkDirectory(Directory *parentDir_p, Directory *dir_p, fuse_ino_t ino, const char *name);
+
+    /**
+     * @brief Unlink an empty directory from its parent directory.
+     *
+     * @param parentDir_p The parent directory.
+     * @param dir_p The directory to remove.
+     * @param name The name of the directory to remove.
+     */
+    static void UnlinkDirectory(Directory *parentDir_p, Directory *dir_p, const char *name);
+
+    /**
+     * @brief Move an inode from a directory entry to another, replacing the existing one.
+     *
+     * @param parentDir The current parent directory.
+     * @param name The current name.
+     * @param newParentDir The new parent directory.
+     * @param newname The new name.
+     * @param ino The inode to move.
+     */
+    static void MoveChild(Directory *parentDir, const char *name, Directory *newParentDir, const char *newname, fuse_ino_t ino);
+
+    /**
+     * @brief Build the request replicating the creation of an inode on the other processes.
+     */
+    static INodeCreationRequest MakeCreationRequest(fuse_ino_t parent, INode *inode_p, const char *name);
+
+    /**
+     * @brief Build the request replicating the deletion of an inode on the other processes.
+     */
+    static INodeDeletionRequest MakeDeletionRequest(fuse_ino_t parent, INode *inode_p, const char *name);
+
+    /**
+     * @brief Find the inode targeted by a replicated operation.
+     *
+     * @param parent The parent directory of the inode.
+     * @param name The name of the inode in the parent directory.
+     * @param ino The expected inode number.
+     * @param generation The expected generation number.
+     * @param parentDir_p Set to the parent directory.
+     * @return The inode, nullptr if the local replica doesn't match the request.
+     */
+    static INode *FindReplicaChild(fuse_ino_t parent, const char *name, fuse_ino_t ino, uint64_t generation, Directory **parentDir_p);
+
+    /**
+     * @brief Install an inode created by another process, m_namespaceMutex must be held.
+     *
+     * An inode already at the same number is replaced only if it's deleted and forgotten by the kernel.
+     *
+     * @return The new inode, nullptr if the parent directory doesn't exist or the number is still in use.
+     */
+    static INode *InstallINode(INodeType type, const INodeCreationRequest &request);
+
+    /**
+     * @brief Build the reply describing an entry to another process.
+     */
+    static NamespaceReply MakeEntryReply(fuse_ino_t parent, INode *inode_p, const char *name);
+
+    /**
+     * @brief Install or refresh the local copy of an entry owned by another process, m_namespaceMutex must be held.
+     *
+     * @param parentDir_p The parent directory of the entry.
+     * @param reply The entry received from its owner.
+     * @return The inode of the entry.
+     */
+    static INode *InstallCachedEntry(Directory *parentDir_p, const NamespaceReply &reply);
+
+    /**
+     * @brief Drop the local copy of an entry which doesn't exist on its owner, m_namespaceMutex must be held.
+     */
+    static void DropCachedEntry(Directory *parentDir_p, const char *name);
+
+    /**
+     * @brief Fetch from the other processes the entries of a directory of a sharded namespace.
+     *
+     * @param ino The directory.
+     */
+    static void RefreshDirectory(fuse_ino_t ino);
 public:
     //Attributes
     /**
@@ -112,11 +236,6 @@ public:
 	static double endWriteTime;
 	static double startReadTime;
 	static double endReadTime;
-	static bool createFileFromThread;
-	static bool deleteFileFromThread;
-	static bool createDirFromThread;
-	static bool deleteDirFromThread;
-	static bool renameFromThread;
 	static bool unmountFromThread;
 
     //Methods
@@ -450,6 +569,63 @@ public:
      */
     static void FuseWrite(fuse_req_t req, fuse_ino_t ino, const char *buf, size_t size, off_t off, struct fuse_file_info *fi);
 
+    //  Replication of the operations of the other processes
+    /**
+     * @brief Apply to the local namespace the creation of an inode made by another process.
+     *
+     * @param type The type of the new inode (REGULAR_FILE or DIRECTORY).
+     * @param request The creation request received from the other process.
+     */
+    static void ReplicateCreate(INodeType type, const INodeCreationRequest &request);
+
+    /**
+     * @brief Apply to the local namespace the unlink of a file made by another process.
+     *
+     * @param request The deletion request received from the other process.
+     */
+    static void ReplicateUnlink(const INodeDeletionRequest &request);
+
+    /**
+     * @brief Apply to the local namespace the removal of a directory made by another process.
+     *
+     * @param request The deletion request received from the other process.
+     */
+    static void ReplicateRmdir(const INodeDeletionRequest &request);
+
+    /**
+     * @brief Apply to the local namespace the rename of an inode made by another process.
+     *
+     * @param request The rename request received from the other process.
+     */
+    static void ReplicateRename(const RenameRequest &request);
+
+    /**
+     * @brief Look up for another process an entry of a file owned by this process.
+     *
+     * @param reply Set to the entry, reply.error is ENOENT if it doesn't exist.
+     */
+    static void ServeLookup(fuse_ino_t parent, const char *name, NamespaceReply &reply);
+
+    /**
+     * @brief Create for another process an entry of a file owned by this process.
+     *
+     * @param request The entry, request.replace is TRUE if an existing entry with the same name is replaced.
+     * @return 0 on success, EAGAIN if the parent directory isn't known yet, EEXIST if the name is used.
+     */
+    static int ServeCreate(const NamespaceRequest &request);
+
+    /**
+     * @brief Unlink for another process an entry of a file owned by this process.
+     *
+     * @return 0 on success, ENOENT if the entry doesn't exist.
+     */
+    static int ServeUnlink(const INodeDeletionRequest &request);
+
+    /**
+     * @brief List for another process the entries of a directory owned by this process.
+     */
+    static void ServeList(fuse_ino_t parent, vector<NamespaceReply> &entries);
+
     /**
      * @brief Update the number of used blocks decrementing the number of the free blocks
      *
@@ -0,0 +1,104 @@
+//
+// Created on 10/19/26.
+//
+
+#include "KernelNotifier.hpp"
+
+#include <cerrno>
+
+using namespace std;
+using namespace log4cplus;
+
+KernelNotifier *KernelNotifier::instance = nullptr;
+
+KernelNotifier *KernelNotifier::getInstance() {
+    if (instance == nullptr) {
+        instance = new KernelNotifier();
+    }
+
+    return instance;
+}
+
+KernelNotifier::KernelNotifier() {
+    session = nullptr;
+    running = false;
+
+    NotifierLogger = Logger::getInstance("KernelNotifier.logger - ");
+    LogLevel ll = DAGONFS_LOG_LEVEL;
+    NotifierLogger.setLogLevel(ll);
+}
+
+void KernelNotifier::start(fuse_session *se) {
+    lock_guard<mutex> lock(queueMutex);
+    if (!running) {
+        session = se;
+        running = true;
+        notifierThread = thread(&KernelNotifier::notifierLoop, this);
+    }
+}
+
+void KernelNotifier::stop() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    queueCondition.notify_one();
+    notifierThread.join();
+
+    lock_guard<mutex> lock(queueMutex);
+    pending.clear();
+    session = nullptr;
+}
+
+void KernelNotifier::enqueue(Invalidation invalidation) {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        //Before the mount the kernel has nothing cached
+        if (!running) {
+            return;
+        }
+        pending.push_back(std::move(invalidation));
+    }
+    queueCondition.notify_one();
+}
+
+void KernelNotifier::invalidateEntry(fuse_ino_t parent, const char *name) {
+    enqueue({parent, 0, string(name)});
+}
+
+void KernelNotifier::invalidateINode(fuse_ino_t ino) {
+    enqueue({0, ino, string()});
+}
+
+void KernelNotifier::notifierLoop() {
+    unique_lock<mutex> lock(queueMutex);
+    while (running) {
+        if (pending.empty()) {
+            queueCondition.wait(lock);
+            continue;
+        }
+
+        Invalidation invalidation = std::move(pending.front());
+        pending.pop_front();
+        lock.unlock();
+
+        int ret;
+        if (invalidation.name.empty()) {
+            //Offset 0 and length 0 drop every cached page together with the attributes
+            ret = fuse_lowlevel_notify_inval_inode(session, invalidation.ino, 0, 0);
+        }
+        else {
+            ret = fuse_lowlevel_notify_inval_entry(session, invalidation.parent, invalidation.name.c_str(), invalidation.name.length());
+        }
+        //ENOENT: the kernel doesn't know the inode or the entry, there's nothing to invalidate
+        if (ret != 0 && ret != -ENOENT) {
+            LOG4CPLUS_ERROR(NotifierLogger, NotifierLogger.getName() << "invalidation of " << (invalidation.name.empty() ? invalidation.ino : invalidation.parent)
+                            << " '" << invalidation.name << "' failed: " << ret);
+        }
+
+        lock.lock();
+    }
+}
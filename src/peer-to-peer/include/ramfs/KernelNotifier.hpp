@@ -0,0 +1,83 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef KERNELNOTIFIER_HPP
+#define KERNELNOTIFIER_HPP
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <condition_variable>
+
+#include "../utils/fuse_headers.hpp"
+#include "../utils/log_level.hpp"
+
+using namespace std;
+
+/**
+ * @brief The invalidations of the kernel caches (attributes, pages and directory entries) of the local mount.
+ *
+ * The kernel keeps the attributes and the entries for the timeouts given in the FUSE replies, so the changes
+ * made by the other processes must be pushed to it. A notification can't be sent by a thread holding the
+ * namespace lock: the kernel may be waiting for a FUSE request which needs the lock, while holding the locks
+ * of the inode to invalidate. The notifications are queued and sent by a dedicated thread instead.
+ */
+class KernelNotifier {
+private:
+    typedef struct Invalidation {
+        fuse_ino_t parent;
+        fuse_ino_t ino;
+        string name;
+    } Invalidation;
+
+    //Singleton implementation
+    static KernelNotifier *instance;
+    KernelNotifier();
+
+    fuse_session *session;
+
+    mutex queueMutex;
+    condition_variable queueCondition;
+    thread notifierThread;
+    bool running;
+
+    //An invalidation of an entry has a name, an invalidation of an inode doesn't
+    deque<Invalidation> pending;
+
+    log4cplus::Logger NotifierLogger;
+
+    void enqueue(Invalidation invalidation);
+    void notifierLoop();
+
+public:
+    static KernelNotifier *getInstance();
+
+    /**
+     * @brief Start sending the notifications to a mounted session.
+     */
+    void start(fuse_session *se);
+
+    /**
+     * @brief Stop the notifier thread, it must be invoked before the session is unmounted.
+     */
+    void stop();
+
+    /**
+     * @brief Invalidate an entry (even a negative one) of a directory.
+     *
+     * @param parent The directory.
+     * @param name The name of the entry.
+     */
+    void invalidateEntry(fuse_ino_t parent, const char *name);
+
+    /**
+     * @brief Invalidate the attributes and the cached pages of an inode.
+     */
+    void invalidateINode(fuse_ino_t ino);
+};
+
+
+
+#endif //KERNELNOTIFIER_HPP